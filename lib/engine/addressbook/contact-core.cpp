@@ -46,6 +46,16 @@ on_search ()
   std::cout << "Search not implemented yet" << std::endl;
 }
 
+Ekiga::ContactCore::ContactCore (ServiceCore& _services):
+  services(_services)
+{
+  contact_updated.connect (sigc::mem_fun (this, &Ekiga::ContactCore::on_contact_changed));
+  contact_removed.connect (sigc::mem_fun (this, &Ekiga::ContactCore::on_contact_changed));
+  /* a refresh or a clear shows as an update of the book */
+  book_updated.connect (sigc::mem_fun (this, &Ekiga::ContactCore::on_book_changed));
+  book_removed.connect (sigc::mem_fun (this, &Ekiga::ContactCore::on_book_changed));
+}
+
 Ekiga::ContactCore::~ContactCore ()
 {
   for (std::list<sigc::connection>::iterator iter = conns.begin (); iter != conns.end (); ++iter)
@@ -91,6 +101,10 @@ Ekiga::ContactCore::visit_sources (sigc::slot1<bool, SourcePtr > visitor)
 {
   bool go_on = true;
 
+  /* the lazy sources are built the first time they're looked at -- be it
+   * from the address book window or from a search */
+  services.materialize ("addressbook");
+
   for (std::list<SourcePtr >::iterator iter = sources.begin ();
        iter != sources.end () && go_on;
        ++iter)
@@ -121,3 +135,46 @@ Ekiga::ContactCore::populate_contact_menu (ContactPtr contact,
 
   return populated;
 }
+
+const std::list<std::string>
+Ekiga::ContactCore::get_contact_uris (BookPtr book,
+				      ContactPtr contact)
+{
+  uris_cache &cache = contact_uris[&*book];
+  uris_cache::iterator iter = cache.find (&*contact);
+
+  if (iter == cache.end ())
+    iter = cache.insert (std::make_pair (&*contact, contact->get_uris ())).first;
+
+  return iter->second;
+}
+
+void
+Ekiga::ContactCore::on_contact_changed (SourcePtr /*source*/,
+					BookPtr book,
+					ContactPtr contact)
+{
+  std::map<const Book*, uris_cache>::iterator iter = contact_uris.find (&*book);
+
+  if (iter != contact_uris.end ())
+    iter->second.erase (&*contact);
+}
+
+void
+Ekiga::ContactCore::on_book_changed (SourcePtr /*source*/,
+				     BookPtr book)
+{
+  contact_uris.erase (&*book);
+}
+
+Ekiga::ContactSearchPtr
+Ekiga::ContactCore::search (const std::string query,
+			    ContactSearch::Sink sink,
+			    unsigned int budget)
+{
+  ContactSearchPtr result (new ContactSearch (*this, query, sink, budget));
+
+  result->start ();
+
+  return result;
+}
@@ -36,8 +36,11 @@
 #ifndef __CONTACT_CORE_H__
 #define __CONTACT_CORE_H__
 
+#include <map>
+
 #include "services.h"
 #include "source.h"
+#include "contact-search.h"
 
 /* declaration of a few helper classes */
 namespace Ekiga
@@ -71,9 +74,10 @@ namespace Ekiga
   public:
 
     /** The constructor.
+     * @param The service core, to build the lazy address book sources
+     * when they're needed.
      */
-    ContactCore ()
-    {}
+    ContactCore (ServiceCore& services);
 
     /** The destructor.
      */
@@ -105,7 +109,8 @@ namespace Ekiga
 
 
     /** Triggers a callback for all Ekiga::Source sources of the
-     * ContactCore service.
+     * ContactCore service (the lazy ones are built first if needed, so
+     * searches see them too).
      * @param The callback (the return value means "go on" and allows
      *  stopping the visit)
      */
@@ -147,8 +152,20 @@ namespace Ekiga
      */
     sigc::signal3<void, SourcePtr, BookPtr, ContactPtr > contact_updated;
 
+
+    /** Searches a text in the contacts of all the books of all the sources.
+     * @param The text to search.
+     * @param Where the results go, see Ekiga::ContactSearch.
+     * @param The latency budget, in milliseconds.
+     * @return The search, which can be cancelled.
+     */
+    ContactSearchPtr search (const std::string query,
+			     ContactSearch::Sink sink,
+			     unsigned int budget = 300);
+
   private:
 
+    ServiceCore& services;
     std::list<SourcePtr > sources;
 
     /*** Contact Helpers ***/
@@ -166,10 +183,32 @@ namespace Ekiga
 				const std::string uri,
                                 MenuBuilder &builder);
 
+    /** Returns the uris of a Contact of a Book, as Contact::get_uris
+     * does. They are remembered until the contact is updated or removed,
+     * or the book is updated or removed.
+     * @param The Ekiga::Book of the contact.
+     * @param The Ekiga::Contact.
+     * @return The uris, in the order the contact gives them.
+     */
+    const std::list<std::string> get_contact_uris (BookPtr book,
+						   ContactPtr contact);
+
   private:
 
+    void on_contact_changed (SourcePtr source,
+			     BookPtr book,
+			     ContactPtr contact);
+
+    void on_book_changed (SourcePtr source,
+			  BookPtr book);
+
     std::list<gmref_ptr<ContactDecorator> > contact_decorators;
 
+    /* by book then contact ; the pointers are only used as keys, so the
+     * cache doesn't keep anything alive */
+    typedef std::map<const Contact*, std::list<std::string> > uris_cache;
+    std::map<const Book*, uris_cache> contact_uris;
+
 
     /*** Misc ***/
 
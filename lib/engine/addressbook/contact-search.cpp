@@ -0,0 +1,330 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         contact-search.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of a search through all the books
+ *
+ */
+
+#include <algorithm>
+
+#include "contact-search.h"
+#include "contact-core.h"
+
+/* How long the search may keep the main loop at each turn, in ms */
+#define SLICE 10
+
+/* How many contacts of a book are looked at before the next book */
+#define CHUNK 32
+
+static std::string
+fold (const std::string text)
+{
+  std::string result;
+  gchar *normalized = g_utf8_normalize (text.c_str (), -1, G_NORMALIZE_ALL);
+
+  if (normalized == NULL)
+    return text;
+
+  gchar *folded = g_utf8_casefold (normalized, -1);
+  result = folded;
+
+  g_free (folded);
+  g_free (normalized);
+
+  return result;
+}
+
+static int
+name_rank (const std::string name,
+	   const std::string query)
+{
+  std::string::size_type pos = name.find (query);
+
+  if (pos == std::string::npos)
+    return -1;
+
+  if (pos == 0)
+    return 0;
+
+  for ( ; pos != std::string::npos ; pos = name.find (query, pos + 1))
+    if (g_ascii_isspace (name[pos - 1]) || g_ascii_ispunct (name[pos - 1]))
+      return 1;
+
+  return 3;
+}
+
+static int
+uri_rank (const std::string uri,
+	  const std::string query)
+{
+  std::string::size_type user = uri.find (':');
+
+  if (uri.find (query) == std::string::npos)
+    return -1;
+
+  /* "sip:user@host" or "h323:user@host" */
+  if (user == std::string::npos || user > uri.find ('@'))
+    user = 0;
+  else
+    user++;
+
+  if (uri.compare (user, query.length (), query) == 0)
+    return 2;
+
+  return 3;
+}
+
+static bool
+rank_less (const Ekiga::ContactSearchResult &a,
+	   const Ekiga::ContactSearchResult &b)
+{
+  return a.rank < b.rank;
+}
+
+
+Ekiga::ContactSearch::ContactSearch (ContactCore &_core,
+				     const std::string _query,
+				     Sink _sink,
+				     unsigned int _budget):
+  core(_core), query(fold (_query)), sink(_sink), budget(_budget),
+  timer(NULL), source_id(0), running(false)
+{
+  timer = g_timer_new ();
+}
+
+Ekiga::ContactSearch::~ContactSearch ()
+{
+  added_connection.disconnect ();
+  g_timer_destroy (timer);
+}
+
+void
+Ekiga::ContactSearch::start ()
+{
+  if (running)
+    return;
+
+  running = true;
+  g_timer_start (timer);
+
+  if ( !query.empty ()) {
+
+    core.visit_sources (sigc::mem_fun (this, &Ekiga::ContactSearch::on_source));
+    added_connection = core.contact_added.connect (sigc::mem_fun (this, &Ekiga::ContactSearch::on_contact_added));
+  }
+
+  /* the main loop keeps us alive while we run */
+  reference ();
+  source_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, on_idle, this, on_idle_destroyed);
+}
+
+void
+Ekiga::ContactSearch::cancel ()
+{
+  if ( !running)
+    return;
+
+  running = false;
+  added_connection.disconnect ();
+  pending.clear ();
+
+  if (source_id != 0)
+    g_source_remove (source_id);
+  source_id = 0;
+}
+
+bool
+Ekiga::ContactSearch::is_running () const
+{
+  return running;
+}
+
+bool
+Ekiga::ContactSearch::on_source (SourcePtr source)
+{
+  source->visit_books (sigc::mem_fun (this, &Ekiga::ContactSearch::on_book));
+
+  return true;
+}
+
+bool
+Ekiga::ContactSearch::on_book (BookPtr book)
+{
+  /* remote directories are searched in what they hold too : giving them
+   * the text as filter would query them at each keystroke, and change
+   * what their views show */
+  pending.push_back (Pending ());
+  pending.back ().book = book;
+  pending.back ().next = 0;
+
+  book->visit_contacts (sigc::bind (sigc::mem_fun (this, &Ekiga::ContactSearch::on_contact), &pending.back ()));
+
+  return true;
+}
+
+bool
+Ekiga::ContactSearch::on_contact (ContactPtr contact,
+				  Pending *book_pending)
+{
+  book_pending->contacts.push_back (contact);
+
+  return true;
+}
+
+void
+Ekiga::ContactSearch::on_contact_added (SourcePtr /*source*/,
+					BookPtr book,
+					ContactPtr contact)
+{
+  std::list<Pending>::iterator iter = pending.begin ();
+
+  while (iter != pending.end () && iter->book != book)
+    ++iter;
+
+  if (iter == pending.end ()) {
+
+    pending.push_back (Pending ());
+    pending.back ().book = book;
+    pending.back ().next = 0;
+    iter = --pending.end ();
+  }
+
+  iter->contacts.push_back (contact);
+}
+
+void
+Ekiga::ContactSearch::match (const Pending &book_pending,
+			     ContactPtr contact,
+			     std::list<ContactSearchResult> &batch)
+{
+  const std::string name = contact->get_name ();
+  int rank = name_rank (fold (name), query);
+  const std::list<std::string> uris = core.get_contact_uris (book_pending.book,
+							    contact);
+
+  for (std::list<std::string>::const_iterator iter = uris.begin ();
+       iter != uris.end ();
+       ++iter) {
+
+    if (found.find (*iter) != found.end ())
+      continue;
+
+    int best = uri_rank (fold (*iter), query);
+
+    if (best < 0 || (rank >= 0 && rank < best))
+      best = rank;
+
+    if (best < 0)
+      continue;
+
+    ContactSearchResult result;
+    result.contact = contact;
+    result.book = book_pending.book;
+    result.name = name;
+    result.uri = *iter;
+    result.rank = best;
+    batch.push_back (result);
+  }
+}
+
+bool
+Ekiga::ContactSearch::step ()
+{
+  std::list<ContactSearchResult> batch;
+  double slice_start = g_timer_elapsed (timer, NULL);
+  bool done = false;
+
+  /* each book in turn, a few contacts at a time */
+  while ( !done && (g_timer_elapsed (timer, NULL) - slice_start) * 1000 < SLICE) {
+
+    done = true;
+    for (std::list<Pending>::iterator iter = pending.begin ();
+	 iter != pending.end ();
+	 ++iter) {
+
+      size_t end = std::min (iter->next + CHUNK, iter->contacts.size ());
+
+      for ( ; iter->next < end ; iter->next++)
+	match (*iter, iter->contacts[iter->next], batch);
+
+      if (iter->next < iter->contacts.size ())
+	done = false;
+      else {
+
+	iter->contacts.clear ();
+	iter->next = 0;
+      }
+    }
+  }
+
+  /* best first, and each uri once */
+  batch.sort (rank_less);
+  for (std::list<ContactSearchResult>::iterator iter = batch.begin ();
+       iter != batch.end ();
+       /* nothing */)
+    if (found.insert (iter->uri).second)
+      ++iter;
+    else
+      iter = batch.erase (iter);
+
+  bool finished = done || g_timer_elapsed (timer, NULL) * 1000 >= budget;
+
+  if (finished)
+    finish ();
+
+  if ( !batch.empty () || finished)
+    sink (batch, finished);
+
+  /* the sink may have cancelled us */
+  return running;
+}
+
+void
+Ekiga::ContactSearch::finish ()
+{
+  running = false;
+  added_connection.disconnect ();
+  pending.clear ();
+}
+
+gboolean
+Ekiga::ContactSearch::on_idle (gpointer data)
+{
+  return ((ContactSearch *) data)->step ();
+}
+
+void
+Ekiga::ContactSearch::on_idle_destroyed (gpointer data)
+{
+  ContactSearch *self = (ContactSearch *) data;
+
+  self->source_id = 0;
+  self->unreference ();
+}
@@ -0,0 +1,173 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         contact-search.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : interface of a search through all the books
+ *
+ */
+
+#ifndef __CONTACT_SEARCH_H__
+#define __CONTACT_SEARCH_H__
+
+#include <list>
+#include <set>
+#include <vector>
+
+#include "source.h"
+
+namespace Ekiga
+{
+
+/**
+ * @addtogroup contacts
+ * @{
+ */
+
+  class ContactCore;
+
+  /** What a search found : one uri of a contact.
+   */
+  struct ContactSearchResult
+  {
+    ContactPtr contact;
+    BookPtr book;
+    std::string name;
+    std::string uri;
+    unsigned int rank;   // the lower the better
+  };
+
+  /** A search of a text in the contacts of all the books of all the
+   * sources of the ContactCore.
+   *
+   * The books are searched in turns, a few contacts at a time from the
+   * main loop, so that one big book doesn't hold back the results of the
+   * others and the user interface stays responsive. The search looks at
+   * the contacts the books hold : it doesn't ask remote directories for
+   * more, since that changes what their views show. The contacts which
+   * appear in a book during the search are looked at too.
+   *
+   * A contact matches if its name or one of its uris contains the text,
+   * regardless of the case. Each match is ranked :
+   *  - 0 : the name begins with the text ;
+   *  - 1 : a word of the name begins with the text ;
+   *  - 2 : the user part of the uri begins with the text ;
+   *  - 3 : the text is elsewhere in the name or the uri.
+   *
+   * The results are given to the sink as they are found, a batch at a
+   * time, best first ; an uri is only given once, with the best rank of
+   * the batch it was found in. The last batch, maybe empty, comes with
+   * finished set to true : either everything was searched, or the latency
+   * budget was spent. Once cancelled, the sink isn't called anymore.
+   */
+  class ContactSearch:
+    public virtual GmRefCounted,
+    public sigc::trackable
+  {
+  public:
+
+    typedef sigc::slot2<void, const std::list<ContactSearchResult> &, bool> Sink;
+
+    /** The constructor ; use ContactCore::search rather.
+     * @param The ContactCore whose books are searched.
+     * @param The text to search.
+     * @param Where the results go.
+     * @param The latency budget, in milliseconds.
+     */
+    ContactSearch (ContactCore &core,
+		   const std::string query,
+		   Sink sink,
+		   unsigned int budget);
+
+    ~ContactSearch ();
+
+    /** Starts the search ; the first results come from the main loop.
+     */
+    void start ();
+
+    /** Stops the search, if it isn't finished.
+     */
+    void cancel ();
+
+    /** Returns true until the search finished or was cancelled.
+     */
+    bool is_running () const;
+
+  private:
+
+    struct Pending
+    {
+      BookPtr book;
+      std::vector<ContactPtr> contacts;
+      size_t next;
+    };
+
+    bool on_source (SourcePtr source);
+
+    bool on_book (BookPtr book);
+
+    bool on_contact (ContactPtr contact,
+		     Pending *book_pending);
+
+    void on_contact_added (SourcePtr source,
+			   BookPtr book,
+			   ContactPtr contact);
+
+    void match (const Pending &book_pending,
+		ContactPtr contact,
+		std::list<ContactSearchResult> &batch);
+
+    bool step ();
+
+    void finish ();
+
+    static gboolean on_idle (gpointer data);
+
+    static void on_idle_destroyed (gpointer data);
+
+    ContactCore &core;
+    std::string query;   // normalized and case-folded
+    Sink sink;
+    unsigned int budget;
+
+    std::list<Pending> pending;
+    std::set<std::string> found;   // the uris given to the sink
+    sigc::connection added_connection;
+    GTimer *timer;
+    unsigned int source_id;
+    bool running;
+  };
+
+  typedef gmref_ptr<ContactSearch> ContactSearchPtr;
+
+/**
+ * @}
+ */
+
+};
+#endif
@@ -38,6 +38,7 @@
 #define __CONTACT_H__
 
 #include <set>
+#include <list>
 #include <map>
 #include <string>
 
@@ -93,6 +94,15 @@ namespace Ekiga
     virtual bool populate_menu (MenuBuilder &) = 0;
 
 
+    /** Returns the uris of the contact : the ones it gives to
+     * ContactCore::populate_contact_menu, in the same order.
+     * This function is purely virtual and should be implemented by
+     * the descendant of the Ekiga::Contact.
+     * @return The uris of the Ekiga::Contact.
+     */
+    virtual const std::list<std::string> get_uris () const = 0;
+
+
     /**
      * Signals on that object
      */
@@ -37,6 +37,8 @@
 #include <iostream>
 #include <sstream>
 #include <math.h>
+#include <cstring>
+#include <algorithm>
 
 #include "audioinput-core.h"
 
@@ -133,10 +135,17 @@ AudioInputCore::AudioInputCore (AudioOutputCore& _audio_output_core)
   current_volume = 0;
 
   current_manager = NULL;
+  device_samplerate = 0;
+  opened_samplerate = 0;
   audioinput_core_conf_bridge = NULL;
   average_level = 0;
+  average_level_bytes = 0;
   calculate_average = false;
   yield = false;
+
+  filters.append (new HighPassFilter ());
+  filters.append (new NoiseGate ());
+  filters.append (new AutomaticGainControl ());
 }
 
 AudioInputCore::~AudioInputCore ()
@@ -166,9 +175,9 @@ void AudioInputCore::add_manager (AudioInputManager &manager)
   managers.insert (&manager);
   manager_added.emit (manager);
 
-  manager.device_error.connect   (sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_error), &manager));
-  manager.device_opened.connect  (sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_opened), &manager));
-  manager.device_closed.connect  (sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_closed), &manager));
+  manager.device_events.subscribe (InternedString ("error"), sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_error), &manager));
+  manager.device_events.subscribe (InternedString ("opened"), sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_opened), &manager));
+  manager.device_events.subscribe (InternedString ("closed"), sigc::bind (sigc::mem_fun (this, &AudioInputCore::on_device_closed), &manager));
 }
 
 
@@ -282,7 +291,7 @@ void AudioInputCore::start_preview (unsigned channels, unsigned samplerate, unsi
   preview_config.num_buffers = 5;
 
   if (current_manager)
-    current_manager->set_buffer_size(preview_config.buffer_size, preview_config.num_buffers);
+    current_manager->set_buffer_size(device_buffer_size (preview_config.buffer_size, samplerate), preview_config.num_buffers);
 //    preview_manager.start(preview_config.channels,preview_config.samplerate);
 
   average_level = 0;
@@ -303,6 +312,10 @@ void AudioInputCore::stop_preview ()
   internal_close();
   internal_set_manager(desired_device);
   preview_config.active = false;
+
+  average_level = 0;
+  if (calculate_average)
+    push_average_level ();
 }
 
 
@@ -314,7 +327,7 @@ void AudioInputCore::set_stream_buffer_size (unsigned buffer_size, unsigned num_
   PTRACE(4, "AudioInputCore\tSetting stream buffer size " << num_buffers << "/" << buffer_size);
 
   if (current_manager)
-    current_manager->set_buffer_size(buffer_size, num_buffers);
+    current_manager->set_buffer_size(device_buffer_size (buffer_size, stream_config.samplerate), num_buffers);
 
   stream_config.buffer_size = buffer_size;
   stream_config.num_buffers = num_buffers;
@@ -360,6 +373,17 @@ void AudioInputCore::stop_stream ()
 
   stream_config.active = false;
   average_level = 0;
+  if (calculate_average)
+    push_average_level ();
+
+  std::vector<AudioFilterStatistics> statistics;
+  filters.get_statistics (statistics);
+  for (std::vector<AudioFilterStatistics>::const_iterator iter = statistics.begin ();
+       iter != statistics.end ();
+       iter++)
+    if (iter->buffers > 0)
+      PTRACE(4, "AudioInputCore\tFilter " << iter->name << ": " << iter->buffers << " buffers, "
+             << iter->total_time / iter->buffers << " us average, " << iter->max_time << " us max");
 }
 
 void AudioInputCore::get_frame_data (char *data,
@@ -373,12 +397,12 @@ void AudioInputCore::get_frame_data (char *data,
   PWaitAndSignal m_var(core_mutex);
 
   if (current_manager) {
-    if (!current_manager->get_frame_data(data, size, bytes_read)) {
+    if (!internal_read(data, size, bytes_read)) {
       internal_close();
       internal_set_fallback();
       internal_open(stream_config.channels, stream_config.samplerate, stream_config.bits_per_sample);
       if (current_manager)
-        current_manager->get_frame_data(data, size, bytes_read); // the default device must always return true
+        internal_read(data, size, bytes_read); // the default device must always return true
     }
 
     PWaitAndSignal m_vol(volume_mutex);
@@ -388,8 +412,52 @@ void AudioInputCore::get_frame_data (char *data,
     }
   }
 
-  if (calculate_average) 
+  filters.process ((short *) data, bytes_read);
+
+  if (calculate_average) {
     calculate_average_level((const short*) data, bytes_read);
+    update_average_level(bytes_read);
+  }
+
+  PWaitAndSignal m_taps(taps_mutex);
+  if (!taps.empty ()) {
+
+    const DeviceConfig & config = stream_config.active ? stream_config : preview_config;
+    for (std::set<AudioInputTap *>::iterator iter = taps.begin ();
+         iter != taps.end ();
+         iter++)
+      (*iter)->on_captured_audio (data, bytes_read, config.channels, config.samplerate, config.bits_per_sample);
+  }
+}
+
+void AudioInputCore::add_tap (AudioInputTap & tap)
+{
+  PWaitAndSignal m(taps_mutex);
+
+  taps.insert (&tap);
+}
+
+void AudioInputCore::remove_tap (AudioInputTap & tap)
+{
+  PWaitAndSignal m(taps_mutex);
+
+  taps.erase (&tap);
+}
+
+void AudioInputCore::add_filter (AudioFilter *filter)
+{
+  filters.append (filter);
+}
+
+void AudioInputCore::set_filter_enabled (const std::string & name, bool enabled)
+{
+  if (!filters.set_enabled (name, enabled))
+    PTRACE(1, "AudioInputCore\tTried to set unexisting filter " << name);
+}
+
+void AudioInputCore::get_filter_statistics (std::vector<AudioFilterStatistics> & statistics)
+{
+  filters.get_statistics (statistics);
 }
 
 void AudioInputCore::set_volume (unsigned volume)
@@ -399,21 +467,29 @@ void AudioInputCore::set_volume (unsigned volume)
   desired_volume = volume;
 }
 
-void AudioInputCore::on_device_opened (AudioInputDevice device,
-                                       AudioInputSettings settings, 
+void AudioInputCore::set_device_samplerate (unsigned samplerate)
+{
+  yield = true;
+  PWaitAndSignal m(core_mutex);
+
+  PTRACE(4, "AudioInputCore\tSetting device samplerate to " << samplerate);
+  device_samplerate = samplerate;
+}
+
+void AudioInputCore::on_device_opened (const AudioInputDeviceEvent & event,
                                        AudioInputManager *manager)
 {
-  device_opened.emit (*manager, device, settings);
+  device_opened.emit (*manager, event.device, event.settings);
 }
 
-void AudioInputCore::on_device_closed (AudioInputDevice device, AudioInputManager *manager)
+void AudioInputCore::on_device_closed (const AudioInputDeviceEvent & event, AudioInputManager *manager)
 {
-  device_closed.emit (*manager, device);
+  device_closed.emit (*manager, event.device);
 }
 
-void AudioInputCore::on_device_error (AudioInputDevice device, AudioInputErrorCodes error_code, AudioInputManager *manager)
+void AudioInputCore::on_device_error (const AudioInputDeviceEvent & event, AudioInputManager *manager)
 {
- device_error.emit (*manager, device, error_code);
+ device_error.emit (*manager, event.device, event.error_code);
 }
 
 void AudioInputCore::internal_set_device(const AudioInputDevice & device)
@@ -433,7 +509,7 @@ void AudioInputCore::internal_set_device(const AudioInputDevice & device)
 
     if ((preview_config.buffer_size > 0) && (preview_config.num_buffers > 0 ) ) {
       if (current_manager)
-        current_manager->set_buffer_size (preview_config.buffer_size, preview_config.num_buffers);
+        current_manager->set_buffer_size (device_buffer_size (preview_config.buffer_size, preview_config.samplerate), preview_config.num_buffers);
     }
 //    preview_manager.start();
   }
@@ -443,7 +519,7 @@ void AudioInputCore::internal_set_device(const AudioInputDevice & device)
 
     if ((stream_config.buffer_size > 0) && (stream_config.num_buffers > 0 ) ) {
       if (current_manager)
-        current_manager->set_buffer_size (stream_config.buffer_size, stream_config.num_buffers);
+        current_manager->set_buffer_size (device_buffer_size (stream_config.buffer_size, stream_config.samplerate), stream_config.num_buffers);
     }
   }
 }
@@ -485,6 +561,31 @@ void AudioInputCore::internal_open (unsigned channels, unsigned samplerate, unsi
 {
   PTRACE(4, "AudioInputCore\tOpening device with " << channels << "-" << samplerate << "/" << bits_per_sample );
 
+  /* the filters only handle 16 bit samples */
+  if (bits_per_sample == 16)
+    filters.reset (channels, samplerate);
+  else
+    filters.reset (0, 0);
+
+  opened_samplerate = samplerate;
+  converted.clear ();
+
+  /* open the device at its native rate and convert, rather than have
+   * the backend reopen it at every change of rate */
+  if (current_manager && device_samplerate != 0 && device_samplerate != samplerate && bits_per_sample == 16) {
+
+    if (current_manager->open(channels, device_samplerate, bits_per_sample)) {
+
+      PTRACE(4, "AudioInputCore\tConverting from " << device_samplerate << " to " << samplerate);
+      opened_samplerate = device_samplerate;
+      resampler.setup (channels, device_samplerate, samplerate);
+      return;
+    }
+    PTRACE(1, "AudioInputCore\tUnable to open device at " << device_samplerate << ", trying " << samplerate);
+  }
+
+  resampler.setup (channels, samplerate, samplerate);
+
   if (current_manager && !current_manager->open(channels, samplerate, bits_per_sample)) {
 
     internal_set_fallback();
@@ -501,6 +602,55 @@ void AudioInputCore::internal_close()
     current_manager->close();
 }
 
+bool AudioInputCore::internal_read (char *data, unsigned size, unsigned & bytes_read)
+{
+  if (!resampler.is_active () || resampler.is_passthrough ())
+    return current_manager->get_frame_data(data, size, bytes_read);
+
+  unsigned channels = resampler.get_channels ();
+  unsigned wanted = size / 2;
+
+  while (converted.size () < wanted) {
+
+    /* read what the missing samples need at the rate of the device */
+    unsigned missing = (wanted - converted.size ()) / channels + 1;
+    unsigned frames = (unsigned) (((unsigned long long) missing * resampler.get_in_rate ()) / resampler.get_out_rate ()) + 1;
+    unsigned read = 0;
+
+    device_buffer.resize (frames * channels);
+    if (!current_manager->get_frame_data((char *) &device_buffer[0], frames * channels * 2, read))
+      return false;
+
+    frames = read / (2 * channels);
+    if (frames == 0)
+      break;
+
+    unsigned start = converted.size ();
+    converted.resize (start + resampler.get_max_output (frames) * channels);
+    frames = resampler.process (&device_buffer[0], frames, &converted[start], (converted.size () - start) / channels);
+    converted.resize (start + frames * channels);
+  }
+
+  /* a short read from the device is made up with silence */
+  unsigned available = std::min (wanted, (unsigned) converted.size ());
+  if (available > 0)
+    memcpy (data, &converted[0], available * 2);
+  memset (data + available * 2, 0, size - available * 2);
+  converted.erase (converted.begin (), converted.begin () + available);
+  bytes_read = size;
+
+  return true;
+}
+
+unsigned AudioInputCore::device_buffer_size (unsigned buffer_size, unsigned samplerate)
+{
+  if (samplerate == 0 || opened_samplerate == samplerate)
+    return buffer_size;
+
+  /* the same duration at the rate of the device, in whole samples */
+  return (unsigned) (((unsigned long long) buffer_size * opened_samplerate / samplerate) & ~1ULL);
+}
+
 void AudioInputCore::calculate_average_level (const short *buffer, unsigned size)
 {
   int sum = 0;
@@ -518,3 +668,28 @@ void AudioInputCore::calculate_average_level (const short *buffer, unsigned size
 	  
   average_level = log10 (9.0*sum/size/32767+1)*1.0;
 }
+
+void AudioInputCore::update_average_level (unsigned size)
+{
+  const DeviceConfig & config = stream_config.active ? stream_config : preview_config;
+  unsigned period = config.samplerate * config.channels * (config.bits_per_sample / 8) * AUDIO_INPUT_LEVEL_PERIOD / 1000;
+
+  average_level_bytes += size;
+  if (average_level_bytes < period)
+    return;
+
+  average_level_bytes = 0;
+  push_average_level ();
+}
+
+void AudioInputCore::push_average_level ()
+{
+  /* the UI only wants the last level */
+  Ekiga::Runtime::run_in_main_coalesced ("audioinput-core-level",
+                                         sigc::mem_fun (this, &AudioInputCore::emit_average_level));
+}
+
+void AudioInputCore::emit_average_level ()
+{
+  average_level_changed.emit (average_level);
+}
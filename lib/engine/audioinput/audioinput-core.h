@@ -41,7 +41,9 @@
 #include "runtime.h"
 
 #include "audioinput-manager.h"
+#include "audioinput-filters.h"
 #include "audiooutput-core.h"
+#include "audiooutput-resampler.h"
 #include "hal-core.h"
 #include "audioinput-gmconf-bridge.h"
 
@@ -52,6 +54,9 @@
 #define AUDIO_INPUT_FALLBACK_DEVICE_SOURCE "Ekiga"
 #define AUDIO_INPUT_FALLBACK_DEVICE_NAME   "SILENT"
 
+/* How often the average level is pushed to the UI, in ms of audio */
+#define AUDIO_INPUT_LEVEL_PERIOD 50
+
 namespace Ekiga
 {
 /**
@@ -238,8 +243,20 @@ namespace Ekiga
        */
       void set_volume (unsigned volume);
 
+      /** Set the samplerate the devices are opened at
+       * The captured audio is converted from that rate to the one
+       * requested by start_stream() or start_preview(), so that the devices
+       * always run at their native rate. If a device can't be opened at
+       * that rate, it is opened at the requested one.
+       * Will be applied the next time the device is opened.
+       * @param samplerate the samplerate, or 0 to open the devices at the
+       * requested rate.
+       */
+      void set_device_samplerate (unsigned samplerate);
+
       /** Turn average collecion on and off
-       * The average values can be collected via get_average_level()
+       * The average values can be collected via get_average_level(), or
+       * through the average_level_changed signal.
        * @param on_off whether to turn the collection on or off.
        */
       void set_average_collection (bool on_off) { calculate_average = on_off; }
@@ -250,14 +267,50 @@ namespace Ekiga
        */
       float get_average_level () { return average_level; }
 
+      /** Register a consumer of the captured audio
+       * The tap gets every buffer returned by get_frame_data(), from the
+       * thread calling it.
+       * @param tap the tap.
+       */
+      void add_tap (AudioInputTap & tap);
+
+      /** Unregister a consumer of the captured audio
+       * When this returns, the tap isn't called anymore.
+       * @param tap the tap.
+       */
+      void remove_tap (AudioInputTap & tap);
+
+      /** Add a filter at the end of the capture processing chain
+       * The captured buffers go through the enabled filters of the chain
+       * before they are returned by get_frame_data(). The filter starts
+       * disabled.
+       * @param filter the filter, which the core then owns.
+       */
+      void add_filter (AudioFilter *filter);
+
+      /** Enable or disable a filter of the capture processing chain
+       * The high-pass filter ("high-pass"), the noise gate ("noise-gate")
+       * and the automatic gain control ("automatic-gain-control") are
+       * always in the chain.
+       * @param name the name of the filter.
+       * @param enabled whether the captured buffers go through it.
+       */
+      void set_filter_enabled (const std::string & name, bool enabled);
+
+      /** Get the time spent in each filter of the chain
+       * The statistics are reset every time the device is opened.
+       * @param statistics filled with one entry per filter.
+       */
+      void get_filter_statistics (std::vector<AudioFilterStatistics> & statistics);
+
 
       /*** VidInput Related Signals ***/
 
       /** See audioinput-manager.h for the API
        */
-      sigc::signal3<void, AudioInputManager &, AudioInputDevice &, AudioInputSettings&> device_opened;
-      sigc::signal2<void, AudioInputManager &, AudioInputDevice &> device_closed;
-      sigc::signal3<void, AudioInputManager &, AudioInputDevice &, AudioInputErrorCodes> device_error;
+      sigc::signal3<void, AudioInputManager &, const AudioInputDevice &, const AudioInputSettings &> device_opened;
+      sigc::signal2<void, AudioInputManager &, const AudioInputDevice &> device_closed;
+      sigc::signal3<void, AudioInputManager &, const AudioInputDevice &, AudioInputErrorCodes> device_error;
 
       /** This signal is emitted when an audio device input has been added to the system.
        * This signal will be emitted if add_device was called with a device name and
@@ -273,12 +326,18 @@ namespace Ekiga
        */
       sigc::signal2<void, AudioInputDevice, bool> device_removed;
 
+      /** This signal is emitted in the main thread while the average
+       * collection is on, when a new average level is available ; that is
+       * at most every AUDIO_INPUT_LEVEL_PERIOD ms, and never when no audio
+       * is captured.
+       * @param level the average volume level.
+       */
+      sigc::signal1<void, float> average_level_changed;
+
   private:
-      void on_device_opened (AudioInputDevice device,  
-                             AudioInputSettings settings, 
-                             AudioInputManager *manager);
-      void on_device_closed (AudioInputDevice device, AudioInputManager *manager);
-      void on_device_error  (AudioInputDevice device, AudioInputErrorCodes error_code, AudioInputManager *manager);
+      void on_device_opened (const AudioInputDeviceEvent & event, AudioInputManager *manager);
+      void on_device_closed (const AudioInputDeviceEvent & event, AudioInputManager *manager);
+      void on_device_error  (const AudioInputDeviceEvent & event, AudioInputManager *manager);
 
       void internal_set_device(const AudioInputDevice & device);
       void internal_set_manager (const AudioInputDevice & device);
@@ -286,8 +345,13 @@ namespace Ekiga
 
       void internal_open (unsigned channels, unsigned samplerate, unsigned bits_per_sample);
       void internal_close();
+      bool internal_read (char *data, unsigned size, unsigned & bytes_read);
+      unsigned device_buffer_size (unsigned buffer_size, unsigned samplerate);
 
       void calculate_average_level (const short *buffer, unsigned size);
+      void update_average_level (unsigned size);
+      void push_average_level ();
+      void emit_average_level ();
 
   private:
 
@@ -338,10 +402,22 @@ namespace Ekiga
       PMutex core_mutex;
       PMutex volume_mutex;
 
+      std::set<AudioInputTap *> taps;
+      PMutex taps_mutex;
+
+      AudioFilterChain filters;
+
+      unsigned device_samplerate;
+      unsigned opened_samplerate;
+      AudioResampler resampler;
+      std::vector<short> device_buffer;
+      std::vector<short> converted;  // converted, not returned yet
+
       AudioPreviewManager preview_manager;
       AudioInputCoreConfBridge* audioinput_core_conf_bridge;
 
       float average_level;
+      unsigned average_level_bytes;  // captured since the last push
       bool calculate_average;
       bool yield;
     };
@@ -0,0 +1,462 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         audioinput-filters.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Implementation of the filters processing the
+ *                          captured audio before it is streamed.
+ *
+ */
+
+#include <math.h>
+
+#include "audioinput-filters.h"
+
+/* Time constants of the automatic gain control, in ms : the gain goes
+ * down quickly on loud speech, and comes back up slowly */
+#define AGC_ATTACK 50
+#define AGC_RELEASE 1500
+
+using namespace Ekiga;
+
+/* The peak, level and gain kernels below are written so that the
+ * iterations don't depend on each other : the saturation has no branch,
+ * the sums are on integers (a float sum can't be reordered), and a gain
+ * ramp is computed from the index rather than accumulated. As Ekiga is
+ * built at -O2, where GCC doesn't vectorize, they ask for it explicitly
+ * (the ramp over interleaved channels stays scalar).
+ *
+ * The high-pass filter can't be vectorized this way : each output
+ * depends on the two previous ones. */
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4))
+#define VECTORIZED __attribute__ ((optimize ("tree-vectorize")))
+#else
+#define VECTORIZED
+#endif
+
+static float
+db_to_amplitude (float db)
+{
+  return (float) pow (10.0, db / 20.0);
+}
+
+
+/* Rounds to the nearest (truncating is flooring while value + 32768.5 is
+ * positive), then clamps on integers : a clamp on floats would be turned
+ * into branches around float operations, which GCC doesn't vectorize as
+ * they could trap. The values are the samples times a bounded gain, far
+ * from the limits of an int. */
+static inline short
+saturate (float value)
+{
+  int rounded = (int) (value + 32768.5f) - 32768;
+
+  rounded = rounded > 32767 ? 32767 : rounded;
+  rounded = rounded < -32768 ? -32768 : rounded;
+
+  return (short) rounded;
+}
+
+
+static unsigned VECTORIZED
+buffer_peak (const short *samples,
+             unsigned count)
+{
+  int peak = 0;
+
+  for (unsigned i = 0 ; i < count ; i++) {
+
+    int value = samples[i] < 0 ? -samples[i] : samples[i];
+    peak = value > peak ? value : peak;
+  }
+
+  return peak;
+}
+
+
+static float VECTORIZED
+buffer_rms (const short *samples,
+            unsigned count)
+{
+  long long sum = 0;
+
+  if (count == 0)
+    return 0;
+
+  for (unsigned i = 0 ; i < count ; i++)
+    sum += (int) samples[i] * samples[i];
+
+  return (float) sqrt ((double) sum / count);
+}
+
+
+/* Apply a gain going linearly from 'from' to 'to' over the buffer, so that
+ * gain changes don't click */
+static void VECTORIZED
+apply_gain (short *samples,
+            unsigned frames,
+            unsigned channels,
+            float from,
+            float to)
+{
+  if (from == 1.0f && to == 1.0f)
+    return;
+
+  if (from == to) {
+
+    unsigned count = frames * channels;
+    for (unsigned i = 0 ; i < count ; i++)
+      samples[i] = saturate (samples[i] * from);
+    return;
+  }
+
+  float step = (to - from) / frames;
+
+  if (channels == 1) {
+
+    for (unsigned i = 0 ; i < frames ; i++)
+      samples[i] = saturate (samples[i] * (from + step * i));
+    return;
+  }
+
+  for (unsigned i = 0 ; i < frames ; i++) {
+
+    float gain = from + step * i;
+    for (unsigned c = 0 ; c < channels ; c++)
+      samples[i * channels + c] = saturate (samples[i * channels + c] * gain);
+  }
+}
+
+
+HighPassFilter::HighPassFilter (unsigned cutoff_)
+  : cutoff(cutoff_), channels(0)
+{
+  reset (1, 0);
+}
+
+
+void
+HighPassFilter::reset (unsigned channels_,
+                       unsigned samplerate)
+{
+  channels = channels_;
+  states.assign (channels, State ());
+  for (unsigned c = 0 ; c < channels ; c++)
+    states[c].x1 = states[c].x2 = states[c].y1 = states[c].y2 = 0;
+
+  if (samplerate == 0 || 2 * cutoff >= samplerate) {
+
+    b0 = 1;
+    b1 = b2 = a1 = a2 = 0;
+    return;
+  }
+
+  /* second order Butterworth, from the bilinear transform */
+  double w0 = 2 * M_PI * cutoff / samplerate;
+  double alpha = sin (w0) / (2 * M_SQRT1_2);
+  double a0 = 1 + alpha;
+
+  b0 = (float) ((1 + cos (w0)) / 2 / a0);
+  b1 = (float) (-(1 + cos (w0)) / a0);
+  b2 = b0;
+  a1 = (float) (-2 * cos (w0) / a0);
+  a2 = (float) ((1 - alpha) / a0);
+}
+
+
+void
+HighPassFilter::process (short *samples,
+                         unsigned frames)
+{
+  for (unsigned c = 0 ; c < channels ; c++) {
+
+    State & state = states[c];
+    short *sample = samples + c;
+
+    for (unsigned i = 0 ; i < frames ; i++, sample += channels) {
+
+      float x = *sample;
+      float y = b0 * x + b1 * state.x1 + b2 * state.x2 - a1 * state.y1 - a2 * state.y2;
+
+      state.x2 = state.x1;
+      state.x1 = x;
+      state.y2 = state.y1;
+      state.y1 = y;
+      *sample = saturate (y);
+    }
+
+    /* the output of digital silence decays into denormals, which are
+     * very slow to compute with */
+    if (fabs (state.y1) < 1e-10 && fabs (state.y2) < 1e-10)
+      state.y1 = state.y2 = 0;
+  }
+}
+
+
+NoiseGate::NoiseGate (int threshold_,
+                      unsigned attenuation,
+                      unsigned hold_,
+                      unsigned release_)
+  : channels(0), hold_ms(hold_), release_ms(release_)
+{
+  threshold = (unsigned) (32767 * db_to_amplitude (threshold_));
+  floor = db_to_amplitude (- (float) attenuation);
+  reset (1, 8000);
+}
+
+
+void
+NoiseGate::reset (unsigned channels_,
+                  unsigned samplerate)
+{
+  channels = channels_;
+  hold = hold_ms * samplerate / 1000;
+  release = release_ms * samplerate / 1000;
+  hold_left = 0;
+  gain = floor;
+}
+
+
+void
+NoiseGate::process (short *samples,
+                    unsigned frames)
+{
+  float target = floor;
+
+  if (buffer_peak (samples, frames * channels) >= threshold) {
+
+    hold_left = hold;
+    target = 1;
+  }
+  else if (hold_left > 0) {
+
+    hold_left = (hold_left > frames) ? hold_left - frames : 0;
+    target = 1;
+  }
+  else if (release > 0) {
+
+    target = gain - (1 - floor) * frames / release;
+    if (target < floor)
+      target = floor;
+  }
+
+  apply_gain (samples, frames, channels, gain, target);
+  gain = target;
+}
+
+
+AutomaticGainControl::AutomaticGainControl (int target_,
+                                            unsigned max_gain_,
+                                            int threshold_)
+  : channels(0), samplerate(0), gain(1)
+{
+  target = 32767 * db_to_amplitude (target_);
+  max_gain = db_to_amplitude (max_gain_);
+  threshold = 32767 * db_to_amplitude (threshold_);
+}
+
+
+void
+AutomaticGainControl::reset (unsigned channels_,
+                             unsigned samplerate_)
+{
+  channels = channels_;
+  samplerate = samplerate_;
+  gain = 1;
+}
+
+
+void
+AutomaticGainControl::process (short *samples,
+                               unsigned frames)
+{
+  unsigned count = frames * channels;
+  float rms = buffer_rms (samples, count);
+  unsigned peak = buffer_peak (samples, count);
+  float from = gain;
+  float next = gain;
+
+  if (samplerate == 0)
+    return;
+
+  /* only speech moves the gain, so that it doesn't climb during the
+   * silences */
+  if (rms >= threshold) {
+
+    float desired = target / rms;
+    if (desired > max_gain)
+      desired = max_gain;
+    if (desired < 1 / max_gain)
+      desired = 1 / max_gain;
+
+    double duration = 1000.0 * frames / samplerate;
+    double time_constant = (desired < gain) ? AGC_ATTACK : AGC_RELEASE;
+    next = gain + (desired - gain) * (float) (1 - exp (-duration / time_constant));
+  }
+
+  /* never clip */
+  if (peak > 0 && peak * next > 32767)
+    next = 32767.0f / peak;
+  if (peak > 0 && peak * from > 32767)
+    from = 32767.0f / peak;
+
+  apply_gain (samples, frames, channels, from, next);
+  gain = next;
+}
+
+
+AudioFilterChain::AudioFilterChain ()
+  : channels(0), samplerate(0)
+{
+  timer = g_timer_new ();
+}
+
+
+AudioFilterChain::~AudioFilterChain ()
+{
+  for (std::vector<Stage>::iterator iter = stages.begin ();
+       iter != stages.end ();
+       ++iter)
+    delete iter->filter;
+
+  g_timer_destroy (timer);
+}
+
+
+void
+AudioFilterChain::append (AudioFilter *filter)
+{
+  PWaitAndSignal m(mutex);
+
+  Stage stage;
+  stage.filter = filter;
+  stage.statistics.name = filter->get_name ();
+
+  if (channels > 0)
+    filter->reset (channels, samplerate);
+
+  stages.push_back (stage);
+}
+
+
+bool
+AudioFilterChain::set_enabled (const std::string & name,
+                               bool enabled)
+{
+  PWaitAndSignal m(mutex);
+
+  for (std::vector<Stage>::iterator iter = stages.begin ();
+       iter != stages.end ();
+       ++iter) {
+
+    if (iter->statistics.name == name) {
+
+      PTRACE(4, "AudioFilterChain\t" << (enabled ? "Enabling " : "Disabling ") << name);
+
+      /* start from a clean state rather than from where the filter was
+       * when it got disabled */
+      if (enabled && !iter->statistics.enabled && channels > 0)
+        iter->filter->reset (channels, samplerate);
+
+      iter->statistics.enabled = enabled;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void
+AudioFilterChain::reset (unsigned channels_,
+                         unsigned samplerate_)
+{
+  PWaitAndSignal m(mutex);
+
+  channels = channels_;
+  samplerate = samplerate_;
+
+  for (std::vector<Stage>::iterator iter = stages.begin ();
+       iter != stages.end ();
+       ++iter) {
+
+    if (channels > 0)
+      iter->filter->reset (channels, samplerate);
+
+    iter->statistics.buffers = 0;
+    iter->statistics.total_time = 0;
+    iter->statistics.max_time = 0;
+  }
+}
+
+
+void
+AudioFilterChain::process (short *samples,
+                           unsigned size)
+{
+  PWaitAndSignal m(mutex);
+
+  if (channels == 0)
+    return;
+
+  unsigned frames = size / (2 * channels);
+  if (frames == 0)
+    return;
+
+  for (std::vector<Stage>::iterator iter = stages.begin ();
+       iter != stages.end ();
+       ++iter) {
+
+    AudioFilterStatistics & statistics = iter->statistics;
+
+    if (!statistics.enabled)
+      continue;
+
+    g_timer_start (timer);
+    iter->filter->process (samples, frames);
+    double elapsed = g_timer_elapsed (timer, NULL) * 1000000;
+
+    statistics.buffers++;
+    statistics.total_time += elapsed;
+    if (elapsed > statistics.max_time)
+      statistics.max_time = elapsed;
+  }
+}
+
+
+void
+AudioFilterChain::get_statistics (std::vector<AudioFilterStatistics> & statistics) const
+{
+  PWaitAndSignal m(mutex);
+
+  statistics.clear ();
+  for (std::vector<Stage>::const_iterator iter = stages.begin ();
+       iter != stages.end ();
+       ++iter)
+    statistics.push_back (iter->statistics);
+}
@@ -0,0 +1,282 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         audioinput-filters.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Declaration of the filters processing the
+ *                          captured audio before it is streamed.
+ *
+ */
+
+#ifndef __AUDIOINPUT_FILTERS_H__
+#define __AUDIOINPUT_FILTERS_H__
+
+#include <glib.h>
+
+#include "ptbuildopts.h"
+#include "ptlib.h"
+
+#include <string>
+#include <vector>
+
+namespace Ekiga
+{
+/**
+ * @addtogroup audioinput
+ * @{
+ */
+
+  /** A processing stage of the captured audio
+   *
+   * Filters work in place on buffers of interleaved 16 bit samples, so
+   * that they can be chained without any copy.
+   */
+  class AudioFilter
+  {
+  public:
+
+    virtual ~AudioFilter () {}
+
+    /** Return the name identifying the filter in the chain
+     */
+    virtual const std::string get_name () const = 0;
+
+    /** Forget the state and prepare for a new stream
+     * @param channels the number of interleaved channels.
+     * @param samplerate the samplerate.
+     */
+    virtual void reset (unsigned channels,
+                        unsigned samplerate) = 0;
+
+    /** Process a buffer in place
+     * @param samples the interleaved samples.
+     * @param frames the number of samples per channel in the buffer.
+     */
+    virtual void process (short *samples,
+                          unsigned frames) = 0;
+  };
+
+
+  /** Removes the DC offset and the low frequency rumble (second order
+   * Butterworth high-pass filter)
+   */
+  class HighPassFilter : public AudioFilter
+  {
+  public:
+
+    /** The constructor
+     * @param cutoff the cutoff frequency in Hz.
+     */
+    HighPassFilter (unsigned cutoff = 100);
+
+    const std::string get_name () const
+      { return "high-pass"; }
+
+    void reset (unsigned channels,
+                unsigned samplerate);
+
+    void process (short *samples,
+                  unsigned frames);
+
+  private:
+
+    struct State
+    {
+      float x1, x2, y1, y2;
+    };
+
+    unsigned cutoff;
+    unsigned channels;
+    float b0, b1, b2, a1, a2;
+    std::vector<State> states;
+  };
+
+
+  /** Attenuates the signal while it stays below a threshold, so that the
+   * background noise isn't sent between the sentences
+   */
+  class NoiseGate : public AudioFilter
+  {
+  public:
+
+    /** The constructor
+     * @param threshold the level opening the gate, in dBFS.
+     * @param attenuation the attenuation of the closed gate, in dB.
+     * @param hold the time the gate stays open after the signal fell
+     * below the threshold, in ms.
+     * @param release the time the gate takes to close, in ms.
+     */
+    NoiseGate (int threshold = -45,
+               unsigned attenuation = 24,
+               unsigned hold = 200,
+               unsigned release = 100);
+
+    const std::string get_name () const
+      { return "noise-gate"; }
+
+    void reset (unsigned channels,
+                unsigned samplerate);
+
+    void process (short *samples,
+                  unsigned frames);
+
+  private:
+
+    unsigned channels;
+    unsigned threshold;       // peak amplitude
+    float floor;              // gain of the closed gate
+    unsigned hold;            // in frames
+    unsigned release;         // in frames
+    unsigned hold_ms;
+    unsigned release_ms;
+    unsigned hold_left;
+    float gain;
+  };
+
+
+  /** Brings the speech level to a target, without amplifying the silences
+   * and without clipping
+   */
+  class AutomaticGainControl : public AudioFilter
+  {
+  public:
+
+    /** The constructor
+     * @param target the level to reach, in dBFS.
+     * @param max_gain the maximum gain, in dB.
+     * @param threshold the level under which the gain isn't adapted, in dBFS.
+     */
+    AutomaticGainControl (int target = -18,
+                          unsigned max_gain = 18,
+                          int threshold = -45);
+
+    const std::string get_name () const
+      { return "automatic-gain-control"; }
+
+    void reset (unsigned channels,
+                unsigned samplerate);
+
+    void process (short *samples,
+                  unsigned frames);
+
+  private:
+
+    unsigned channels;
+    unsigned samplerate;
+    float target;             // rms amplitude
+    float max_gain;
+    float threshold;          // rms amplitude
+    float gain;
+  };
+
+
+  /** The CPU time a filter of the chain took
+   */
+  class AudioFilterStatistics
+  {
+  public:
+
+    AudioFilterStatistics (): enabled(false), buffers(0), total_time(0), max_time(0) {}
+
+    std::string name;
+    bool enabled;
+    unsigned long buffers;    // the number of buffers processed
+    double total_time;        // in microseconds
+    double max_time;          // in microseconds, for one buffer
+  };
+
+
+  /** An ordered chain of filters, which the buffers go through
+   *
+   * All the methods are thread-safe : the stream thread processes the
+   * buffers while the UI thread enables the filters or collects the
+   * statistics.
+   */
+  class AudioFilterChain
+  {
+  public:
+
+    AudioFilterChain ();
+
+    ~AudioFilterChain ();
+
+    /** Add a filter at the end of the chain, disabled
+     * @param filter the filter, which the chain then owns.
+     */
+    void append (AudioFilter *filter);
+
+    /** Enable or disable a filter
+     * @param name the name of the filter.
+     * @param enabled whether the buffers go through it.
+     * @return false if there is no filter with that name.
+     */
+    bool set_enabled (const std::string & name,
+                      bool enabled);
+
+    /** Forget the state of the filters and the statistics, and prepare for
+     * a new stream
+     * @param channels the number of interleaved channels.
+     * @param samplerate the samplerate.
+     */
+    void reset (unsigned channels,
+                unsigned samplerate);
+
+    /** Run a buffer through the enabled filters
+     * @param samples the interleaved 16 bit samples.
+     * @param size the size of the buffer in bytes.
+     */
+    void process (short *samples,
+                  unsigned size);
+
+    /** Get the statistics since the last reset, one per filter in the
+     * order of the chain
+     */
+    void get_statistics (std::vector<AudioFilterStatistics> & statistics) const;
+
+  private:
+
+    struct Stage
+    {
+      AudioFilter *filter;
+      AudioFilterStatistics statistics;
+    };
+
+    std::vector<Stage> stages;
+    unsigned channels;
+    unsigned samplerate;
+    GTimer *timer;
+
+    mutable PMutex mutex;
+  };
+
+/**
+ * @}
+ */
+};
+
+#endif
@@ -51,6 +51,10 @@ AudioInputCoreConfBridge::AudioInputCoreConfBridge (Ekiga::Service & _service)
   property_changed.connect (sigc::mem_fun (this, &AudioInputCoreConfBridge::on_property_changed));
 
   keys.push_back (AUDIO_DEVICES_KEY "input_device"); 
+  keys.push_back (AUDIO_DEVICES_KEY "samplerate");
+  keys.push_back (AUDIO_DEVICES_KEY "high_pass_filter");
+  keys.push_back (AUDIO_DEVICES_KEY "noise_gate");
+  keys.push_back (AUDIO_DEVICES_KEY "automatic_gain_control");
   load (keys);
 }
 
@@ -81,5 +85,22 @@ void AudioInputCoreConfBridge::on_property_changed (std::string key, GmConfEntry
 
     audioinput_core.set_device (device);
   }
+  else if (key == AUDIO_DEVICES_KEY "samplerate") {
+
+    PTRACE(4, "AudioInputCoreConfBridge\tUpdating device samplerate");
+    audioinput_core.set_device_samplerate (gm_conf_entry_get_int (entry));
+  }
+  else if (key == AUDIO_DEVICES_KEY "high_pass_filter") {
+
+    audioinput_core.set_filter_enabled ("high-pass", gm_conf_entry_get_bool (entry));
+  }
+  else if (key == AUDIO_DEVICES_KEY "noise_gate") {
+
+    audioinput_core.set_filter_enabled ("noise-gate", gm_conf_entry_get_bool (entry));
+  }
+  else if (key == AUDIO_DEVICES_KEY "automatic_gain_control") {
+
+    audioinput_core.set_filter_enabled ("automatic-gain-control", gm_conf_entry_get_bool (entry));
+  }
 }
 
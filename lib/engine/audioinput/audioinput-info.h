@@ -53,6 +53,24 @@ namespace Ekiga
     AI_ERROR_DEVICE, 
     AI_ERROR_READ
   };
+
+  /** A consumer of the captured audio, see AudioInputCore::add_tap ()
+   */
+  class AudioInputTap
+  {
+  public:
+
+    virtual ~AudioInputTap () {}
+
+    /** Called from the media thread with every captured buffer.
+     * It must never block, and the buffer is only valid during the call.
+     */
+    virtual void on_captured_audio (const char *data,
+                                    unsigned size,
+                                    unsigned channels,
+                                    unsigned samplerate,
+                                    unsigned bits_per_sample) = 0;
+  };
 				      
 };
 
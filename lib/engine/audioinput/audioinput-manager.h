@@ -42,6 +42,7 @@
 #include <sigc++/sigc++.h>
 
 #include "audioinput-info.h"
+#include "event-bus.h"
 
 namespace Ekiga
 {
@@ -51,6 +52,22 @@ namespace Ekiga
  * @{
  */
 
+  /** What an audio input manager publishes when its device is opened, is
+   * closed, or fails : see AudioInputManager::device_events.
+   */
+  struct AudioInputDeviceEvent
+  {
+    AudioInputDeviceEvent (): error_code(AI_ERROR_NONE)
+    {
+      settings.volume = 0;
+      settings.modifyable = false;
+    }
+
+    AudioInputDevice device;
+    AudioInputSettings settings;   // when it's opened
+    AudioInputErrorCodes error_code;   // when it fails
+  };
+
   /** Generic implementation for the Ekiga::AudioInputManager class.
    *
    * Each AudioInputManager will represent a specific backend able to record audio.
@@ -143,25 +160,47 @@ namespace Ekiga
 
       /*** API to act on AudioInputDevice events ***/
 
-      /** This signal is emitted when an audio input device is opened.
-       * @param device the audio input device that was opened.
-       * @param config the current audio input device configuration (current volume, etc.).
+      /** The events of the devices of the manager, on the "opened",
+       * "closed" and "error" topics, which it publishes in the main thread.
+       * The record of a topic is reused from one event to the next, so
+       * delivering one allocates nothing : listeners get a reference to
+       * it, which is only valid during the call.
        */
-      sigc::signal2<void, AudioInputDevice, AudioInputSettings> device_opened;
-
-      /** This signal is emitted when an audio input device is closed.
-       * @param device the audio input device that was closed.
-       */
-      sigc::signal1<void, AudioInputDevice> device_closed;
-
-      /** This signal is emitted when an error occurs when opening a audio input device.
-       * @param device the audio input device that caused the error.
-       * @param error_code the audio input device error code.
-       */
-      sigc::signal2<void, AudioInputDevice, AudioInputErrorCodes> device_error;
-
+      EventBus<AudioInputDeviceEvent> device_events;
+
+  protected:
+      /* to be called in the main thread */
+      void publish_device_opened (const AudioInputDevice & device,
+                                  const AudioInputSettings & settings)
+      {
+        InternedString topic("opened");
+        AudioInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        event.settings = settings;
+        device_events.publish (topic);
+      }
+
+      void publish_device_closed (const AudioInputDevice & device)
+      {
+        InternedString topic("closed");
+        AudioInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        device_events.publish (topic);
+      }
+
+      void publish_device_error (const AudioInputDevice & device,
+                                 AudioInputErrorCodes error_code)
+      {
+        InternedString topic("error");
+        AudioInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        event.error_code = error_code;
+        device_events.publish (topic);
+      }
 
-  protected:  
       typedef struct ManagerState {
         bool opened;
         unsigned channels;
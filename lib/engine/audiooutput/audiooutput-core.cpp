@@ -59,8 +59,12 @@ AudioOutputCore::AudioOutputCore ()
   
   current_manager[primary] = NULL;
   current_manager[secondary] = NULL;
+  device_samplerate = 0;
+  opened_samplerate[primary] = 0;
+  opened_samplerate[secondary] = 0;
   audiooutput_core_conf_bridge = NULL;
   average_level = 0;
+  average_level_bytes = 0;
   calculate_average = false;
   yield = false;
 }
@@ -94,9 +98,9 @@ void AudioOutputCore::add_manager (AudioOutputManager &manager)
   managers.insert (&manager);
   manager_added.emit (manager);
 
-  manager.device_error.connect (sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_error), &manager));
-  manager.device_opened.connect (sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_opened), &manager));
-  manager.device_closed.connect (sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_closed), &manager));
+  manager.device_events.subscribe (InternedString ("error"), sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_error), &manager));
+  manager.device_events.subscribe (InternedString ("opened"), sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_opened), &manager));
+  manager.device_events.subscribe (InternedString ("closed"), sigc::bind (sigc::mem_fun (this, &AudioOutputCore::on_device_closed), &manager));
 }
 
 void AudioOutputCore::visit_managers (sigc::slot1<bool, AudioOutputManager &> visitor)
@@ -270,6 +274,9 @@ void AudioOutputCore::stop()
   internal_set_manager(primary, desired_primary_device);
 
   current_primary_config.active = false;
+
+  if (calculate_average)
+    push_average_level ();
 }
 
 void AudioOutputCore::set_buffer_size (unsigned buffer_size, unsigned num_buffers) {
@@ -277,7 +284,7 @@ void AudioOutputCore::set_buffer_size (unsigned buffer_size, unsigned num_buffer
   PWaitAndSignal m_pri(core_mutex[primary]);
 
   if (current_manager[primary])
-    current_manager[primary]->set_buffer_size (primary, buffer_size, num_buffers);
+    current_manager[primary]->set_buffer_size (primary, device_buffer_size (buffer_size), num_buffers);
 
   current_primary_config.buffer_size = buffer_size;
   current_primary_config.num_buffers = num_buffers;
@@ -287,6 +294,8 @@ void AudioOutputCore::set_frame_data (const char *data,
                                       unsigned size,
 				      unsigned & bytes_written)
 {
+  bytes_written = 0;
+
   if (yield) {
     yield = false;
     PThread::Current()->Sleep(5);
@@ -294,12 +303,13 @@ void AudioOutputCore::set_frame_data (const char *data,
   PWaitAndSignal m_pri(core_mutex[primary]);
 
   if (current_manager[primary]) {
-    if (!current_manager[primary]->set_frame_data(primary, data, size, bytes_written)) {
+
+    if (!internal_write (data, size, bytes_written)) {
       internal_close(primary);
       internal_set_primary_fallback();
       internal_open(primary, current_primary_config.channels, current_primary_config.samplerate, current_primary_config.bits_per_sample);
       if (current_manager[primary])
-        current_manager[primary]->set_frame_data(primary, data, size, bytes_written); // the default device must always return true
+        internal_write (data, size, bytes_written); // the default device must always return true
     }
 
     PWaitAndSignal m_vol(volume_mutex);
@@ -309,8 +319,37 @@ void AudioOutputCore::set_frame_data (const char *data,
     }
   }
 
-  if (calculate_average) 
+  if (calculate_average) {
     calculate_average_level((const short*) data, bytes_written);
+    update_average_level(bytes_written);
+  }
+
+  /* the taps only get what was really played */
+  if (bytes_written == 0)
+    return;
+
+  PWaitAndSignal m_taps(taps_mutex);
+  for (std::set<AudioOutputTap *>::iterator iter = taps.begin ();
+       iter != taps.end ();
+       iter++)
+    (*iter)->on_played_audio (data, bytes_written,
+                              current_primary_config.channels,
+                              current_primary_config.samplerate,
+                              current_primary_config.bits_per_sample);
+}
+
+void AudioOutputCore::add_tap (AudioOutputTap & tap)
+{
+  PWaitAndSignal m(taps_mutex);
+
+  taps.insert (&tap);
+}
+
+void AudioOutputCore::remove_tap (AudioOutputTap & tap)
+{
+  PWaitAndSignal m(taps_mutex);
+
+  taps.erase (&tap);
 }
 
 void AudioOutputCore::set_volume (AudioOutputPS ps, unsigned volume)
@@ -322,6 +361,16 @@ void AudioOutputCore::set_volume (AudioOutputPS ps, unsigned volume)
   }
 }
 
+void AudioOutputCore::set_device_samplerate (unsigned samplerate)
+{
+  yield = true;
+  PWaitAndSignal m_pri(core_mutex[primary]);
+  PWaitAndSignal m_sec(core_mutex[secondary]);
+
+  PTRACE(4, "AudioOutputCore\tSetting device samplerate to " << samplerate);
+  device_samplerate = samplerate;
+}
+
 void AudioOutputCore::play_buffer(AudioOutputPS ps, const char* buffer, unsigned long len, unsigned channels, unsigned sample_rate, unsigned bps)
 {
   switch (ps) {
@@ -361,22 +410,20 @@ void AudioOutputCore::play_buffer(AudioOutputPS ps, const char* buffer, unsigned
   }
 }
 
-void AudioOutputCore::on_device_opened (AudioOutputPS ps,
-                                        AudioOutputDevice device,
-                                        AudioOutputSettings settings, 
+void AudioOutputCore::on_device_opened (const AudioOutputDeviceEvent & event,
                                         AudioOutputManager *manager)
 {
-  device_opened.emit (*manager, ps, device, settings);
+  device_opened.emit (*manager, event.ps, event.device, event.settings);
 }
 
-void AudioOutputCore::on_device_closed (AudioOutputPS ps, AudioOutputDevice device, AudioOutputManager *manager)
+void AudioOutputCore::on_device_closed (const AudioOutputDeviceEvent & event, AudioOutputManager *manager)
 {
-  device_closed.emit (*manager, ps, device);
+  device_closed.emit (*manager, event.ps, event.device);
 }
 
-void AudioOutputCore::on_device_error (AudioOutputPS ps, AudioOutputDevice device, AudioOutputErrorCodes error_code, AudioOutputManager *manager)
+void AudioOutputCore::on_device_error (const AudioOutputDeviceEvent & event, AudioOutputManager *manager)
 {
-  device_error.emit (*manager, ps, device, error_code);
+  device_error.emit (*manager, event.ps, event.device, event.error_code);
 }
 
 void AudioOutputCore::internal_set_primary_device(const AudioOutputDevice & device)
@@ -399,7 +446,7 @@ void AudioOutputCore::internal_set_primary_device(const AudioOutputDevice & devi
 
   if ((current_primary_config.buffer_size > 0) && (current_primary_config.num_buffers > 0 ) ) {
     if (current_manager[primary])
-      current_manager[primary]->set_buffer_size (primary, current_primary_config.buffer_size, current_primary_config.num_buffers);
+      current_manager[primary]->set_buffer_size (primary, device_buffer_size (current_primary_config.buffer_size), current_primary_config.num_buffers);
   }
 }
 void AudioOutputCore::internal_set_manager (AudioOutputPS ps, const AudioOutputDevice & device)
@@ -431,6 +478,32 @@ void AudioOutputCore::internal_set_manager (AudioOutputPS ps, const AudioOutputD
 
 }
 
+bool AudioOutputCore::internal_write (const char *data, unsigned size, unsigned & bytes_written)
+{
+  const char *device_data = data;
+  unsigned device_size = size;
+
+  if (stream_resampler.is_active () && !stream_resampler.is_passthrough ()) {
+
+    unsigned channels = stream_resampler.get_channels ();
+    unsigned frames = size / (2 * channels);
+
+    stream_buffer.resize (stream_resampler.get_max_output (frames) * channels);
+    frames = stream_resampler.process ((const short *) data, frames, &stream_buffer[0], stream_buffer.size () / channels);
+    device_data = (const char *) &stream_buffer[0];
+    device_size = frames * channels * 2;
+  }
+
+  if (!current_manager[primary]->set_frame_data(primary, device_data, device_size, bytes_written))
+    return false;
+
+  /* the caller wants to know how much of its own data went */
+  if (device_data != data)
+    bytes_written = size;
+
+  return true;
+}
+
 void AudioOutputCore::internal_set_primary_fallback()
 {
   current_device[primary].type   = AUDIO_OUTPUT_FALLBACK_DEVICE_TYPE;
@@ -444,11 +517,30 @@ bool AudioOutputCore::internal_open (AudioOutputPS ps, unsigned channels, unsign
 {
   PTRACE(4, "AudioOutputCore\tOpening device["<<ps<<"] with " << channels<< "-" << samplerate << "/" << bits_per_sample);
 
+  opened_samplerate[ps] = samplerate;
+  if (ps == primary)
+    stream_resampler.setup (channels, samplerate, samplerate);
+
   if (!current_manager[ps]) {
     PTRACE(1, "AudioOutputCore\tUnable to obtain current manager for device["<<ps<<"]");
     return false;
   }
 
+  /* open the device at its native rate and convert, rather than have
+   * the backend reopen it at every change of rate */
+  if (device_samplerate != 0 && device_samplerate != samplerate && bits_per_sample == 16) {
+
+    if (current_manager[ps]->open(ps, channels, device_samplerate, bits_per_sample)) {
+
+      PTRACE(4, "AudioOutputCore\tConverting from " << samplerate << " to " << device_samplerate);
+      opened_samplerate[ps] = device_samplerate;
+      if (ps == primary)
+        stream_resampler.setup (channels, samplerate, device_samplerate);
+      return true;
+    }
+    PTRACE(1, "AudioOutputCore\tUnable to open device["<<ps<<"] at " << device_samplerate << ", trying " << samplerate);
+  }
+
   if (!current_manager[ps]->open(ps, channels, samplerate, bits_per_sample)) {
     PTRACE(1, "AudioOutputCore\tUnable to open device["<<ps<<"]");
     if (ps == primary) {
@@ -475,11 +567,27 @@ void AudioOutputCore::internal_play(AudioOutputPS ps, const char* buffer, unsign
 {
   unsigned long pos = 0;
   unsigned bytes_written = 0;
-  unsigned buffer_size = (unsigned)((float)sample_rate/25);
+  std::vector<short> converted;
 
   if (!internal_open ( ps, channels, sample_rate, bps))
     return;
 
+  if (opened_samplerate[ps] != sample_rate) {
+
+    AudioResampler resampler;
+    unsigned frames = len / (2 * channels);
+
+    resampler.setup (channels, sample_rate, opened_samplerate[ps]);
+    converted.resize ((resampler.get_max_output (frames) + resampler.get_max_output (resampler.get_delay ())) * channels);
+    frames = resampler.process ((const short *) buffer, frames, &converted[0], converted.size () / channels);
+    frames += resampler.flush (&converted[frames * channels], converted.size () / channels - frames);
+
+    buffer = (const char *) &converted[0];
+    len = frames * channels * 2;
+  }
+
+  unsigned buffer_size = (unsigned)((float)opened_samplerate[ps]/25);
+
   if (current_manager[ps]) {
     current_manager[ps]->set_buffer_size (ps, buffer_size, 4);
     do {
@@ -492,6 +600,17 @@ void AudioOutputCore::internal_play(AudioOutputPS ps, const char* buffer, unsign
   internal_close( ps);
 }
 
+unsigned AudioOutputCore::device_buffer_size (unsigned buffer_size)
+{
+  unsigned samplerate = current_primary_config.samplerate;
+
+  if (samplerate == 0 || opened_samplerate[primary] == samplerate)
+    return buffer_size;
+
+  /* the same duration at the rate of the device, in whole samples */
+  return (unsigned) (((unsigned long long) buffer_size * opened_samplerate[primary] / samplerate) & ~1ULL);
+}
+
 void AudioOutputCore::calculate_average_level (const short *buffer, unsigned size)
 {
   int sum = 0;
@@ -509,3 +628,28 @@ void AudioOutputCore::calculate_average_level (const short *buffer, unsigned siz
 	  
   average_level = log10 (9.0*sum/size/32767+1)*1.0;
 }
+
+void AudioOutputCore::update_average_level (unsigned size)
+{
+  unsigned period = current_primary_config.samplerate * current_primary_config.channels
+    * (current_primary_config.bits_per_sample / 8) * AUDIO_OUTPUT_LEVEL_PERIOD / 1000;
+
+  average_level_bytes += size;
+  if (average_level_bytes < period)
+    return;
+
+  average_level_bytes = 0;
+  push_average_level ();
+}
+
+void AudioOutputCore::push_average_level ()
+{
+  /* the UI only wants the last level */
+  Ekiga::Runtime::run_in_main_coalesced ("audiooutput-core-level",
+                                         sigc::mem_fun (this, &AudioOutputCore::emit_average_level));
+}
+
+void AudioOutputCore::emit_average_level ()
+{
+  average_level_changed.emit (average_level);
+}
@@ -43,6 +43,7 @@
 #include "audiooutput-manager.h"
 #include "audiooutput-gmconf-bridge.h"
 #include "audiooutput-scheduler.h"
+#include "audiooutput-resampler.h"
 
 #include "ptbuildopts.h"
 #include "ptlib.h"
@@ -51,6 +52,9 @@
 #define AUDIO_OUTPUT_FALLBACK_DEVICE_SOURCE "Ekiga"
 #define AUDIO_OUTPUT_FALLBACK_DEVICE_NAME   "SILENT"
 
+/* How often the average level is pushed to the UI, in ms of audio */
+#define AUDIO_OUTPUT_LEVEL_PERIOD 50
+
 namespace Ekiga
 {
 /**
@@ -280,8 +284,20 @@ namespace Ekiga
        */
       void set_volume (AudioOutputPS ps, unsigned volume);
 
+      /** Set the samplerate the devices are opened at
+       * The streams and the sound events are converted to that rate, so
+       * that the devices always run at their native rate, whatever the
+       * codec or the sound file. If a device can't be opened at that rate,
+       * it is opened at the rate of what is played.
+       * Will be applied the next time a device is opened.
+       * @param samplerate the samplerate, or 0 to open the devices at the
+       * rate of what is played.
+       */
+      void set_device_samplerate (unsigned samplerate);
+
       /** Turn average collecion on and off
-       * The average values can be collected via get_average_level()
+       * The average values can be collected via get_average_level(), or
+       * through the average_level_changed signal.
        * This applies to primary device only.
        * @param on_off whether to turn the collection on or off.
        */
@@ -293,14 +309,27 @@ namespace Ekiga
        */
       float get_average_level () { return average_level; }
 
+      /** Register a consumer of the played audio
+       * The tap gets every buffer passed to set_frame_data(), from the
+       * thread calling it.
+       * @param tap the tap.
+       */
+      void add_tap (AudioOutputTap & tap);
+
+      /** Unregister a consumer of the played audio
+       * When this returns, the tap isn't called anymore.
+       * @param tap the tap.
+       */
+      void remove_tap (AudioOutputTap & tap);
+
 
       /*** Signals ***/
 
       /** See audiooutput-manager.h for the API
        */
-      sigc::signal4<void, AudioOutputManager &, AudioOutputPS, AudioOutputDevice&, AudioOutputSettings&> device_opened;
-      sigc::signal3<void, AudioOutputManager &, AudioOutputPS, AudioOutputDevice&> device_closed;
-      sigc::signal4<void, AudioOutputManager &, AudioOutputPS, AudioOutputDevice&, AudioOutputErrorCodes> device_error;
+      sigc::signal4<void, AudioOutputManager &, AudioOutputPS, const AudioOutputDevice &, const AudioOutputSettings &> device_opened;
+      sigc::signal3<void, AudioOutputManager &, AudioOutputPS, const AudioOutputDevice &> device_closed;
+      sigc::signal4<void, AudioOutputManager &, AudioOutputPS, const AudioOutputDevice &, AudioOutputErrorCodes> device_error;
 
       /** This signal is emitted when an audio output device has been added to the system.
        * This signal will be emitted if add_device was called with a device name and
@@ -316,13 +345,18 @@ namespace Ekiga
        */
       sigc::signal2<void, AudioOutputDevice, bool> device_removed;
 
+      /** This signal is emitted in the main thread while the average
+       * collection is on, when a new average level of the primary device
+       * is available ; that is at most every AUDIO_OUTPUT_LEVEL_PERIOD ms,
+       * and never when no audio is played.
+       * @param level the average volume level.
+       */
+      sigc::signal1<void, float> average_level_changed;
+
   private:
-      void on_device_opened (AudioOutputPS ps, 
-                             AudioOutputDevice device,
-                             AudioOutputSettings settings, 
-                             AudioOutputManager *manager);
-      void on_device_closed (AudioOutputPS ps, AudioOutputDevice device, AudioOutputManager *manager);
-      void on_device_error  (AudioOutputPS ps, AudioOutputDevice device, AudioOutputErrorCodes error_code, AudioOutputManager *manager);
+      void on_device_opened (const AudioOutputDeviceEvent & event, AudioOutputManager *manager);
+      void on_device_closed (const AudioOutputDeviceEvent & event, AudioOutputManager *manager);
+      void on_device_error  (const AudioOutputDeviceEvent & event, AudioOutputManager *manager);
 
       void internal_set_primary_device(const AudioOutputDevice & device);
       void internal_set_manager (AudioOutputPS ps, const AudioOutputDevice & device);
@@ -331,9 +365,18 @@ namespace Ekiga
       bool internal_open (AudioOutputPS ps, unsigned channels, unsigned samplerate, unsigned bits_per_sample);
       void internal_close(AudioOutputPS ps);
 
+      /* writes the stream to the primary device, converted to the rate it
+       * was opened at */
+      bool internal_write (const char *data, unsigned size, unsigned & bytes_written);
+
       void internal_play(AudioOutputPS ps, const char* buffer, unsigned long len, unsigned channels, unsigned sample_rate, unsigned bps);
 
+      unsigned device_buffer_size (unsigned buffer_size);
+
       void calculate_average_level (const short *buffer, unsigned size);
+      void update_average_level (unsigned size);
+      void push_average_level ();
+      void emit_average_level ();
 
       std::set<AudioOutputManager *> managers;
 
@@ -354,13 +397,22 @@ namespace Ekiga
       unsigned desired_primary_volume;
       unsigned current_primary_volume;
 
+      unsigned device_samplerate;
+      unsigned opened_samplerate[2];
+      AudioResampler stream_resampler;
+      std::vector<short> stream_buffer;
+
       PMutex core_mutex[2];
       PMutex volume_mutex;
 
+      std::set<AudioOutputTap *> taps;
+      PMutex taps_mutex;
+
       AudioOutputCoreConfBridge* audiooutput_core_conf_bridge;
       AudioEventScheduler audio_event_scheduler;
 
       float average_level;
+      unsigned average_level_bytes;  // played since the last push
       bool calculate_average;
       bool yield;
     };
@@ -52,6 +52,7 @@ AudioOutputCoreConfBridge::AudioOutputCoreConfBridge (Ekiga::Service & _service)
   property_changed.connect (sigc::mem_fun (this, &AudioOutputCoreConfBridge::on_property_changed));
 
   keys.push_back (AUDIO_DEVICES_KEY "output_device"); 
+  keys.push_back (AUDIO_DEVICES_KEY "samplerate");
   keys.push_back (SOUND_EVENTS_KEY "output_device"); 
   keys.push_back (SOUND_EVENTS_KEY "busy_tone_sound"); 
   keys.push_back (SOUND_EVENTS_KEY "incoming_call_sound"); 
@@ -102,6 +103,12 @@ void AudioOutputCoreConfBridge::on_property_changed (std::string key, GmConfEntr
     audioinput_core.set_device (primary, device);
   }
 
+  if (key == AUDIO_DEVICES_KEY "samplerate") {
+
+    PTRACE(4, "AudioOutputCoreConfBridge\tUpdating device samplerate");
+    audioinput_core.set_device_samplerate (gm_conf_entry_get_int (entry));
+  }
+
   if (key == SOUND_EVENTS_KEY "output_device") {
 
     PTRACE(4, "AudioOutputCoreConfBridge\tUpdating device");
@@ -59,6 +59,25 @@ namespace Ekiga
     secondary
   };
 
+  /** A consumer of the played audio, see AudioOutputCore::add_tap ()
+   */
+  class AudioOutputTap
+  {
+  public:
+
+    virtual ~AudioOutputTap () {}
+
+    /** Called from the media thread with every buffer played on the
+     * primary device. It must never block, and the buffer is only valid
+     * during the call.
+     */
+    virtual void on_played_audio (const char *data,
+                                  unsigned size,
+                                  unsigned channels,
+                                  unsigned samplerate,
+                                  unsigned bits_per_sample) = 0;
+  };
+
 };
 
 #endif
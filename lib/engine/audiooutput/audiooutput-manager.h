@@ -42,6 +42,7 @@
 #include <sigc++/sigc++.h>
 
 #include "audiooutput-info.h"
+#include "event-bus.h"
 
 namespace Ekiga
 {
@@ -51,6 +52,23 @@ namespace Ekiga
  * @{
  */
 
+  /** What an audio output manager publishes when its device is opened, is
+   * closed, or fails : see AudioOutputManager::device_events.
+   */
+  struct AudioOutputDeviceEvent
+  {
+    AudioOutputDeviceEvent (): ps(primary), error_code(AO_ERROR_NONE)
+    {
+      settings.volume = 0;
+      settings.modifyable = false;
+    }
+
+    AudioOutputPS ps;
+    AudioOutputDevice device;
+    AudioOutputSettings settings;   // when it's opened
+    AudioOutputErrorCodes error_code;   // when it fails
+  };
+
   /** Generic implementation for the Ekiga::AudioOutputManager class.
    *
    * Each AudioOutputManager will represent a specific backend able to play back audio.
@@ -146,27 +164,53 @@ namespace Ekiga
 
       /*** API to act on AudioOutputDevice events ***/
 
-      /** This signal is emitted when an audio output device is opened.
-       * @param prim whether the primary or secondary audio output device was opened.
-       * @param device the audio output device that was opened.
-       * @param config the current audio output device configuration (current volume, etc.).
-       */
-      sigc::signal3<void, AudioOutputPS, AudioOutputDevice, AudioOutputSettings> device_opened;
-
-      /** This signal is emitted when an audio output device is closed.
-       * @param prim whether the primary or secondary audio output device was closed.
-       * @param device the audio output device that was closed.
-       */
-      sigc::signal2<void, AudioOutputPS, AudioOutputDevice> device_closed;
-
-      /** This signal is emitted when an error occurs when opening an audio output device.
-       * @param prim whether the primary or secondary audio output device caused the error.
-       * @param device the audio output device that caused the error.
-       * @param error_code the audio output device error code.
+      /** The events of the devices of the manager, on the "opened",
+       * "closed" and "error" topics, which it publishes in the main thread.
+       * The record of a topic is reused from one event to the next, so
+       * delivering one allocates nothing : listeners get a reference to
+       * it, which is only valid during the call.
        */
-      sigc::signal3<void, AudioOutputPS, AudioOutputDevice, AudioOutputErrorCodes> device_error;
+      EventBus<AudioOutputDeviceEvent> device_events;
+
+  protected:
+      /* to be called in the main thread */
+      void publish_device_opened (AudioOutputPS ps,
+                                  const AudioOutputDevice & device,
+                                  const AudioOutputSettings & settings)
+      {
+        InternedString topic("opened");
+        AudioOutputDeviceEvent & event = device_events.record (topic);
+
+        event.ps = ps;
+        event.device = device;
+        event.settings = settings;
+        device_events.publish (topic);
+      }
+
+      void publish_device_closed (AudioOutputPS ps,
+                                  const AudioOutputDevice & device)
+      {
+        InternedString topic("closed");
+        AudioOutputDeviceEvent & event = device_events.record (topic);
+
+        event.ps = ps;
+        event.device = device;
+        device_events.publish (topic);
+      }
+
+      void publish_device_error (AudioOutputPS ps,
+                                 const AudioOutputDevice & device,
+                                 AudioOutputErrorCodes error_code)
+      {
+        InternedString topic("error");
+        AudioOutputDeviceEvent & event = device_events.record (topic);
+
+        event.ps = ps;
+        event.device = device;
+        event.error_code = error_code;
+        device_events.publish (topic);
+      }
 
-  protected:  
       typedef struct ManagerState {
         bool opened;
         unsigned channels;
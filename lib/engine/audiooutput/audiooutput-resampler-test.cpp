@@ -0,0 +1,231 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         audiooutput-resampler-test.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : offline quality test and benchmark of the
+ *                          sample rate converter.
+ *
+ */
+
+
+/* Without argument, a sine is converted between every pair of the usual
+ * codec and device rates, in 20 ms buffers as the audio cores do, and the
+ * output is compared with the ideal sine at the output rate : the THD+N is
+ * the power of the difference relative to the power of the sine. The
+ * program fails if a conversion is worse than the limit.
+ *
+ * With --bench, one minute of audio is converted between every pair, and
+ * the CPU time it took is printed.
+ */
+
+#include <math.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include "audiooutput-resampler.h"
+
+/* The worst acceptable THD+N, in dB ; 16 bit quantization alone is around
+ * -98 dB for the test level */
+#define THD_N_LIMIT -80.0
+
+static const unsigned rates[] = { 8000, 16000, 32000, 44100, 48000 };
+static const unsigned rates_nbr = sizeof (rates) / sizeof (rates[0]);
+
+
+static void
+usage (const char *name)
+{
+  std::cerr << "Usage: " << name << " [--bench]" << std::endl;
+}
+
+
+/* Convert the input in buffers of 20 ms, then flush */
+static void
+convert (Ekiga::AudioResampler & resampler,
+         const std::vector<short> & input,
+         std::vector<short> & output)
+{
+  unsigned buffer_frames = resampler.get_in_rate () / 50;
+  std::vector<short> buffer (resampler.get_max_output (buffer_frames + resampler.get_delay ()));
+
+  output.clear ();
+  for (unsigned pos = 0 ; pos < input.size () ; pos += buffer_frames) {
+
+    unsigned frames = std::min (buffer_frames, (unsigned) input.size () - pos);
+    unsigned produced = resampler.process (&input[pos], frames, &buffer[0], buffer.size ());
+    output.insert (output.end (), buffer.begin (), buffer.begin () + produced);
+  }
+
+  unsigned produced = resampler.flush (&buffer[0], buffer.size ());
+  output.insert (output.end (), buffer.begin (), buffer.begin () + produced);
+}
+
+
+/* Fit the sine of the given frequency to the signal by least squares, and
+ * return the power of what remains relative to the power of the sine */
+static double
+thd_n (const std::vector<short> & signal,
+       unsigned start,
+       unsigned end,
+       double frequency)
+{
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+
+  for (unsigned n = start ; n < end ; n++) {
+
+    double s = sin (2 * M_PI * frequency * n);
+    double c = cos (2 * M_PI * frequency * n);
+
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    ys += signal[n] * s;
+    yc += signal[n] * c;
+  }
+
+  double determinant = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / determinant;
+  double b = (yc * ss - ys * sc) / determinant;
+  double noise = 0, power = 0;
+
+  for (unsigned n = start ; n < end ; n++) {
+
+    double reference = a * sin (2 * M_PI * frequency * n) + b * cos (2 * M_PI * frequency * n);
+
+    power += reference * reference;
+    noise += (signal[n] - reference) * (signal[n] - reference);
+  }
+
+  return 10 * log10 (noise / power);
+}
+
+
+static bool
+run_quality ()
+{
+  bool success = true;
+
+  std::cout << "in,out,frequency,thd_n_db" << std::endl;
+
+  for (unsigned i = 0 ; i < rates_nbr ; i++) {
+
+    for (unsigned o = 0 ; o < rates_nbr ; o++) {
+
+      if (i == o)
+        continue;
+
+      /* a tone in the middle of the band, and one near its edge */
+      double nyquist = std::min (rates[i], rates[o]) / 2.0;
+      double frequencies[] = { 1000.0, 0.8 * nyquist };
+
+      for (unsigned f = 0 ; f < 2 ; f++) {
+
+        Ekiga::AudioResampler resampler;
+        std::vector<short> input (rates[i]);   // one second
+        std::vector<short> output;
+
+        for (unsigned n = 0 ; n < input.size () ; n++)
+          input[n] = (short) floor (16384 * sin (2 * M_PI * frequencies[f] * n / rates[i]) + 0.5);
+
+        resampler.setup (1, rates[i], rates[o]);
+        convert (resampler, input, output);
+
+        /* leave the filter transients out */
+        unsigned margin = (resampler.get_delay () * rates[o]) / rates[i] * 2 + 1;
+        double result = thd_n (output, margin, output.size () - margin, frequencies[f] / rates[o]);
+
+        std::cout << rates[i] << "," << rates[o] << "," << frequencies[f] << "," << result << std::endl;
+
+        if (result > THD_N_LIMIT) {
+
+          std::cerr << "THD+N too high from " << rates[i] << " to " << rates[o]
+                    << " at " << frequencies[f] << " Hz" << std::endl;
+          success = false;
+        }
+      }
+    }
+  }
+
+  return success;
+}
+
+
+static void
+run_bench ()
+{
+  std::cout << "in,out,cpu_ms_per_second,realtime_factor" << std::endl;
+
+  for (unsigned i = 0 ; i < rates_nbr ; i++) {
+
+    for (unsigned o = 0 ; o < rates_nbr ; o++) {
+
+      if (i == o)
+        continue;
+
+      Ekiga::AudioResampler resampler;
+      std::vector<short> input (rates[i] * 60);
+      std::vector<short> output;
+
+      for (unsigned n = 0 ; n < input.size () ; n++)
+        input[n] = (short) (rand () % 65536 - 32768);
+
+      resampler.setup (1, rates[i], rates[o]);
+
+      clock_t start = clock ();
+      convert (resampler, input, output);
+      double cpu = (double) (clock () - start) / CLOCKS_PER_SEC;
+
+      std::cout << rates[i] << "," << rates[o] << ","
+                << 1000 * cpu / 60 << "," << (cpu > 0 ? 60 / cpu : 0) << std::endl;
+    }
+  }
+}
+
+
+int
+main (int argc,
+      char *argv[])
+{
+  if (argc == 2 && strcmp (argv[1], "--bench") == 0) {
+
+    run_bench ();
+    return 0;
+  }
+
+  if (argc != 1) {
+
+    usage (argv[0]);
+    return 1;
+  }
+
+  return run_quality () ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         audiooutput-resampler.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Implementation of the sample rate converter
+ *                          used between the audio devices and the rest of
+ *                          the engine.
+ *
+ */
+
+#include <math.h>
+#include <cstring>
+
+#include "audiooutput-resampler.h"
+
+/* Zero crossings of the sinc on each side of the center, at the lowest of
+ * the two rates : it sets the width of the transition band */
+#define ZERO_CROSSINGS 32
+
+/* Position of the cutoff, relative to the lowest Nyquist frequency */
+#define ROLLOFF 0.91
+
+/* Shape of the Kaiser window : about 90 dB of stopband attenuation */
+#define KAISER_BETA 9.0
+
+using namespace Ekiga;
+
+static unsigned
+gcd (unsigned a,
+     unsigned b)
+{
+  while (b != 0) {
+
+    unsigned r = a % b;
+    a = b;
+    b = r;
+  }
+
+  return a;
+}
+
+
+/* Modified Bessel function of the first kind, order 0 */
+static double
+bessel_i0 (double x)
+{
+  double sum = 1;
+  double term = 1;
+
+  for (unsigned k = 1 ; k < 50 && term > sum * 1e-12 ; k++) {
+
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+  }
+
+  return sum;
+}
+
+
+/* Four independent sums, so that the compiler can keep them in the lanes
+ * of a vector register without reordering the floating point additions ;
+ * n is a multiple of 4 */
+static float
+dot_product (const float *a,
+             const float *b,
+             unsigned n)
+{
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+  for (unsigned i = 0 ; i < n ; i += 4) {
+
+    s0 += a[i] * b[i];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+
+  return (s0 + s1) + (s2 + s3);
+}
+
+
+static short
+saturate (float value)
+{
+  if (value >= 32767.0f)
+    return 32767;
+  if (value <= -32768.0f)
+    return -32768;
+
+  return (short) (value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+
+AudioResampler::AudioResampler ()
+  : active(false), channels(0), in_rate(0), out_rate(0),
+    up(1), down(1), taps(0), position(0), phase(0)
+{
+}
+
+
+bool
+AudioResampler::setup (unsigned channels_,
+                       unsigned in_rate_,
+                       unsigned out_rate_)
+{
+  active = false;
+  coefficients.clear ();
+  history.clear ();
+
+  if (channels_ == 0 || in_rate_ == 0 || out_rate_ == 0)
+    return false;
+
+  channels = channels_;
+  in_rate = in_rate_;
+  out_rate = out_rate_;
+  active = true;
+
+  if (in_rate == out_rate)
+    return true;
+
+  unsigned divisor = gcd (in_rate, out_rate);
+  up = out_rate / divisor;
+  down = in_rate / divisor;
+
+  /* when decimating, the filter has to be longer in input samples to
+   * keep the same transition band at the output */
+  double scale = (up < down) ? (double) up / down : 1.0;
+  unsigned half = (unsigned) ceil (ZERO_CROSSINGS / scale);
+  taps = (2 * half + 3) & ~3u;
+
+  /* the prototype filter works at in_rate * up */
+  unsigned length = taps * up;
+  double cutoff = 0.5 * scale * ROLLOFF / up;
+  double center = (length - 1) / 2.0;
+  double norm = bessel_i0 (KAISER_BETA);
+  std::vector<double> prototype (length);
+  double sum = 0;
+
+  for (unsigned n = 0 ; n < length ; n++) {
+
+    double t = n - center;
+    double x = 2 * t / (length - 1);
+    double sinc = (t == 0) ? 2 * cutoff : sin (2 * M_PI * cutoff * t) / (M_PI * t);
+    double window = bessel_i0 (KAISER_BETA * sqrt (x * x < 1 ? 1 - x * x : 0)) / norm;
+
+    prototype[n] = sinc * window;
+    sum += prototype[n];
+  }
+
+  /* unity gain once the zeros inserted by the upsampling are accounted */
+  coefficients.resize (length);
+  for (unsigned p = 0 ; p < up ; p++)
+    for (unsigned k = 0 ; k < taps ; k++)
+      coefficients[p * taps + k] = (float) (prototype[p + (taps - 1 - k) * up] * up / sum);
+
+  reset ();
+
+  return true;
+}
+
+
+void
+AudioResampler::reset ()
+{
+  if (!active || is_passthrough ())
+    return;
+
+  history.assign (channels, std::vector<float> (taps - 1, 0.0f));
+  position = taps - 1;
+  phase = 0;
+}
+
+
+unsigned
+AudioResampler::get_max_output (unsigned in_frames) const
+{
+  if (!active)
+    return 0;
+
+  if (is_passthrough ())
+    return in_frames;
+
+  unsigned pending = history.empty () ? 0 : history[0].size () - position;
+
+  return (unsigned) (((unsigned long long) (pending + in_frames) * up) / down) + 1;
+}
+
+
+unsigned
+AudioResampler::process (const short *in,
+                         unsigned in_frames,
+                         short *out,
+                         unsigned max_out_frames)
+{
+  if (!active)
+    return 0;
+
+  if (is_passthrough ()) {
+
+    unsigned frames = (in_frames < max_out_frames) ? in_frames : max_out_frames;
+    memcpy (out, in, frames * channels * sizeof (short));
+    return frames;
+  }
+
+  for (unsigned c = 0 ; c < channels ; c++) {
+
+    std::vector<float> & samples = history[c];
+    unsigned start = samples.size ();
+
+    samples.resize (start + in_frames);
+    for (unsigned i = 0 ; i < in_frames ; i++)
+      samples[start + i] = in[i * channels + c];
+  }
+
+  unsigned available = history[0].size ();
+  unsigned produced = 0;
+
+  while (position < available && produced < max_out_frames) {
+
+    const float *phase_coefficients = &coefficients[phase * taps];
+
+    for (unsigned c = 0 ; c < channels ; c++)
+      out[produced * channels + c]
+        = saturate (dot_product (phase_coefficients, &history[c][position + 1 - taps], taps));
+
+    produced++;
+    phase += down;
+    position += phase / up;
+    phase %= up;
+  }
+
+  /* keep the history the next outputs need */
+  unsigned consumed = ((position < available) ? position : available) + 1 - taps;
+  for (unsigned c = 0 ; c < channels ; c++)
+    history[c].erase (history[c].begin (), history[c].begin () + consumed);
+  position -= consumed;
+
+  return produced;
+}
+
+
+unsigned
+AudioResampler::flush (short *out,
+                       unsigned max_out_frames)
+{
+  if (!active || is_passthrough ())
+    return 0;
+
+  std::vector<short> silence (get_delay () * channels, 0);
+
+  return process (&silence[0], get_delay (), out, max_out_frames);
+}
@@ -0,0 +1,150 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         audiooutput-resampler.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Declaration of the sample rate converter used
+ *                          between the audio devices and the rest of the
+ *                          engine.
+ *
+ */
+
+#ifndef __AUDIOOUTPUT_RESAMPLER_H__
+#define __AUDIOOUTPUT_RESAMPLER_H__
+
+#include <vector>
+
+namespace Ekiga
+{
+/**
+ * @addtogroup audiooutput
+ * @{
+ */
+
+  /** Converts interleaved 16 bit audio from a sample rate to another.
+   *
+   * It is a polyphase windowed-sinc (Kaiser) resampler : the ratio of the
+   * rates is reduced to up/down, and every output sample is the dot
+   * product of the input history with one of the up phases of the filter.
+   * The phases are computed once in setup (), and stored in the order of
+   * the history so that the inner loop is a plain dot product.
+   *
+   * The stopband attenuation is about 90 dB, so that the conversion is
+   * transparent for 16 bit audio ; the passband is 91% of the lowest
+   * Nyquist frequency.
+   */
+  class AudioResampler
+  {
+  public:
+
+    AudioResampler ();
+
+    /** Prepare the conversion
+     * @param channels the number of interleaved channels.
+     * @param in_rate the samplerate of the input.
+     * @param out_rate the samplerate of the output.
+     * @return false if a parameter is 0.
+     */
+    bool setup (unsigned channels,
+                unsigned in_rate,
+                unsigned out_rate);
+
+    /** Forget the input history, as at the start of a new stream
+     */
+    void reset ();
+
+    /** Return true if setup () succeeded
+     */
+    bool is_active () const { return active; }
+
+    /** Return true if both rates are the same
+     */
+    bool is_passthrough () const { return active && in_rate == out_rate; }
+
+    unsigned get_channels () const { return channels; }
+    unsigned get_in_rate () const { return in_rate; }
+    unsigned get_out_rate () const { return out_rate; }
+
+    /** Return the delay of the conversion, in input frames
+     */
+    unsigned get_delay () const { return is_passthrough () ? 0 : taps / 2; }
+
+    /** Return the maximum number of frames process () can output
+     * @param in_frames the number of input frames which will be given.
+     */
+    unsigned get_max_output (unsigned in_frames) const;
+
+    /** Convert a buffer
+     * Every input frame is consumed ; the output is late by half the
+     * filter length, which flush () releases.
+     * @param in the interleaved input samples.
+     * @param in_frames the number of input frames.
+     * @param out the buffer receiving the interleaved output samples.
+     * @param max_out_frames the size of the output buffer, in frames,
+     * which should be get_max_output (in_frames).
+     * @return the number of frames written to out.
+     */
+    unsigned process (const short *in,
+                      unsigned in_frames,
+                      short *out,
+                      unsigned max_out_frames);
+
+    /** Output what remains in the filter at the end of a stream
+     * @param out the buffer receiving the interleaved output samples.
+     * @param max_out_frames the size of the output buffer, in frames,
+     * which should be get_max_output (get_delay ()).
+     * @return the number of frames written to out.
+     */
+    unsigned flush (short *out,
+                    unsigned max_out_frames);
+
+  private:
+
+    bool active;
+    unsigned channels;
+    unsigned in_rate;
+    unsigned out_rate;
+    unsigned up;
+    unsigned down;
+    unsigned taps;            // per phase, a multiple of 4
+
+    /* up phases of taps coefficients, each in the order of the history */
+    std::vector<float> coefficients;
+
+    /* per channel, the last taps - 1 input frames and the pending ones */
+    std::vector< std::vector<float> > history;
+    unsigned position;        // index in history of the next output
+    unsigned phase;
+  };
+
+/**
+ * @}
+ */
+};
+
+#endif
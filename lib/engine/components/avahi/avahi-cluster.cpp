@@ -37,9 +37,10 @@
 
 #include "avahi-cluster.h"
 
-Avahi::Cluster::Cluster (Ekiga::ServiceCore &_core): core(_core)
+Avahi::Cluster::Cluster (Ekiga::ServiceCore &_core,
+			 BrowserPtr browser): core(_core)
 {
-  heap = HeapPtr(new Heap (core));
+  heap = HeapPtr(new Heap (core, browser));
 
   add_heap (heap);
 
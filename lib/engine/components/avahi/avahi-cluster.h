@@ -57,7 +57,8 @@ namespace Avahi
   {
   public:
 
-    Cluster (Ekiga::ServiceCore &_core);
+    Cluster (Ekiga::ServiceCore &_core,
+	     BrowserPtr browser);
 
     ~Cluster ();
 
@@ -39,13 +39,14 @@
 #include <glib/gi18n.h>
 
 #include "avahi-heap.h"
+#include "runtime.h"
 
 static void
 avahi_client_callback (AvahiClient *client,
 		       AvahiClientState state,
 		       void *data)
 {
-  ((Avahi::Heap *)data)->ClientCallback (client, state);
+  ((Avahi::Browser *)data)->ClientCallback (client, state);
 }
 
 static void
@@ -59,7 +60,7 @@ avahi_browser_callback (AvahiServiceBrowser *browser,
 			AvahiLookupResultFlags flags,
 			void *data)
 {
-  ((Avahi::Heap *)data)->BrowserCallback (browser, interface, protocol,
+  ((Avahi::Browser *)data)->BrowserCallback (browser, interface, protocol,
 					  event, name, type, domain, flags);
 }
 
@@ -80,24 +81,37 @@ avahi_resolver_callback (AvahiServiceResolver *resolver,
 			 void *data)
 {
   if (!(flags & AVAHI_LOOKUP_RESULT_LOCAL))
-    ((Avahi::Heap *)data)->ResolverCallback (resolver, interface, protocol,
+    ((Avahi::Browser *)data)->ResolverCallback (resolver, interface, protocol,
                                              event, name, type, domain,
                                              host_name, address, port,
                                              txt, flags);
 }
 
 
-Avahi::Heap::Heap (Ekiga::ServiceCore &_core): core(_core)
+Avahi::Browser::Browser (): context(NULL), loop(NULL), thread(NULL),
+			    poll(NULL), client(NULL), heap(NULL)
+{
+}
+
+Avahi::Browser::~Browser ()
+{
+  stop ();
+}
+
+void
+Avahi::Browser::start ()
 {
   const AvahiPoll *poll_api = NULL;
   int error;
 
-  /* let's make sure those are sanely initialized */
-  poll = NULL;
-  client = NULL;
+  /* the browser has a main loop of its own, so the callbacks don't run
+   * in the main thread while we're connecting here
+   */
+  context = g_main_context_new ();
+  loop = g_main_loop_new (context, FALSE);
 
   avahi_set_allocator (avahi_glib_allocator ());
-  poll = avahi_glib_poll_new (NULL, G_PRIORITY_DEFAULT);
+  poll = avahi_glib_poll_new (context, G_PRIORITY_DEFAULT);
   poll_api = avahi_glib_poll_get (poll);
 
   /* this may not be the final valid client pointer according to
@@ -107,40 +121,75 @@ Avahi::Heap::Heap (Ekiga::ServiceCore &_core): core(_core)
 			     avahi_client_callback, this,
 			     &error);
   /* if (client == NULL); FIXME: better error reporting? */
+
+  thread = g_thread_create (run_thread, this, TRUE, NULL);
 }
 
-Avahi::Heap::~Heap ()
+void
+Avahi::Browser::stop ()
 {
+  if (thread != NULL) {
+
+    g_main_loop_quit (loop);
+    g_thread_join (thread);
+    thread = NULL;
+  }
+
   if (client != NULL)
     avahi_client_free (client);
+  client = NULL;
 
   if (poll != NULL)
     avahi_glib_poll_free (poll);
+  poll = NULL;
+
+  if (loop != NULL)
+    g_main_loop_unref (loop);
+  loop = NULL;
+
+  if (context != NULL)
+    g_main_context_unref (context);
+  context = NULL;
 }
 
+void
+Avahi::Browser::set_heap (Heap* heap_)
+{
+  heap = heap_;
+}
 
-const std::string
-Avahi::Heap::get_name () const
+gpointer
+Avahi::Browser::run_thread (gpointer data)
 {
-  return _("Neighbours");
+  Browser* self = (Browser*)data;
+
+  g_main_loop_run (self->loop);
+
+  return NULL;
 }
 
-bool
-Avahi::Heap::populate_menu (Ekiga::MenuBuilder& /*builder*/)
+void
+Avahi::Browser::deliver_found (BrowserPtr self,
+			       std::string name,
+			       std::string url,
+			       std::string presence,
+			       std::string status)
 {
-  return false;
+  if (self->heap != NULL)
+    self->heap->on_found (name, url, presence, status);
 }
 
-bool
-Avahi::Heap::populate_menu_for_group (const std::string /*name*/,
-				      Ekiga::MenuBuilder& /*builder*/)
+void
+Avahi::Browser::deliver_removed (BrowserPtr self,
+				 std::string name)
 {
-  return false;
+  if (self->heap != NULL)
+    self->heap->on_removed (name);
 }
 
 void
-Avahi::Heap::ClientCallback (AvahiClient *_client,
-			     AvahiClientState state)
+Avahi::Browser::ClientCallback (AvahiClient *_client,
+				AvahiClientState state)
 {
   /* this is the good client pointer */
   client = _client;
@@ -180,14 +229,14 @@ Avahi::Heap::ClientCallback (AvahiClient *_client,
 }
 
 void
-Avahi::Heap::BrowserCallback (AvahiServiceBrowser *browser,
-			      AvahiIfIndex interface,
-			      AvahiProtocol protocol,
-			      AvahiBrowserEvent event,
-			      const char *name,
-			      const char *type,
-			      const char *domain,
-			      AvahiLookupResultFlags /*flags*/)
+Avahi::Browser::BrowserCallback (AvahiServiceBrowser *browser,
+				 AvahiIfIndex interface,
+				 AvahiProtocol protocol,
+				 AvahiBrowserEvent event,
+				 const char *name,
+				 const char *type,
+				 const char *domain,
+				 AvahiLookupResultFlags /*flags*/)
 {
   AvahiServiceResolver *resolver = NULL;
 
@@ -206,19 +255,9 @@ Avahi::Heap::BrowserCallback (AvahiServiceBrowser *browser,
     break;
 
   case AVAHI_BROWSER_REMOVE:
-    {
-      bool found;
-      for (iterator iter = begin ();
-	   !found && iter != end ();
-	   ++iter) {
-
-	if ((*iter)->get_name () == name) {
-
-	  found = true;
-	  (*iter)->removed ();
-	}
-      }
-    }
+    Ekiga::Runtime::run_in_main (sigc::bind (sigc::ptr_fun (deliver_removed),
+					     BrowserPtr (this),
+					     std::string (name)));
     break;
   case AVAHI_BROWSER_CACHE_EXHAUSTED:
     // FIXME: do I care?
@@ -237,46 +276,19 @@ Avahi::Heap::BrowserCallback (AvahiServiceBrowser *browser,
   }
 }
 
-class resolver_callback_helper
-{
-public:
-
-  resolver_callback_helper (const std::string name_): name(name_)
-  {}
-
-  bool test (gmref_ptr<Ekiga::URIPresentity> presentity_)
-  {
-    bool result;
-
-    if (presentity_->get_name () == name) {
-
-      presentity = presentity_;
-      result = false;
-    }
-    return result;
-  }
-
-  gmref_ptr<Ekiga::URIPresentity> found_presentity () const
-  { return presentity; }
-
-private:
-  gmref_ptr<Ekiga::URIPresentity> presentity;
-  const std::string name;
-};
-
 void
-Avahi::Heap::ResolverCallback (AvahiServiceResolver *resolver,
-			       AvahiIfIndex /*interface*/,
-			       AvahiProtocol /*protocol*/,
-			       AvahiResolverEvent event,
-			       const char * name_,
-			       const char * typ,
-			       const char * /*domain*/,
-			       const char* host_name,
-			       const AvahiAddress */*address*/,
-			       uint16_t port,
-			       AvahiStringList *txt,
-			       AvahiLookupResultFlags /*flags*/)
+Avahi::Browser::ResolverCallback (AvahiServiceResolver *resolver,
+				  AvahiIfIndex /*interface*/,
+				  AvahiProtocol /*protocol*/,
+				  AvahiResolverEvent event,
+				  const char * name_,
+				  const char * typ,
+				  const char * /*domain*/,
+				  const char* host_name,
+				  const AvahiAddress */*address*/,
+				  uint16_t port,
+				  AvahiStringList *txt,
+				  AvahiLookupResultFlags /*flags*/)
 {
   std::string name;
   std::string software;
@@ -312,32 +324,18 @@ Avahi::Heap::ResolverCallback (AvahiServiceResolver *resolver,
       }
     }
 
-    resolver_callback_helper helper(name);
-    visit_presentities (sigc::mem_fun (helper, &resolver_callback_helper::test));
-    if (helper.found_presentity ()) {
-
-      /* known contact has been updated */
-      presence_received.emit (helper.found_presentity ()->get_uri (), presence);
-      status_received.emit (helper.found_presentity ()->get_uri (), status);
-    } else {
-
-      /* ok, this is a new contact */
-      gchar** broken = NULL;
-      broken = g_strsplit_set (typ, "._", 0);
-      if (broken != NULL && broken[0] != NULL && broken[1] != NULL) {
-
-	std::set<std::string> groups;
-
-	groups.insert (_("Neighbours"));
-	url = g_strdup_printf ("%s:neighbour@%s:%d", broken[1], host_name, port);
-	gmref_ptr<Ekiga::URIPresentity> presentity (new Ekiga::URIPresentity (core, name, url, groups));
-	status_received.emit (url, status);
-	presence_received.emit (url, presence);
-	add_presentity (presentity);
-	g_free (url);
-      }
-      g_strfreev (broken);
+    gchar** broken = NULL;
+    broken = g_strsplit_set (typ, "._", 0);
+    if (broken != NULL && broken[0] != NULL && broken[1] != NULL) {
+
+      url = g_strdup_printf ("%s:neighbour@%s:%d", broken[1], host_name, port);
+      Ekiga::Runtime::run_in_main (sigc::bind (sigc::ptr_fun (deliver_found),
+					       BrowserPtr (this), name,
+					       std::string (url),
+					       presence, status));
+      g_free (url);
     }
+    g_strfreev (broken);
     break;}
   case AVAHI_RESOLVER_FAILURE:
 
@@ -350,3 +348,89 @@ Avahi::Heap::ResolverCallback (AvahiServiceResolver *resolver,
   }
 }
 
+Avahi::Heap::Heap (Ekiga::ServiceCore &_core,
+		   BrowserPtr browser_): core(_core), browser(browser_)
+{
+  browser->set_heap (this);
+}
+
+Avahi::Heap::~Heap ()
+{
+  browser->set_heap (NULL);
+  browser->stop ();
+}
+
+
+const std::string
+Avahi::Heap::get_name () const
+{
+  return _("Neighbours");
+}
+
+bool
+Avahi::Heap::populate_menu (Ekiga::MenuBuilder& /*builder*/)
+{
+  return false;
+}
+
+bool
+Avahi::Heap::populate_menu_for_group (const std::string /*name*/,
+				      Ekiga::MenuBuilder& /*builder*/)
+{
+  return false;
+}
+
+void
+Avahi::Heap::on_found (const std::string name,
+		       const std::string url,
+		       const std::string presence,
+		       const std::string status)
+{
+  /* services are known by their name, as when they're removed : if the
+   * service moved to another host or port, it's a new contact */
+  gmref_ptr<Ekiga::URIPresentity> presentity = find_by_name (name);
+
+  if (presentity && presentity->get_uri () != url) {
+
+    presentity->removed ();
+    presentity = gmref_ptr<Ekiga::URIPresentity> ();
+  }
+
+  if (presentity) {
+
+    /* known contact has been updated */
+    presence_received.emit (presentity->get_uri (), presence);
+    status_received.emit (presentity->get_uri (), status);
+  } else {
+
+    /* ok, this is a new contact */
+    std::set<std::string> groups;
+
+    groups.insert (_("Neighbours"));
+    presentity = gmref_ptr<Ekiga::URIPresentity> (new Ekiga::URIPresentity (core, name, url, groups));
+    status_received.emit (url, status);
+    presence_received.emit (url, presence);
+    add_presentity (presentity);
+  }
+}
+
+void
+Avahi::Heap::on_removed (const std::string name)
+{
+  gmref_ptr<Ekiga::URIPresentity> presentity = find_by_name (name);
+
+  if (presentity)
+    presentity->removed ();
+}
+
+gmref_ptr<Ekiga::URIPresentity>
+Avahi::Heap::find_by_name (const std::string name)
+{
+  for (iterator iter = begin ();
+       iter != end ();
+       ++iter)
+    if ((*iter)->get_name () == name)
+      return *iter;
+
+  return gmref_ptr<Ekiga::URIPresentity> ();
+}
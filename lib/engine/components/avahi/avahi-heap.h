@@ -57,29 +57,30 @@ namespace Avahi
  * @{
  */
 
-  class Heap:
-    public Ekiga::PresenceFetcher,
-    public Ekiga::HeapImpl<Ekiga::URIPresentity>,
-    public sigc::trackable
+  class Heap;
+
+  /* The link with the avahi daemon : it connects in 'start', which blocks
+   * and can be called from any thread, then runs in a thread of its own.
+   * What it finds is handed to the heap in the main thread.
+   */
+  class Browser: public virtual GmRefCounted
   {
   public:
 
-    Heap (Ekiga::ServiceCore &_core);
+    Browser ();
 
-    ~Heap ();
+    ~Browser ();
 
-    const std::string get_name () const;
+    void start ();
 
-    bool populate_menu (Ekiga::MenuBuilder &builder);
+    /* from the main thread ; the browser should be stopped before the
+     * last reference on it is dropped */
+    void set_heap (Heap* heap_);
 
-    bool populate_menu_for_group (const std::string name,
-				  Ekiga::MenuBuilder& builder);
+    void stop ();
 
-    /* the PresenceFetcher interface : we don't do what we're told ;-) */
-    void fetch (std::string) {}
-    void unfetch (std::string) {}
-
-    /* these should be private but are called from C code */
+    /* these should be private but are called from C code, in the
+     * browser's thread */
 
     void ClientCallback (AvahiClient *client,
 			 AvahiClientState state);
@@ -108,10 +109,68 @@ namespace Avahi
 
   private:
 
-    Ekiga::ServiceCore &core;
+    static gpointer run_thread (gpointer data);
+
+    static void deliver_found (gmref_ptr<Browser> self,
+			       std::string name,
+			       std::string url,
+			       std::string presence,
+			       std::string status);
+
+    static void deliver_removed (gmref_ptr<Browser> self,
+				 std::string name);
+
+    GMainContext *context;
+    GMainLoop *loop;
+    GThread *thread;
     AvahiGLibPoll *poll;
     AvahiClient *client;
 
+    Heap* heap;
+  };
+
+  typedef gmref_ptr<Browser> BrowserPtr;
+
+  class Heap:
+    public Ekiga::PresenceFetcher,
+    public Ekiga::HeapImpl<Ekiga::URIPresentity>,
+    public sigc::trackable
+  {
+  public:
+
+    /* the browser should be started already */
+    Heap (Ekiga::ServiceCore &_core,
+	  BrowserPtr browser_);
+
+    ~Heap ();
+
+    const std::string get_name () const;
+
+    bool populate_menu (Ekiga::MenuBuilder &builder);
+
+    bool populate_menu_for_group (const std::string name,
+				  Ekiga::MenuBuilder& builder);
+
+    /* the PresenceFetcher interface : we don't do what we're told ;-) */
+    void fetch (std::string) {}
+    void unfetch (std::string) {}
+
+    /* what the browser found, in the main thread */
+
+    void on_found (const std::string name,
+		   const std::string url,
+		   const std::string presence,
+		   const std::string status);
+
+    void on_removed (const std::string name);
+
+  private:
+
+    Ekiga::ServiceCore &core;
+    BrowserPtr browser;
+
+    gmref_ptr<Ekiga::URIPresentity> find_by_name (const std::string name);
+
     bool remover (Ekiga::PresentityPtr presentity,
 		  const std::string name);
   };
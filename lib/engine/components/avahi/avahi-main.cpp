@@ -41,9 +41,15 @@
 
 struct AVAHISpark: public Ekiga::Spark
 {
-  AVAHISpark (): result(false)
+  AVAHISpark (): result(false), browser(new Avahi::Browser)
   {}
 
+  ~AVAHISpark ()
+  {
+    if (browser)
+      browser->stop ();
+  }
+
   bool try_initialize_more (Ekiga::ServiceCore& core,
 			    int* /*argc*/,
 			    char** /*argv*/[])
@@ -53,15 +59,25 @@ struct AVAHISpark: public Ekiga::Spark
 
     if ( !service && presence_core) {
 
-      gmref_ptr<Avahi::Cluster> cluster (new Avahi::Cluster (core));
+      gmref_ptr<Avahi::Cluster> cluster (new Avahi::Cluster (core, browser));
       core.add (cluster);
       presence_core->add_cluster (cluster);
+      browser = Avahi::BrowserPtr ();
       result = true;
     }
 
     return result;
   }
 
+  bool needs_preparation () const
+  { return true; }
+
+  void prepare ()
+  {
+    // connecting to the daemon goes through the system bus
+    browser->start ();
+  }
+
   Ekiga::Spark::state get_state () const
   { return result?FULL:BLANK; }
 
@@ -69,6 +85,7 @@ struct AVAHISpark: public Ekiga::Spark
   { return "AVAHI"; }
 
   bool result;
+  Avahi::BrowserPtr browser;
 };
 
 void
@@ -176,6 +176,16 @@ History::Contact::populate_menu (Ekiga::MenuBuilder &builder)
 					      uri, builder);
 }
 
+const std::list<std::string>
+History::Contact::get_uris () const
+{
+  std::list<std::string> result;
+
+  result.push_back (uri);
+
+  return result;
+}
+
 xmlNodePtr
 History::Contact::get_node ()
 {
@@ -85,6 +85,8 @@ namespace History
 
     bool populate_menu (Ekiga::MenuBuilder &builder);
 
+    const std::list<std::string> get_uris () const;
+
     bool is_found (std::string test) const;
 
     /*** more specific api ***/
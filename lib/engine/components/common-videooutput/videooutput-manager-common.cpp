@@ -45,6 +45,10 @@
 
 #include "videooutput-manager-common.h"
 
+/* While a display is open, how long the thread waits for a frame before it
+ * redraws anyway : the windows get their expose and configure events then */
+#define VIDEO_OUTPUT_EVENTS_PERIOD 250
+
 /* The functions */
 GMVideoOutputManager::GMVideoOutputManager(Ekiga::ServiceCore & _core)
   : PThread (1000, NoAutoDeleteThread, HighestPriority, "GMVideoOutputManager"),
@@ -83,7 +87,7 @@ GMVideoOutputManager::Main ()
 
   while (!end_thread) {
     if (initialised_thread)
-      run_thread.Wait(250);
+      run_thread.Wait(VIDEO_OUTPUT_EVENTS_PERIOD);
     else
       run_thread.Wait();
 
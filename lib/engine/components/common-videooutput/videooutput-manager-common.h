@@ -119,8 +119,13 @@
 
     virtual void set_display_info (const Ekiga::DisplayInfo & _display_info)
     {
-      PWaitAndSignal m(display_info_mutex);
-      display_info = _display_info;
+      {
+        PWaitAndSignal m(display_info_mutex);
+        display_info = _display_info;
+      }
+
+      /* redraw at once, rather than when the thread next wakes up */
+      run_thread.Signal();
     };
 
   protected:
@@ -65,10 +65,25 @@ Evolution::Book::on_view_contacts_added (GList *econtacts)
 
     if (e_contact_get_const (econtact, E_CONTACT_FULL_NAME) != NULL) {
 
-      ContactPtr contact(new Evolution::Contact (services, book,
-						 econtact));
+      const gchar *id = (const gchar *)e_contact_get_const (econtact, E_CONTACT_UID);
+      std::map<std::string, ContactPtr>::iterator iter = contacts_by_id.end ();
 
-      add_contact (contact);
+      if (id != NULL)
+	iter = contacts_by_id.find (id);
+
+      if (iter != contacts_by_id.end ()) {
+
+	iter->second->update_econtact (econtact);
+      }
+      else {
+
+	ContactPtr contact(new Evolution::Contact (services, book,
+						   econtact));
+
+	if (id != NULL)
+	  contacts_by_id[id] = contact;
+	add_contact (contact);
+      }
       nbr++;
     }
   }
@@ -89,38 +104,29 @@ on_view_contacts_removed_c (EBook */*ebook*/,
   ((Evolution::Book *)data)->on_view_contacts_removed (ids);
 }
 
-class contacts_removed_helper
+void
+Evolution::Book::on_view_contacts_removed (GList *ids)
 {
-public:
+  bool found = false;
+
+  for (; ids != NULL; ids = g_list_next (ids)) {
 
-  contacts_removed_helper (const std::string id_): id(id_)
-  {}
+    std::map<std::string, ContactPtr>::iterator iter
+      = contacts_by_id.find ((const gchar *)ids->data);
 
-  bool test (Evolution::ContactPtr contact)
-  {
-    bool result;
+    if (iter != contacts_by_id.end ()) {
 
-    if (contact->get_id () == id) {
+      ContactPtr contact = iter->second;
 
+      contacts_by_id.erase (iter);
       contact->removed.emit ();
-      result = false;
+      found = true;
     }
-
-    return result;
   }
 
-private:
-  const std::string id;
-};
-
-void
-Evolution::Book::on_view_contacts_removed (GList *ids)
-{
-  for (; ids != NULL; ids = g_list_next (ids)) {
-
-    contacts_removed_helper helper((gchar*)ids->data);
-    visit_contacts (sigc::mem_fun (helper, &contacts_removed_helper::test));
-  }
+  /* once for the whole batch */
+  if (found)
+    updated.emit ();
 }
 
 static void
@@ -131,42 +137,31 @@ on_view_contacts_changed_c (EBook */*ebook*/,
   ((Evolution::Book*)data)->on_view_contacts_changed (econtacts);
 }
 
-class contact_updated_helper
+void
+Evolution::Book::on_view_contacts_changed (GList *econtacts)
 {
-public:
-
-  contact_updated_helper (EContact* econtact_): econtact(econtact_)
-  {
-    id = (const gchar*)e_contact_get_const (econtact, E_CONTACT_UID);
-  }
+  bool found = false;
 
-  bool test (Evolution::ContactPtr contact)
-  {
-    bool result = true;
+  for (; econtacts != NULL; econtacts = g_list_next (econtacts)) {
 
-    if (contact->get_id () == id) {
+    EContact *econtact = E_CONTACT (econtacts->data);
+    const gchar *id = (const gchar *)e_contact_get_const (econtact, E_CONTACT_UID);
 
-      contact->update_econtact (econtact);
-      result = false;
-    }
+    if (id == NULL)
+      continue;
 
-    return result;
-  }
+    std::map<std::string, ContactPtr>::iterator iter = contacts_by_id.find (id);
 
-private:
-  EContact* econtact;
-  std::string id;
-};
+    if (iter != contacts_by_id.end ()) {
 
-void
-Evolution::Book::on_view_contacts_changed (GList *econtacts)
-{
-  for (; econtacts != NULL; econtacts = g_list_next (econtacts)) {
-
-    contact_updated_helper helper (E_CONTACT (econtacts->data));
-
-    visit_contacts (sigc::mem_fun (helper, &contact_updated_helper::test));
+      iter->second->update_econtact (econtact);
+      found = true;
+    }
   }
+
+  /* once for the whole batch */
+  if (found)
+    updated.emit ();
 }
 
 static void
@@ -300,6 +295,7 @@ void
 Evolution::Book::refresh ()
 {
   remove_all_objects ();
+  contacts_by_id.clear ();
 
   /* we go */
   if (e_book_is_opened (book))
@@ -38,6 +38,7 @@
 #ifndef __EVOLUTION_BOOK_H__
 #define __EVOLUTION_BOOK_H__
 
+#include <map>
 #include <libebook/e-book.h>
 
 #include "form.h"
@@ -102,6 +103,10 @@ namespace Evolution
 
     std::string status;
     std::string search_filter;
+
+    /* the contacts by their evolution id, so the changes reported by the
+     * view are applied without going through the whole book */
+    std::map<std::string, ContactPtr> contacts_by_id;
   };
 
   typedef gmref_ptr<Book> BookPtr;
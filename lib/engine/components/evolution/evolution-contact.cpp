@@ -240,6 +240,21 @@ Evolution::Contact::populate_menu (Ekiga::MenuBuilder &builder)
   return populated;
 }
 
+const std::list<std::string>
+Evolution::Contact::get_uris () const
+{
+  std::list<std::string> result;
+
+  for (unsigned int attr_type = 0; attr_type < ATTR_NUMBER; attr_type++) {
+
+    std::string attr_value = get_attribute_value (attr_type);
+    if ( !attr_value.empty ())
+      result.push_back (attr_value);
+  }
+
+  return result;
+}
+
 
 std::string
 Evolution::Contact::get_attribute_name_from_type (unsigned int attribute_type) const
@@ -71,6 +71,8 @@ namespace Evolution
 
     bool populate_menu (Ekiga::MenuBuilder &builder);
 
+    const std::list<std::string> get_uris () const;
+
     bool is_found (const std::string) const;
 
     void update_econtact (EContact *econtact);
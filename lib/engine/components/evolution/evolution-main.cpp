@@ -41,6 +41,18 @@
 #include "evolution-main.h"
 #include "evolution-source.h"
 
+static gmref_ptr<Ekiga::Service>
+build_source (Ekiga::ServiceCore* services)
+{
+  gmref_ptr<Ekiga::ContactCore> core = services->get ("contact-core");
+  gmref_ptr<Evolution::Source> source (new Evolution::Source (*services));
+
+  services->add (source);
+  core->add_source (source);
+
+  return source;
+}
+
 struct EVOSpark: public Ekiga::Spark
 {
   EVOSpark (): result(false)
@@ -54,9 +66,9 @@ struct EVOSpark: public Ekiga::Spark
 
     if (core) {
 
-      gmref_ptr<Evolution::Source> source (new Evolution::Source (services));
-      services.add (source);
-      core->add_source (source);
+      // the source opens the address books : only build it when needed
+      services.add_lazy ("evolution-source", "addressbook",
+			 sigc::bind (sigc::ptr_fun (build_source), &services));
       result = true;
     }
 
@@ -139,7 +139,8 @@ GST::VideoInputManager::open (unsigned width,
 
       Ekiga::VideoInputSettings settings;
       settings.modifyable = false;
-      device_opened.emit (current_state.device, settings);
+      settings.pipeline = "GStreamer pipeline";
+      publish_device_opened (current_state.device, settings);
       result = true;
     }
   } else {
@@ -159,7 +160,7 @@ GST::VideoInputManager::close ()
 {
   if (pipeline != NULL) {
 
-    device_closed.emit (current_state.device);
+    publish_device_closed (current_state.device);
     g_object_unref (pipeline);
     pipeline = NULL;
   }
@@ -45,6 +45,12 @@ struct HALDBUSSpark: public Ekiga::Spark
   HALDBUSSpark (): result(false)
   {}
 
+  ~HALDBUSSpark ()
+  {
+    if (probe.bus)
+      dbus_g_connection_unref (probe.bus);
+  }
+
   bool try_initialize_more (Ekiga::ServiceCore& core,
 			    int* /*argc*/,
 			    char** /*argv*/[])
@@ -53,7 +59,7 @@ struct HALDBUSSpark: public Ekiga::Spark
 
     if (hal_core) {
 
-      HalManager_dbus *hal_manager = new HalManager_dbus(core);
+      HalManager_dbus *hal_manager = new HalManager_dbus(core, probe);
 
       hal_core->add_manager (*hal_manager);
       core.add (gmref_ptr<Ekiga::Service> (new Ekiga::BasicService ("hal-dbus",
@@ -64,6 +70,15 @@ struct HALDBUSSpark: public Ekiga::Spark
     return result;
   }
 
+  bool needs_preparation () const
+  { return true; }
+
+  void prepare ()
+  {
+    // the system bus answers slowly when it answers at all
+    HalManager_dbus::probe (probe);
+  }
+
   Ekiga::Spark::state get_state () const
   { return result?FULL:BLANK; }
 
@@ -71,11 +86,15 @@ struct HALDBUSSpark: public Ekiga::Spark
   { return "HALDBUSSPARK"; }
 
   bool result;
+  HalProbe probe;
 };
 
 void
 hal_dbus_init (Ekiga::KickStart& kickstart)
 {
+  // the probe uses the bus from a worker thread
+  dbus_g_thread_init ();
+
   gmref_ptr<Ekiga::Spark> spark(new HALDBUSSpark);
   kickstart.add_spark (spark);
 }
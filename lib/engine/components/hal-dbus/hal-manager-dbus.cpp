@@ -51,18 +51,39 @@ extern "C" {
 #include "ptbuildopts.h"
 #include "ptlib.h"
 
-HalManager_dbus::HalManager_dbus (Ekiga::ServiceCore & _core)
-:    core (_core)
+void HalManager_dbus::probe (HalProbe & probe)
 {
-  PTRACE(4, "HalManager_dbus\tInitialising HAL Manager");
-
   GError *error = NULL;
-  bus = dbus_g_bus_get(DBUS_BUS_SYSTEM, &error);
+  probe.bus = dbus_g_bus_get(DBUS_BUS_SYSTEM, &error);
   if (error != NULL) {
-    PTRACE (1, "HalManager_dbus\tConnecting to system bus failed: " << error->message);
+    probe.notes.push_back (std::string ("Connecting to system bus failed: ") + error->message);
     g_error_free(error);
+    probe.bus = NULL;
     return;
   }
+
+  populate_devices_list (probe);
+  populate_interfaces_list (probe);
+}
+
+HalManager_dbus::HalManager_dbus (Ekiga::ServiceCore & _core,
+                                  HalProbe & probe)
+:    core (_core), hal_proxy (NULL), nm_proxy (NULL)
+{
+  PTRACE(4, "HalManager_dbus\tInitialising HAL Manager");
+
+  trace_notes (probe.notes);
+
+  bus = probe.bus;
+  probe.bus = NULL;
+  if (bus == NULL)
+    return;
+
+  hal_devices.swap (probe.hal_devices);
+  nm_interfaces.swap (probe.nm_interfaces);
+  PTRACE(4, "HalManager_dbus\tPopulated device list with " << hal_devices.size() << " devices");
+  PTRACE(4, "HalManager_dbus\tPopulated interface list with " << nm_interfaces.size() << " devices");
+
   dbus_connection_setup_with_g_main (dbus_g_connection_get_connection (bus), g_main_context_default());
 
   // Hardware Abstraction Layer registration for callbacks
@@ -76,8 +97,6 @@ HalManager_dbus::HalManager_dbus (Ekiga::ServiceCore & _core)
   dbus_g_proxy_add_signal(hal_proxy, "DeviceAdded", G_TYPE_STRING, G_TYPE_INVALID);
   dbus_g_proxy_connect_signal(hal_proxy, "DeviceAdded", G_CALLBACK(&device_added_cb_proxy), this, NULL);
 
-  populate_devices_list();
-
   // NetworkManager registration for callbacks
   nm_proxy = dbus_g_proxy_new_for_name (bus, "org.freedesktop.NetworkManager",
                                               "/org/freedesktop/NetworkManager",
@@ -92,16 +111,26 @@ HalManager_dbus::HalManager_dbus (Ekiga::ServiceCore & _core)
   dbus_g_proxy_add_signal(nm_proxy, "DeviceIP4AddressChange", DBUS_TYPE_G_OBJECT_PATH, G_TYPE_INVALID);
   dbus_g_proxy_connect_signal(nm_proxy, "DeviceIP4AddressChange", G_CALLBACK(&interface_ip4_address_change_cb_proxy), this, NULL);
 
-  populate_interfaces_list();
-
   dbus_g_connection_flush (bus);
 }
 
 HalManager_dbus::~HalManager_dbus ()
 {
-  g_object_unref(hal_proxy);
-  g_object_unref(nm_proxy);
-  dbus_g_connection_unref(bus);
+  if (hal_proxy)
+    g_object_unref(hal_proxy);
+  if (nm_proxy)
+    g_object_unref(nm_proxy);
+  if (bus)
+    dbus_g_connection_unref(bus);
+}
+
+void HalManager_dbus::trace_notes (std::vector<std::string> & notes)
+{
+  for (std::vector<std::string>::iterator iter = notes.begin ();
+       iter != notes.end ();
+       ++iter)
+    PTRACE(4, "HalManager_dbus\t" << *iter);
+  notes.clear ();
 }
 
 void HalManager_dbus::device_added_cb_proxy (DBusGProxy */*object*/, const char *device, gpointer user_data)
@@ -138,9 +167,12 @@ void HalManager_dbus::device_added_cb (const char *device)
 {
   std::string type, name;
   HalDevice hal_device;
+  std::vector<std::string> notes;
   hal_device.key = device;
 
-  if (!get_device_type_name(device, hal_device))
+  bool found = get_device_type_name(bus, device, hal_device, notes);
+  trace_notes (notes);
+  if (!found)
     return;
 
   hal_devices.push_back(hal_device);
@@ -215,7 +247,7 @@ void HalManager_dbus::interface_now_active_cb (const char *interface)
   NmInterface nm_interface;
 
   nm_interface.key = interface;
-  get_interface_name_ip (interface, nm_interface);
+  get_interface_name_ip (bus, interface, nm_interface);
 
   nm_interfaces.push_back(nm_interface);
 
@@ -265,7 +297,7 @@ void HalManager_dbus::get_string_property(DBusGProxy *proxy, const char * proper
   g_free (c_value);
 }
 
-bool HalManager_dbus::get_device_type_name (const char * device, HalDevice & hal_device)
+bool HalManager_dbus::get_device_type_name (DBusGConnection * bus, const char * device, HalDevice & hal_device, std::vector<std::string> & notes)
 {
   DBusGProxy * device_proxy = NULL;
   bool ret = false;
@@ -301,38 +333,38 @@ bool HalManager_dbus::get_device_type_name (const char * device, HalDevice & hal
       supported_versions = v4l_get_device_names ((const char*) device_dir.c_str(), &v4l1_name, &v4l2_name);
 
       if (supported_versions == 0) {
-        PTRACE(1, "HalManager_dbus\tNo supported V4L version detected for device " << device_dir);
+        notes.push_back ("No supported V4L version detected for device " + device_dir);
         hal_device.name = device_dir;
         hal_device.type = "";
       }
       else if (supported_versions == -1) {
-        PTRACE(1, "HalManager_dbus\tCould not open device " << device_dir);
+        notes.push_back ("Could not open device " + device_dir);
         hal_device.name = device_dir;
         hal_device.type = "";
       }
       else {
         if (supported_versions && 1) {
           if (v4l1_name) {
-            PTRACE(4, "HalManager_dbus\tDetected V4L capabilities on " << device_dir << " name: " << v4l1_name);
+            notes.push_back ("Detected V4L capabilities on " + device_dir + " name: " + v4l1_name);
             hal_device.name = v4l1_name;
             hal_device.type = "capture";
             hal_device.video_capabilities  |= V4L_VERSION_1;
           }
           else {
-            PTRACE(4, "HalManager_dbus\tSkipped V4L1 device " << device_dir <<  "without name");
+            notes.push_back ("Skipped V4L1 device " + device_dir + " without name");
             ret = false;
           }
         }
         if (supported_versions && 2) {
           if (v4l2_name) {
-            PTRACE(4, "HalManager_dbus\tDetected V4L2 capabilities on " << device_dir << " name: " << v4l2_name);
+            notes.push_back ("Detected V4L2 capabilities on " + device_dir + " name: " + v4l2_name);
             hal_device.name = v4l2_name;
             hal_device.type = "capture";
             hal_device.video_capabilities  |= V4L_VERSION_2;
             ret = true;
           }
           else {
-            PTRACE(4, "HalManager_dbus\tSkipped V4L2 device " << device_dir <<  "without name");
+            notes.push_back ("Skipped V4L2 device " + device_dir + " without name");
             ret = false;
           }
         }
@@ -356,7 +388,7 @@ bool HalManager_dbus::get_device_type_name (const char * device, HalDevice & hal
   return ret;
 }
 
-void HalManager_dbus::get_interface_name_ip (const char * interface, NmInterface & nm_interface)
+void HalManager_dbus::get_interface_name_ip (DBusGConnection * bus, const char * interface, NmInterface & nm_interface)
 {
 
   DBusGProxy * interface_proxy = NULL;
@@ -407,19 +439,23 @@ void HalManager_dbus::get_interface_name_ip (const char * interface, NmInterface
   g_object_unref(interface_proxy);
 }
 
-void HalManager_dbus::populate_devices_list ()
+void HalManager_dbus::populate_devices_list (HalProbe & probe)
 {
   GError *error = NULL;
   char **device_list;
   char **device_list_ptr;
   HalDevice hal_device;
+  DBusGProxy * hal_proxy = NULL;
 
-  PTRACE(4, "HalManager_dbus\tPopulating device list");
+  hal_proxy = dbus_g_proxy_new_for_name (probe.bus, "org.freedesktop.Hal",
+                                                    "/org/freedesktop/Hal/Manager",
+                                                    "org.freedesktop.Hal.Manager");
 
   dbus_g_proxy_call (hal_proxy, "GetAllDevices", &error, G_TYPE_INVALID, G_TYPE_STRV, &device_list, G_TYPE_INVALID);
+  g_object_unref(hal_proxy);
 
   if (error != NULL) {
-    PTRACE(1, "HalManager_dbus\tPopulating full device list failed - " << error->message);
+    probe.notes.push_back (std::string ("Populating full device list failed - ") + error->message);
     g_error_free(error);
     return;
   }
@@ -428,33 +464,35 @@ void HalManager_dbus::populate_devices_list ()
     hal_device.key = *device_list_ptr;
     
     if (hal_device.key != "/org/freedesktop/Hal/devices/computer") {
-      if (get_device_type_name(*device_list_ptr, hal_device)) {
+      if (get_device_type_name(probe.bus, *device_list_ptr, hal_device, probe.notes)) {
         if ( (hal_device.category == "alsa") ||
              (hal_device.category == "oss") ||
              (hal_device.category == "video4linux") )  
-              hal_devices.push_back(hal_device);
+              probe.hal_devices.push_back(hal_device);
       }
     }
   }
 
   g_strfreev(device_list);
-
-  PTRACE(4, "HalManager_dbus\tPopulated device list with " << hal_devices.size() << " devices");
 }
 
-void HalManager_dbus::populate_interfaces_list ()
+void HalManager_dbus::populate_interfaces_list (HalProbe & probe)
 {
   GError *error = NULL;
   GPtrArray *interface_list;
   NmInterface nm_interface;
+  DBusGProxy * nm_proxy = NULL;
 
-  PTRACE(4, "HalManager_dbus\tPopulating interface list");
+  nm_proxy = dbus_g_proxy_new_for_name (probe.bus, "org.freedesktop.NetworkManager",
+                                                   "/org/freedesktop/NetworkManager",
+                                                   "org.freedesktop.NetworkManager");
 
   dbus_g_proxy_call (nm_proxy, "getDevices", &error, G_TYPE_INVALID,
                      dbus_g_type_get_collection ("GPtrArray", DBUS_TYPE_G_PROXY), &interface_list, G_TYPE_INVALID);
+  g_object_unref(nm_proxy);
 
   if (error != NULL) {
-    PTRACE(1, "HalManager_dbus\tPopulating full interface list failed - " << error->message);
+    probe.notes.push_back (std::string ("Populating full interface list failed - ") + error->message);
     g_error_free(error);
     return;
   }
@@ -462,11 +500,9 @@ void HalManager_dbus::populate_interfaces_list ()
   unsigned i;
   for (i = 0; i < interface_list->len; i++) {
 
-    get_interface_name_ip (dbus_g_proxy_get_path ((DBusGProxy*)g_ptr_array_index (interface_list, i)), nm_interface);
-    nm_interfaces.push_back(nm_interface);
+    get_interface_name_ip (probe.bus, dbus_g_proxy_get_path ((DBusGProxy*)g_ptr_array_index (interface_list, i)), nm_interface);
+    probe.nm_interfaces.push_back(nm_interface);
   }
 
   g_ptr_array_free (interface_list, TRUE);
-
-  PTRACE(4, "HalManager_dbus\tPopulated interface list with " << nm_interfaces.size() << " devices");
 }
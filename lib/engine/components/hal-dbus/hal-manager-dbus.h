@@ -69,14 +69,32 @@ extern "C" {
     bool active;
   } NmInterface;
 
+  /* What is on the system bus when ekiga starts : it is gathered in a
+   * worker thread before the manager is built, so it doesn't use PTLIB.
+   */
+  struct HalProbe {
+    HalProbe (): bus(NULL) {}
+
+    DBusGConnection * bus;
+    std::vector <HalDevice> hal_devices;
+    std::vector <NmInterface> nm_interfaces;
+    std::vector <std::string> notes; // to trace from the main thread
+  };
+
   class HalManager_dbus
    : public Ekiga::HalManager
     {
   public:
 
-      /* The constructor
+      /* Connects to the system bus and lists the devices and interfaces :
+       * this blocks, and is safe to call from any thread
        */
-      HalManager_dbus (Ekiga::ServiceCore & core);
+      static void probe (HalProbe & probe);
+
+      /* The constructor, which takes over what probe found
+       */
+      HalManager_dbus (Ekiga::ServiceCore & core,
+                       HalProbe & probe);
       /* The destructor
        */
       ~HalManager_dbus ();
@@ -105,13 +123,15 @@ extern "C" {
       void interface_ip4_address_change_cb (const char *interface);
 
   protected:  
-      void populate_devices_list();
-      void populate_interfaces_list ();
+      static void populate_devices_list (HalProbe & probe);
+      static void populate_interfaces_list (HalProbe & probe);
+
+      static bool get_device_type_name (DBusGConnection * bus, const char * device, HalDevice & hal_device, std::vector<std::string> & notes);
+      static void get_interface_name_ip (DBusGConnection * bus, const char * interface, NmInterface & nm_interface);
 
-      bool get_device_type_name (const char * device, HalDevice & hal_device);
-      void get_interface_name_ip (const char * interface, NmInterface & nm_interface);
+      static void get_string_property (DBusGProxy *proxy, const char * property, std::string & value);
 
-      void get_string_property (DBusGProxy *proxy, const char * property, std::string & value);
+      void trace_notes (std::vector<std::string> & notes);
 
       Ekiga::ServiceCore & core;
 
@@ -92,6 +92,20 @@ KAB::Contact::populate_menu (Ekiga::MenuBuilder &builder)
   return result;
 }
 
+const std::list<std::string>
+KAB::Contact::get_uris () const
+{
+  std::list<std::string> result;
+
+  KABC::PhoneNumber::List phoneNumbers = addressee.phoneNumbers ();
+  for (KABC::PhoneNumber::List::const_iterator iter = phoneNumbers.begin ();
+       iter != phoneNumbers.end ();
+       iter++)
+    result.push_back ((*iter).number ().toUtf8 ().constData ());
+
+  return result;
+}
+
 bool
 KAB::Contact::is_found (const std::string /*test*/) const
 {
@@ -69,6 +69,8 @@ namespace KAB
 
     bool populate_menu (Ekiga::MenuBuilder &builder);
 
+    const std::list<std::string> get_uris () const;
+
     bool is_found (const std::string test) const;
 
   private:
@@ -39,6 +39,18 @@
 #include "contact-core.h"
 #include "kab-source.h"
 
+static gmref_ptr<Ekiga::Service>
+build_source (Ekiga::ServiceCore* core)
+{
+  gmref_ptr<Ekiga::ContactCore> contact_core = core->get ("contact-core");
+  gmref_ptr<KAB::Source> source (new KAB::Source (*contact_core));
+
+  core->add (source);
+  contact_core->add_source (source);
+
+  return source;
+}
+
 struct KABSpark: public Ekiga::Spark
 {
   KABSpark (): result(false)
@@ -53,9 +65,9 @@ struct KABSpark: public Ekiga::Spark
 
     if (contact_core && kde_core) {
 
-      gmref_ptr<KAB::Source> source (new KAB::Source (*contact_core));
-      core.add (source);
-      contact_core->add_source (source);
+      // the source loads the whole KDE address book : only build it when needed
+      core.add_lazy ("kab-source", "addressbook",
+		     sigc::bind (sigc::ptr_fun (build_source), &core));
       result = true;
     }
 
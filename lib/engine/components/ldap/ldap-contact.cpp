@@ -88,6 +88,20 @@ OPENLDAP::Contact::populate_menu (Ekiga::MenuBuilder &builder)
   return result;
 }
 
+const std::list<std::string>
+OPENLDAP::Contact::get_uris () const
+{
+  std::list<std::string> result;
+
+  for (std::map<std::string, std::string>::const_iterator iter
+	 = uris.begin ();
+       iter != uris.end ();
+       iter++)
+    result.push_back (iter->second);
+
+  return result;
+}
+
 bool
 OPENLDAP::Contact::is_found (const std::string /*test*/) const
 {
@@ -66,6 +66,8 @@ namespace OPENLDAP
 
     bool populate_menu (Ekiga::MenuBuilder &builder);
 
+    const std::list<std::string> get_uris () const;
+
     bool is_found (const std::string) const;
 
   private:
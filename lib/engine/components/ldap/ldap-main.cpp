@@ -41,8 +41,21 @@
 #include "ldap-main.h"
 #include "ldap-source.h"
 
+#include <ldap.h>
 #include <sasl/sasl.h>
 
+static gmref_ptr<Ekiga::Service>
+build_source (Ekiga::ServiceCore* core)
+{
+  gmref_ptr<Ekiga::ContactCore> contact_core = core->get ("contact-core");
+  gmref_ptr<OPENLDAP::Source> service (new OPENLDAP::Source (*core));
+
+  core->add (service);
+  contact_core->add_source (service);
+
+  return service;
+}
+
 struct LDAPSpark: public Ekiga::Spark
 {
   LDAPSpark (): result(false)
@@ -56,16 +69,34 @@ struct LDAPSpark: public Ekiga::Spark
 
     if (contact_core) {
 
-      gmref_ptr<OPENLDAP::Source> service (new OPENLDAP::Source (core));
-      core.add (service);
-      contact_core->add_source (service);
-      sasl_client_init (NULL); // FIXME: shouldn't it be done by the source!?
+      // the source connects to the servers : only build it when needed
+      core.add_lazy ("ldap-source", "addressbook",
+		     sigc::bind (sigc::ptr_fun (build_source), &core));
       result = true;
     }
 
     return result;
   }
 
+  bool needs_preparation () const
+  { return true; }
+
+  void prepare ()
+  {
+    sasl_client_init (NULL); // FIXME: shouldn't it be done by the source!?
+
+    /* the first libldap call initializes the library, which reads
+     * ldap.conf and the user's ldaprc : get it out of the way now -- the
+     * books bind when they're refreshed, with their own settings */
+    LDAPAPIInfo info;
+    info.ldapai_info_version = LDAP_API_INFO_VERSION;
+    if (ldap_get_option (NULL, LDAP_OPT_API_INFO, &info) == LDAP_OPT_SUCCESS) {
+
+      ldap_memfree (info.ldapai_vendor_name);
+      ldap_memvfree ((void**)info.ldapai_extensions);
+    }
+  }
+
   Ekiga::Spark::state get_state () const
   { return result?FULL:BLANK; }
 
@@ -92,14 +92,14 @@ Local::Cluster::on_new_presentity ()
 }
 
 void
-Local::Cluster::on_presence_received (std::string uri,
-				      std::string presence)
+Local::Cluster::on_presence_received (const std::string &uri,
+				      const std::string &presence)
 {
   heap->push_presence (uri, presence);
 }
 
-void Local::Cluster::on_status_received (std::string uri,
-					 std::string status)
+void Local::Cluster::on_status_received (const std::string &uri,
+					 const std::string &status)
 {
   heap->push_status (uri, status);
 }
@@ -83,11 +83,11 @@ namespace Local
 
     void on_new_presentity ();
 
-    void on_presence_received (std::string uri,
-			       std::string presence);
+    void on_presence_received (const std::string &uri,
+			       const std::string &presence);
 
-    void on_status_received (std::string uri,
-			     std::string status);
+    void on_status_received (const std::string &uri,
+			     const std::string &status);
   };
 
   typedef gmref_ptr<Cluster> ClusterPtr;
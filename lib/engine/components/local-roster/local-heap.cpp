@@ -42,6 +42,7 @@
 
 #include "gmconf.h"
 #include "form-request-simple.h"
+#include "runtime.h"
 
 #include "local-heap.h"
 
@@ -51,51 +52,19 @@
 /*
  * Public API
  */
-Local::Heap::Heap (Ekiga::ServiceCore &_core): core (_core), doc ()
+Local::Heap::Heap (Ekiga::ServiceCore &_core): core (_core), doc (),
+						store (roster_directory ()),
+						loaded(false)
 {
   xmlNodePtr root;
-  gchar *c_raw = gm_conf_get_string (KEY);
 
-  // Build the XML document representing the contacts list from the configuration
-  if (c_raw != NULL) {
+  doc = std::tr1::shared_ptr<xmlDoc> (xmlNewDoc (BAD_CAST "1.0"), xmlFreeDoc);
+  root = xmlNewDocNode (doc.get (), NULL, BAD_CAST "list", NULL);
+  xmlDocSetRootElement (doc.get (), root);
 
-    const std::string raw = c_raw;
-    doc = std::tr1::shared_ptr<xmlDoc> (xmlRecoverMemory (raw.c_str (), raw.length ()), xmlFreeDoc);
-    if ( !doc)
-      doc = std::tr1::shared_ptr<xmlDoc> (xmlNewDoc (BAD_CAST "1.0"), xmlFreeDoc);
-
-    root = xmlDocGetRootElement (doc.get ());
-    if (root == NULL) {
-
-      root = xmlNewDocNode (doc.get (), NULL, BAD_CAST "list", NULL);
-      xmlDocSetRootElement (doc.get (), root);
-    }
-
-    for (xmlNodePtr child = root->children; child != NULL; child = child->next)
-      if (child->type == XML_ELEMENT_NODE
-	  && child->name != NULL
-	  && xmlStrEqual (BAD_CAST ("entry"), child->name))
-	add (child);
-
-    g_free (c_raw);
-
-    // Or create a new XML document
-  }
-  else {
-
-    doc = std::tr1::shared_ptr<xmlDoc> (xmlNewDoc (BAD_CAST "1.0"), xmlFreeDoc);
-    root = xmlNewDocNode (doc.get (), NULL, BAD_CAST "list", NULL);
-    xmlDocSetRootElement (doc.get (), root);
-
-    {
-      // add 500 and 501 at ekiga.net in this case!
-      std::set<std::string> groups;
-
-      groups.insert (_("Services"));
-      add (_("Echo test"), "sip:500@ekiga.net", groups);
-      add (_("Conference room"), "sip:501@ekiga.net", groups);
-    }
-  }
+  // The entries are read once the main loop runs, not to slow the startup,
+  // or before that if they're needed
+  Ekiga::Runtime::run_in_main (sigc::mem_fun (this, &Local::Heap::load));
 }
 
 
@@ -129,35 +98,12 @@ Local::Heap::populate_menu_for_group (const std::string name,
   return true;
 }
 
-struct has_presentity_with_uri_helper
-{
-  has_presentity_with_uri_helper (const std::string uri_): uri(uri_),
-							   found(false)
-  {}
-
-  const std::string uri;
-
-  bool found;
-
-  bool test (Local::PresentityPtr presentity)
-  {
-    if (presentity->get_uri () == uri) {
-
-      found = true;
-    }
-
-    return !found;
-  }
-};
-
 bool
 Local::Heap::has_presentity_with_uri (const std::string uri)
 {
-  has_presentity_with_uri_helper helper(uri);
-
-  visit_presentities (sigc::mem_fun (helper, &has_presentity_with_uri_helper::test));
+  load ();
 
-  return helper.found;
+  return find_presentity_by_uri (uri);
 }
 
 struct existing_groups_helper
@@ -180,6 +126,8 @@ Local::Heap::existing_groups ()
 {
   std::set<std::string> result;
 
+  load ();
+
   {
     existing_groups_helper helper;
 
@@ -255,76 +203,130 @@ Local::Heap::new_presentity (const std::string name,
   }
 }
 
-struct push_presence_helper
+void
+Local::Heap::push_presence (const std::string &uri,
+			    const std::string &presence)
 {
-  push_presence_helper (const std::string uri_,
-			const std::string presence_): uri(uri_),
-						      presence(presence_)
-  {}
+  std::list<PresentityPtr> presentities;
+
+  // the roster may hold the same uri more than once
+  find_presentities_by_uri (uri, presentities);
+  for (std::list<PresentityPtr>::iterator iter = presentities.begin ();
+       iter != presentities.end ();
+       ++iter)
+    (*iter)->set_presence (presence);
+}
 
-  bool test (Local::PresentityPtr presentity)
-  {
-    if (presentity->get_uri () == uri) {
+void
+Local::Heap::push_status (const std::string &uri,
+			  const std::string &status)
+{
+  std::list<PresentityPtr> presentities;
 
-      presentity->set_presence (presence);
-    }
+  find_presentities_by_uri (uri, presentities);
+  for (std::list<PresentityPtr>::iterator iter = presentities.begin ();
+       iter != presentities.end ();
+       ++iter)
+    (*iter)->set_status (status);
+}
 
-    return true;
-  }
 
-  const std::string uri;
-  const std::string presence;
-};
 
-void
-Local::Heap::push_presence (const std::string uri,
-			    const std::string presence)
+/*
+ * Private API
+ */
+const std::string
+Local::Heap::roster_directory ()
 {
-  push_presence_helper helper(uri, presence);
+  gchar* c_directory = NULL;
+  std::string result;
+
+  c_directory = g_build_filename (g_get_user_config_dir (),
+				  PACKAGE_NAME "-roster", NULL);
+  result = c_directory;
+  g_free (c_directory);
 
-  visit_presentities (sigc::mem_fun (helper, &push_presence_helper::test));
+  return result;
 }
 
-struct push_status_helper
+
+void
+Local::Heap::load ()
 {
-  push_status_helper (const std::string uri_,
-		      const std::string status_): uri(uri_),
-						  status(status_)
-  {}
+  xmlNodePtr root = xmlDocGetRootElement (doc.get ());
 
-  bool test (Local::PresentityPtr presentity)
-  {
-    if (presentity->get_uri () == uri) {
+  if (loaded)
+    return;
+  loaded = true;
 
-      presentity->set_status (status);
-    }
+  store.begin ();
 
-    return true;
+  if (store.exists ()) {
+
+    std::vector<std::pair<xmlNodePtr, std::string> > entries;
+
+    store.load (root, entries);
+    for (std::vector<std::pair<xmlNodePtr, std::string> >::const_iterator iter = entries.begin ();
+	 iter != entries.end ();
+	 ++iter)
+      add (iter->first, iter->second);
   }
+  else {
 
-  const std::string uri;
-  const std::string status;
-};
+    gchar *c_raw = gm_conf_get_string (KEY);
 
-void
-Local::Heap::push_status (const std::string uri,
-			  const std::string status)
-{
-  push_status_helper helper(uri, status);
+    // Import the contacts list from the configuration, where it used to be
+    if (c_raw != NULL) {
 
-  visit_presentities (sigc::mem_fun (helper, &push_status_helper::test));
-}
+      const std::string raw = c_raw;
+      xmlDocPtr old_doc = xmlRecoverMemory (raw.c_str (), raw.length ());
+      xmlNodePtr old_root = NULL;
 
+      if (old_doc != NULL)
+	old_root = xmlDocGetRootElement (old_doc);
+
+      if (old_root != NULL)
+	for (xmlNodePtr child = old_root->children; child != NULL; child = child->next)
+	  if (child->type == XML_ELEMENT_NODE
+	      && child->name != NULL
+	      && xmlStrEqual (BAD_CAST ("entry"), child->name)) {
+
+	    xmlNodePtr node = xmlDocCopyNode (child, doc.get (), 1);
+	    const std::string id = store.new_id ();
+
+	    xmlAddChild (root, node);
+	    store.write (id, node);
+	    add (node, id);
+	  }
+
+      if (old_doc != NULL)
+	xmlFreeDoc (old_doc);
+      g_free (c_raw);
+
+      // Or start with a few useful entries
+    }
+    else {
+
+      // add 500 and 501 at ekiga.net in this case!
+      std::set<std::string> groups;
+
+      groups.insert (_("Services"));
+      add (_("Echo test"), "sip:500@ekiga.net", groups);
+      add (_("Conference room"), "sip:501@ekiga.net", groups);
+    }
+  }
+
+  store.commit ();
+}
 
 
-/*
- * Private API
- */
 void
-Local::Heap::add (xmlNodePtr node)
+Local::Heap::add (xmlNodePtr node,
+		  const std::string id)
 {
   PresentityPtr presentity (new Presentity (core, doc, node));
 
+  record_ids[presentity.get ()] = id;
   common_add (presentity);
 }
 
@@ -341,7 +343,8 @@ Local::Heap::add (const std::string name,
 
   xmlAddChild (root, presentity->get_node ());
 
-  save ();
+  record_ids[presentity.get ()] = store.new_id ();
+  save (presentity.get ());
   common_add (presentity);
 }
 
@@ -358,21 +361,27 @@ Local::Heap::common_add (PresentityPtr presentity)
   presence_core->fetch_presence (presentity->get_uri ());
 
   // Connect the Local::Presentity signals.
-  add_connection (presentity, presentity->trigger_saving.connect (sigc::mem_fun (this, &Local::Heap::save)));
+  add_connection (presentity, presentity->trigger_saving.connect (sigc::bind (sigc::mem_fun (this, &Local::Heap::save), presentity.get ())));
 }
 
 
 void
-Local::Heap::save () const
+Local::Heap::save (Presentity* presentity)
 {
-  xmlChar *buffer = NULL;
-  int size = 0;
+  std::map<Presentity*, std::string>::iterator iter
+    = record_ids.find (presentity);
 
-  xmlDocDumpMemory (doc.get (), &buffer, &size);
+  if (iter == record_ids.end ())
+    return;
 
-  gm_conf_set_string (KEY, (const char *)buffer);
+  if (presentity->get_node () != NULL)
+    store.write (iter->second, presentity->get_node ());
+  else {
 
-  xmlFree (buffer);
+    // it has been removed
+    store.remove (iter->second);
+    record_ids.erase (iter);
+  }
 }
 
 
@@ -401,7 +410,6 @@ Local::Heap::new_presentity_form_submitted (bool submitted,
       && !has_presentity_with_uri (uri)) {
 
     add (name, uri, groups);
-    save ();
   } else {
 
     Ekiga::FormRequestSimple request(sigc::mem_fun (this, &Local::Heap::new_presentity_form_submitted));
@@ -473,6 +481,10 @@ Local::Heap::rename_group_form_submitted (std::string old_name,
   if ( !new_name.empty () && new_name != old_name) {
 
     rename_group_form_submitted_helper helper (old_name, new_name);
+
+    // each presentity saves itself, but the store writes them all at once
+    store.begin ();
     visit_presentities (sigc::mem_fun (helper, &rename_group_form_submitted_helper::rename_group));
+    store.commit ();
   }
 }
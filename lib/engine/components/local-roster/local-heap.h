@@ -39,6 +39,7 @@
 
 #include "heap-impl.h"
 #include "local-presentity.h"
+#include "local-store.h"
 
 
 namespace Local
@@ -59,8 +60,10 @@ namespace Local
    * signals defined in heap.h through the use of global implementations
    * coded in heap-imp.h.
    *
-   * When required, the Heap content is being saved in a GmConf entry.
-   * Alternatively, it could be saved elsewhere.
+   * The entries are kept in a Local::Store, one record per presentity,
+   * so a change only saves the presentity which changed. The contacts list
+   * used to be saved in a GmConf entry : it is imported from there the
+   * first time.
    */
   class Heap : public Ekiga::HeapImpl<Presentity>
   {
@@ -129,10 +132,10 @@ namespace Local
      *  These functions are called by the Local::Cluster to push
      * presence&status information down.
      */
-    void push_presence (const std::string uri,
-			const std::string presence);
-    void push_status (const std::string uri,
-		      const std::string status);
+    void push_presence (const std::string &uri,
+			const std::string &presence);
+    void push_status (const std::string &uri,
+		      const std::string &status);
 
   private:
 
@@ -149,8 +152,22 @@ namespace Local
      * to the internal XML document and calls common_add.
      * The internal XML document is supposed to be up
      * to date.
+     * @param: The node of the entry.
+     * @param: The identifier of its record in the store.
      */
-    void add (xmlNodePtr node);
+    void add (xmlNodePtr node,
+	      const std::string id);
+
+
+    /** Returns the directory of the store.
+     */
+    static const std::string roster_directory ();
+
+
+    /** Reads the entries from the store (or imports them from the GmConf
+     * entry the first time), and adds them ; only the first call does.
+     */
+    void load ();
 
 
     /** Add the Presentity to the Ekiga::Heap.
@@ -173,9 +190,11 @@ namespace Local
     void common_add (PresentityPtr presentity);
 
 
-    /** Save the XML Document in the GmConf key.
+    /** Save the record of the presentity in the store, or remove it if
+     * the presentity is gone.
+     * @param: The presentity which changed.
      */
-    void save () const;
+    void save (Presentity* presentity);
 
 
     /** This should be triggered when a new Presentity form
@@ -200,6 +219,9 @@ namespace Local
 
     Ekiga::ServiceCore &core;
     std::tr1::shared_ptr<xmlDoc> doc;
+    Store store;
+    std::map<Presentity*, std::string> record_ids;
+    bool loaded;
   };
 
   typedef gmref_ptr<Heap> HeapPtr;
@@ -352,6 +352,7 @@ Local::Presentity::remove ()
 
   xmlUnlinkNode (node);
   xmlFreeNode (node);
+  node = NULL; // this tells the heap we're gone
 
   trigger_saving.emit ();
   removed.emit ();
@@ -129,7 +129,7 @@ namespace Local
 
     /** Return the current node in the XML document
      * describing the Presentity.
-     * @return: A pointer to the node.
+     * @return: A pointer to the node, NULL once removed.
      */
     xmlNodePtr get_node () const;
 
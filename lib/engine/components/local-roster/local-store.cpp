@@ -0,0 +1,283 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         local-store.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of the on-disk store of the
+ *                          local roster
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <ctime>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libxml/parser.h>
+
+#include "local-store.h"
+
+#define SUFFIX ".xml"
+
+
+/* the identifiers from new_id are the creation time and a counter, in
+ * hexadecimal : they give the order the records were created in -- the
+ * directory doesn't keep any */
+static bool
+parse_id (const std::string id,
+	  unsigned long& time,
+	  unsigned int& counter)
+{
+  return sscanf (id.c_str (), "%lx-%x", &time, &counter) == 2;
+}
+
+static bool
+id_before (const std::string a,
+	   const std::string b)
+{
+  unsigned long a_time = 0;
+  unsigned long b_time = 0;
+  unsigned int a_counter = 0;
+  unsigned int b_counter = 0;
+  bool a_parsed = parse_id (a, a_time, a_counter);
+  bool b_parsed = parse_id (b, b_time, b_counter);
+
+  if (a_parsed != b_parsed)
+    return a_parsed;
+
+  if (a_parsed && a_time != b_time)
+    return a_time < b_time;
+
+  if (a_parsed && a_counter != b_counter)
+    return a_counter < b_counter;
+
+  return a < b;
+}
+
+
+Local::Store::Store (const std::string directory_):
+  directory(directory_), transaction_depth(0), counter(0)
+{
+}
+
+
+Local::Store::~Store ()
+{
+  /* don't lose what an unbalanced transaction kept */
+  if (transaction_depth > 0) {
+
+    transaction_depth = 1;
+    commit ();
+  }
+}
+
+
+bool
+Local::Store::exists () const
+{
+  return g_file_test (directory.c_str (), G_FILE_TEST_IS_DIR);
+}
+
+
+void
+Local::Store::load (xmlNodePtr root,
+		    std::vector<std::pair<xmlNodePtr, std::string> >& entries)
+{
+  GDir* dir = g_dir_open (directory.c_str (), 0, NULL);
+  const gchar* name = NULL;
+  std::vector<std::string> ids;
+
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL) {
+
+    std::string file = name;
+
+    if (file.length () <= sizeof (SUFFIX) - 1
+	|| file.compare (file.length () - (sizeof (SUFFIX) - 1),
+			 std::string::npos, SUFFIX) != 0)
+      continue;
+
+    ids.push_back (file.substr (0, file.length () - (sizeof (SUFFIX) - 1)));
+  }
+
+  g_dir_close (dir);
+
+  std::sort (ids.begin (), ids.end (), id_before);
+
+  for (std::vector<std::string>::const_iterator id = ids.begin ();
+       id != ids.end ();
+       ++id) {
+
+    xmlDocPtr record = xmlRecoverFile (filename (*id).c_str ());
+
+    if (record == NULL)
+      continue;
+
+    xmlNodePtr entry = xmlDocGetRootElement (record);
+    if (entry != NULL
+	&& entry->name != NULL
+	&& xmlStrEqual (BAD_CAST ("entry"), entry->name)) {
+
+      xmlNodePtr copy = xmlDocCopyNode (entry, root->doc, 1);
+      xmlAddChild (root, copy);
+      entries.push_back (std::make_pair (copy, *id));
+    }
+    xmlFreeDoc (record);
+  }
+}
+
+
+std::string
+Local::Store::new_id ()
+{
+  std::string id;
+
+  do {
+
+    gchar* c_id = g_strdup_printf ("%lx-%x", (unsigned long) time (NULL),
+				   counter++);
+    id = c_id;
+    g_free (c_id);
+  } while (g_file_test (filename (id).c_str (), G_FILE_TEST_EXISTS)
+	   || pending_writes.find (id) != pending_writes.end ());
+
+  return id;
+}
+
+
+void
+Local::Store::write (const std::string id,
+		     xmlNodePtr node)
+{
+  if (transaction_depth > 0) {
+
+    pending_removals.erase (id);
+    pending_writes[id] = node;
+  } else
+    flush_write (id, node);
+}
+
+
+void
+Local::Store::remove (const std::string id)
+{
+  if (transaction_depth > 0) {
+
+    pending_writes.erase (id);
+    pending_removals.insert (id);
+  } else
+    flush_remove (id);
+}
+
+
+void
+Local::Store::begin ()
+{
+  transaction_depth++;
+}
+
+
+void
+Local::Store::commit ()
+{
+  if (transaction_depth == 0 || --transaction_depth > 0)
+    return;
+
+  for (std::set<std::string>::const_iterator iter = pending_removals.begin ();
+       iter != pending_removals.end ();
+       ++iter)
+    flush_remove (*iter);
+
+  for (std::map<std::string, xmlNodePtr>::const_iterator iter = pending_writes.begin ();
+       iter != pending_writes.end ();
+       ++iter)
+    flush_write (iter->first, iter->second);
+
+  pending_removals.clear ();
+  pending_writes.clear ();
+}
+
+
+const std::string
+Local::Store::filename (const std::string id) const
+{
+  gchar* c_filename = NULL;
+  std::string result;
+
+  c_filename = g_build_filename (directory.c_str (), (id + SUFFIX).c_str (), NULL);
+  result = c_filename;
+  g_free (c_filename);
+
+  return result;
+}
+
+
+void
+Local::Store::flush_write (const std::string id,
+			   xmlNodePtr node)
+{
+  xmlDocPtr record = NULL;
+  xmlChar* buffer = NULL;
+  int size = 0;
+  GError* error = NULL;
+
+  if ( !exists ())
+    g_mkdir_with_parents (directory.c_str (), 0700);
+
+  /* the entry is serialized alone, in a document of its own */
+  record = xmlNewDoc (BAD_CAST "1.0");
+  xmlDocSetRootElement (record, xmlDocCopyNode (node, record, 1));
+  xmlDocDumpMemory (record, &buffer, &size);
+  xmlFreeDoc (record);
+
+  /* this writes to a temporary file, then renames it */
+  if ( !g_file_set_contents (filename (id).c_str (),
+			     (const gchar*) buffer, size, &error)) {
+
+    // FIXME: better error reporting
+#ifdef __GNUC__
+    std::cout << "Couldn't save a local roster entry: "
+	      << error->message << std::endl;
+#endif
+    g_error_free (error);
+  }
+
+  xmlFree (buffer);
+}
+
+
+void
+Local::Store::flush_remove (const std::string id)
+{
+  (void) g_unlink (filename (id).c_str ());
+}
@@ -0,0 +1,136 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+
+/*
+ *                         local-store.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of the on-disk store of the local
+ *                          roster
+ *
+ */
+
+#ifndef __LOCAL_STORE_H__
+#define __LOCAL_STORE_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <libxml/tree.h>
+
+namespace Local
+{
+/**
+ * @addtogroup presence
+ * @internal
+ * @{
+ */
+
+  /**
+   * This class keeps the entries of the local roster on disk, one file
+   * per entry, so changing a contact only rewrites that contact.
+   *
+   * The writes can be grouped in a transaction : between begin and
+   * commit, they're only recorded, and each modified entry is written
+   * once when the outermost commit comes.
+   */
+  class Store
+  {
+  public:
+
+    /** The constructor.
+     * @param: The directory where the entries are kept.
+     */
+    Store (const std::string directory);
+
+    ~Store ();
+
+    /** Determines if the store was already created on disk.
+     * @return: TRUE if the directory exists.
+     */
+    bool exists () const;
+
+    /** Reads all entries, and adds them as children of the given node, in
+     * the order they were created.
+     * @param: The node to which the entries are added.
+     * @param: Filled with each node added and its record identifier, in
+     * the same order.
+     */
+    void load (xmlNodePtr root,
+	       std::vector<std::pair<xmlNodePtr, std::string> >& entries);
+
+    /** Returns an identifier for a new record.
+     */
+    std::string new_id ();
+
+    /** Writes (or schedules writing, in a transaction) an entry.
+     * The node has to stay valid until the end of the transaction, or
+     * be removed before.
+     * @param: The identifier of the record.
+     * @param: The entry node.
+     */
+    void write (const std::string id,
+		xmlNodePtr node);
+
+    /** Removes (or schedules removing, in a transaction) an entry.
+     * @param: The identifier of the record.
+     */
+    void remove (const std::string id);
+
+    /** Starts a transaction ; they can be nested.
+     */
+    void begin ();
+
+    /** Ends a transaction ; the outermost one flushes the changes.
+     */
+    void commit ();
+
+  private:
+
+    const std::string filename (const std::string id) const;
+
+    void flush_write (const std::string id,
+		      xmlNodePtr node);
+
+    void flush_remove (const std::string id);
+
+    std::string directory;
+    unsigned int transaction_depth;
+    unsigned int counter;
+    std::map<std::string, xmlNodePtr> pending_writes;
+    std::set<std::string> pending_removals;
+  };
+
+/**
+ * @}
+ */
+};
+
+#endif
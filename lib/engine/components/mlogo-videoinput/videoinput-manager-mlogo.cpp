@@ -106,6 +106,7 @@ bool GMVideoInputManager_mlogo::open (unsigned width, unsigned height, unsigned
   settings.colour = 127;
   settings.contrast = 127;
   settings.modifyable = false;
+  settings.pipeline = "YUV420P (generated)";
   Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &GMVideoInputManager_mlogo::device_opened_in_main), current_state.device, settings));
   
   return true;
@@ -199,14 +200,14 @@ bool GMVideoInputManager_mlogo::has_device     (const std::string & /*source*/,
 }
 
 void
-GMVideoInputManager_mlogo::device_opened_in_main (Ekiga::VideoInputDevice device,
-						  Ekiga::VideoInputSettings settings)
+GMVideoInputManager_mlogo::device_opened_in_main (const Ekiga::VideoInputDevice & device,
+						  const Ekiga::VideoInputSettings & settings)
 {
-  device_opened.emit (device, settings);
+  publish_device_opened (device, settings);
 }
 
 void
-GMVideoInputManager_mlogo::device_closed_in_main (Ekiga::VideoInputDevice device)
+GMVideoInputManager_mlogo::device_closed_in_main (const Ekiga::VideoInputDevice & device)
 {
-  device_closed.emit (device);
+  publish_device_closed (device);
 }
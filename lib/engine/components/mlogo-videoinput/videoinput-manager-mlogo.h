@@ -91,9 +91,9 @@
       PAdaptiveDelay adaptive_delay;
 
     private:
-      void device_opened_in_main (Ekiga::VideoInputDevice device,
-				  Ekiga::VideoInputSettings settings);
-      void device_closed_in_main (Ekiga::VideoInputDevice device);
+      void device_opened_in_main (const Ekiga::VideoInputDevice & device,
+				  const Ekiga::VideoInputSettings & settings);
+      void device_closed_in_main (const Ekiga::VideoInputDevice & device);
 
   };
 /**
@@ -121,14 +121,14 @@ bool GMAudioInputManager_null::has_device(const std::string & /*source*/, const
 }
 
 void
-GMAudioInputManager_null::device_opened_in_main (Ekiga::AudioInputDevice device,
-						 Ekiga::AudioInputSettings settings)
+GMAudioInputManager_null::device_opened_in_main (const Ekiga::AudioInputDevice & device,
+						 const Ekiga::AudioInputSettings & settings)
 {
-  device_opened.emit (device, settings);
+  publish_device_opened (device, settings);
 }
 
 void
-GMAudioInputManager_null::device_closed_in_main (Ekiga::AudioInputDevice device)
+GMAudioInputManager_null::device_closed_in_main (const Ekiga::AudioInputDevice & device)
 {
-  device_closed.emit (device);
+  publish_device_closed (device);
 }
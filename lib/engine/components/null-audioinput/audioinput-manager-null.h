@@ -79,9 +79,9 @@
       PAdaptiveDelay adaptive_delay;
 
     private:
-      void device_opened_in_main (Ekiga::AudioInputDevice device,
-				  Ekiga::AudioInputSettings settings);
-      void device_closed_in_main (Ekiga::AudioInputDevice device);
+      void device_opened_in_main (const Ekiga::AudioInputDevice & device,
+				  const Ekiga::AudioInputSettings & settings);
+      void device_closed_in_main (const Ekiga::AudioInputDevice & device);
   };
 /**
  * @}
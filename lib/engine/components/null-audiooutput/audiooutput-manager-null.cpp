@@ -122,15 +122,15 @@ bool GMAudioOutputManager_null::has_device(const std::string & /*sink*/, const s
 
 void
 GMAudioOutputManager_null::device_opened_in_main (Ekiga::AudioOutputPS ps,
-						  Ekiga::AudioOutputDevice device,
-						  Ekiga::AudioOutputSettings settings)
+						  const Ekiga::AudioOutputDevice & device,
+						  const Ekiga::AudioOutputSettings & settings)
 {
-  device_opened.emit (ps, device, settings);
+  publish_device_opened (ps, device, settings);
 }
 
 void
 GMAudioOutputManager_null::device_closed_in_main (Ekiga::AudioOutputPS ps,
-						  Ekiga::AudioOutputDevice device)
+						  const Ekiga::AudioOutputDevice & device)
 {
-  device_closed.emit (ps, device);
+  publish_device_closed (ps, device);
 }
@@ -79,10 +79,10 @@
 
     private:
       void device_opened_in_main (Ekiga::AudioOutputPS ps,
-				  Ekiga::AudioOutputDevice device,
-				  Ekiga::AudioOutputSettings settings);
+				  const Ekiga::AudioOutputDevice & device,
+				  const Ekiga::AudioOutputSettings & settings);
       void device_closed_in_main (Ekiga::AudioOutputPS ps,
-				  Ekiga::AudioOutputDevice device);
+				  const Ekiga::AudioOutputDevice & device);
 
   };
 
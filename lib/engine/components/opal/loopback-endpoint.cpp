@@ -0,0 +1,573 @@
+
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         loopback-endpoint.cpp  -  description
+ *                         --------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : This file contains the Loopback Endpoint class,
+ *                          calling itself to measure the media path.
+ *
+ */
+
+
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <codec/vidcodec.h>
+
+#include "loopback-endpoint.h"
+
+/* An audio mark : a burst of 1 kHz, every half second */
+#define CLICK_INTERVAL 500
+#define CLICK_LENGTH 5
+#define CLICK_LEVEL 16000
+
+/* What is loud enough to be the mark once decoded, and how long it has
+ * to be quiet before, in ms */
+#define CLICK_THRESHOLD 4000
+#define CLICK_QUIET 100
+
+/* A video mark : a frame counter of 12 bits and a check of 4 bits, drawn
+ * as a grid of 4 x 4 black or white blocks in the top left corner */
+#define MARK_BITS 16
+#define MARK_COUNTER_MASK 0xfff
+
+/* The marks which didn't come back after that long are lost, in ms */
+#define MARK_TIMEOUT 2000
+
+/* What the reflector keeps at most, in ms of audio and in pictures */
+#define REFLECTED_AUDIO 1000
+#define REFLECTED_PICTURES 10
+
+
+static unsigned
+mark_check (unsigned counter)
+{
+  return (counter ^ (counter >> 4) ^ (counter >> 8) ^ 0x5) & 0xf;
+}
+
+
+static unsigned
+mark_block_size (unsigned width,
+                 unsigned height)
+{
+  /* the grid takes half the height, and fits in the width */
+  return (std::min (width, height) / 8) & ~1u;
+}
+
+
+GMLoopbackEndpoint::GMLoopbackEndpoint (OpalManager & manager)
+  : OpalLocalEndPoint (manager, "loopback")
+{
+  /* the calls to ourselves have to reach the reflector, and ours have to
+   * go out through the protocol endpoint : those routes come before the
+   * ones already there */
+  PStringArray routes;
+  const OpalManager::RouteTable & table = manager.GetRouteTable ();
+
+  routes.AppendString ("sip:.*loopback@.* = loopback:reflector");
+  routes.AppendString ("loopback:.* = sip:<da>");
+
+  for (PINDEX i = 0 ; i < table.GetSize () ; i++)
+    routes.AppendString (table[i].pattern + " = " + table[i].destination);
+
+  manager.SetRouteTable (routes);
+}
+
+
+GMLoopbackEndpoint::~GMLoopbackEndpoint ()
+{
+  PWaitAndSignal m(mutex);
+
+  for (std::map<std::string, Stream *>::iterator iter = streams.begin ();
+       iter != streams.end ();
+       ++iter)
+    delete iter->second;
+}
+
+
+bool
+GMLoopbackEndpoint::start (const std::string & uri,
+                           PString & token)
+{
+  return manager.SetUpCall ("loopback:source", uri, token);
+}
+
+
+void
+GMLoopbackEndpoint::get_statistics (Statistics & audio,
+                                    Statistics & video) const
+{
+  PWaitAndSignal m(mutex);
+
+  audio = audio_statistics;
+  video = video_statistics;
+}
+
+
+OpalMediaFormatList
+GMLoopbackEndpoint::GetMediaFormats () const
+{
+  OpalMediaFormatList list;
+
+  list += OpalPCM16;
+  list += OpalPCM16_16KHZ;
+  list += OpalYUV420P;
+
+  return list;
+}
+
+
+bool
+GMLoopbackEndpoint::OnIncomingCall (OpalLocalConnection & connection)
+{
+  {
+    PWaitAndSignal m(mutex);
+    reflectors.insert ((const char *) connection.GetCall ().GetToken ());
+  }
+
+  return AcceptIncomingCall (connection.GetToken ());
+}
+
+
+void
+GMLoopbackEndpoint::OnReleased (OpalConnection & connection)
+{
+  {
+    PWaitAndSignal m(mutex);
+
+    std::string token = (const char *) connection.GetToken ();
+    PTime now;
+
+    for (std::map<std::string, Stream *>::iterator iter = streams.begin ();
+         iter != streams.end ();) {
+
+      if (iter->first.compare (0, token.length () + 1, token + "/") == 0) {
+
+        /* the marks still on their way when the call ends don't count,
+         * the older ones are lost */
+        Stream *state = iter->second;
+
+        for (std::deque<PTime>::iterator mark = state->pending.begin ();
+             mark != state->pending.end ();
+             ++mark) {
+
+          if ((now - *mark).GetMilliSeconds () < MARK_TIMEOUT)
+            audio_statistics.sent--;
+          else
+            audio_statistics.lost++;
+        }
+
+        for (std::map<unsigned, PTime>::iterator mark = state->pictures.begin ();
+             mark != state->pictures.end ();
+             ++mark) {
+
+          if ((now - mark->second).GetMilliSeconds () < MARK_TIMEOUT)
+            video_statistics.sent--;
+          else
+            video_statistics.lost++;
+        }
+
+        delete state;
+        streams.erase (iter++);
+      }
+      else
+        ++iter;
+    }
+
+    reflectors.erase ((const char *) connection.GetCall ().GetToken ());
+  }
+
+  OpalLocalEndPoint::OnReleased (connection);
+}
+
+
+bool
+GMLoopbackEndpoint::OnReadMediaData (const OpalLocalConnection & connection,
+                                     const OpalMediaStream & stream,
+                                     void *data,
+                                     PINDEX size,
+                                     PINDEX & length)
+{
+  OpalMediaFormat format = stream.GetMediaFormat ();
+  bool audio = (format.GetMediaType () == OpalMediaType::Audio ());
+  PAdaptiveDelay *pace = NULL;
+  unsigned delay = 0;
+
+  {
+    PWaitAndSignal m(mutex);
+
+    Stream & state = get_stream (connection, stream);
+    bool source = is_source (connection);
+
+    if (audio) {
+
+      unsigned rate = std::max (format.GetClockRate (), 8000u);
+      unsigned count = size / sizeof (short);
+      short *samples = (short *) data;
+
+      if (source)
+        generate_audio (state, rate, samples, count);
+      else {
+
+        unsigned available = std::min ((unsigned) state.samples.size (), count);
+
+        std::copy (state.samples.begin (), state.samples.begin () + available, samples);
+        std::fill (samples + available, samples + count, 0);
+        state.samples.erase (state.samples.begin (), state.samples.begin () + available);
+      }
+
+      length = count * sizeof (short);
+      delay = count * 1000 / rate;
+      state.position += count;
+    }
+    else {
+
+      if (source || (state.frames.empty () && state.last_frame.empty ()))
+        generate_video (state, format, source, (BYTE *) data, size, length);
+      else {
+
+        if (!state.frames.empty ()) {
+
+          state.last_frame.swap (state.frames.front ());
+          state.frames.pop_front ();
+        }
+
+        if ((PINDEX) state.last_frame.size () <= size) {
+
+          memcpy (data, &state.last_frame[0], state.last_frame.size ());
+          length = state.last_frame.size ();
+        }
+        else
+          generate_video (state, format, false, (BYTE *) data, size, length);
+      }
+
+      delay = std::max (format.GetOptionInteger (OpalVideoFormat::FrameTimeOption (), 90000 / 15) / 90, 1);
+      state.position++;
+    }
+
+    pace = &state.pace;
+  }
+
+  /* the local media streams are not synchronous : we are the clock, and
+   * the other streams mustn't wait for us meanwhile */
+  pace->Delay (delay);
+
+  return true;
+}
+
+
+bool
+GMLoopbackEndpoint::OnWriteMediaData (const OpalLocalConnection & connection,
+                                      const OpalMediaStream & stream,
+                                      const void *data,
+                                      PINDEX length,
+                                      PINDEX & written)
+{
+  PWaitAndSignal m(mutex);
+
+  OpalMediaFormat format = stream.GetMediaFormat ();
+  bool audio = (format.GetMediaType () == OpalMediaType::Audio ());
+  Stream & state = get_stream (connection, stream);
+  bool source = is_source (connection);
+
+  written = length;
+
+  if (audio) {
+
+    unsigned rate = std::max (format.GetClockRate (), 8000u);
+    const short *samples = (const short *) data;
+    unsigned count = length / sizeof (short);
+
+    if (source)
+      detect_audio (state, rate, samples, count);
+    else {
+
+      state.samples.insert (state.samples.end (), samples, samples + count);
+      if (state.samples.size () > rate * REFLECTED_AUDIO / 1000)
+        state.samples.erase (state.samples.begin (),
+                             state.samples.begin () + (state.samples.size () - rate * REFLECTED_AUDIO / 1000));
+    }
+  }
+  else {
+
+    const BYTE *frame = (const BYTE *) data;
+
+    if (source)
+      detect_video (state, frame, length);
+    else {
+
+      state.frames.push_back (std::vector<BYTE> (frame, frame + length));
+      if (state.frames.size () > REFLECTED_PICTURES)
+        state.frames.pop_front ();
+    }
+  }
+
+  return true;
+}
+
+
+GMLoopbackEndpoint::Stream &
+GMLoopbackEndpoint::get_stream (const OpalLocalConnection & connection,
+                                const OpalMediaStream & stream)
+{
+  bool audio = (stream.GetMediaFormat ().GetMediaType () == OpalMediaType::Audio ());
+  std::string key = (const char *) connection.GetToken ();
+
+  /* both directions of a medium share their state : the reflector reads
+   * what it wrote, and the source matches what it reads with what it
+   * wrote */
+  key += audio ? "/audio" : "/video";
+
+  std::map<std::string, Stream *>::iterator iter = streams.find (key);
+  if (iter == streams.end ())
+    iter = streams.insert (std::make_pair (key, new Stream)).first;
+
+  return *iter->second;
+}
+
+
+bool
+GMLoopbackEndpoint::is_source (const OpalLocalConnection & connection) const
+{
+  return reflectors.find ((const char *) connection.GetCall ().GetToken ()) == reflectors.end ();
+}
+
+
+void
+GMLoopbackEndpoint::generate_audio (Stream & state,
+                                    unsigned rate,
+                                    short *samples,
+                                    unsigned count)
+{
+  unsigned interval = rate * CLICK_INTERVAL / 1000;
+  unsigned click = rate * CLICK_LENGTH / 1000;
+  PTime now;
+
+  for (unsigned i = 0 ; i < count ; i++) {
+
+    unsigned phase = (state.position + i) % interval;
+
+    if (phase == 0) {
+
+      state.pending.push_back (now + PTimeInterval (i * 1000 / rate));
+      audio_statistics.sent++;
+    }
+
+    if (phase < click)
+      samples[i] = (short) (CLICK_LEVEL * sin (2 * M_PI * 1000 * phase / rate));
+    else
+      samples[i] = 0;
+  }
+}
+
+
+void
+GMLoopbackEndpoint::detect_audio (Stream & state,
+                                  unsigned rate,
+                                  const short *samples,
+                                  unsigned count)
+{
+  PTime now;
+
+  for (unsigned i = 0 ; i < count ; i++) {
+
+    if (abs (samples[i]) < CLICK_THRESHOLD) {
+
+      state.quiet++;
+      continue;
+    }
+
+    bool onset = (state.quiet >= rate * CLICK_QUIET / 1000);
+    state.quiet = 0;
+
+    if (!onset)
+      continue;
+
+    PTime received = now + PTimeInterval (i * 1000 / rate);
+
+    while (!state.pending.empty ()
+           && (received - state.pending.front ()).GetMilliSeconds () > MARK_TIMEOUT) {
+
+      state.pending.pop_front ();
+      audio_statistics.lost++;
+    }
+
+    if (!state.pending.empty () && state.pending.front () <= received) {
+
+      record_latency (audio_statistics, state.pending.front (), received);
+      state.pending.pop_front ();
+    }
+  }
+
+  while (!state.pending.empty ()
+         && (now - state.pending.front ()).GetMilliSeconds () > MARK_TIMEOUT) {
+
+    state.pending.pop_front ();
+    audio_statistics.lost++;
+  }
+}
+
+
+void
+GMLoopbackEndpoint::generate_video (Stream & state,
+                                    const OpalMediaFormat & format,
+                                    bool marked,
+                                    BYTE *data,
+                                    PINDEX size,
+                                    PINDEX & length)
+{
+  unsigned width = format.GetOptionInteger (OpalVideoFormat::FrameWidthOption (), PVideoFrameInfo::QCIFWidth);
+  unsigned height = format.GetOptionInteger (OpalVideoFormat::FrameHeightOption (), PVideoFrameInfo::QCIFHeight);
+  unsigned luma = width * height;
+
+  length = 0;
+  if (size < (PINDEX) (sizeof (OpalVideoTranscoder::FrameHeader) + luma * 3 / 2))
+    return;
+
+  OpalVideoTranscoder::FrameHeader *header = (OpalVideoTranscoder::FrameHeader *) data;
+  header->x = header->y = 0;
+  header->width = width;
+  header->height = height;
+
+  /* a scrolling gradient, so that the encoder has some work to do */
+  BYTE *picture = OPAL_VIDEO_FRAME_DATA_PTR (header);
+  for (unsigned y = 0 ; y < height ; y++)
+    for (unsigned x = 0 ; x < width ; x++)
+      picture[y * width + x] = (BYTE) (64 + ((x + y + state.position * 4) & 0x7f));
+  memset (picture + luma, 128, luma / 2);
+
+  /* the reflector only draws unmarked pictures, until it has one to send
+   * back */
+  if (marked) {
+
+    unsigned counter = state.position & MARK_COUNTER_MASK;
+    unsigned mark = counter | (mark_check (counter) << 12);
+    unsigned block = mark_block_size (width, height);
+
+    for (unsigned bit = 0 ; bit < MARK_BITS && block > 0 ; bit++) {
+
+      BYTE value = (mark & (1 << bit)) ? 235 : 16;
+      unsigned left = (bit % 4) * block;
+      unsigned top = (bit / 4) * block;
+
+      for (unsigned y = top ; y < top + block ; y++)
+        memset (picture + y * width + left, value, block);
+    }
+
+    /* the counter wraps after a few minutes, long after the timeout */
+    state.pictures[counter] = PTime ();
+    video_statistics.sent++;
+  }
+
+  length = sizeof (OpalVideoTranscoder::FrameHeader) + luma * 3 / 2;
+}
+
+
+void
+GMLoopbackEndpoint::detect_video (Stream & state,
+                                  const BYTE *data,
+                                  PINDEX length)
+{
+  PTime now;
+
+  if (length < (PINDEX) sizeof (OpalVideoTranscoder::FrameHeader))
+    return;
+
+  const OpalVideoTranscoder::FrameHeader *header = (const OpalVideoTranscoder::FrameHeader *) data;
+  unsigned width = header->width;
+  unsigned height = header->height;
+  unsigned block = mark_block_size (width, height);
+
+  if (block == 0
+      || length < (PINDEX) (sizeof (OpalVideoTranscoder::FrameHeader) + width * height))
+    return;
+
+  /* read the middle of each block : the edges are blurred by the codec */
+  const BYTE *picture = OPAL_VIDEO_FRAME_DATA_PTR (header);
+  unsigned mark = 0;
+
+  for (unsigned bit = 0 ; bit < MARK_BITS ; bit++) {
+
+    unsigned left = (bit % 4) * block + block / 4;
+    unsigned top = (bit / 4) * block + block / 4;
+    unsigned sum = 0;
+
+    for (unsigned y = top ; y < top + block / 2 ; y++)
+      for (unsigned x = left ; x < left + block / 2 ; x++)
+        sum += picture[y * width + x];
+
+    if (sum / ((block / 2) * (block / 2)) > 128)
+      mark |= (1 << bit);
+  }
+
+  unsigned counter = mark & MARK_COUNTER_MASK;
+  if ((mark >> 12) == mark_check (counter)) {
+
+    /* a picture shown twice is only counted once */
+    std::map<unsigned, PTime>::iterator iter = state.pictures.find (counter);
+    if (iter != state.pictures.end ()) {
+
+      record_latency (video_statistics, iter->second, now);
+      state.pictures.erase (iter);
+    }
+  }
+
+  for (std::map<unsigned, PTime>::iterator iter = state.pictures.begin ();
+       iter != state.pictures.end ();) {
+
+    if ((now - iter->second).GetMilliSeconds () > MARK_TIMEOUT) {
+
+      video_statistics.lost++;
+      state.pictures.erase (iter++);
+    }
+    else
+      ++iter;
+  }
+}
+
+
+void
+GMLoopbackEndpoint::record_latency (Statistics & statistics,
+                                    const PTime & sent,
+                                    const PTime & received)
+{
+  double latency = (received - sent).GetMilliSeconds ();
+
+  if (statistics.received == 0 || latency < statistics.latency_min)
+    statistics.latency_min = latency;
+  if (latency > statistics.latency_max)
+    statistics.latency_max = latency;
+
+  statistics.latency_sum += latency;
+  statistics.received++;
+}
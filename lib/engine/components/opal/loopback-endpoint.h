@@ -0,0 +1,184 @@
+
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         loopback-endpoint.h  -  description
+ *                         ------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : This file contains the Loopback Endpoint class,
+ *                          calling itself to measure the media path.
+ *
+ */
+
+
+#ifndef _LOOPBACK_ENDPOINT_H_
+#define _LOOPBACK_ENDPOINT_H_
+
+#include <opal/buildopts.h>
+#include <ptbuildopts.h>
+#include <ptlib.h>
+
+#include <opal/manager.h>
+#include <opal/localep.h>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/* The loopback endpoint calls itself through a protocol endpoint of the
+ * same manager, over localhost : the "source" side of the call generates
+ * the media, the "reflector" side which answers it sends back what it
+ * receives. The media thus goes through the codecs, RTP and the jitter
+ * buffers twice, as in a real call, without any device.
+ *
+ * The source marks its media : an audio click every half second, and a
+ * frame counter drawn in each picture. When the marks come back, their
+ * round trip time is measured ; the marks which never come back are
+ * lost.
+ *
+ * Nothing here is meant for the real calls of the user : the endpoint is
+ * only registered by the test programs.
+ */
+class GMLoopbackEndpoint : public OpalLocalEndPoint
+{
+  PCLASSINFO (GMLoopbackEndpoint, OpalLocalEndPoint);
+
+public:
+
+  /** What was measured on one medium
+   */
+  struct Statistics
+  {
+    Statistics (): sent(0), received(0), lost(0),
+                   latency_min(0.0), latency_max(0.0), latency_sum(0.0)
+    {}
+
+    unsigned sent;            // marks
+    unsigned received;
+    unsigned lost;            // the ones which didn't come back in time
+    double latency_min;       // ms, round trip
+    double latency_max;
+    double latency_sum;
+  };
+
+  GMLoopbackEndpoint (OpalManager & manager);
+
+  ~GMLoopbackEndpoint ();
+
+  /** Call ourselves
+   * @param uri is where the protocol endpoint listens, for example
+   * "sip:loopback@127.0.0.1:5060" ; the user part has to be "loopback"
+   * so that the call is routed back to the reflector.
+   * @param token receives the token of the call of the source side.
+   * @return false if the call couldn't be set up.
+   */
+  bool start (const std::string & uri,
+              PString & token);
+
+  /** Return what was measured since the beginning, all the calls
+   * together
+   */
+  void get_statistics (Statistics & audio,
+                       Statistics & video) const;
+
+  OpalMediaFormatList GetMediaFormats () const;
+
+  bool OnIncomingCall (OpalLocalConnection & connection);
+
+  bool OnReadMediaData (const OpalLocalConnection & connection,
+                        const OpalMediaStream & stream,
+                        void *data,
+                        PINDEX size,
+                        PINDEX & length);
+
+  bool OnWriteMediaData (const OpalLocalConnection & connection,
+                         const OpalMediaStream & stream,
+                         const void *data,
+                         PINDEX length,
+                         PINDEX & written);
+
+  void OnReleased (OpalConnection & connection);
+
+private:
+
+  struct Stream
+  {
+    Stream (): position(0), quiet(0) {}
+
+    PAdaptiveDelay pace;
+    unsigned long position;   // samples or pictures read so far
+    unsigned quiet;           // samples since the last loud one
+
+    std::deque<PTime> pending;                    // audio marks sent
+    std::map<unsigned, PTime> pictures;           // video marks sent
+    std::deque<short> samples;                    // reflected audio
+    std::deque< std::vector<BYTE> > frames;       // reflected video
+    std::vector<BYTE> last_frame;
+  };
+
+  Stream & get_stream (const OpalLocalConnection & connection,
+                       const OpalMediaStream & stream);
+
+  bool is_source (const OpalLocalConnection & connection) const;
+
+  void generate_audio (Stream & state,
+                       unsigned rate,
+                       short *samples,
+                       unsigned count);
+
+  void detect_audio (Stream & state,
+                     unsigned rate,
+                     const short *samples,
+                     unsigned count);
+
+  void generate_video (Stream & state,
+                       const OpalMediaFormat & format,
+                       bool marked,
+                       BYTE *data,
+                       PINDEX size,
+                       PINDEX & length);
+
+  void detect_video (Stream & state,
+                     const BYTE *data,
+                     PINDEX length);
+
+  void record_latency (Statistics & statistics,
+                       const PTime & sent,
+                       const PTime & received);
+
+  std::map<std::string, Stream *> streams;
+  std::set<std::string> reflectors;         // the tokens of their calls
+  Statistics audio_statistics;
+  Statistics video_statistics;
+  mutable PMutex mutex;
+};
+
+#endif
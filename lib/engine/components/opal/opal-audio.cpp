@@ -42,7 +42,6 @@
 #pragma implementation "opal-audio.h"
 
 #include "opal-audio.h"
-#include "engine.h"
 
 namespace OpalLinkerHacks {
   int loadOpalAudio;
@@ -53,9 +52,11 @@ class PSoundChannel_EKIGA_PluginServiceDescriptor
 : public PDevicePluginServiceDescriptor
 {
   public:
+    /* the call manager makes the devices, with the cores : the plugin
+     * only makes the name known to OPAL */
     virtual PObject *CreateInstance (int) const 
       {
-	return new PSoundChannel_EKIGA (*(engine_get_service_core ())); 
+	return NULL; 
       }
     
     
@@ -76,10 +77,10 @@ PCREATE_PLUGIN(EKIGA, PSoundChannel, &PSoundChannel_EKIGA_descriptor);
 
 ///////////////////////////////////////////////////////////////////////////////
 
-PSoundChannel_EKIGA::PSoundChannel_EKIGA (Ekiga::ServiceCore & _core):
-  core (_core),
-  audioinput_core (core.get ("audioinput-core")),
-  audiooutput_core (core.get ("audiooutput-core"))
+PSoundChannel_EKIGA::PSoundChannel_EKIGA (gmref_ptr<Ekiga::AudioInputCore> _audioinput_core,
+                                          gmref_ptr<Ekiga::AudioOutputCore> _audiooutput_core):
+  audioinput_core (_audioinput_core),
+  audiooutput_core (_audiooutput_core)
 {
   opened = false;
 }
@@ -90,10 +91,10 @@ PSoundChannel_EKIGA::PSoundChannel_EKIGA (const PString & /*_device*/,
 					  unsigned numChannels,
 					  unsigned sampleRate,
 					  unsigned bitsPerSample,
-					  Ekiga::ServiceCore & _core):
-  core (_core),
-  audioinput_core (core.get ("audioinput-core")),
-  audiooutput_core (core.get ("audiooutput-core"))
+					  gmref_ptr<Ekiga::AudioInputCore> _audioinput_core,
+					  gmref_ptr<Ekiga::AudioOutputCore> _audiooutput_core):
+  audioinput_core (_audioinput_core),
+  audiooutput_core (_audiooutput_core)
 {
   opened = false;
   Open (device, dir, numChannels, sampleRate, bitsPerSample);
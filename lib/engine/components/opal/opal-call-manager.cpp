@@ -45,6 +45,9 @@
 #include "call-core.h"
 #include "opal-call.h"
 #include "opal-codec-description.h"
+#include "opal-codec-benchmark.h"
+#include "opal-videoinput.h"
+#include "opal-videooutput.h"
 #include "videoinput-info.h"
 
 #include "call-manager.h"
@@ -93,12 +96,105 @@ private:
 };
 
 
+/* Measures the cost of the codecs once, for the automatic ordering ; the
+ * call manager stops and joins it when it goes away */
+class CodecMeasurer : public PThread
+{
+  PCLASSINFO(CodecMeasurer, PThread);
+
+public:
+
+  CodecMeasurer (Opal::CallManager & _manager,
+                 const OpalMediaFormatList & _raw_formats,
+                 const OpalMediaFormatList & _formats,
+                 unsigned _video_bitrate)
+    : PThread (1000, NoAutoDeleteThread, LowestPriority),
+      manager (_manager),
+      raw_formats (_raw_formats),
+      formats (_formats),
+      video_bitrate (_video_bitrate),
+      stopping (false)
+  {
+    this->Resume ();
+  };
+
+  void stop ()
+  {
+    PWaitAndSignal m(stopping_mutex);
+    stopping = true;
+  };
+
+  void Main ()
+  {
+    Opal::CodecBenchmark::VideoClip video_clip;
+
+    Opal::CodecBenchmark::make_video_clip (1, video_clip);
+
+    for (PINDEX i = 0 ; i < formats.GetSize () ; i++) {
+
+      {
+        PWaitAndSignal m(stopping_mutex);
+        if (stopping)
+          return;
+      }
+
+      if (!formats[i].IsTransportable ())
+        continue;
+
+      Ekiga::CodecDescription desc = Opal::CodecDescription (formats[i]);
+      Opal::CodecBenchmark::Result result;
+      OpalMediaFormat raw;
+      bool done = false;
+
+      if (desc.name.empty ()
+          || !Opal::CodecBenchmark::find_raw_format (raw_formats, desc, raw))
+        continue;
+
+      if (desc.audio) {
+
+        std::vector<short> clip;
+        Opal::CodecBenchmark::make_audio_clip (desc.rate, 1, clip);
+        done = Opal::CodecBenchmark::run_audio (raw, formats[i], clip, result);
+      }
+      else
+        done = Opal::CodecBenchmark::run_video (raw, formats[i], video_clip, video_bitrate, result);
+
+      if (!done || result.duration <= 0)
+        continue;
+
+      Opal::CodecPlanner::Cost cost;
+      cost.cpu = (result.encode_time + result.decode_time) / (result.duration * 1000000);
+      cost.bitrate = result.bytes * 8 / result.duration / 1000;
+
+      PTRACE (4, "Opal::CallManager\tCodec " << formats[i] << " costs "
+              << 100 * cost.cpu << "% of a CPU, " << cost.bitrate << " kbit/s");
+
+      manager.set_codec_cost (desc, cost,
+                              desc.audio ? 0 : video_clip.width,
+                              desc.audio ? 0 : video_clip.height);
+    }
+  };
+
+private:
+  Opal::CallManager & manager;
+  const OpalMediaFormatList raw_formats;
+  const OpalMediaFormatList formats;
+  unsigned video_bitrate;
+  bool stopping;
+  PMutex stopping_mutex;
+};
+
+
 using namespace Opal;
 
 
 /* The class */
 CallManager::CallManager (Ekiga::ServiceCore & _core)
-  : core (_core)
+  : core (_core),
+    audioinput_core (core.get<Ekiga::AudioInputCore> ("audioinput-core")),
+    audiooutput_core (core.get<Ekiga::AudioOutputCore> ("audiooutput-core")),
+    videoinput_core (core.get<Ekiga::VideoInputCore> ("videoinput-core")),
+    videooutput_core (core.get<Ekiga::VideoOutputCore> ("videooutput-core"))
 {
   /* Initialise the endpoint paramaters */
   PIPSocket::SetDefaultIpAddressFamilyV4();
@@ -114,6 +210,9 @@ CallManager::CallManager (Ekiga::ServiceCore & _core)
   forward_on_busy = false;
   unconditional_forward = false;
   stun_enabled = false;
+  adaptive_jitter = false;
+  automatic_codecs = false;
+  codec_measurer = NULL;
 
   // Create video devices
   PVideoDevice::OpenArgs video = GetVideoOutputDevice();
@@ -146,12 +245,84 @@ CallManager::CallManager (Ekiga::ServiceCore & _core)
 
 CallManager::~CallManager ()
 {
+  if (codec_measurer != NULL) {
+
+    codec_measurer->stop ();
+    codec_measurer->WaitForTermination ();
+    delete codec_measurer;
+  }
+
   ClearAllCalls (OpalConnection::EndedByLocalUser, true);
 
+  /* the devices of the calls are gone with them */
+  audioinput_core.reset ();
+  audiooutput_core.reset ();
+  videoinput_core.reset ();
+  videooutput_core.reset ();
+
   g_async_queue_unref (queue);
 }
 
 
+PBoolean CallManager::CreateVideoInputDevice (const OpalConnection & connection,
+                                              const OpalMediaFormat & media_format,
+                                              PVideoInputDevice * & device,
+                                              PBoolean & auto_delete)
+{
+  PVideoDevice::OpenArgs args = GetVideoInputDevice ();
+
+  if (args.deviceName != "EKIGA")
+    return OpalManager::CreateVideoInputDevice (connection, media_format,
+                                                device, auto_delete);
+
+  /* as OpalManager does, but with a device which knows the core */
+  args.width = media_format.GetOptionInteger (OpalVideoFormat::FrameWidthOption (),
+                                              PVideoFrameInfo::QCIFWidth);
+  args.height = media_format.GetOptionInteger (OpalVideoFormat::FrameHeightOption (),
+                                               PVideoFrameInfo::QCIFHeight);
+  args.rate = media_format.GetClockRate () / media_format.GetFrameTime ();
+
+  auto_delete = true;
+  device = new PVideoInputDevice_EKIGA (videoinput_core);
+  if (device->OpenFull (args, false))
+    return true;
+
+  delete device;
+  device = NULL;
+
+  return false;
+}
+
+
+PBoolean CallManager::CreateVideoOutputDevice (const OpalConnection & connection,
+                                               const OpalMediaFormat & media_format,
+                                               PBoolean preview,
+                                               PVideoOutputDevice * & device,
+                                               PBoolean & auto_delete)
+{
+  PVideoDevice::OpenArgs args = preview ? GetVideoPreviewDevice () : GetVideoOutputDevice ();
+
+  if (args.deviceName != "EKIGAOUT" && args.deviceName != "EKIGAIN")
+    return OpalManager::CreateVideoOutputDevice (connection, media_format,
+                                                 preview, device, auto_delete);
+
+  args.width = media_format.GetOptionInteger (OpalVideoFormat::FrameWidthOption (),
+                                              PVideoFrameInfo::QCIFWidth);
+  args.height = media_format.GetOptionInteger (OpalVideoFormat::FrameHeightOption (),
+                                               PVideoFrameInfo::QCIFHeight);
+
+  auto_delete = true;
+  device = new PVideoOutputDevice_EKIGA (videooutput_core);
+  if (device->OpenFull (args, false))
+    return true;
+
+  delete device;
+  device = NULL;
+
+  return false;
+}
+
+
 void CallManager::set_display_name (const std::string & name)
 {
   display_name = name;
@@ -210,33 +381,26 @@ bool CallManager::get_echo_cancellation () const
 
 void CallManager::set_maximum_jitter (unsigned max_val)
 {
+  max_val = PMIN (PMAX (max_val, 20), 1000);
+
   // Adjust general settings
-  SetAudioJitterDelay (20, PMIN (PMAX (max_val, 20), 1000));
+  SetAudioJitterDelay (20, max_val);
 
-  // Adjust setting for all sessions of all connections of all calls
+  // Adjust setting for all calls
   for (PSafePtr<OpalCall> call = activeCalls;
        call != NULL;
        ++call) {
 
-    for (int i = 0;
-         i < 2;
-         i++) {
-
-      PSafePtr<OpalRTPConnection> connection = PSafePtrCast<OpalConnection, OpalRTPConnection> (call->GetConnection (i));
-      if (connection) {
-
-        OpalMediaStreamPtr stream = connection->GetMediaStream (OpalMediaType::Audio (), false);
-        if (stream != NULL) {
+    std::map<std::string, JitterController>::iterator iter
+      = jitter_controllers.find ((const char *) call->GetToken ());
 
-          RTP_Session *session = connection->GetSession (stream->GetSessionID ());
-          if (session != NULL) {
+    if (adaptive_jitter && iter != jitter_controllers.end ()) {
 
-            unsigned units = session->GetJitterTimeUnits ();
-            session->SetJitterBufferSize (20 * units, max_val * units, units);
-          }
-        }
-      }
+      iter->second.set_bounds (20, max_val);
+      set_jitter_window (*call, iter->second.get_min_delay (), iter->second.get_max_delay ());
     }
+    else
+      set_jitter_window (*call, 20, max_val);
   }
 }
 
@@ -247,6 +411,31 @@ unsigned CallManager::get_maximum_jitter () const
 }
 
 
+void CallManager::set_adaptive_jitter (bool enabled)
+{
+  adaptive_jitter = enabled;
+
+  if (!adaptive_jitter) {
+
+    // Go back to the static window
+    jitter_controllers.clear ();
+    set_maximum_jitter (get_maximum_jitter ());
+  }
+}
+
+
+bool CallManager::get_adaptive_jitter () const
+{
+  return adaptive_jitter;
+}
+
+
+void CallManager::get_jitter_decisions (std::list<std::pair<std::string, JitterController::Decision> > & decisions) const
+{
+  decisions.insert (decisions.end (), jitter_decisions.begin (), jitter_decisions.end ());
+}
+
+
 void CallManager::set_silence_detection (bool enabled)
 {
   OpalSilenceDetector::Params sd;
@@ -317,9 +506,6 @@ void CallManager::set_codecs (Ekiga::CodecList & _codecs)
   OpalMediaFormatList all_media_formats;
   OpalMediaFormatList media_formats;
 
-  PStringArray order;
-  PStringArray mask;
-
   // What do we support
   GetAllowedFormats (all_media_formats);
   Ekiga::CodecList all_codecs = Opal::CodecList (all_media_formats);
@@ -355,15 +541,34 @@ void CallManager::set_codecs (Ekiga::CodecList & _codecs)
       it = _codecs.begin ();
     }
   }
-  codecs = _codecs;
+  {
+    PWaitAndSignal m(manager_access_mutex);
+    codecs = _codecs;
+  }
+
+  // The automatic ordering applies its own order at the next call
+  if (!automatic_codecs) {
+
+    PWaitAndSignal m(media_formats_mutex);
+    apply_codecs (codecs);
+  }
+}
+
+
+void CallManager::apply_codecs (const Ekiga::CodecList & list)
+{
+  OpalMediaFormatList all_media_formats;
+  PStringArray order;
+  PStringArray mask;
 
+  GetAllowedFormats (all_media_formats);
 
   //
   // Update OPAL
   //
-  Ekiga::CodecList::iterator codecs_it;
-  for (codecs_it = codecs.begin () ;
-       codecs_it != codecs.end () ;
+  Ekiga::CodecList::const_iterator codecs_it;
+  for (codecs_it = list.begin () ;
+       codecs_it != list.end () ;
        codecs_it++) {
 
     bool active = (*codecs_it).active;
@@ -401,6 +606,83 @@ void CallManager::set_codecs (Ekiga::CodecList & _codecs)
   SetMediaFormatOrder (order);
 }
 
+
+void CallManager::set_automatic_codecs (bool enabled)
+{
+  automatic_codecs = enabled;
+
+  if (automatic_codecs) {
+
+    // The costs are measured once, in the background
+    if (codec_measurer == NULL && !planner.has_costs ()) {
+
+      OpalMediaFormatList formats;
+
+      GetAllowedFormats (formats);
+      codec_measurer = new CodecMeasurer (*this, pcssEP->GetMediaFormats (), formats,
+                         video_options.maximum_transmitted_bitrate > 0 ? video_options.maximum_transmitted_bitrate : 48);
+    }
+  }
+  else {
+
+    // Go back to the user's choices
+    PWaitAndSignal m(media_formats_mutex);
+    apply_codecs (codecs);
+    apply_video_options (video_options);
+  }
+}
+
+
+bool CallManager::get_automatic_codecs () const
+{
+  return automatic_codecs;
+}
+
+
+void CallManager::set_codec_cost (const Ekiga::CodecDescription & desc,
+                                  const CodecPlanner::Cost & cost,
+                                  unsigned width,
+                                  unsigned height)
+{
+  planner.set_cost (desc, cost, width, height);
+}
+
+
+void CallManager::plan_codecs ()
+{
+  Ekiga::CodecList preferred;
+  VideoOptions options;
+  CodecPlanner::Plan plan;
+
+  // The running calls keep the formats they were planned with
+  if (GetCallCount () > 0)
+    return;
+
+  {
+    PWaitAndSignal m(manager_access_mutex);
+    preferred = codecs;
+    options = video_options;
+  }
+
+  // Computed unlocked : it watches the CPU for a while
+  planner.plan (preferred, options.size, plan);
+
+  PWaitAndSignal m(media_formats_mutex);
+
+  // Another call may have started meanwhile
+  if (GetCallCount () > 0)
+    return;
+
+  PTRACE (3, "Opal::CallManager\tCodecs planned with " << plan.cpu_headroom
+          << " CPU left and " << plan.link_capacity << " kbit/s of link: "
+          << plan.codecs << ", video size " << plan.video_size);
+
+  apply_codecs (plan.codecs);
+
+  options.size = plan.video_size;
+  apply_video_options (options);
+}
+
 void CallManager::set_forward_on_no_answer (bool enabled)
 {
   forward_on_no_answer = enabled;
@@ -498,6 +780,55 @@ bool CallManager::dial (const std::string & uri)
 
 
 void CallManager::set_video_options (const CallManager::VideoOptions & options)
+{
+  {
+    PWaitAndSignal m(manager_access_mutex);
+    video_options = options;
+  }
+
+  {
+    PWaitAndSignal m(media_formats_mutex);
+    apply_video_options (options);
+  }
+
+  // Adjust setting for all sessions of all connections of all calls
+  for (PSafePtr<OpalCall> call = activeCalls;
+       call != NULL;
+       ++call) {
+
+    for (int i = 0;
+         i < 2;
+         i++) {
+
+      PSafePtr<OpalRTPConnection> connection = PSafePtrCast<OpalConnection, OpalRTPConnection> (call->GetConnection (i));
+      if (connection) {
+
+        OpalMediaStreamPtr stream = connection->GetMediaStream (OpalMediaType::Video (), false);
+        if (stream != NULL) {
+
+          OpalMediaFormat mediaFormat = stream->GetMediaFormat ();
+          mediaFormat.SetOptionInteger (OpalVideoFormat::TemporalSpatialTradeOffOption(),
+                                        (options.temporal_spatial_tradeoff > 0 ? options.temporal_spatial_tradeoff : 31));
+          mediaFormat.SetOptionInteger (OpalVideoFormat::TargetBitRateOption (),
+                                        (options.maximum_transmitted_bitrate > 0 ? options.maximum_transmitted_bitrate : 48) * 1000);
+          mediaFormat.ToNormalisedOptions();
+          stream->UpdateMediaFormat (mediaFormat);
+        }
+      }
+    }
+  }
+}
+
+
+void CallManager::get_video_options (CallManager::VideoOptions & options) const
+{
+  PWaitAndSignal m(manager_access_mutex);
+
+  options = video_options;
+}
+
+
+void CallManager::apply_video_options (const CallManager::VideoOptions & options)
 {
   OpalMediaFormatList media_formats_list;
   OpalMediaFormat::GetAllRegisteredMediaFormats (media_formats_list);
@@ -553,91 +884,106 @@ void CallManager::set_video_options (const CallManager::VideoOptions & options)
       OpalMediaFormat::SetRegisteredMediaFormat(media_format);
     }
   }
+}
 
-  // Adjust setting for all sessions of all connections of all calls
-  for (PSafePtr<OpalCall> call = activeCalls;
-       call != NULL;
-       ++call) {
 
-    for (int i = 0;
-         i < 2;
-         i++) {
+OpalCall *CallManager::CreateCall (void *uri)
+{
+  gmref_ptr<Ekiga::CallCore> call_core = core.get ("call-core"); // FIXME: threaded?
+  gmref_ptr<Opal::Call> call;
 
-      PSafePtr<OpalRTPConnection> connection = PSafePtrCast<OpalConnection, OpalRTPConnection> (call->GetConnection (i));
-      if (connection) {
+  // The media formats are negotiated after the call is created
+  if (automatic_codecs)
+    plan_codecs ();
 
-        OpalMediaStreamPtr stream = connection->GetMediaStream (OpalMediaType::Video (), false);
-        if (stream != NULL) {
+  if (uri != 0)
+    call = gmref_ptr<Opal::Call> (new Opal::Call (*this, core, (const char *) uri));
+  else
+    call = gmref_ptr<Opal::Call> (new Opal::Call (*this, core, ""));
+  call_core->add_call (call, gmref_ptr<CallManager>(this));
 
-          OpalMediaFormat mediaFormat = stream->GetMediaFormat ();
-          mediaFormat.SetOptionInteger (OpalVideoFormat::TemporalSpatialTradeOffOption(),
-                                        (options.temporal_spatial_tradeoff > 0 ? options.temporal_spatial_tradeoff : 31));
-          mediaFormat.SetOptionInteger (OpalVideoFormat::TargetBitRateOption (),
-                                        (options.maximum_transmitted_bitrate > 0 ? options.maximum_transmitted_bitrate : 48) * 1000);
-          mediaFormat.ToNormalisedOptions();
-          stream->UpdateMediaFormat (mediaFormat);
-        }
-      }
-    }
-  }
+  call->statistics_updated.connect (sigc::bind (sigc::mem_fun (this, &CallManager::on_call_statistics), call->get_id ()));
+  call->removed.connect (sigc::bind (sigc::mem_fun (this, &CallManager::on_call_removed), call->get_id ()));
+
+  return call.get ();
 }
 
 
-void CallManager::get_video_options (CallManager::VideoOptions & options) const
+void
+CallManager::DestroyCall (OpalCall *_call)
 {
-  OpalMediaFormatList media_formats_list;
-  OpalMediaFormat::GetAllRegisteredMediaFormats (media_formats_list);
+  Ekiga::Call *call = dynamic_cast<Ekiga::Call *> (_call);
 
-  for (int i = 0 ; i < media_formats_list.GetSize () ; i++) {
+  Ekiga::Runtime::emit_signal_in_main(call->removed);
+}
 
-    OpalMediaFormat media_format = media_formats_list [i];
-    if (media_format.GetMediaType () == OpalMediaType::Video ()) {
 
-      int j = 0;
-      for (j = 0; j < NB_VIDEO_SIZES; j++) {
+void
+CallManager::set_jitter_window (OpalCall & call,
+                                unsigned min_val,
+                                unsigned max_val)
+{
+  // Adjust setting for all sessions of all connections of the call
+  for (int i = 0;
+       i < 2;
+       i++) {
+
+    PSafePtr<OpalRTPConnection> connection = PSafePtrCast<OpalConnection, OpalRTPConnection> (call.GetConnection (i));
+    if (connection) {
+
+      OpalMediaStreamPtr stream = connection->GetMediaStream (OpalMediaType::Audio (), false);
+      if (stream != NULL) {
 
-        if (Ekiga::VideoSizes [j].width == media_format.GetOptionInteger (OpalVideoFormat::FrameWidthOption ())
-            && Ekiga::VideoSizes [j].width == media_format.GetOptionInteger (OpalVideoFormat::FrameWidthOption ()))
-          break;
+        RTP_Session *session = connection->GetSession (stream->GetSessionID ());
+        if (session != NULL) {
+
+          unsigned units = session->GetJitterTimeUnits ();
+          session->SetJitterBufferSize (min_val * units, max_val * units, units);
+        }
       }
-      options.size = j;
-
-      options.maximum_frame_rate =
-        (int) (90000 / media_format.GetOptionInteger (OpalVideoFormat::FrameTimeOption ()));
-      options.maximum_received_bitrate =
-        (int) (media_format.GetOptionInteger (OpalVideoFormat::MaxBitRateOption ()) / 1000);
-      options.maximum_transmitted_bitrate =
-        (int) (media_format.GetOptionInteger (OpalVideoFormat::TargetBitRateOption ()) / 1000);
-      options.temporal_spatial_tradeoff =
-        media_format.GetOptionInteger (OpalVideoFormat::TemporalSpatialTradeOffOption ());
-
-      break;
     }
   }
 }
 
 
-OpalCall *CallManager::CreateCall (void *uri)
+void
+CallManager::on_call_statistics (Ekiga::CallStatistics stats,
+                                 std::string token)
 {
-  gmref_ptr<Ekiga::CallCore> call_core = core.get ("call-core"); // FIXME: threaded?
-  gmref_ptr<Opal::Call> call;
+  planner.feed (stats);
 
-  if (uri != 0)
-    call = gmref_ptr<Opal::Call> (new Opal::Call (*this, core, (const char *) uri));
-  else
-    call = gmref_ptr<Opal::Call> (new Opal::Call (*this, core, ""));
-  call_core->add_call (call, gmref_ptr<CallManager>(this));
+  if (!adaptive_jitter)
+    return;
 
-  return call.get ();
+  std::map<std::string, JitterController>::iterator iter = jitter_controllers.find (token);
+  if (iter == jitter_controllers.end ())
+    iter = jitter_controllers.insert (std::make_pair (token, JitterController (20, get_maximum_jitter ()))).first;
+
+  const JitterController::Decision & decision = iter->second.feed (stats.late_packets, stats.lost_packets);
+  if (decision.what == JitterController::KEEP)
+    return;
+
+  PSafePtr<OpalCall> call = FindCallWithLock (token, PSafeReadOnly);
+  if (call != NULL)
+    set_jitter_window (*call, decision.min_delay, decision.max_delay);
+
+  PTRACE (4, "Opal::CallManager\tJitter buffer of " << token
+          << " moved to " << decision.min_delay << "-" << decision.max_delay
+          << " ms (late " << decision.late_packets
+          << "%, lost " << decision.lost_packets << "%)");
+
+  jitter_decisions.push_back (std::make_pair (token, decision));
+  if (jitter_decisions.size () > 100)
+    jitter_decisions.pop_front ();
+
+  jitter_adjusted.emit (token, decision);
 }
 
 
 void
-CallManager::DestroyCall (OpalCall *_call)
+CallManager::on_call_removed (std::string token)
 {
-  Ekiga::Call *call = dynamic_cast<Ekiga::Call *> (_call);
-
-  Ekiga::Runtime::emit_signal_in_main(call->removed);
+  jitter_controllers.erase (token);
 }
 
 
@@ -669,31 +1015,7 @@ CallManager::OnOpenMediaStream (OpalConnection & connection,
 
 void CallManager::GetAllowedFormats (OpalMediaFormatList & full_list)
 {
-  OpalMediaFormatList list = OpalTranscoder::GetPossibleFormats (pcssEP->GetMediaFormats ());
-  std::list<std::string> black_list;
-
-  black_list.push_back ("GSM-AMR");
-  black_list.push_back ("Linear-16-Stereo-48kHz");
-  black_list.push_back ("LPC-10");
-  black_list.push_back ("SpeexIETFNarrow-11k");
-  black_list.push_back ("SpeexIETFNarrow-15k");
-  black_list.push_back ("SpeexIETFNarrow-18.2k");
-  black_list.push_back ("SpeexIETFNarrow-24.6k");
-  black_list.push_back ("SpeexIETFNarrow-5.95k");
-  black_list.push_back ("iLBC-13k3");
-  black_list.push_back ("iLBC-15k2");
-  black_list.push_back ("RFC4175_YCbCr-4:2:0");
-  black_list.push_back ("RFC4175_RGB");
-
-  // Purge blacklisted codecs
-  for (PINDEX i = 0 ; i < list.GetSize () ; i++) {
-
-    std::list<std::string>::iterator it = find (black_list.begin (), black_list.end (), (const char *) list [i]);
-    if (it == black_list.end ()) {
-      if (list [i].GetMediaType () == OpalMediaType::Audio () || list [i].GetMediaType () == OpalMediaType::Video ())
-        full_list += list [i];
-    }
-  }
+  CodecList::get_allowed_formats (pcssEP->GetMediaFormats (), full_list);
 }
 
 void
@@ -56,13 +56,22 @@
 #include "presence-core.h"
 #include "call-manager.h"
 #include "call.h"
+#include "audioinput-core.h"
+#include "audiooutput-core.h"
+#include "videoinput-core.h"
+#include "videooutput-core.h"
+#include "opal-jitter-controller.h"
+#include "opal-codec-planner.h"
 
 #include <sigc++/sigc++.h>
 #include <string>
+#include <map>
+#include <list>
 
 
 class GMLid;
 class GMPCSSEndpoint;
+class CodecMeasurer;
 
 namespace Opal {
 
@@ -97,6 +106,26 @@ public:
     void set_maximum_jitter (unsigned max_val);
     unsigned get_maximum_jitter () const;
 
+    /** Let the jitter buffer window of each call follow its network
+     * statistics, between 20 ms and the maximum jitter
+     * @param enabled is true if the window should be adaptive
+     */
+    void set_adaptive_jitter (bool enabled);
+    bool get_adaptive_jitter () const;
+
+    /** Return the last decisions of the jitter controllers
+     * @param decisions is filled with the call ids and the decisions,
+     * oldest first
+     */
+    void get_jitter_decisions (std::list<std::pair<std::string, JitterController::Decision> > & decisions) const;
+
+    /** This signal is emitted when the jitter buffer window of a call
+     * was moved by its controller
+     * @param the call id
+     * @param the decision taken
+     */
+    sigc::signal2<void, std::string, JitterController::Decision> jitter_adjusted;
+
     void set_silence_detection (bool enabled);
     bool get_silence_detection () const;
 
@@ -106,6 +135,21 @@ public:
     void set_codecs (Ekiga::CodecList & codecs); 
     const Ekiga::CodecList & get_codecs () const;
 
+    /** Let the order of the codecs and the video size of each new call
+     * follow the cost of the codecs, the CPU left and the capacity of the
+     * link ; the codecs the user disabled stay disabled
+     * @param enabled is true if the ordering should be automatic
+     */
+    void set_automatic_codecs (bool enabled);
+    bool get_automatic_codecs () const;
+
+    /** Record the cost of a codec, as measured by the codec benchmark
+     */
+    void set_codec_cost (const Ekiga::CodecDescription & desc,
+                         const CodecPlanner::Cost & cost,
+                         unsigned width,
+                         unsigned height);
+
     /* Extended stuff, OPAL CallManager specific */
     void set_forward_on_busy (bool enabled);
     bool get_forward_on_busy ();
@@ -151,6 +195,25 @@ public:
     void set_video_options (const VideoOptions & options);
     void get_video_options (VideoOptions & options) const;
 
+    /* The media cores the devices of the calls work with : resolved in
+     * the main thread once, since OPAL makes the devices from its own */
+    gmref_ptr<Ekiga::AudioInputCore> get_audioinput_core () const
+      { return audioinput_core; }
+
+    gmref_ptr<Ekiga::AudioOutputCore> get_audiooutput_core () const
+      { return audiooutput_core; }
+
+    PBoolean CreateVideoInputDevice (const OpalConnection & connection,
+                                     const OpalMediaFormat & media_format,
+                                     PVideoInputDevice * & device,
+                                     PBoolean & auto_delete);
+
+    PBoolean CreateVideoOutputDevice (const OpalConnection & connection,
+                                      const OpalMediaFormat & media_format,
+                                      PBoolean preview,
+                                      PVideoOutputDevice * & device,
+                                      PBoolean & auto_delete);
+
 private:
     OpalCall *CreateCall (void *uri);
     void DestroyCall (OpalCall *);
@@ -162,6 +225,23 @@ private:
 
     void GetAllowedFormats (OpalMediaFormatList & full_list);
 
+    void apply_codecs (const Ekiga::CodecList & list);
+
+    void apply_video_options (const VideoOptions & options);
+
+    /* only plans when no other call is running : the order and the
+     * mask are global, and the running calls may still negotiate */
+    void plan_codecs ();
+
+    void set_jitter_window (OpalCall & call,
+                            unsigned min_val,
+                            unsigned max_val);
+
+    void on_call_statistics (Ekiga::CallStatistics stats,
+                             std::string token);
+
+    void on_call_removed (std::string token);
+
     void HandleSTUNResult ();
 
     void ReportSTUNError (const std::string error);
@@ -171,11 +251,17 @@ private:
 
     /* Various mutexes to ensure thread safeness around internal
        variables */
-    PMutex manager_access_mutex;
+    mutable PMutex manager_access_mutex;
 
     Ekiga::ServiceCore & core;
     Ekiga::CodecList codecs; 
 
+    /* left in the destructor, once the calls are cleared */
+    gmref_ptr<Ekiga::AudioInputCore> audioinput_core;
+    gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core;
+    gmref_ptr<Ekiga::VideoInputCore> videoinput_core;
+    gmref_ptr<Ekiga::VideoOutputCore> videooutput_core;
+
     /* used to get the STUNDetector results */
     GAsyncQueue* queue;
     unsigned int patience;
@@ -187,6 +273,22 @@ private:
     bool unconditional_forward;
     bool forward_on_no_answer;
     bool stun_enabled;
+
+    /* the user's choices, which the automatic ordering starts from */
+    VideoOptions video_options;
+    bool automatic_codecs;
+    CodecMeasurer *codec_measurer;  // joined in the destructor
+    CodecPlanner planner;
+
+    /* serializes the changes of the global media formats : the calls are
+     * planned from the Opal threads, the user changes them from the main
+     * thread */
+    PMutex media_formats_mutex;
+
+    /* only used from the main thread */
+    bool adaptive_jitter;
+    std::map<std::string, JitterController> jitter_controllers;
+    std::list<std::pair<std::string, JitterController::Decision> > jitter_decisions;
   };
 };
 #endif
@@ -0,0 +1,478 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-call-recorder.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the recorder writing the media
+ *                          of a call to disk.
+ *
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <glib/gstdio.h>
+#ifdef G_OS_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "opal-call-recorder.h"
+
+/* The queues hold that much audio (bytes : two seconds of 48 kHz) */
+#define AUDIO_QUEUE_SIZE (2 * 48000 * 2)
+/* The queue holds that many video frames */
+#define VIDEO_QUEUE_FRAMES 4
+/* The video is recorded in CIF at 15 fps */
+#define VIDEO_WIDTH 352
+#define VIDEO_HEIGHT 288
+#define VIDEO_FPS 15
+/* The writer wakes up that often (ms) */
+#define WRITER_PERIOD 100
+/* The files are synced that often (ms) */
+#define SYNC_PERIOD 5000
+/* The data is written by chunks of at least that size (bytes) */
+#define WRITE_SIZE 65536
+/* When a direction has been silent for that long (ms), the other one is
+ * written alone */
+#define MAX_LAG 500
+/* Number of samples mixed at once */
+#define CHUNK_SAMPLES 1024
+
+#define WAV_HEADER_SIZE 44
+
+
+static void
+put_le32 (char *where,
+          guint32 value)
+{
+  value = GUINT32_TO_LE (value);
+  memcpy (where, &value, 4);
+}
+
+
+static void
+put_le16 (char *where,
+          guint16 value)
+{
+  value = GUINT16_TO_LE (value);
+  memcpy (where, &value, 2);
+}
+
+
+static void
+sync_file (FILE *file)
+{
+  fflush (file);
+#ifdef G_OS_WIN32
+  _commit (_fileno (file));
+#else
+  fsync (fileno (file));
+#endif
+}
+
+
+Opal::CallRecorder::Writer::Writer (CallRecorder & _recorder)
+  : PThread (1000, NoAutoDeleteThread, NormalPriority, "CallRecorder"),
+    recorder (_recorder), quit (false)
+{
+  this->Resume ();
+}
+
+
+void
+Opal::CallRecorder::Writer::stop ()
+{
+  quit = true;
+  wake.Signal ();
+  WaitForTermination ();
+}
+
+
+void
+Opal::CallRecorder::Writer::Main ()
+{
+  while (!quit) {
+
+    wake.Wait (PTimeInterval (WRITER_PERIOD));
+    if (!quit)
+      recorder.drain (false);
+  }
+}
+
+
+Opal::CallRecorder::CallRecorder (Ekiga::ServiceCore & core)
+  : audioinput_core (core.get<Ekiga::AudioInputCore> ("audioinput-core")),
+    audiooutput_core (core.get<Ekiga::AudioOutputCore> ("audiooutput-core")),
+    videoinput_core (core.get<Ekiga::VideoInputCore> ("videoinput-core")),
+    recording (false), mode (Ekiga::Call::RecordMixed), writer (NULL),
+    captured (NULL), played (NULL), video (NULL),
+    captured_rate (0), played_rate (0),
+    wav_file (NULL), y4m_file (NULL), wav_bytes (0), wav_rate (0),
+    rates_differ (false)
+{
+}
+
+
+Opal::CallRecorder::~CallRecorder ()
+{
+  stop ();
+}
+
+
+bool
+Opal::CallRecorder::start (const std::string & basename,
+                           Ekiga::Call::RecordingMode _mode,
+                           bool with_video)
+{
+  if (recording)
+    return false;
+
+  std::string wav_name = basename + ".wav";
+  std::string y4m_name = basename + ".y4m";
+
+  wav_file = g_fopen (wav_name.c_str (), "wb");
+  if (wav_file == NULL) {
+
+    PTRACE (1, "CallRecorder\tCould not create " << wav_name);
+    return false;
+  }
+
+  if (with_video) {
+
+    y4m_file = g_fopen (y4m_name.c_str (), "wb");
+    if (y4m_file == NULL) {
+
+      PTRACE (1, "CallRecorder\tCould not create " << y4m_name);
+      fclose (wav_file);
+      wav_file = NULL;
+      return false;
+    }
+  }
+
+  PTRACE (3, "CallRecorder\tRecording to " << basename);
+
+  mode = _mode;
+  wav_bytes = 0;
+  wav_rate = 0;
+  rates_differ = false;
+  g_atomic_int_set (&captured_rate, 0);
+  g_atomic_int_set (&played_rate, 0);
+  wav_staging.reserve (2 * WRITE_SIZE);
+  local_samples.resize (CHUNK_SAMPLES);
+  remote_samples.resize (CHUNK_SAMPLES);
+  last_sync = PTime ();
+
+  // a placeholder until we know the rate
+  write_wav_header ();
+
+  captured = new MediaQueue (AUDIO_QUEUE_SIZE);
+  played = new MediaQueue (AUDIO_QUEUE_SIZE);
+
+  if (y4m_file) {
+
+    std::ostringstream header;
+    header << "YUV4MPEG2 W" << VIDEO_WIDTH << " H" << VIDEO_HEIGHT
+           << " F" << VIDEO_FPS << ":1 Ip A1:1 C420jpeg\n";
+    fwrite (header.str ().c_str (), 1, header.str ().size (), y4m_file);
+
+    frame.resize ((VIDEO_WIDTH * VIDEO_HEIGHT * 3) >> 1);
+    y4m_staging.reserve (2 * WRITE_SIZE + frame.size ());
+    video = new MediaQueue (VIDEO_QUEUE_FRAMES * frame.size ());
+  }
+
+  recording = true;
+  writer = new Writer (*this);
+
+  // the queues are ready : let the media in
+  audioinput_core->add_tap (*this);
+  audiooutput_core->add_tap (*this);
+  if (video)
+    videoinput_core->add_sink (*this, VIDEO_WIDTH, VIDEO_HEIGHT, VIDEO_FPS);
+
+  return true;
+}
+
+
+void
+Opal::CallRecorder::stop ()
+{
+  if (!recording)
+    return;
+
+  // when those return, the media threads don't touch the queues anymore
+  audioinput_core->remove_tap (*this);
+  audiooutput_core->remove_tap (*this);
+  if (video)
+    videoinput_core->remove_sink (*this);
+
+  writer->stop ();
+  delete writer;
+  writer = NULL;
+
+  drain (true);
+
+  PTRACE (3, "CallRecorder\tRecorded " << wav_bytes << " bytes of audio, dropped "
+          << captured->get_dropped () << " captured and "
+          << played->get_dropped () << " played buffers"
+          << (video ? ", " : "")
+          << (video ? video->get_dropped () : 0)
+          << (video ? " video frames" : ""));
+
+  fclose (wav_file);
+  wav_file = NULL;
+  delete captured;
+  captured = NULL;
+  delete played;
+  played = NULL;
+
+  if (y4m_file) {
+
+    fclose (y4m_file);
+    y4m_file = NULL;
+  }
+  delete video;
+  video = NULL;
+
+  recording = false;
+}
+
+
+bool
+Opal::CallRecorder::accept_audio (volatile gint & rate,
+                                  unsigned channels,
+                                  unsigned samplerate,
+                                  unsigned bits_per_sample)
+{
+  /* Opal gives us mono 16 bits audio ; anything else would be a bug */
+  if (channels != 1 || bits_per_sample != 16 || samplerate == 0)
+    return false;
+
+  gint known = g_atomic_int_get (&rate);
+  if (known == (gint) samplerate)
+    return true;
+
+  return (known == 0 && g_atomic_int_compare_and_exchange (&rate, 0, (gint) samplerate));
+}
+
+
+void
+Opal::CallRecorder::on_captured_audio (const char *data,
+                                       unsigned size,
+                                       unsigned channels,
+                                       unsigned samplerate,
+                                       unsigned bits_per_sample)
+{
+  if (accept_audio (captured_rate, channels, samplerate, bits_per_sample))
+    captured->push (data, size & ~1);
+}
+
+
+void
+Opal::CallRecorder::on_played_audio (const char *data,
+                                     unsigned size,
+                                     unsigned channels,
+                                     unsigned samplerate,
+                                     unsigned bits_per_sample)
+{
+  if (accept_audio (played_rate, channels, samplerate, bits_per_sample))
+    played->push (data, size & ~1);
+}
+
+
+void
+Opal::CallRecorder::on_frame (const char *data,
+                              unsigned width,
+                              unsigned height,
+                              const PTime & /*timestamp*/)
+{
+  if (width == VIDEO_WIDTH && height == VIDEO_HEIGHT)
+    video->push (data, (width * height * 3) >> 1);
+}
+
+
+void
+Opal::CallRecorder::drain (bool last)
+{
+  unsigned local_rate = (unsigned) g_atomic_int_get (&captured_rate);
+  unsigned remote_rate = (unsigned) g_atomic_int_get (&played_rate);
+
+  if (wav_rate == 0)
+    wav_rate = local_rate ? local_rate : remote_rate;
+
+  /* both directions share the rate of the codec ; if they ever don't,
+   * the one which came last is dropped */
+  if ((local_rate && local_rate != wav_rate)
+      || (remote_rate && remote_rate != wav_rate)) {
+
+    if (!rates_differ)
+      PTRACE (1, "CallRecorder\tCaptured and played audio at different rates, "
+              << local_rate << " and " << remote_rate << ", keeping " << wav_rate);
+    rates_differ = true;
+
+    MediaQueue *odd = (local_rate && local_rate != wav_rate) ? captured : played;
+    while (odd->pop ((char *) &remote_samples[0], CHUNK_SAMPLES * 2) > 0)
+      ;
+  }
+
+  if (wav_rate) {
+
+    unsigned local = captured->available () / 2;
+    unsigned remote = played->available () / 2;
+    unsigned samples = std::min (local, remote);
+
+    /* a direction may be silent for a while (hold, no audio from the
+     * remote...) : don't wait for it forever */
+    if (last || std::max (local, remote) > wav_rate * MAX_LAG / 1000)
+      samples = std::max (local, remote);
+
+    write_audio (samples);
+  }
+
+  if (video) {
+
+    while (video->available () >= frame.size ()) {
+
+      video->pop (&frame[0], frame.size ());
+      y4m_staging.insert (y4m_staging.end (), "FRAME\n", "FRAME\n" + 6);
+      y4m_staging.insert (y4m_staging.end (), frame.begin (), frame.end ());
+
+      if (y4m_staging.size () >= WRITE_SIZE)
+        flush (y4m_file, y4m_staging);
+    }
+  }
+
+  if (last || (PTime () - last_sync).GetMilliSeconds () >= SYNC_PERIOD)
+    sync ();
+}
+
+
+void
+Opal::CallRecorder::write_audio (unsigned samples)
+{
+  unsigned channels = (mode == Ekiga::Call::RecordStereo) ? 2 : 1;
+
+  while (samples > 0) {
+
+    unsigned count = std::min (samples, (unsigned) CHUNK_SAMPLES);
+    unsigned local = captured->pop ((char *) &local_samples[0], count * 2) / 2;
+    unsigned remote = played->pop ((char *) &remote_samples[0], count * 2) / 2;
+
+    // the silent direction
+    std::fill (local_samples.begin () + local, local_samples.begin () + count, 0);
+    std::fill (remote_samples.begin () + remote, remote_samples.begin () + count, 0);
+
+    std::vector<char>::size_type offset = wav_staging.size ();
+    wav_staging.resize (offset + count * channels * 2);
+    char *out = &wav_staging[offset];
+
+    for (unsigned i = 0 ; i < count ; i++) {
+
+      if (channels == 2) {
+
+        put_le16 (out, (guint16) local_samples[i]);
+        put_le16 (out + 2, (guint16) remote_samples[i]);
+        out += 4;
+      }
+      else {
+
+        int mixed = local_samples[i] + remote_samples[i];
+        mixed = std::max (std::min (mixed, 32767), -32768);
+        put_le16 (out, (guint16) (gint16) mixed);
+        out += 2;
+      }
+    }
+
+    wav_bytes += count * channels * 2;
+    samples -= count;
+
+    if (wav_staging.size () >= WRITE_SIZE)
+      flush (wav_file, wav_staging);
+  }
+}
+
+
+void
+Opal::CallRecorder::flush (FILE *file,
+                           std::vector<char> & staging)
+{
+  if (staging.empty ())
+    return;
+
+  if (fwrite (&staging[0], 1, staging.size (), file) != staging.size ())
+    PTRACE (1, "CallRecorder\tCould not write " << staging.size () << " bytes");
+
+  staging.clear ();
+}
+
+
+void
+Opal::CallRecorder::write_wav_header ()
+{
+  char header[WAV_HEADER_SIZE];
+  unsigned channels = (mode == Ekiga::Call::RecordStereo) ? 2 : 1;
+  unsigned rate = wav_rate ? wav_rate : 8000;
+
+  memcpy (header, "RIFF", 4);
+  put_le32 (header + 4, (guint32) (WAV_HEADER_SIZE - 8 + wav_bytes));
+  memcpy (header + 8, "WAVEfmt ", 8);
+  put_le32 (header + 16, 16);
+  put_le16 (header + 20, 1);  // PCM
+  put_le16 (header + 22, (guint16) channels);
+  put_le32 (header + 24, rate);
+  put_le32 (header + 28, rate * channels * 2);
+  put_le16 (header + 32, (guint16) (channels * 2));
+  put_le16 (header + 34, 16);
+  memcpy (header + 36, "data", 4);
+  put_le32 (header + 40, (guint32) wav_bytes);
+
+  fseek (wav_file, 0, SEEK_SET);
+  fwrite (header, 1, WAV_HEADER_SIZE, wav_file);
+  fseek (wav_file, 0, SEEK_END);
+}
+
+
+void
+Opal::CallRecorder::sync ()
+{
+  flush (wav_file, wav_staging);
+  write_wav_header ();
+  sync_file (wav_file);
+
+  if (y4m_file) {
+
+    flush (y4m_file, y4m_staging);
+    sync_file (y4m_file);
+  }
+
+  last_sync = PTime ();
+}
@@ -0,0 +1,174 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-call-recorder.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the recorder writing the media
+ *                          of a call to disk.
+ *
+ */
+
+
+#ifndef __OPAL_CALL_RECORDER_H__
+#define __OPAL_CALL_RECORDER_H__
+
+#include <ptbuildopts.h>
+#include <ptlib.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "services.h"
+#include "call.h"
+#include "audioinput-core.h"
+#include "audiooutput-core.h"
+#include "videoinput-core.h"
+#include "opal-media-queue.h"
+
+namespace Opal {
+
+  /** Writes the media of a call to disk : the audio of both directions to
+   * a WAV file, and optionally the local video to a YUV4MPEG2 file.
+   *
+   * The media threads only push their frames to lock-free queues, which
+   * a writer thread drains into large sequential writes ; the files are
+   * synced and their headers made valid every few seconds, so that they
+   * are usable even if Ekiga dies during the call.
+   */
+  class CallRecorder
+    : public Ekiga::AudioInputTap,
+      public Ekiga::AudioOutputTap,
+      public Ekiga::VideoInputSink
+  {
+  public:
+
+    CallRecorder (Ekiga::ServiceCore & core);
+
+    ~CallRecorder ();
+
+    /** Start recording ; see Ekiga::Call::start_recording
+     */
+    bool start (const std::string & basename,
+                Ekiga::Call::RecordingMode mode,
+                bool video);
+
+    /** Stop recording ; the files are complete when it returns
+     */
+    void stop ();
+
+    bool is_recording () const { return recording; }
+
+    /* the taps, called by the media threads */
+    void on_captured_audio (const char *data,
+                            unsigned size,
+                            unsigned channels,
+                            unsigned samplerate,
+                            unsigned bits_per_sample);
+
+    void on_played_audio (const char *data,
+                          unsigned size,
+                          unsigned channels,
+                          unsigned samplerate,
+                          unsigned bits_per_sample);
+
+    void on_frame (const char *data,
+                   unsigned width,
+                   unsigned height,
+                   const PTime & timestamp);
+
+  private:
+
+    class Writer : public PThread
+    {
+      PCLASSINFO(Writer, PThread);
+
+    public:
+
+      Writer (CallRecorder & recorder);
+
+      /* blocks until the thread is over */
+      void stop ();
+
+    protected:
+
+      void Main ();
+
+      CallRecorder & recorder;
+      PSyncPoint wake;
+      volatile bool quit;
+    };
+
+    friend class Writer;
+
+    /* called by the writer thread, or by stop () once it is over */
+    void drain (bool last);
+    void write_audio (unsigned samples);
+    void flush (FILE *file,
+                std::vector<char> & staging);
+    void write_wav_header ();
+    void sync ();
+
+    /* the format of the queued audio is checked once per direction */
+    bool accept_audio (volatile gint & rate,
+                       unsigned channels,
+                       unsigned samplerate,
+                       unsigned bits_per_sample);
+
+    gmref_ptr<Ekiga::AudioInputCore> audioinput_core;
+    gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core;
+    gmref_ptr<Ekiga::VideoInputCore> videoinput_core;
+
+    bool recording;
+    Ekiga::Call::RecordingMode mode;
+    Writer *writer;
+
+    /* filled by the media threads */
+    MediaQueue *captured;
+    MediaQueue *played;
+    MediaQueue *video;
+    volatile gint captured_rate;
+    volatile gint played_rate;
+
+    /* only touched by the writer */
+    FILE *wav_file;
+    FILE *y4m_file;
+    unsigned long wav_bytes;
+    unsigned wav_rate;
+    bool rates_differ;
+    std::vector<char> wav_staging;
+    std::vector<char> y4m_staging;
+    std::vector<short> local_samples;
+    std::vector<short> remote_samples;
+    std::vector<char> frame;
+    PTime last_sync;
+  };
+};
+
+#endif
@@ -0,0 +1,271 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-call-stats.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the RTP statistics gathered
+ *                          for a call handled by Opal.
+ *
+ */
+
+
+#include <algorithm>
+
+#include "opal-call-stats.h"
+
+/* a media thread only keeps the sequence odd for a handful of stores, so
+ * a reader seldom needs more than one retry */
+#define SNAPSHOT_ATTEMPTS 8
+
+static double
+ratio (guint part,
+       guint total)
+{
+  if (total == 0)
+    return 0.0;
+
+  return (100.0 * part) / total;
+}
+
+
+Opal::RTPCounters::RTPCounters ()
+{
+  reset ();
+}
+
+
+void
+Opal::RTPCounters::update (const RTP_Session & session)
+{
+  gint seq = g_atomic_int_get (&sequence);
+
+  if ((seq & 1) || !g_atomic_int_compare_and_exchange (&sequence, seq, seq + 1))
+    return;
+
+  g_atomic_int_set (&octets_received, (gint) session.GetOctetsReceived ());
+  g_atomic_int_set (&octets_sent, (gint) session.GetOctetsSent ());
+  g_atomic_int_set (&packets_received, (gint) session.GetPacketsReceived ());
+  g_atomic_int_set (&packets_lost, (gint) session.GetPacketsLost ());
+  g_atomic_int_set (&packets_late, (gint) session.GetPacketsTooLate ());
+  g_atomic_int_set (&packets_out_of_order, (gint) session.GetPacketsOutOfOrder ());
+  g_atomic_int_set (&jitter, (gint) (session.GetJitterBufferSize ()
+                                     / std::max ((unsigned) session.GetJitterTimeUnits (), (unsigned) 8)));
+
+  g_atomic_int_inc (&sequence);
+}
+
+
+bool
+Opal::RTPCounters::snapshot (Snapshot & snap) const
+{
+  for (int attempt = 0 ; attempt < SNAPSHOT_ATTEMPTS ; attempt++) {
+
+    gint seq = g_atomic_int_get (&sequence);
+    if (seq & 1)
+      continue;
+
+    snap.octets_received = (guint) g_atomic_int_get (&octets_received);
+    snap.octets_sent = (guint) g_atomic_int_get (&octets_sent);
+    snap.packets_received = (guint) g_atomic_int_get (&packets_received);
+    snap.packets_lost = (guint) g_atomic_int_get (&packets_lost);
+    snap.packets_late = (guint) g_atomic_int_get (&packets_late);
+    snap.packets_out_of_order = (guint) g_atomic_int_get (&packets_out_of_order);
+    snap.jitter = (guint) g_atomic_int_get (&jitter);
+
+    if (g_atomic_int_get (&sequence) == seq)
+      return true;
+  }
+
+  return false;
+}
+
+
+void
+Opal::RTPCounters::reset ()
+{
+  g_atomic_int_set (&sequence, 0);
+  g_atomic_int_set (&octets_received, 0);
+  g_atomic_int_set (&octets_sent, 0);
+  g_atomic_int_set (&packets_received, 0);
+  g_atomic_int_set (&packets_lost, 0);
+  g_atomic_int_set (&packets_late, 0);
+  g_atomic_int_set (&packets_out_of_order, 0);
+  g_atomic_int_set (&jitter, 0);
+}
+
+
+Opal::CallStatsCollector::CallStatsCollector (unsigned history_size)
+  : history(std::max (history_size, (unsigned) 1)), first(0), count(0)
+{
+}
+
+
+const Ekiga::CallStatistics &
+Opal::CallStatsCollector::sample (const RTPCounters & audio,
+                                  const RTPCounters & video)
+{
+  PTime now;
+  RTPCounters::Snapshot audio_delta;
+  RTPCounters::Snapshot video_delta;
+  Ekiga::CallStatistics stats;
+
+  compute (audio, now, audio_direction, audio_delta);
+  compute (video, now, video_direction, video_delta);
+
+  stats.received_audio_bandwidth = audio_direction.rx_bandwidth;
+  stats.transmitted_audio_bandwidth = audio_direction.tx_bandwidth;
+  stats.received_video_bandwidth = video_direction.rx_bandwidth;
+  stats.transmitted_video_bandwidth = video_direction.tx_bandwidth;
+
+  guint received = audio_delta.packets_received + video_delta.packets_received;
+
+  stats.timestamp = now.GetTimeInSeconds ();
+  stats.jitter = audio_direction.valid ? audio_direction.last.jitter : 0;
+  stats.lost_packets = ratio (audio_delta.packets_lost + video_delta.packets_lost,
+                              received);
+  // only audio goes through a jitter buffer
+  stats.late_packets = ratio (audio_delta.packets_late,
+                              audio_delta.packets_received);
+  stats.out_of_order_packets = ratio (audio_delta.packets_out_of_order
+                                      + video_delta.packets_out_of_order,
+                                      received);
+
+  current = stats;
+
+  if (count < history.size ()) {
+
+    history[(first + count) % history.size ()] = stats;
+    count++;
+  }
+  else {
+
+    history[first] = stats;
+    first = (first + 1) % history.size ();
+  }
+
+  return current;
+}
+
+
+double
+Opal::CallStatsCollector::get_total_lost_packets () const
+{
+  return ratio (audio_direction.last.packets_lost + video_direction.last.packets_lost,
+                audio_direction.last.packets_received + video_direction.last.packets_received);
+}
+
+
+double
+Opal::CallStatsCollector::get_total_late_packets () const
+{
+  return ratio (audio_direction.last.packets_late + video_direction.last.packets_late,
+                audio_direction.last.packets_received + video_direction.last.packets_received);
+}
+
+
+double
+Opal::CallStatsCollector::get_total_out_of_order_packets () const
+{
+  return ratio (audio_direction.last.packets_out_of_order + video_direction.last.packets_out_of_order,
+                audio_direction.last.packets_received + video_direction.last.packets_received);
+}
+
+
+void
+Opal::CallStatsCollector::get_history (std::list<Ekiga::CallStatistics> & result) const
+{
+  for (unsigned i = 0 ; i < count ; i++)
+    result.push_back (history[(first + i) % history.size ()]);
+}
+
+
+void
+Opal::CallStatsCollector::reset ()
+{
+  audio_direction = Direction ();
+  video_direction = Direction ();
+  current = Ekiga::CallStatistics ();
+  first = 0;
+  count = 0;
+}
+
+
+Opal::CallStatsCollector::Direction::Direction ()
+  : valid(false), rx_bandwidth(0.0), tx_bandwidth(0.0)
+{
+  last.octets_received = last.octets_sent = 0;
+  last.packets_received = last.packets_lost = 0;
+  last.packets_late = last.packets_out_of_order = 0;
+  last.jitter = 0;
+}
+
+
+void
+Opal::CallStatsCollector::compute (const RTPCounters & counters,
+                                   const PTime & now,
+                                   Direction & direction,
+                                   RTPCounters::Snapshot & delta)
+{
+  RTPCounters::Snapshot snap;
+
+  delta.octets_received = delta.octets_sent = 0;
+  delta.packets_received = delta.packets_lost = 0;
+  delta.packets_late = delta.packets_out_of_order = 0;
+  delta.jitter = 0;
+
+  /* the media threads kept us out : keep the previous rates, the next
+   * sample will cover both periods */
+  if (!counters.snapshot (snap))
+    return;
+
+  if (!direction.valid) {
+
+    direction.valid = true;
+    direction.tick = now;
+    direction.last = snap;
+    return;
+  }
+
+  double elapsed_ms = std::max ((double) (now - direction.tick).GetMilliSeconds (), 1.0);
+
+  /* unsigned arithmetic, so the 32-bits counters can wrap */
+  delta.octets_received = snap.octets_received - direction.last.octets_received;
+  delta.octets_sent = snap.octets_sent - direction.last.octets_sent;
+  delta.packets_received = snap.packets_received - direction.last.packets_received;
+  delta.packets_lost = snap.packets_lost - direction.last.packets_lost;
+  delta.packets_late = snap.packets_late - direction.last.packets_late;
+  delta.packets_out_of_order = snap.packets_out_of_order - direction.last.packets_out_of_order;
+
+  // bytes per millisecond are kbytes per second
+  direction.rx_bandwidth = delta.octets_received / elapsed_ms;
+  direction.tx_bandwidth = delta.octets_sent / elapsed_ms;
+
+  direction.tick = now;
+  direction.last = snap;
+}
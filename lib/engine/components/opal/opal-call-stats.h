@@ -0,0 +1,176 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-call-stats.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the RTP statistics gathered
+ *                          for a call handled by Opal.
+ *
+ */
+
+
+#ifndef __OPAL_CALL_STATS_H__
+#define __OPAL_CALL_STATS_H__
+
+#include <opal/buildopts.h>
+#include <ptbuildopts.h>
+#include <ptlib.h>
+#include <rtp/rtp.h>
+
+#include <glib.h>
+#include <vector>
+
+#include "call.h"
+
+namespace Opal {
+
+  /** The raw counters of one RTP session.
+   * They are written by the media threads without ever taking a lock,
+   * and read by the statistics collector, which retries until it gets a
+   * consistent copy.
+   */
+  class RTPCounters
+  {
+  public:
+
+    struct Snapshot
+    {
+      guint octets_received;
+      guint octets_sent;
+      guint packets_received;
+      guint packets_lost;
+      guint packets_late;
+      guint packets_out_of_order;
+      guint jitter;
+    };
+
+    RTPCounters ();
+
+    /** Publish the current values of the session
+     * This is called from the media threads and never blocks : if another
+     * thread is already publishing, the update is simply skipped, as the
+     * values it publishes are as fresh.
+     * @param session is the RTP session to read
+     */
+    void update (const RTP_Session & session);
+
+    /** Take a consistent copy of the counters
+     * @param snapshot is filled with the counters
+     * @return false if no consistent copy could be taken
+     */
+    bool snapshot (Snapshot & snapshot) const;
+
+    /** Forget everything ; not to be called while a session is running
+     */
+    void reset ();
+
+  private:
+
+    /* odd while a media thread is writing */
+    mutable volatile gint sequence;
+
+    mutable volatile gint octets_received;
+    mutable volatile gint octets_sent;
+    mutable volatile gint packets_received;
+    mutable volatile gint packets_lost;
+    mutable volatile gint packets_late;
+    mutable volatile gint packets_out_of_order;
+    mutable volatile gint jitter;
+  };
+
+
+  /** Turns RTPCounters into rates, and keeps the last samples around.
+   * This is not thread-safe : the owner protects it.
+   */
+  class CallStatsCollector
+  {
+  public:
+
+    /** Constructor
+     * @param history_size is the number of samples kept in the history
+     */
+    CallStatsCollector (unsigned history_size = 60);
+
+    /** Compute a new sample from the counters
+     * @param audio is the audio session counters
+     * @param video is the video session counters
+     * @return the new sample
+     */
+    const Ekiga::CallStatistics & sample (const RTPCounters & audio,
+                                          const RTPCounters & video);
+
+    /** Return the last computed sample
+     */
+    const Ekiga::CallStatistics & get_current () const { return current; }
+
+    /** Return the ratios computed since the beginning of the call
+     */
+    double get_total_lost_packets () const;
+    double get_total_late_packets () const;
+    double get_total_out_of_order_packets () const;
+
+    /** Fill the list with the history, oldest sample first
+     */
+    void get_history (std::list<Ekiga::CallStatistics> & history) const;
+
+    /** Forget everything
+     */
+    void reset ();
+
+  private:
+
+    struct Direction
+    {
+      Direction ();
+
+      bool valid;
+      PTime tick;
+      RTPCounters::Snapshot last;
+      double rx_bandwidth;
+      double tx_bandwidth;
+    };
+
+    void compute (const RTPCounters & counters,
+                  const PTime & now,
+                  Direction & direction,
+                  RTPCounters::Snapshot & delta);
+
+    Direction audio_direction;
+    Direction video_direction;
+
+    Ekiga::CallStatistics current;
+
+    /* fixed-size ring, 'first' is the oldest sample */
+    std::vector<Ekiga::CallStatistics> history;
+    unsigned first;
+    unsigned count;
+  };
+};
+
+#endif
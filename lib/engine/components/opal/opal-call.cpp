@@ -93,27 +93,17 @@ private:
 
 Opal::Call::Call (OpalManager & _manager, Ekiga::ServiceCore & _core, const std::string& uri)
   : OpalCall (_manager), Ekiga::Call (), core (_core), remote_uri (uri),
-    call_setup(false),outgoing(true),jitter(0)
-{
-  re_a_bytes = tr_a_bytes = re_v_bytes = tr_v_bytes = 0.0;
-  last_v_tick = last_a_tick = PTime ();
-  total_a =
-    total_v =
-    lost_a =
-    too_late_a =
-    out_of_order_a =
-    lost_v =
-    too_late_v =
-    out_of_order_v = 0;
-  lost_packets = late_packets = out_of_order_packets = 0.0;
-  re_a_bw = tr_a_bw = re_v_bw = tr_v_bw = 0.0;
-
+    call_setup(false),outgoing(true), recorder (_core)
+{
   NoAnswerTimer.SetNotifier (PCREATE_NOTIFIER (OnNoAnswerTimeout));
+  StatisticsTimer.SetNotifier (PCREATE_NOTIFIER (OnStatisticsTimeout));
 }
 
 
 Opal::Call::~Call ()
 {
+  StatisticsTimer.Stop ();
+  stop_recording ();
 }
 
 
@@ -216,6 +206,45 @@ void Opal::Call::set_reject_delay (unsigned delay)
 }
 
 
+bool
+Opal::Call::start_recording (const std::string & basename,
+                             RecordingMode mode,
+                             bool video)
+{
+  PWaitAndSignal m(recorder_mutex);
+
+  if (!recorder.start (basename, mode, video))
+    return false;
+
+  Ekiga::Runtime::emit_signal_in_main (recording_started, basename);
+
+  return true;
+}
+
+
+void
+Opal::Call::stop_recording ()
+{
+  PWaitAndSignal m(recorder_mutex);
+
+  if (!recorder.is_recording ())
+    return;
+
+  recorder.stop ();
+
+  Ekiga::Runtime::emit_signal_in_main (recording_stopped);
+}
+
+
+bool
+Opal::Call::is_recording () const
+{
+  PWaitAndSignal m(recorder_mutex);
+
+  return recorder.is_recording ();
+}
+
+
 const std::string
 Opal::Call::get_id () const
 {
@@ -283,6 +312,87 @@ Opal::Call::is_outgoing () const
 }
 
 
+double
+Opal::Call::get_received_audio_bandwidth () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_current ().received_audio_bandwidth;
+}
+
+
+double
+Opal::Call::get_transmitted_audio_bandwidth () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_current ().transmitted_audio_bandwidth;
+}
+
+
+double
+Opal::Call::get_received_video_bandwidth () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_current ().received_video_bandwidth;
+}
+
+
+double
+Opal::Call::get_transmitted_video_bandwidth () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_current ().transmitted_video_bandwidth;
+}
+
+
+unsigned
+Opal::Call::get_jitter_size () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_current ().jitter;
+}
+
+
+double
+Opal::Call::get_lost_packets () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_total_lost_packets ();
+}
+
+
+double
+Opal::Call::get_late_packets () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_total_late_packets ();
+}
+
+
+double
+Opal::Call::get_out_of_order_packets () const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  return stats.get_total_out_of_order_packets ();
+}
+
+
+void
+Opal::Call::get_statistics_history (std::list<Ekiga::CallStatistics> & history) const
+{
+  PWaitAndSignal m(stats_mutex);
+
+  stats.get_history (history);
+}
+
+
 void
 Opal::Call::parse_info (OpalConnection & connection)
 {
@@ -365,6 +475,8 @@ Opal::Call::OnEstablished (OpalConnection & connection)
         session->SetTxStatisticsInterval(50);
       }
     }
+
+    StatisticsTimer.RunContinuous (PTimeInterval (0, 1));
   }
   
   return OpalCall::OnEstablished (connection);
@@ -386,6 +498,10 @@ Opal::Call::OnCleared ()
   std::string reason;
 
   NoAnswerTimer.Stop (false);
+  StatisticsTimer.Stop (false);
+
+  // the media is over
+  stop_recording ();
 
   // hack for busy here bug: if we receive a call while in communication, then wait for 1.5 secs, afterwards return.  New smaller bug appears: we are not informed about missed call anymore in this case
   for (int i=0 ; i<15 && !call_setup ; i++)
@@ -574,58 +690,11 @@ void
 Opal::Call::OnRTPStatistics (const OpalConnection & /* connection */,
 			     const RTP_Session & session)
 {
-  PWaitAndSignal m(stats_mutex); // The stats are computed from two different threads
-
-  if (session.IsAudio ()) {
-
-    PTimeInterval t = PTime () - last_a_tick;
-    if (t.GetMilliSeconds () < 500)
-      return;
-
-    unsigned elapsed_seconds = max ((unsigned long) t.GetMilliSeconds (), (unsigned long) 1);
-    double octets_received = session.GetOctetsReceived ();
-    double octets_sent = session.GetOctetsSent ();
-
-    re_a_bw = max ((octets_received - re_a_bytes) / elapsed_seconds, 0.0);
-    tr_a_bw = max ((octets_sent - tr_a_bytes) / elapsed_seconds, 0.0);
-
-    re_a_bytes = octets_received;
-    tr_a_bytes = octets_sent;
-    last_a_tick = PTime ();
-
-    total_a = session.GetPacketsReceived ();
-    lost_a = session.GetPacketsLost ();
-    too_late_a = session.GetPacketsTooLate ();
-    out_of_order_a = session.GetPacketsOutOfOrder ();
-
-    jitter = session.GetJitterBufferSize () / max ((unsigned) session.GetJitterTimeUnits (), (unsigned) 8);
-  }
-  else {
-
-    PTimeInterval t = PTime () - last_v_tick;
-    if (t.GetMilliSeconds () < 500)
-      return;
-
-    unsigned elapsed_seconds = max ((unsigned long) t.GetMilliSeconds (), (unsigned long) 1);
-    double octets_received = session.GetOctetsReceived ();
-    double octets_sent = session.GetOctetsSent ();
-
-    re_v_bw = max ((octets_received - re_v_bytes) / elapsed_seconds, 0.0);
-    tr_v_bw = max ((octets_sent - tr_v_bytes) / elapsed_seconds, 0.0);
-
-    re_v_bytes = octets_received;
-    tr_v_bytes = octets_sent;
-    last_v_tick = PTime ();
-
-    total_v = session.GetPacketsReceived ();
-    lost_v = session.GetPacketsLost ();
-    too_late_v = session.GetPacketsTooLate ();
-    out_of_order_v = session.GetPacketsOutOfOrder ();
-  }
-
-  lost_packets = (lost_a + lost_v) / max ((unsigned long)(total_a + total_v), (unsigned long) 1);
-  late_packets = (too_late_a + too_late_v) / max ((unsigned long)(total_a + total_v), (unsigned long) 1);
-  out_of_order_packets = (out_of_order_a + out_of_order_v) / max ((unsigned long)(total_a + total_v), (unsigned long) 1);
+  // Called from the media threads : this must never block
+  if (session.IsAudio ())
+    audio_counters.update (session);
+  else
+    video_counters.update (session);
 }
 
 
@@ -654,6 +723,21 @@ Opal::Call::OnNoAnswerTimeout (PTimer &,
 }
 
 
+void
+Opal::Call::OnStatisticsTimeout (PTimer &,
+                                 INT)
+{
+  Ekiga::CallStatistics sample;
+
+  {
+    PWaitAndSignal m(stats_mutex);
+    sample = stats.sample (audio_counters, video_counters);
+  }
+
+  Ekiga::Runtime::emit_signal_in_main (statistics_updated, sample);
+}
+
+
 void
 Opal::Call::on_cleared_call (std::string /*reason*/)
 {
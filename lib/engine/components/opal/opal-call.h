@@ -41,6 +41,8 @@
 #include "runtime.h"
 #include "services.h"
 #include "call.h"
+#include "opal-call-stats.h"
+#include "opal-call-recorder.h"
 
 #ifndef __OPAL_CALL_H__
 #define __OPAL_CALL_H__
@@ -103,6 +105,17 @@ public:
      */
     void set_reject_delay (unsigned delay);
 
+    /** Record the call to disk
+     * See Ekiga::Call for the API
+     */
+    bool start_recording (const std::string & basename,
+                          RecordingMode mode,
+                          bool video);
+
+    void stop_recording ();
+
+    bool is_recording () const;
+
 
     /*
      * Call Information
@@ -153,14 +166,15 @@ public:
     */
 
     bool is_outgoing () const;
-    double get_received_audio_bandwidth () const { return re_a_bw; }
-    double get_transmitted_audio_bandwidth () const { return tr_a_bw; }
-    double get_received_video_bandwidth () const { return re_v_bw; }
-    double get_transmitted_video_bandwidth () const { return tr_v_bw; }
-    unsigned get_jitter_size () const { return jitter; }
-    double get_lost_packets () const { return lost_packets; }
-    double get_late_packets () const { return late_packets; }
-    double get_out_of_order_packets () const { return out_of_order_packets; }
+    double get_received_audio_bandwidth () const;
+    double get_transmitted_audio_bandwidth () const;
+    double get_received_video_bandwidth () const;
+    double get_transmitted_video_bandwidth () const;
+    unsigned get_jitter_size () const;
+    double get_lost_packets () const;
+    double get_late_packets () const;
+    double get_out_of_order_packets () const;
+    void get_statistics_history (std::list<Ekiga::CallStatistics> & history) const;
 
 
     /*
@@ -215,6 +229,9 @@ private:
     PDECLARE_NOTIFIER(PTimer, Opal::Call, OnNoAnswerTimeout);
     PTimer NoAnswerTimer;
 
+    PDECLARE_NOTIFIER(PTimer, Opal::Call, OnStatisticsTimeout);
+    PTimer StatisticsTimer;
+
     /*
      * Variables
      */
@@ -231,41 +248,18 @@ private:
 
     std::string forward_uri;
 
-    double re_a_bw;
-    double tr_a_bw;
-    double re_v_bw;
-    double tr_v_bw;
-    unsigned re_v_fps;
-    unsigned tr_v_fps;
-    unsigned tr_width;
-    unsigned tr_height;
-    unsigned re_width;
-    unsigned re_height;
-
-    unsigned jitter;
-
-    double lost_packets;
-    double late_packets;
-    double out_of_order_packets;
-
-    PMutex stats_mutex;
-    double re_a_bytes;
-    double tr_a_bytes;
-    double re_v_bytes;
-    double tr_v_bytes;
-
-    PTime last_a_tick;
-    PTime last_v_tick;
+    /* written by the media threads without locking */
+    RTPCounters audio_counters;
+    RTPCounters video_counters;
+
+    /* only touched by the statistics timer and the readers */
+    mutable PMutex stats_mutex;
+    CallStatsCollector stats;
+
     PTime start_time;
 
-    unsigned lost_a;
-    unsigned too_late_a;
-    unsigned out_of_order_a;
-    unsigned total_a;
-    unsigned lost_v;
-    unsigned too_late_v;
-    unsigned out_of_order_v;
-    unsigned total_v;
+    mutable PMutex recorder_mutex;
+    CallRecorder recorder;
 
 private:
     void on_cleared_call (std::string);
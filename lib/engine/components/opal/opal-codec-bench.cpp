@@ -0,0 +1,324 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-codec-bench.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : offline benchmark of the codecs Ekiga offers
+ *                          in calls.
+ *
+ */
+
+
+/* The codecs are the formats the call manager offers : the ones the raw
+ * formats of the PC sound system endpoint can be transcoded to, without
+ * the blacklisted ones. Each of them encodes a reference clip and decodes
+ * it back through the OPAL transcoders, in packets of 20 ms for audio and
+ * one picture at a time for video, and one CSV line is printed per codec :
+ *
+ *   format,encoding,rate,media,frames,encode_us,decode_us,bitrate_kbps,quality_db
+ *
+ * encode_us and decode_us are the average wall-clock time per packet or
+ * picture. For audio, the quality is the segmental SNR of the decoded
+ * signal, once aligned with the reference to compensate for the delay of
+ * the codec ; it is a rough substitute for a perceptual score, and only
+ * makes sense to compare the same codec over time. For video, it is the
+ * average PSNR of the luminance.
+ *
+ * The reference clips are synthetic unless given : raw 16 bit mono audio
+ * at --audio-rate (converted to the rate of each codec), and 4:2:0 Y4M
+ * video, as the call recorder writes them.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "opal-codec-benchmark.h"
+#include "opal-codec-description.h"
+#include "audiooutput-resampler.h"
+
+using Opal::CodecBenchmark;
+
+
+struct Options
+{
+  std::string codec;
+  unsigned seconds;
+  std::string audio_file;
+  unsigned audio_rate;
+  std::string video_file;
+  unsigned video_bitrate;
+};
+
+
+class CodecBench : public PProcess
+{
+  PCLASSINFO(CodecBench, PProcess);
+
+public:
+
+  CodecBench ();
+
+  void Main ();
+};
+
+PCREATE_PROCESS(CodecBench);
+
+
+static void
+usage (const char *name)
+{
+  std::cerr << "Usage: " << name << " [--codec=name] [--seconds=s]"
+            << " [--audio=file.raw] [--audio-rate=hz] [--video=file.y4m]"
+            << " [--video-bitrate=kbit/s]" << std::endl;
+}
+
+
+static bool
+load_audio_clip (const std::string & file,
+                 unsigned seconds,
+                 unsigned rate,
+                 std::vector<short> & clip)
+{
+  std::ifstream input (file.c_str (), std::ios::binary);
+  short sample;
+
+  while (clip.size () < rate * seconds && input.read ((char *) &sample, sizeof (sample)))
+    clip.push_back (GINT16_FROM_LE (sample));
+
+  return !clip.empty ();
+}
+
+
+static void
+convert_audio_clip (const std::vector<short> & clip,
+                    unsigned from,
+                    unsigned to,
+                    std::vector<short> & output)
+{
+  Ekiga::AudioResampler resampler;
+
+  resampler.setup (1, from, to);
+  if (resampler.is_passthrough ()) {
+
+    output = clip;
+    return;
+  }
+
+  output.resize (resampler.get_max_output (clip.size ()) + resampler.get_max_output (resampler.get_delay ()));
+  unsigned produced = resampler.process (&clip[0], clip.size (), &output[0], output.size ());
+  produced += resampler.flush (&output[produced], output.size () - produced);
+
+  /* the reference has to start with the clip, not with the filter delay */
+  unsigned delay = (resampler.get_delay () * to) / from;
+  output.erase (output.begin (), output.begin () + std::min (delay, produced));
+  output.resize (produced - std::min (delay, produced));
+}
+
+
+static bool
+load_video_clip (const std::string & file,
+                 unsigned seconds,
+                 CodecBenchmark::VideoClip & clip)
+{
+  std::ifstream input (file.c_str (), std::ios::binary);
+  std::string header;
+  std::string token;
+
+  if (!std::getline (input, header) || header.compare (0, 10, "YUV4MPEG2 ") != 0)
+    return false;
+
+  std::istringstream tokens (header.substr (10));
+  clip.width = clip.height = 0;
+  clip.fps = 25;
+
+  while (tokens >> token) {
+
+    if (token[0] == 'W')
+      clip.width = atoi (token.c_str () + 1);
+    else if (token[0] == 'H')
+      clip.height = atoi (token.c_str () + 1);
+    else if (token[0] == 'F') {
+
+      unsigned numerator = 0, denominator = 0;
+      if (sscanf (token.c_str () + 1, "%u:%u", &numerator, &denominator) == 2 && denominator > 0)
+        clip.fps = std::max (numerator / denominator, 1u);
+    }
+    else if (token[0] == 'C' && token.compare (1, 3, "420") != 0)
+      return false;
+  }
+
+  if (clip.width == 0 || clip.height == 0)
+    return false;
+
+  std::string frame_header;
+  std::vector<BYTE> frame (clip.width * clip.height * 3 / 2);
+
+  while (clip.frames.size () < seconds * clip.fps
+         && std::getline (input, frame_header)
+         && frame_header.compare (0, 5, "FRAME") == 0
+         && input.read ((char *) &frame[0], frame.size ()))
+    clip.frames.push_back (frame);
+
+  return !clip.frames.empty ();
+}
+
+
+CodecBench::CodecBench ()
+  : PProcess ("", "ekiga-codec-bench")
+{
+}
+
+
+void
+CodecBench::Main ()
+{
+  PArgList & args = GetArguments ();
+  Options options;
+
+  options.seconds = 10;
+  options.audio_rate = 16000;
+  options.video_bitrate = 256;
+
+  for (PINDEX i = 0 ; i < args.GetCount () ; i++) {
+
+    std::string arg = (const char *) args[i];
+
+    if (arg.compare (0, 8, "--codec=") == 0)
+      options.codec = arg.substr (8);
+    else if (arg.compare (0, 10, "--seconds=") == 0)
+      options.seconds = std::max (atoi (arg.c_str () + 10), 1);
+    else if (arg.compare (0, 8, "--audio=") == 0)
+      options.audio_file = arg.substr (8);
+    else if (arg.compare (0, 13, "--audio-rate=") == 0)
+      options.audio_rate = atoi (arg.c_str () + 13);
+    else if (arg.compare (0, 8, "--video=") == 0)
+      options.video_file = arg.substr (8);
+    else if (arg.compare (0, 16, "--video-bitrate=") == 0)
+      options.video_bitrate = atoi (arg.c_str () + 16);
+    else {
+
+      usage ((const char *) GetName ());
+      SetTerminationValue (1);
+      return;
+    }
+  }
+
+  std::vector<short> audio_clip;
+  CodecBenchmark::VideoClip video_clip;
+
+  if (!options.audio_file.empty ()) {
+
+    if (options.audio_rate == 0
+        || !load_audio_clip (options.audio_file, options.seconds, options.audio_rate, audio_clip)) {
+
+      std::cerr << "Could not read " << options.audio_file << std::endl;
+      SetTerminationValue (1);
+      return;
+    }
+  }
+  else
+    CodecBenchmark::make_audio_clip (options.audio_rate, options.seconds, audio_clip);
+
+  if (!options.video_file.empty ()) {
+
+    if (!load_video_clip (options.video_file, options.seconds, video_clip)) {
+
+      std::cerr << "Could not read " << options.video_file << std::endl;
+      SetTerminationValue (1);
+      return;
+    }
+  }
+  else
+    CodecBenchmark::make_video_clip (options.seconds, video_clip);
+
+  /* the raw formats of the PC sound system endpoint */
+  OpalMediaFormatList raw_formats;
+  OpalMediaFormatList formats;
+
+  raw_formats += OpalPCM16;
+  raw_formats += OpalPCM16_16KHZ;
+  raw_formats += OpalYUV420P;
+  Opal::CodecList::get_allowed_formats (raw_formats, formats);
+
+  bool failed = false;
+
+  std::cout << "format,encoding,rate,media,frames,encode_us,decode_us,bitrate_kbps,quality_db" << std::endl;
+
+  for (PINDEX i = 0 ; i < formats.GetSize () ; i++) {
+
+    OpalMediaFormat format = formats[i];
+
+    if (!format.IsTransportable ())
+      continue;
+
+    Ekiga::CodecDescription desc = Opal::CodecDescription (format);
+    if (desc.name.empty ()
+        || (!options.codec.empty () && options.codec != desc.name && options.codec != (const char *) format.GetName ()))
+      continue;
+
+    CodecBenchmark::Result result;
+    OpalMediaFormat raw;
+    bool done = false;
+
+    if (CodecBenchmark::find_raw_format (raw_formats, desc, raw)) {
+
+      if (desc.audio) {
+
+        std::vector<short> clip;
+        convert_audio_clip (audio_clip, options.audio_rate, desc.rate, clip);
+        done = CodecBenchmark::run_audio (raw, format, clip, result);
+      }
+      else
+        done = CodecBenchmark::run_video (raw, format, video_clip, options.video_bitrate, result);
+    }
+
+    if (!done) {
+
+      std::cerr << "Could not transcode " << format << std::endl;
+      failed = true;
+      continue;
+    }
+
+    std::cout << format << "," << desc.name << "," << desc.rate << ","
+              << (desc.audio ? "audio" : "video") << "," << result.frames << ","
+              << result.encode_time / result.frames << ","
+              << result.decode_time / result.frames << ","
+              << (result.duration > 0 ? result.bytes * 8 / result.duration / 1000 : 0) << ","
+              << result.quality << std::endl;
+  }
+
+  SetTerminationValue (failed ? 1 : 0);
+}
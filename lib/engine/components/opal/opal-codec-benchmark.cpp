@@ -0,0 +1,402 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-codec-benchmark.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the encode/decode loops
+ *                          measuring what a codec costs.
+ *
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <glib.h>
+
+#include <opal/transcoders.h>
+#include <codec/vidcodec.h>
+
+#include "opal-codec-benchmark.h"
+
+/* Audio packets, as the streams send them */
+#define PACKET_TIME 20
+
+/* Segments of the segmental SNR, in ms, and the range of their SNR so
+ * that silences and glitches don't dominate the average */
+#define SEGMENT_TIME 20
+#define SEGMENT_MIN_SNR -10.0
+#define SEGMENT_MAX_SNR 35.0
+
+/* The longest codec delay the audio alignment looks for, in ms */
+#define MAX_DELAY 60
+
+/* The synthetic video clip */
+#define VIDEO_WIDTH 352
+#define VIDEO_HEIGHT 288
+#define VIDEO_FPS 15
+
+using namespace Opal;
+
+
+/* Find the delay of the decoded signal on its first second, then compute
+ * the segmental SNR */
+static double
+segmental_snr (const std::vector<short> & reference,
+               const std::vector<short> & decoded,
+               unsigned rate)
+{
+  unsigned window = std::min ((unsigned) reference.size (), rate);
+  unsigned max_delay = rate * MAX_DELAY / 1000;
+  unsigned delay = 0;
+  double best = -1;
+
+  for (unsigned lag = 0 ; lag <= max_delay && lag + window <= decoded.size () ; lag++) {
+
+    double correlation = 0, energy = 0;
+
+    for (unsigned n = 0 ; n < window ; n++) {
+
+      correlation += (double) reference[n] * decoded[n + lag];
+      energy += (double) decoded[n + lag] * decoded[n + lag];
+    }
+
+    double score = (energy > 0) ? correlation / sqrt (energy) : 0;
+    if (score > best) {
+
+      best = score;
+      delay = lag;
+    }
+  }
+
+  unsigned segment = rate * SEGMENT_TIME / 1000;
+  double sum = 0;
+  unsigned segments = 0;
+
+  for (unsigned start = 0 ;
+       start + segment <= reference.size () && start + segment + delay <= decoded.size () ;
+       start += segment) {
+
+    double signal = 0, noise = 0;
+
+    for (unsigned n = start ; n < start + segment ; n++) {
+
+      double error = (double) reference[n] - decoded[n + delay];
+      signal += (double) reference[n] * reference[n];
+      noise += error * error;
+    }
+
+    /* the silences say nothing about the codec */
+    if (signal < segment * 100.0 * 100.0)
+      continue;
+
+    double snr = (noise > 0) ? 10 * log10 (signal / noise) : SEGMENT_MAX_SNR;
+    sum += std::max (SEGMENT_MIN_SNR, std::min (SEGMENT_MAX_SNR, snr));
+    segments++;
+  }
+
+  return segments ? sum / segments : 0;
+}
+
+
+static double
+luma_psnr (const BYTE *reference,
+           const BYTE *decoded,
+           unsigned size)
+{
+  double error = 0;
+
+  for (unsigned i = 0 ; i < size ; i++)
+    error += ((int) reference[i] - decoded[i]) * ((int) reference[i] - decoded[i]);
+
+  if (error == 0)
+    return 99;
+
+  return 10 * log10 (255.0 * 255.0 * size / error);
+}
+
+
+static double
+elapsed_us (GTimer *timer)
+{
+  return g_timer_elapsed (timer, NULL) * 1000000;
+}
+
+
+/* Voiced sound : a few harmonics of a pitch which moves, in syllables
+ * separated by silences, over a little noise */
+void
+CodecBenchmark::make_audio_clip (unsigned rate,
+                                 unsigned seconds,
+                                 std::vector<short> & clip)
+{
+  double phase = 0;
+
+  clip.resize (rate * seconds);
+  srand (1);
+
+  for (unsigned n = 0 ; n < clip.size () ; n++) {
+
+    double t = (double) n / rate;
+    double pitch = 140 + 40 * sin (2 * M_PI * 0.7 * t);
+    double envelope = sin (M_PI * fmod (t, 0.25) / 0.25);
+    double value = 0;
+
+    if (fmod (t, 2.0) > 1.5)
+      envelope = 0;
+
+    phase += 2 * M_PI * pitch / rate;
+    for (unsigned h = 1 ; h <= 8 && h * pitch < rate / 2 ; h++)
+      value += sin (h * phase) / h;
+
+    value = 6000 * envelope * value + (rand () % 201 - 100);
+    clip[n] = (short) value;
+  }
+}
+
+
+/* A gradient scrolling under a moving square, with a little noise for the
+ * encoders to chew on */
+void
+CodecBenchmark::make_video_clip (unsigned seconds,
+                                 VideoClip & clip)
+{
+  clip.width = VIDEO_WIDTH;
+  clip.height = VIDEO_HEIGHT;
+  clip.fps = VIDEO_FPS;
+  clip.frames.resize (seconds * VIDEO_FPS);
+  srand (1);
+
+  unsigned luma = clip.width * clip.height;
+
+  for (unsigned f = 0 ; f < clip.frames.size () ; f++) {
+
+    std::vector<BYTE> & frame = clip.frames[f];
+    unsigned square_x = (f * 4) % (clip.width - 64);
+    unsigned square_y = (f * 3) % (clip.height - 64);
+
+    frame.resize (luma * 3 / 2);
+
+    for (unsigned y = 0 ; y < clip.height ; y++)
+      for (unsigned x = 0 ; x < clip.width ; x++) {
+
+        int value = (x + y + 2 * f) % 200 + 28 + rand () % 9 - 4;
+        if (x >= square_x && x < square_x + 64 && y >= square_y && y < square_y + 64)
+          value = 230;
+        frame[y * clip.width + x] = (BYTE) value;
+      }
+
+    for (unsigned i = 0 ; i < luma / 4 ; i++) {
+
+      frame[luma + i] = (BYTE) (96 + (i + f) % 64);
+      frame[luma + luma / 4 + i] = (BYTE) (160 - (i + 2 * f) % 64);
+    }
+  }
+}
+
+
+bool
+CodecBenchmark::find_raw_format (const OpalMediaFormatList & raw_formats,
+                                 const Ekiga::CodecDescription & desc,
+                                 OpalMediaFormat & raw)
+{
+  OpalMediaType type = desc.audio ? OpalMediaType::Audio () : OpalMediaType::Video ();
+
+  for (PINDEX i = 0 ; i < raw_formats.GetSize () ; i++) {
+
+    if (raw_formats[i].GetMediaType () != type
+        || (desc.audio && raw_formats[i].GetClockRate () != desc.rate))
+      continue;
+
+    raw = raw_formats[i];
+    return true;
+  }
+
+  return false;
+}
+
+
+bool
+CodecBenchmark::run_audio (const OpalMediaFormat & raw,
+                           const OpalMediaFormat & format,
+                           const std::vector<short> & clip,
+                           Result & result)
+{
+  OpalTranscoder *encoder = OpalTranscoder::Create (raw, format);
+  OpalTranscoder *decoder = OpalTranscoder::Create (format, raw);
+
+  if (encoder == NULL || decoder == NULL) {
+
+    delete encoder;
+    delete decoder;
+    return false;
+  }
+
+  /* whole codec frames, as close to a packet as they can get */
+  unsigned rate = raw.GetClockRate ();
+  unsigned frame_samples = std::max (format.GetFrameTime () * rate / format.GetClockRate (), 1u);
+  unsigned samples = std::max ((rate * PACKET_TIME / 1000) / frame_samples, 1u) * frame_samples;
+
+  RTP_DataFrame input (samples * sizeof (short));
+  RTP_DataFrameList encoded;
+  RTP_DataFrameList decoded;
+  std::vector<short> output;
+  GTimer *timer = g_timer_new ();
+
+  for (unsigned pos = 0 ; pos + samples <= clip.size () ; pos += samples) {
+
+    input.SetSequenceNumber (result.frames);
+    input.SetTimestamp (pos);
+    memcpy (input.GetPayloadPtr (), &clip[pos], samples * sizeof (short));
+
+    g_timer_start (timer);
+    encoder->ConvertFrames (input, encoded);
+    result.encode_time += elapsed_us (timer);
+    result.frames++;
+
+    for (PINDEX i = 0 ; i < encoded.GetSize () ; i++) {
+
+      result.bytes += encoded[i].GetPayloadSize ();
+
+      g_timer_start (timer);
+      decoder->ConvertFrames (encoded[i], decoded);
+      result.decode_time += elapsed_us (timer);
+
+      for (PINDEX j = 0 ; j < decoded.GetSize () ; j++) {
+
+        const short *payload = (const short *) decoded[j].GetPayloadPtr ();
+        output.insert (output.end (), payload, payload + decoded[j].GetPayloadSize () / sizeof (short));
+      }
+    }
+  }
+
+  g_timer_destroy (timer);
+  delete encoder;
+  delete decoder;
+
+  result.duration = (double) result.frames * samples / rate;
+  result.quality = segmental_snr (clip, output, rate);
+
+  return result.frames > 0;
+}
+
+
+bool
+CodecBenchmark::run_video (const OpalMediaFormat & raw_format,
+                           const OpalMediaFormat & video_format,
+                           const VideoClip & clip,
+                           unsigned bitrate,
+                           Result & result)
+{
+  OpalMediaFormat raw = raw_format;
+  OpalMediaFormat format = video_format;
+
+  /* the options the call manager sets for the configured video size */
+  raw.SetOptionInteger (OpalVideoFormat::FrameWidthOption (), clip.width);
+  raw.SetOptionInteger (OpalVideoFormat::FrameHeightOption (), clip.height);
+  format.SetOptionInteger (OpalVideoFormat::FrameWidthOption (), clip.width);
+  format.SetOptionInteger (OpalVideoFormat::FrameHeightOption (), clip.height);
+  format.SetOptionInteger (OpalVideoFormat::FrameTimeOption (), 90000 / clip.fps);
+  format.SetOptionInteger (OpalVideoFormat::TargetBitRateOption (), bitrate * 1000);
+  format.SetOptionInteger (OpalVideoFormat::MaxFrameSizeOption (), 1400);
+  format.SetOptionBoolean (OpalVideoFormat::RateControlEnableOption (), true);
+
+  OpalTranscoder *encoder = OpalTranscoder::Create (raw, format);
+  OpalTranscoder *decoder = OpalTranscoder::Create (format, raw);
+
+  if (encoder == NULL || decoder == NULL) {
+
+    delete encoder;
+    delete decoder;
+    return false;
+  }
+
+  encoder->UpdateMediaFormats (raw, format);
+  decoder->UpdateMediaFormats (format, raw);
+
+  unsigned luma = clip.width * clip.height;
+  unsigned compared = 0;
+  double psnr = 0;
+  RTP_DataFrame input (sizeof (OpalVideoTranscoder::FrameHeader) + luma * 3 / 2);
+  RTP_DataFrameList encoded;
+  RTP_DataFrameList decoded;
+  GTimer *timer = g_timer_new ();
+
+  OpalVideoTranscoder::FrameHeader *header = (OpalVideoTranscoder::FrameHeader *) input.GetPayloadPtr ();
+  header->x = header->y = 0;
+  header->width = clip.width;
+  header->height = clip.height;
+
+  for (unsigned f = 0 ; f < clip.frames.size () ; f++) {
+
+    input.SetSequenceNumber (f);
+    input.SetTimestamp (f * 90000 / clip.fps);
+    input.SetMarker (true);
+    memcpy (OPAL_VIDEO_FRAME_DATA_PTR (header), &clip.frames[f][0], luma * 3 / 2);
+
+    g_timer_start (timer);
+    encoder->ConvertFrames (input, encoded);
+    result.encode_time += elapsed_us (timer);
+    result.frames++;
+
+    for (PINDEX i = 0 ; i < encoded.GetSize () ; i++) {
+
+      result.bytes += encoded[i].GetPayloadSize ();
+
+      g_timer_start (timer);
+      decoder->ConvertFrames (encoded[i], decoded);
+      result.decode_time += elapsed_us (timer);
+
+      /* a picture coming out now is the one just encoded ; the pictures
+       * the rate control skips are simply not compared */
+      for (PINDEX j = 0 ; j < decoded.GetSize () ; j++) {
+
+        if (decoded[j].GetPayloadSize () < (PINDEX) (sizeof (OpalVideoTranscoder::FrameHeader) + luma))
+          continue;
+
+        const OpalVideoTranscoder::FrameHeader *picture
+          = (const OpalVideoTranscoder::FrameHeader *) decoded[j].GetPayloadPtr ();
+        if (picture->width != clip.width || picture->height != clip.height)
+          continue;
+
+        psnr += luma_psnr (&clip.frames[f][0], OPAL_VIDEO_FRAME_DATA_PTR (picture), luma);
+        compared++;
+      }
+    }
+  }
+
+  g_timer_destroy (timer);
+  delete encoder;
+  delete decoder;
+
+  result.duration = (double) result.frames / clip.fps;
+  result.quality = compared ? psnr / compared : 0;
+
+  return result.frames > 0;
+}
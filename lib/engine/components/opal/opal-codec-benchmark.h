@@ -0,0 +1,128 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-codec-benchmark.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the encode/decode loops
+ *                          measuring what a codec costs.
+ *
+ */
+
+
+#ifndef __OPAL_CODEC_BENCHMARK_H__
+#define __OPAL_CODEC_BENCHMARK_H__
+
+#include <opal/buildopts.h>
+#include <ptbuildopts.h>
+#include <ptlib.h>
+#include <opal/mediafmt.h>
+
+#include <vector>
+
+#include "codec-description.h"
+
+namespace Opal {
+
+  /* Both the offline benchmark and the automatic codec ordering of the
+   * call manager run the codecs through these loops.
+   */
+  class CodecBenchmark
+  {
+  public:
+
+    /** What the loop measured
+     */
+    struct Result
+    {
+      Result (): frames(0), encode_time(0.0), decode_time(0.0), bytes(0),
+                 duration(0.0), quality(0.0)
+      {}
+
+      unsigned frames;        // audio packets or pictures
+      double encode_time;     // us, in total
+      double decode_time;     // us, in total
+      unsigned long bytes;    // of encoded payload
+      double duration;        // s of media
+      double quality;         // dB, segmental SNR or luminance PSNR
+    };
+
+    struct VideoClip
+    {
+      VideoClip (): width(0), height(0), fps(0) {}
+
+      unsigned width;
+      unsigned height;
+      unsigned fps;
+      std::vector< std::vector<BYTE> > frames;    // 4:2:0 planar
+    };
+
+    /** Synthesize voiced sound : harmonics of a moving pitch, in syllables
+     * separated by silences
+     */
+    static void make_audio_clip (unsigned rate,
+                                 unsigned seconds,
+                                 std::vector<short> & clip);
+
+    /** Synthesize a CIF clip : a gradient scrolling under a moving square
+     */
+    static void make_video_clip (unsigned seconds,
+                                 VideoClip & clip);
+
+    /** Find the raw format a codec is fed with
+     * @param raw_formats are the formats of the media endpoint.
+     * @param desc describes the codec.
+     * @param raw receives the raw audio format at the rate of the codec,
+     * or the raw video format.
+     * @return false if there is none.
+     */
+    static bool find_raw_format (const OpalMediaFormatList & raw_formats,
+                                 const Ekiga::CodecDescription & desc,
+                                 OpalMediaFormat & raw);
+
+    /** Encode and decode an audio clip, in packets of 20 ms
+     * @param clip is at the rate of the raw format.
+     * @return false if the formats can't be transcoded.
+     */
+    static bool run_audio (const OpalMediaFormat & raw,
+                           const OpalMediaFormat & format,
+                           const std::vector<short> & clip,
+                           Result & result);
+
+    /** Encode and decode a video clip, one picture at a time
+     * @param bitrate is the target bitrate of the encoder, in kbit/s.
+     * @return false if the formats can't be transcoded.
+     */
+    static bool run_video (const OpalMediaFormat & raw,
+                           const OpalMediaFormat & format,
+                           const VideoClip & clip,
+                           unsigned bitrate,
+                           Result & result);
+  };
+};
+
+#endif
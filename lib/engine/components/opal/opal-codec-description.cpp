@@ -37,6 +37,8 @@
 #include <iostream>
 #include <sstream>
 
+#include <opal/transcoders.h>
+
 #include "opal-codec-description.h"
 
 
@@ -90,3 +92,35 @@ CodecList::CodecList (OpalMediaFormatList & list)
     }
   }
 }
+
+
+void
+CodecList::get_allowed_formats (const OpalMediaFormatList & raw_formats,
+                                OpalMediaFormatList & allowed)
+{
+  OpalMediaFormatList list = OpalTranscoder::GetPossibleFormats (raw_formats);
+  std::list<std::string> black_list;
+
+  black_list.push_back ("GSM-AMR");
+  black_list.push_back ("Linear-16-Stereo-48kHz");
+  black_list.push_back ("LPC-10");
+  black_list.push_back ("SpeexIETFNarrow-11k");
+  black_list.push_back ("SpeexIETFNarrow-15k");
+  black_list.push_back ("SpeexIETFNarrow-18.2k");
+  black_list.push_back ("SpeexIETFNarrow-24.6k");
+  black_list.push_back ("SpeexIETFNarrow-5.95k");
+  black_list.push_back ("iLBC-13k3");
+  black_list.push_back ("iLBC-15k2");
+  black_list.push_back ("RFC4175_YCbCr-4:2:0");
+  black_list.push_back ("RFC4175_RGB");
+
+  // Purge blacklisted codecs
+  for (PINDEX i = 0 ; i < list.GetSize () ; i++) {
+
+    std::list<std::string>::iterator it = find (black_list.begin (), black_list.end (), (const char *) list [i]);
+    if (it == black_list.end ()) {
+      if (list [i].GetMediaType () == OpalMediaType::Audio () || list [i].GetMediaType () == OpalMediaType::Video ())
+        allowed += list [i];
+    }
+  }
+}
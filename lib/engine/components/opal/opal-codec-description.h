@@ -72,6 +72,15 @@ namespace Opal {
        * @param list is an OpalMediaFormatList
        */
       CodecList (OpalMediaFormatList & list);
+
+
+      /** Find the audio and video formats which can be offered in calls
+       * @param raw_formats are the formats of the media endpoint.
+       * @param allowed receives the formats they can be transcoded to,
+       * without the blacklisted ones.
+       */
+      static void get_allowed_formats (const OpalMediaFormatList & raw_formats,
+                                       OpalMediaFormatList & allowed);
     };
 }
 #endif
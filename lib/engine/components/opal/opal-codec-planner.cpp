@@ -0,0 +1,340 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-codec-planner.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the automatic ordering of
+ *                          the codecs from their cost and the resources
+ *                          left.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "opal-codec-planner.h"
+#include "videoinput-info.h"
+
+/* The share of the idle CPU time a call may take : the rest of the
+ * desktop has to keep running */
+#define CPU_SHARE 0.5
+
+/* How long the CPU is watched when a call is planned, in ms : the load
+ * right now is what matters, not the average since the previous call */
+#define CPU_SAMPLE_WINDOW 100
+
+/* The loss above which the link is considered congested, and the one
+ * under which it is considered clean, in % */
+#define CONGESTED_LOSS 5.0
+#define CLEAN_LOSS 1.0
+
+/* How the estimated capacity moves : down below the congested rate, and
+ * slowly up on clean samples, so that an old congestion is forgotten */
+#define CAPACITY_BACKOFF 0.8
+#define CAPACITY_PROBE 1.01
+
+using namespace Opal;
+
+
+static std::string
+cost_key (const Ekiga::CodecDescription & desc)
+{
+  std::stringstream key;
+
+  key << desc.name << "/" << desc.rate;
+
+  return key.str ();
+}
+
+
+static unsigned
+video_size_pixels (unsigned size)
+{
+  if (size >= NB_VIDEO_SIZES)
+    size = 0;
+
+  return Ekiga::VideoSizes [size].width * Ekiga::VideoSizes [size].height;
+}
+
+
+/* Read the idle and total CPU times of the system ; this is Linux only,
+ * elsewhere the headroom is unknown and the CPU isn't taken into
+ * account */
+static bool
+read_cpu_times (unsigned long long & idle,
+                unsigned long long & total,
+                unsigned & cpus)
+{
+  FILE *file = fopen ("/proc/stat", "r");
+  char line[256];
+  bool found = false;
+
+  if (file == NULL)
+    return false;
+
+  cpus = 0;
+  while (fgets (line, sizeof (line), file)) {
+
+    unsigned long long user = 0, nice = 0, system = 0, idle_ = 0, iowait = 0, irq = 0, softirq = 0;
+
+    if (strncmp (line, "cpu ", 4) == 0
+        && sscanf (line + 4, "%llu %llu %llu %llu %llu %llu %llu",
+                   &user, &nice, &system, &idle_, &iowait, &irq, &softirq) >= 4) {
+
+      idle = idle_ + iowait;
+      total = user + nice + system + idle_ + iowait + irq + softirq;
+      found = true;
+    }
+    else if (strncmp (line, "cpu", 3) == 0)
+      cpus++;
+  }
+
+  fclose (file);
+
+  return found && cpus > 0;
+}
+
+
+CodecPlanner::CodecPlanner ()
+  : link_capacity(0.0), cpus(0)
+{
+  unsigned long long idle = 0, total = 0;
+
+  if (!read_cpu_times (idle, total, cpus))
+    cpus = 0;
+}
+
+
+void
+CodecPlanner::set_cost (const Ekiga::CodecDescription & desc,
+                        const Cost & cost,
+                        unsigned width,
+                        unsigned height)
+{
+  PWaitAndSignal m(mutex);
+
+  Entry entry;
+  entry.cost = cost;
+  entry.pixels = width * height;
+
+  costs[cost_key (desc)] = entry;
+}
+
+
+bool
+CodecPlanner::has_costs () const
+{
+  PWaitAndSignal m(mutex);
+
+  return !costs.empty ();
+}
+
+
+void
+CodecPlanner::feed (const Ekiga::CallStatistics & stats)
+{
+  PWaitAndSignal m(mutex);
+
+  /* what we send ; the loss is what we receive, but both directions
+   * usually go through the same bottleneck */
+  double usage = 8 * (stats.transmitted_audio_bandwidth + stats.transmitted_video_bandwidth);
+
+  if (usage <= 0)
+    return;
+
+  /* the capacity stays unknown until the link shows its limit once */
+  if (stats.lost_packets >= CONGESTED_LOSS) {
+
+    if (link_capacity == 0 || usage * CAPACITY_BACKOFF < link_capacity)
+      link_capacity = usage * CAPACITY_BACKOFF;
+  }
+  else if (stats.lost_packets < CLEAN_LOSS && link_capacity > 0)
+    link_capacity = std::max (link_capacity * CAPACITY_PROBE, usage);
+}
+
+
+double
+CodecPlanner::get_link_capacity () const
+{
+  PWaitAndSignal m(mutex);
+
+  return link_capacity;
+}
+
+
+bool
+CodecPlanner::fits (const Ekiga::CodecDescription & desc,
+                    unsigned pixels,
+                    double cpu_budget,
+                    double bandwidth_budget,
+                    Cost & cost) const
+{
+  std::map<std::string, Entry>::const_iterator iter = costs.find (cost_key (desc));
+
+  cost = Cost ();
+  if (iter == costs.end ())
+    return true;
+
+  cost = iter->second.cost;
+  if (pixels > 0 && iter->second.pixels > 0) {
+
+    cost.cpu = cost.cpu * pixels / iter->second.pixels;
+    cost.bitrate = cost.bitrate * pixels / iter->second.pixels;
+  }
+
+  return (cpu_budget < 0 || cost.cpu <= cpu_budget)
+    && (bandwidth_budget <= 0 || cost.bitrate <= bandwidth_budget);
+}
+
+
+double
+CodecPlanner::sample_cpu_headroom () const
+{
+  unsigned long long idle_before = 0, total_before = 0;
+  unsigned long long idle_after = 0, total_after = 0;
+  unsigned count = 0;
+
+  if (cpus == 0 || !read_cpu_times (idle_before, total_before, count))
+    return -1.0;
+
+  PThread::Sleep (CPU_SAMPLE_WINDOW);
+
+  if (!read_cpu_times (idle_after, total_after, count)
+      || total_after <= total_before)
+    return -1.0;
+
+  return (double) (idle_after - idle_before) / (total_after - total_before) * count;
+}
+
+
+void
+CodecPlanner::plan (const Ekiga::CodecList & preferred,
+                    unsigned video_size,
+                    Plan & plan)
+{
+  /* sampled before locking : feed () shouldn't wait for the window */
+  double cpu_headroom = sample_cpu_headroom ();
+
+  PWaitAndSignal m(mutex);
+
+  std::vector<Ekiga::CodecDescription> media[2];   // audio, then video
+
+  for (Ekiga::CodecList::const_iterator iter = preferred.begin ();
+       iter != preferred.end ();
+       ++iter)
+    media[iter->audio ? 0 : 1].push_back (*iter);
+
+  plan.codecs = Ekiga::CodecList ();
+  plan.cpu_headroom = cpu_headroom;
+  plan.link_capacity = link_capacity;
+  plan.video_size = video_size;
+
+  double cpu_budget = (plan.cpu_headroom < 0) ? -1.0 : plan.cpu_headroom * CPU_SHARE;
+  double bandwidth_budget = link_capacity;
+  double audio_cpu_budget = cpu_budget;
+  double audio_bandwidth_budget = bandwidth_budget;
+
+  /* the budget left for video is what the preferred audio codec leaves */
+  for (std::vector<Ekiga::CodecDescription>::const_iterator iter = media[0].begin ();
+       iter != media[0].end ();
+       ++iter) {
+
+    Cost cost;
+    if (iter->active && fits (*iter, 0, cpu_budget, bandwidth_budget, cost)) {
+
+      if (cpu_budget >= 0)
+        cpu_budget = std::max (cpu_budget - cost.cpu, 0.0);
+      if (bandwidth_budget > 0)
+        bandwidth_budget = std::max (bandwidth_budget - cost.bitrate, 1.0);
+      break;
+    }
+  }
+
+  /* the largest video size, not above the user's, at which a video codec
+   * fits, trying them in the user's order ; the smallest size if none
+   * does */
+  unsigned wanted = video_size_pixels (video_size);
+  unsigned smallest = 0;
+  unsigned best = NB_VIDEO_SIZES;
+
+  for (unsigned size = 0 ; size < NB_VIDEO_SIZES ; size++)
+    if (video_size_pixels (size) < video_size_pixels (smallest))
+      smallest = size;
+
+  for (std::vector<Ekiga::CodecDescription>::const_iterator iter = media[1].begin ();
+       iter != media[1].end () && best == NB_VIDEO_SIZES;
+       ++iter) {
+
+    if (!iter->active)
+      continue;
+
+    for (unsigned size = 0 ; size < NB_VIDEO_SIZES ; size++) {
+
+      unsigned pixels = video_size_pixels (size);
+      Cost cost;
+
+      if (pixels > wanted
+          || (best < NB_VIDEO_SIZES && pixels <= video_size_pixels (best)))
+        continue;
+
+      if (fits (*iter, pixels, cpu_budget, bandwidth_budget, cost))
+        best = size;
+    }
+  }
+
+  plan.video_size = (best < NB_VIDEO_SIZES) ? best : smallest;
+
+  /* the codecs which fit keep the user's order, the others follow from
+   * the cheapest to the most expensive */
+  for (unsigned m = 0 ; m < 2 ; m++) {
+
+    unsigned pixels = (m == 0) ? 0 : video_size_pixels (plan.video_size);
+    double cpu = (m == 0) ? audio_cpu_budget : cpu_budget;
+    double bandwidth = (m == 0) ? audio_bandwidth_budget : bandwidth_budget;
+    std::multimap<double, Ekiga::CodecDescription> heavy;
+
+    for (std::vector<Ekiga::CodecDescription>::iterator iter = media[m].begin ();
+         iter != media[m].end ();
+         ++iter) {
+
+      Cost cost;
+      if (!iter->active || fits (*iter, pixels, cpu, bandwidth, cost))
+        plan.codecs.append (*iter);
+      else
+        heavy.insert (std::make_pair (cost.cpu, *iter));
+    }
+
+    for (std::multimap<double, Ekiga::CodecDescription>::iterator iter = heavy.begin ();
+         iter != heavy.end ();
+         ++iter)
+      plan.codecs.append (iter->second);
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-codec-planner.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the automatic ordering of the
+ *                          codecs from their cost and the resources left.
+ *
+ */
+
+
+#ifndef __OPAL_CODEC_PLANNER_H__
+#define __OPAL_CODEC_PLANNER_H__
+
+#include <ptbuildopts.h>
+#include <ptlib.h>
+
+#include <map>
+#include <string>
+
+#include "codec-description.h"
+#include "call.h"
+
+namespace Opal {
+
+  /* Like the jitter controller, the planner only does arithmetic on what
+   * it is fed, and doesn't depend on Opal.
+   *
+   * The user's order of the codecs stays the preference : the planner
+   * only moves the codecs which wouldn't fit in the CPU left or in the
+   * link after the ones which would, and never enables a codec the user
+   * disabled. The codecs it has no cost for stay where they are.
+   *
+   * All the methods are thread-safe : the calls are created from the
+   * Opal threads, while the statistics are fed from the main thread.
+   */
+  class CodecPlanner
+  {
+  public:
+
+    /** What a codec costs during a call
+     */
+    struct Cost
+    {
+      Cost (): cpu(0.0), bitrate(0.0) {}
+
+      double cpu;             // fraction of a CPU, encoding and decoding
+      double bitrate;         // kbit/s, sent
+    };
+
+    /** The order and the video size for a call
+     */
+    struct Plan
+    {
+      Plan (): video_size(0), cpu_headroom(-1.0), link_capacity(0.0) {}
+
+      Ekiga::CodecList codecs;
+      unsigned video_size;    // index in Ekiga::VideoSizes
+      double cpu_headroom;    // CPUs, negative if unknown
+      double link_capacity;   // kbit/s, 0 if unknown
+    };
+
+    CodecPlanner ();
+
+    /** Record the cost of a codec
+     * @param desc describes the codec.
+     * @param cost is its cost ; for video, at the size measured.
+     * @param width is the width of the pictures measured, 0 for audio.
+     * @param height is the height of the pictures measured, 0 for audio.
+     */
+    void set_cost (const Ekiga::CodecDescription & desc,
+                   const Cost & cost,
+                   unsigned width = 0,
+                   unsigned height = 0);
+
+    /** Return true once costs were recorded
+     */
+    bool has_costs () const;
+
+    /** Feed one sample of the statistics of a call, to follow the
+     * capacity of the link
+     */
+    void feed (const Ekiga::CallStatistics & stats);
+
+    /** Return the estimated capacity of the link, in kbit/s, or 0 if it
+     * isn't known yet
+     */
+    double get_link_capacity () const;
+
+    /** Compute the plan of a new call ; the CPU is watched for a tenth of
+     * a second first, so it shouldn't be called from the main thread
+     * @param preferred is the user's order of the codecs.
+     * @param video_size is the user's video size.
+     * @param plan receives the order and the video size.
+     */
+    void plan (const Ekiga::CodecList & preferred,
+               unsigned video_size,
+               Plan & plan);
+
+  private:
+
+    struct Entry
+    {
+      Cost cost;
+      unsigned pixels;        // of the pictures measured, 0 for audio
+    };
+
+    bool fits (const Ekiga::CodecDescription & desc,
+               unsigned pixels,
+               double cpu_budget,
+               double bandwidth_budget,
+               Cost & cost) const;
+
+    /* the idle CPUs, watched over a short window */
+    double sample_cpu_headroom () const;
+
+    std::map<std::string, Entry> costs;
+    double link_capacity;
+
+    unsigned cpus;            // 0 if the CPU times can't be read
+
+    mutable PMutex mutex;
+  };
+};
+
+#endif
@@ -60,6 +60,7 @@
 #define SIP_KEY "/apps/" PACKAGE_NAME "/protocols/sip/"
 #define PORTS_KEY "/apps/" PACKAGE_NAME "/protocols/ports/"
 #define CALL_FORWARDING_KEY "/apps/" PACKAGE_NAME "/protocols/call_forwarding/"
+#define CODECS_KEY "/apps/" PACKAGE_NAME "/codecs/"
 #define AUDIO_CODECS_KEY "/apps/" PACKAGE_NAME "/codecs/audio/"
 #define VIDEO_CODECS_KEY  "/apps/" PACKAGE_NAME "/codecs/video/"
 
@@ -80,8 +81,10 @@ ConfBridge::ConfBridge (Ekiga::Service & _service)
 
   keys.push_back (AUDIO_CODECS_KEY "media_list");
   keys.push_back (VIDEO_CODECS_KEY "media_list");
+  keys.push_back (CODECS_KEY "automatic_ordering");
 
   keys.push_back (AUDIO_CODECS_KEY "maximum_jitter_buffer");
+  keys.push_back (AUDIO_CODECS_KEY "adaptive_jitter_buffer");
 
   keys.push_back (VIDEO_CODECS_KEY "maximum_video_tx_bitrate");
   keys.push_back (VIDEO_CODECS_KEY "maximum_video_rx_bitrate");
@@ -182,6 +185,10 @@ void ConfBridge::on_property_changed (std::string key, GmConfEntry *entry)
 
     manager.set_maximum_jitter (gm_conf_entry_get_int (entry));
   }
+  else if (key == AUDIO_CODECS_KEY "adaptive_jitter_buffer") {
+
+    manager.set_adaptive_jitter (gm_conf_entry_get_bool (entry));
+  }
 
 
   // 
@@ -257,6 +264,11 @@ void ConfBridge::on_property_changed (std::string key, GmConfEntry *entry)
     }
   }
 
+  else if (key == CODECS_KEY "automatic_ordering") {
+
+    manager.set_automatic_codecs (gm_conf_entry_get_bool (entry));
+  }
+
   //
   // SIP related keys
   // 
@@ -0,0 +1,145 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-jitter-controller.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the controller moving the
+ *                          jitter buffer window of a call.
+ *
+ */
+
+
+#include <algorithm>
+
+#include "opal-jitter-controller.h"
+
+/* Above that percentage of late packets, the window grows at once */
+#define LATE_HIGH 2.0
+/* Under that percentage of late packets, the sample is calm */
+#define LATE_LOW 0.2
+/* Above that percentage of lost packets, the network is too unstable to
+ * trust a calm sample */
+#define LOST_HIGH 3.0
+/* Number of calm samples in a row before the window shrinks */
+#define CALM_STEPS 5
+/* The window is never narrower than that (ms) */
+#define MIN_WIDTH 40
+/* Granularity of the changes (ms) */
+#define STEP 10
+
+
+Opal::JitterController::JitterController (unsigned min_bound_,
+                                          unsigned max_bound_)
+  : calm_steps(0)
+{
+  set_bounds (min_bound_, max_bound_);
+
+  /* start with the widest window : this is what the static configuration
+   * did, and the controller only makes it tighter when it's safe */
+  decision.min_delay = min_bound;
+  decision.max_delay = max_bound;
+}
+
+
+void
+Opal::JitterController::set_bounds (unsigned min_bound_,
+                                    unsigned max_bound_)
+{
+  min_bound = min_bound_;
+  max_bound = std::max (max_bound_, min_bound + MIN_WIDTH);
+
+  clamp ();
+}
+
+
+const Opal::JitterController::Decision &
+Opal::JitterController::feed (double late_packets,
+                              double lost_packets)
+{
+  unsigned min_delay = decision.min_delay;
+  unsigned max_delay = decision.max_delay;
+
+  decision.step++;
+  decision.late_packets = late_packets;
+  decision.lost_packets = lost_packets;
+  decision.what = KEEP;
+
+  if (late_packets >= LATE_HIGH) {
+
+    /* grow fast : a dropout is much worse than a bit of latency */
+    unsigned growth = std::max ((unsigned) STEP,
+                                decision.max_delay / 4);
+    decision.max_delay += growth;
+    decision.min_delay += STEP;
+    decision.what = GROW;
+    calm_steps = 0;
+  }
+  else if (late_packets <= LATE_LOW && lost_packets < LOST_HIGH) {
+
+    calm_steps++;
+    if (calm_steps >= CALM_STEPS) {
+
+      /* shrink slowly, the floor first */
+      if (decision.min_delay > min_bound)
+        decision.min_delay -= std::min ((unsigned) STEP,
+                                        decision.min_delay - min_bound);
+      else
+        decision.max_delay -= std::max ((unsigned) STEP,
+                                        decision.max_delay / 10);
+      decision.what = SHRINK;
+      calm_steps = 0;
+    }
+  }
+  else {
+
+    calm_steps = 0;
+  }
+
+  clamp ();
+
+  /* we may already have been against the bounds */
+  if (decision.min_delay == min_delay && decision.max_delay == max_delay)
+    decision.what = KEEP;
+
+  return decision;
+}
+
+
+void
+Opal::JitterController::clamp ()
+{
+  decision.max_delay = std::min (std::max (decision.max_delay,
+                                           min_bound + MIN_WIDTH),
+                                 max_bound);
+  decision.min_delay = std::max (decision.min_delay, min_bound);
+
+  /* the floor never eats more than half of the window */
+  decision.min_delay = std::min (decision.min_delay,
+                                 std::max (min_bound, decision.max_delay / 2));
+}
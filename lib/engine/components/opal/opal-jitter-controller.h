@@ -0,0 +1,110 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-jitter-controller.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the controller moving the
+ *                          jitter buffer window of a call.
+ *
+ */
+
+
+#ifndef __OPAL_JITTER_CONTROLLER_H__
+#define __OPAL_JITTER_CONTROLLER_H__
+
+/* This class only does arithmetic on the statistics it is fed, and
+ * doesn't depend on Opal : this way the replay harness can drive it with
+ * recorded traces.
+ */
+
+namespace Opal {
+
+  class JitterController
+  {
+  public:
+
+    typedef enum { KEEP, GROW, SHRINK } action;
+
+    /** What the controller decided after a sample
+     */
+    struct Decision
+    {
+      Decision (): step(0), late_packets(0.0), lost_packets(0.0),
+                   min_delay(0), max_delay(0), what(KEEP)
+      {}
+
+      unsigned step;          // index of the sample
+      double late_packets;    // percentage during the sample
+      double lost_packets;    // percentage during the sample
+      unsigned min_delay;     // ms
+      unsigned max_delay;     // ms
+      action what;
+    };
+
+    /** Constructor
+     * @param min_bound is the lowest delay the window may go down to (ms)
+     * @param max_bound is the highest delay the window may go up to (ms)
+     */
+    JitterController (unsigned min_bound = 20,
+                      unsigned max_bound = 500);
+
+    /** Change the bounds ; the window is clamped into them
+     */
+    void set_bounds (unsigned min_bound,
+                     unsigned max_bound);
+
+    unsigned get_min_bound () const { return min_bound; }
+    unsigned get_max_bound () const { return max_bound; }
+
+    /** Feed one sample of the call statistics
+     * @param late_packets is the percentage of packets arriving too late
+     * to be played during the sample
+     * @param lost_packets is the percentage of packets lost during the
+     * sample
+     * @return the decision taken
+     */
+    const Decision & feed (double late_packets,
+                           double lost_packets);
+
+    unsigned get_min_delay () const { return decision.min_delay; }
+    unsigned get_max_delay () const { return decision.max_delay; }
+    const Decision & get_last_decision () const { return decision; }
+
+  private:
+
+    void clamp ();
+
+    unsigned min_bound;
+    unsigned max_bound;
+    unsigned calm_steps;
+    Decision decision;
+  };
+};
+
+#endif
@@ -0,0 +1,195 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-jitter-replay.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : offline harness feeding recorded packet
+ *                          arrival traces to the jitter controller.
+ *
+ */
+
+
+/* The trace is read on the standard input, one packet per line :
+ *
+ *   <sequence number> <send time in ms> <arrival time in ms>
+ *
+ * Lines starting with '#' are ignored ; missing sequence numbers are lost
+ * packets. The harness plays the packets out through a simulated jitter
+ * buffer whose delay is the window picked by the controller, and prints
+ * one CSV line per second of trace, then a summary.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "opal-jitter-controller.h"
+
+struct Packet
+{
+  unsigned long sequence;
+  long sent;
+  long arrived;
+};
+
+
+static void
+usage (const char *name)
+{
+  std::cerr << "Usage: " << name << " [--max-jitter=ms] [--static] < trace" << std::endl;
+}
+
+
+static bool
+read_trace (std::istream & input,
+            std::vector<Packet> & packets)
+{
+  std::string line;
+
+  while (std::getline (input, line)) {
+
+    if (line.empty () || line[0] == '#')
+      continue;
+
+    std::istringstream fields (line);
+    Packet packet;
+
+    if (!(fields >> packet.sequence >> packet.sent >> packet.arrived)) {
+
+      std::cerr << "Invalid trace line: " << line << std::endl;
+      return false;
+    }
+    packets.push_back (packet);
+  }
+
+  return !packets.empty ();
+}
+
+
+int
+main (int argc,
+      char *argv[])
+{
+  unsigned max_jitter = 500;
+  bool adaptive = true;
+  std::vector<Packet> packets;
+
+  for (int i = 1 ; i < argc ; i++) {
+
+    if (strncmp (argv[i], "--max-jitter=", 13) == 0)
+      max_jitter = atoi (argv[i] + 13);
+    else if (strcmp (argv[i], "--static") == 0)
+      adaptive = false;
+    else {
+
+      usage (argv[0]);
+      return 1;
+    }
+  }
+
+  if (!read_trace (std::cin, packets)) {
+
+    usage (argv[0]);
+    return 1;
+  }
+
+  Opal::JitterController controller (20, max_jitter);
+
+  /* the shortest transit seen is the network delay, and what comes above
+   * it is the jitter the buffer has to absorb */
+  long base_transit = packets[0].arrived - packets[0].sent;
+  long second_start = packets[0].sent;
+  unsigned long expected_sequence = packets[0].sequence;
+  unsigned long received = 0, late = 0, lost = 0;
+  unsigned long total_received = 0, total_late = 0, total_lost = 0;
+  unsigned long delay_sum = 0, seconds = 0;
+
+  std::cout << "second,late,lost,min_delay,max_delay,decision" << std::endl;
+
+  for (std::vector<Packet>::const_iterator iter = packets.begin ();
+       iter != packets.end ();
+       ++iter) {
+
+    while (iter->sent - second_start >= 1000) {
+
+      double late_ratio = received ? (100.0 * late) / received : 0.0;
+      double lost_ratio = (received + lost) ? (100.0 * lost) / (received + lost) : 0.0;
+      const char *what = "keep";
+
+      if (adaptive) {
+
+        const Opal::JitterController::Decision & decision
+          = controller.feed (late_ratio, lost_ratio);
+        if (decision.what == Opal::JitterController::GROW)
+          what = "grow";
+        else if (decision.what == Opal::JitterController::SHRINK)
+          what = "shrink";
+      }
+
+      std::cout << seconds << "," << late_ratio << "," << lost_ratio << ","
+                << controller.get_min_delay () << ","
+                << controller.get_max_delay () << "," << what << std::endl;
+
+      total_received += received;
+      total_late += late;
+      total_lost += lost;
+      delay_sum += controller.get_max_delay ();
+      seconds++;
+      received = late = lost = 0;
+      second_start += 1000;
+    }
+
+    if (iter->sequence > expected_sequence)
+      lost += iter->sequence - expected_sequence;
+    if (iter->sequence >= expected_sequence)
+      expected_sequence = iter->sequence + 1;
+
+    long transit = iter->arrived - iter->sent;
+    if (transit < base_transit)
+      base_transit = transit;
+
+    received++;
+    if ((unsigned long) (transit - base_transit) > controller.get_max_delay ())
+      late++;
+  }
+
+  total_received += received;
+  total_late += late;
+  total_lost += lost;
+
+  std::cout << "# seconds: " << seconds << std::endl
+            << "# late: " << (total_received ? (100.0 * total_late) / total_received : 0.0) << "%" << std::endl
+            << "# lost: " << ((total_received + total_lost) ? (100.0 * total_lost) / (total_received + total_lost) : 0.0) << "%" << std::endl
+            << "# average maximum delay: " << (seconds ? delay_sum / seconds : (unsigned long) controller.get_max_delay ()) << " ms" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-loopback-test.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : headless end-to-end test of the media path,
+ *                          calling ourselves over SIP.
+ *
+ */
+
+
+/* A SIP endpoint listens on localhost, and the loopback endpoint calls
+ * itself through it : the media goes through the codecs Ekiga offers, RTP
+ * and the jitter buffers in both directions, without any device nor
+ * network. At the end of the call, one CSV line is printed per medium :
+ *
+ *   media,sent,received,lost_pct,latency_min_ms,latency_avg_ms,latency_max_ms,cpu_pct
+ *
+ * The latencies are round trips, so twice the mouth-to-ear or the
+ * glass-to-glass delay of a call, plus the processing of the reflector.
+ * cpu_pct is the CPU time the process took during the call, relative to
+ * the duration of the call.
+ *
+ * The program fails if no audio mark came back, or if the average audio
+ * latency is above --max-latency, so that it can run unattended.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <opal/transcoders.h>
+#include <sip/sipep.h>
+
+#include "loopback-endpoint.h"
+#include "opal-codec-description.h"
+
+
+struct Options
+{
+  unsigned seconds;
+  unsigned port;
+  bool video;
+  unsigned max_latency;
+  PStringArray codecs;
+};
+
+
+class LoopbackTest : public PProcess
+{
+  PCLASSINFO(LoopbackTest, PProcess);
+
+public:
+
+  LoopbackTest ();
+
+  void Main ();
+};
+
+PCREATE_PROCESS(LoopbackTest);
+
+
+static void
+usage (const char *name)
+{
+  std::cerr << "Usage: " << name << " [--seconds=s] [--port=port] [--codec=name]..."
+            << " [--no-video] [--max-latency=ms]" << std::endl;
+}
+
+
+static void
+print_statistics (const char *media,
+                  const GMLoopbackEndpoint::Statistics & statistics,
+                  double cpu)
+{
+  std::cout << media << "," << statistics.sent << "," << statistics.received << ","
+            << (statistics.sent > 0 ? 100.0 * statistics.lost / statistics.sent : 0) << ","
+            << statistics.latency_min << ","
+            << (statistics.received > 0 ? statistics.latency_sum / statistics.received : 0) << ","
+            << statistics.latency_max << ","
+            << 100 * cpu << std::endl;
+}
+
+
+LoopbackTest::LoopbackTest ()
+  : PProcess ("", "ekiga-loopback-test")
+{
+}
+
+
+void
+LoopbackTest::Main ()
+{
+  PArgList & args = GetArguments ();
+  Options options;
+
+  options.seconds = 10;
+  options.port = 5070;
+  options.video = true;
+  options.max_latency = 0;
+
+  for (PINDEX i = 0 ; i < args.GetCount () ; i++) {
+
+    std::string arg = (const char *) args[i];
+
+    if (arg.compare (0, 10, "--seconds=") == 0)
+      options.seconds = std::max (atoi (arg.c_str () + 10), 1);
+    else if (arg.compare (0, 7, "--port=") == 0)
+      options.port = atoi (arg.c_str () + 7);
+    else if (arg.compare (0, 8, "--codec=") == 0)
+      options.codecs.AppendString (arg.substr (8).c_str ());
+    else if (arg == "--no-video")
+      options.video = false;
+    else if (arg.compare (0, 14, "--max-latency=") == 0)
+      options.max_latency = atoi (arg.c_str () + 14);
+    else {
+
+      usage ((const char *) GetName ());
+      SetTerminationValue (1);
+      return;
+    }
+  }
+
+  OpalManager manager;
+  SIPEndPoint *sip = new SIPEndPoint (manager);
+  GMLoopbackEndpoint *loopback = new GMLoopbackEndpoint (manager);
+
+  std::stringstream listener;
+  listener << "udp$127.0.0.1:" << options.port;
+  if (!sip->StartListeners (PStringArray (listener.str ()))) {
+
+    std::cerr << "Could not listen on port " << options.port << std::endl;
+    SetTerminationValue (1);
+    return;
+  }
+
+  /* the codecs Ekiga offers, the first ones given preferred */
+  OpalMediaFormatList allowed;
+  OpalMediaFormatList all_formats = OpalTranscoder::GetPossibleFormats (loopback->GetMediaFormats ());
+  PStringArray mask;
+
+  Opal::CodecList::get_allowed_formats (loopback->GetMediaFormats (), allowed);
+  all_formats.Remove (allowed);
+  for (PINDEX i = 0 ; i < all_formats.GetSize () ; i++)
+    mask += all_formats[i];
+  if (!options.video)
+    mask += "*H.26*";
+
+  manager.SetMediaFormatMask (mask);
+  manager.SetMediaFormatOrder (options.codecs);
+  manager.SetAutoStartTransmitVideo (options.video);
+  manager.SetAutoStartReceiveVideo (options.video);
+
+  std::stringstream uri;
+  uri << "sip:loopback@127.0.0.1:" << options.port;
+
+  PString token;
+  if (!loopback->start (uri.str (), token)) {
+
+    std::cerr << "Could not call " << uri.str () << std::endl;
+    SetTerminationValue (1);
+    return;
+  }
+
+  clock_t cpu_start = clock ();
+  PTime start;
+
+  PThread::Sleep (options.seconds * 1000);
+
+  double cpu = (double) (clock () - cpu_start) / CLOCKS_PER_SEC;
+  double duration = (PTime () - start).GetMilliSeconds () / 1000.0;
+
+  manager.ClearCallSynchronous (token);
+
+  GMLoopbackEndpoint::Statistics audio;
+  GMLoopbackEndpoint::Statistics video;
+  loopback->get_statistics (audio, video);
+
+  std::cout << "media,sent,received,lost_pct,latency_min_ms,latency_avg_ms,latency_max_ms,cpu_pct" << std::endl;
+  print_statistics ("audio", audio, cpu / duration);
+  if (options.video)
+    print_statistics ("video", video, cpu / duration);
+
+  bool failed = (audio.received == 0
+                 || (options.max_latency > 0
+                     && audio.latency_sum / audio.received > options.max_latency));
+
+  SetTerminationValue (failed ? 1 : 0);
+}
@@ -0,0 +1,115 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-media-queue.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : implementation of the lock-free queue carrying
+ *                          media from a real-time thread to another.
+ *
+ */
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "opal-media-queue.h"
+
+Opal::MediaQueue::MediaQueue (unsigned capacity)
+  : size(capacity + 1), head(0), tail(0), dropped(0)
+{
+  buffer = new char[size];
+}
+
+
+Opal::MediaQueue::~MediaQueue ()
+{
+  delete[] buffer;
+}
+
+
+bool
+Opal::MediaQueue::push (const char *data,
+                        unsigned length)
+{
+  unsigned h = (unsigned) g_atomic_int_get (&head);
+  unsigned t = (unsigned) g_atomic_int_get (&tail);
+  unsigned room = (t + size - h - 1) % size;
+
+  if (length > room) {
+
+    g_atomic_int_inc (&dropped);
+    return false;
+  }
+
+  unsigned first = std::min (length, size - h);
+  memcpy (buffer + h, data, first);
+  memcpy (buffer, data + first, length - first);
+
+  /* publish only once the bytes are there */
+  g_atomic_int_set (&head, (gint) ((h + length) % size));
+
+  return true;
+}
+
+
+unsigned
+Opal::MediaQueue::pop (char *data,
+                       unsigned length)
+{
+  unsigned h = (unsigned) g_atomic_int_get (&head);
+  unsigned t = (unsigned) g_atomic_int_get (&tail);
+  unsigned waiting = (h + size - t) % size;
+
+  length = std::min (length, waiting);
+
+  unsigned first = std::min (length, size - t);
+  memcpy (data, buffer + t, first);
+  memcpy (data + first, buffer, length - first);
+
+  g_atomic_int_set (&tail, (gint) ((t + length) % size));
+
+  return length;
+}
+
+
+unsigned
+Opal::MediaQueue::available () const
+{
+  unsigned h = (unsigned) g_atomic_int_get (&head);
+  unsigned t = (unsigned) g_atomic_int_get (&tail);
+
+  return (h + size - t) % size;
+}
+
+
+unsigned
+Opal::MediaQueue::get_dropped () const
+{
+  return (unsigned) g_atomic_int_get (&dropped);
+}
@@ -0,0 +1,101 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         opal-media-queue.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : declaration of the lock-free queue carrying
+ *                          media from a real-time thread to another.
+ *
+ */
+
+
+#ifndef __OPAL_MEDIA_QUEUE_H__
+#define __OPAL_MEDIA_QUEUE_H__
+
+#include <glib.h>
+
+namespace Opal {
+
+  /** A fixed-size byte queue with one writer and one reader, which never
+   * take a lock : the writer only moves the head, the reader only moves
+   * the tail. When the queue is full, the writer drops what it pushes
+   * instead of waiting, so a media thread is never held up by a slow disk.
+   */
+  class MediaQueue
+  {
+  public:
+
+    /** Constructor
+     * @param capacity is the number of bytes the queue holds at most
+     */
+    MediaQueue (unsigned capacity);
+
+    ~MediaQueue ();
+
+    /** Append a buffer, or nothing if it doesn't fit ; writer side
+     * @param data is the buffer
+     * @param size is its size
+     * @return false if the buffer was dropped
+     */
+    bool push (const char *data,
+               unsigned size);
+
+    /** Take bytes from the queue ; reader side
+     * @param data is filled with the bytes
+     * @param size is the number of bytes wanted
+     * @return the number of bytes taken, less than size if there weren't
+     * enough
+     */
+    unsigned pop (char *data,
+                  unsigned size);
+
+    /** Return the number of bytes waiting ; reader side
+     */
+    unsigned available () const;
+
+    /** Return the number of buffers dropped since the queue was created
+     */
+    unsigned get_dropped () const;
+
+  private:
+
+    /* no copy */
+    MediaQueue (const MediaQueue &);
+    MediaQueue & operator= (const MediaQueue &);
+
+    char *buffer;
+    unsigned size;  // one byte more than the capacity, to tell full from empty
+
+    mutable volatile gint head;
+    mutable volatile gint tail;
+    mutable volatile gint dropped;
+  };
+};
+
+#endif
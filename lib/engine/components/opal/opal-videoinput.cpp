@@ -43,7 +43,13 @@
 #include <opal/manager.h>
 
 #include "opal-videoinput.h"
-#include "engine.h"
+
+#include <algorithm>
+
+/* how long the encoder waits for a new frame at most (ms) : it waits for
+ * one frame period, but not longer than this, then takes the last frame
+ * again */
+#define FRAME_WAIT 200
 
 
 namespace OpalLinkerHacks {
@@ -55,9 +61,11 @@ class PVideoInputDevice_EKIGA_PluginServiceDescriptor
 : public PDevicePluginServiceDescriptor
 {
   public:
+    /* the call manager makes the devices, with the cores : the plugin
+     * only makes the name known to OPAL */
     virtual PObject *CreateInstance (int) const 
       {
-	return new PVideoInputDevice_EKIGA (*(engine_get_service_core ())); 
+	return NULL; 
       }
     
     
@@ -77,23 +85,23 @@ PCREATE_PLUGIN(EKIGA, PVideoInputDevice, &PVideoInputDevice_EKIGA_descriptor);
 
 int PVideoInputDevice_EKIGA::devices_nbr = 0;
 
-PVideoInputDevice_EKIGA::PVideoInputDevice_EKIGA (Ekiga::ServiceCore & _core):
-  core (_core)
+PVideoInputDevice_EKIGA::PVideoInputDevice_EKIGA (gmref_ptr<Ekiga::VideoInputCore> _videoinput_core):
+  videoinput_core (_videoinput_core)
 {
-  {
-    gmref_ptr<Ekiga::VideoInputCore> smart = core.get ("videoinput-core");
-    smart->reference (); // take a reference in the main thread
-    videoinput_core = smart.get ();
-  }
   opened = false;
   is_active = false;
+  for (unsigned j = 0 ; j < 3 ; j++)
+    frames[j].width = frames[j].height = 0;
+  writing = 0;
+  ready = 1;
+  reading = 2;
+  frame_fresh = false;
 }
 
 
 PVideoInputDevice_EKIGA::~PVideoInputDevice_EKIGA ()
 {
   Close ();
-  videoinput_core->unreference (); // leave a reference in the main thread
 }
 
 bool
@@ -108,6 +116,7 @@ PVideoInputDevice_EKIGA::Open (const PString &/*name*/,
       }
       is_active = true;
       devices_nbr++;
+      add_sink ();
     }
   }
   opened = true;
@@ -127,6 +136,7 @@ bool
 PVideoInputDevice_EKIGA::Close ()
 {
   if (is_active) {
+    remove_sink ();
     devices_nbr--;
     if (devices_nbr==0)
       videoinput_core->stop_stream();
@@ -148,6 +158,7 @@ PVideoInputDevice_EKIGA::Start ()
     }
     is_active = true;
     devices_nbr++;
+    add_sink ();
   }
 
   return true;
@@ -185,28 +196,110 @@ PVideoInputDevice_EKIGA::SetFrameSize (unsigned int width,
   if (!PVideoDevice::SetFrameSize (width, height))
     return false;
 
+  if (is_active)
+    add_sink ();
+
   return true;
 }
 
 
 bool
-PVideoInputDevice_EKIGA::GetFrameData (BYTE *frame,
+PVideoInputDevice_EKIGA::GetFrameData (BYTE *data,
 				       PINDEX *i)
 {
-  videoinput_core->get_frame_data((char*)frame);
+  return get_frame (data, i, true);
+}
+
+
+bool PVideoInputDevice_EKIGA::GetFrameDataNoDelay (BYTE *data,
+						   PINDEX *i)
+{
+  return get_frame (data, i, false);
+}
+
+
+void
+PVideoInputDevice_EKIGA::on_frame (const char *data,
+				   unsigned width,
+				   unsigned height,
+				   const PTime & /*timestamp*/)
+{
+  Frame & frame = frames[writing];
+
+  /* only this thread touches the frame being written : the lock is only
+   * taken to hand it over */
+  frame.data.assign (data, data + width * height * 3 / 2);
+  frame.width = width;
+  frame.height = height;
+
+  {
+    PWaitAndSignal m(frame_mutex);
+
+    std::swap (writing, ready);
+    frame_fresh = true;
+  }
+
+  frame_ready.Signal ();
+}
+
+
+void
+PVideoInputDevice_EKIGA::add_sink ()
+{
+  videoinput_core->add_sink (*this, frameWidth, frameHeight, frameRate);
+}
+
+
+void
+PVideoInputDevice_EKIGA::remove_sink ()
+{
+  videoinput_core->remove_sink (*this);
+
+  // wake up GetFrameData, as no frame will come
+  frame_ready.Signal ();
+}
+
+
+bool
+PVideoInputDevice_EKIGA::get_frame (BYTE *data,
+				    PINDEX *i,
+				    bool wait)
+{
+  if (!take_frame () && wait && is_active) {
+
+    unsigned period = frameRate > 0 ? 1000 / frameRate : FRAME_WAIT;
+
+    frame_ready.Wait (std::min (period, (unsigned) FRAME_WAIT));
+    take_frame ();
+  }
+
+  /* only this thread touches the frame being read : it is copied without
+   * keeping the capture thread waiting */
+  const Frame & frame = frames[reading];
+
+  if (frame.data.empty ()
+      || frame.width != frameWidth || frame.height != frameHeight)
+    return false; // none yet, or from before a change of size
+
+  memcpy (data, &frame.data[0], frame.data.size ());
+  if (i != NULL)
+    *i = frame.data.size ();
 
-  *i = frameWidth * frameHeight * 3 / 2;
- 
   return true;
 }
 
-//FIXME
-bool PVideoInputDevice_EKIGA::GetFrameDataNoDelay (BYTE *frame,
-						   PINDEX *i)
+
+bool
+PVideoInputDevice_EKIGA::take_frame ()
 {
-  videoinput_core->get_frame_data((char*)frame);
+  PWaitAndSignal m(frame_mutex);
+
+  if (!frame_fresh)
+    return false;
+
+  std::swap (reading, ready);
+  frame_fresh = false;
 
-  *i = frameWidth * frameHeight * 3 / 2;
   return true;
 }
 
@@ -260,6 +353,9 @@ bool
 PVideoInputDevice_EKIGA::SetFrameRate (unsigned rate)
 {
   PVideoDevice::SetFrameRate (rate);
+
+  if (is_active)
+    add_sink ();
  
   return true;
 }
@@ -42,8 +42,15 @@
 
 #include "videoinput-core.h"
 
+#include <vector>
 
-class PVideoInputDevice_EKIGA : public PVideoInputDevice 
+
+/* The encoder's input : while it is active, it is a sink of the video
+ * input core, which hands it the captured frames at the size and rate the
+ * encoder asked for ; GetFrameData takes the latest one, and only waits
+ * for a frame period when there is none. */
+class PVideoInputDevice_EKIGA : public PVideoInputDevice,
+                                public Ekiga::VideoInputSink
 {
   PCLASSINFO(PVideoInputDevice_EKIGA, PVideoInputDevice);
   
@@ -53,7 +60,7 @@ class PVideoInputDevice_EKIGA : public PVideoInputDevice
    * BEHAVIOR     :  Creates the Fake Input Device.
    * PRE          :  /
    */
-  PVideoInputDevice_EKIGA (Ekiga::ServiceCore & core);
+  PVideoInputDevice_EKIGA (gmref_ptr<Ekiga::VideoInputCore> _videoinput_core);
 
 
   /* DESCRIPTION  :  The destructor
@@ -176,14 +183,67 @@ class PVideoInputDevice_EKIGA : public PVideoInputDevice
 
   virtual PStringArray GetDeviceNames() const;
 
+
+  /* DESCRIPTION  :  Called by the video input core for each frame.
+   * BEHAVIOR     :  Keeps the frame for the next GetFrameData.
+   * PRE          :  Called from the capture thread.
+   */
+  void on_frame (const char *data,
+                 unsigned width,
+                 unsigned height,
+                 const PTime & timestamp);
+
   static int devices_nbr;
   bool is_active;
   
 protected:
-  Ekiga::ServiceCore & core;
-  Ekiga::VideoInputCore* videoinput_core;
+  gmref_ptr<Ekiga::VideoInputCore> videoinput_core;
+
+  /* DESCRIPTION  :  /
+   * BEHAVIOR     :  Registers the device as a sink of the core with its
+   *                 current size and rate, or unregisters it.
+   * PRE          :  /
+   */
+  void add_sink ();
+  void remove_sink ();
+
+  /* DESCRIPTION  :  /
+   * BEHAVIOR     :  Copies the latest frame into the given buffer, if it
+   *                 has the size the encoder wants. If wait is true and no
+   *                 new frame came since the last call, it is waited for
+   *                 one frame period at most, then the last one is taken
+   *                 again.
+   * PRE          :  /
+   */
+  bool get_frame (BYTE *data,
+                  PINDEX *i,
+                  bool wait);
+
+  /* DESCRIPTION  :  /
+   * BEHAVIOR     :  Makes the frame handed over by on_frame the one being
+   *                 read, if there is a new one ; returns whether so.
+   * PRE          :  /
+   */
+  bool take_frame ();
 
   bool opened;
+
+  /* The frames from the core : on_frame writes one, hands it over as the
+   * ready one, and GetFrameData reads another ; frame_mutex only protects
+   * the exchange of the indexes, never a copy. */
+  struct Frame
+  {
+    std::vector<char> data;
+    unsigned width;
+    unsigned height;
+  };
+  Frame frames[3];
+  unsigned writing;
+  unsigned ready;
+  unsigned reading;
+  bool frame_fresh; // whether 'ready' wasn't read yet
+  PMutex frame_mutex;
+  PSyncPoint frame_ready;
 };
 
 #endif
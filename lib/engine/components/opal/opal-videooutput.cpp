@@ -42,7 +42,6 @@
 #include <opal/manager.h>
 
 #include "opal-videooutput.h"
-#include "engine.h"
 
 namespace OpalLinkerHacks {
   int loadOpalVideoOutput;
@@ -56,9 +55,11 @@ class PVideoOutputDevice_EKIGA_PluginServiceDescriptor
 : public PDevicePluginServiceDescriptor
 {
   public:
+    /* the call manager makes the devices, with the cores : the plugin
+     * only makes the name known to OPAL */
     virtual PObject *CreateInstance (int) const 
       {
-	return new PVideoOutputDevice_EKIGA (*(engine_get_service_core ())); 
+	return NULL; 
       }
     
     
@@ -78,21 +79,9 @@ PCREATE_PLUGIN(EKIGA, PVideoOutputDevice, &PVideoOutputDevice_EKIGA_descriptor);
 
 
 /* The Methods */
-PVideoOutputDevice_EKIGA::PVideoOutputDevice_EKIGA (Ekiga::ServiceCore & _core)
-: core (_core)
+PVideoOutputDevice_EKIGA::PVideoOutputDevice_EKIGA (gmref_ptr<Ekiga::VideoOutputCore> _videooutput_core)
+: videooutput_core (_videooutput_core)
 { 
-  PWaitAndSignal m(videoDisplay_mutex); /* FIXME: if it's really needed
-					 * then we may crash : it's wrong to
-					 * use 'core' from a thread -- mutex
-					 * or not mutex.
-					 */
-
- {
-   gmref_ptr<Ekiga::VideoOutputCore> smart = core.get ("videooutput-core");
-   smart->reference (); // take a reference in the main thread
-   videooutput_core = smart.get ();
- }
-
   is_active = FALSE;
   
   /* Used to distinguish between input and output device. */
@@ -102,15 +91,13 @@ PVideoOutputDevice_EKIGA::PVideoOutputDevice_EKIGA (Ekiga::ServiceCore & _core)
 
 PVideoOutputDevice_EKIGA::~PVideoOutputDevice_EKIGA()
 {
-  PWaitAndSignal m(videoDisplay_mutex); /* FIXME: if it's really needed
-					 * then we may crash : it's wrong to
-					 * have played with 'core' from a thread
-					 */
-
-  videooutput_core-> unreference (); // leave a reference in the main thread
+  PWaitAndSignal m(videoDisplay_mutex);
 
+  /* the reference on the core is atomic, so it can be left from this
+   * thread */
   if (is_active) {
     devices_nbr--;
+    videooutput_core->set_devices_nbr (devices_nbr);
     if (devices_nbr==0)
       videooutput_core->stop();
     is_active = false;
@@ -171,9 +158,15 @@ bool PVideoOutputDevice_EKIGA::SetFrameData (unsigned x,
     }
     is_active = TRUE;
     devices_nbr++;
+    videooutput_core->set_devices_nbr (devices_nbr);
   }
 
-  videooutput_core->set_frame_data((const char*) data, width, height, (device_id == LOCAL), devices_nbr);
+  /* the local video is displayed by the video input core, straight from
+   * the captured frames : we only keep the device count right */
+  if (device_id == LOCAL)
+    return TRUE;
+
+  videooutput_core->set_frame_data((const char*) data, width, height, false, devices_nbr);
 
   return TRUE;
 }
@@ -54,7 +54,7 @@ class PVideoOutputDevice_EKIGA : public PVideoOutputDevice
    * BEHAVIOR     :  /
    * PRE          :  /
    */
-  PVideoOutputDevice_EKIGA (Ekiga::ServiceCore & core);
+  PVideoOutputDevice_EKIGA (gmref_ptr<Ekiga::VideoOutputCore> _videooutput_core);
 
 
   /* DESCRIPTION  :  The destructor.
@@ -139,8 +139,7 @@ class PVideoOutputDevice_EKIGA : public PVideoOutputDevice
 
   enum {REMOTE, LOCAL};
 
-  Ekiga::ServiceCore & core;
-  Ekiga::VideoOutputCore* videooutput_core;
+  gmref_ptr<Ekiga::VideoOutputCore> videooutput_core;
 };
 
 #endif
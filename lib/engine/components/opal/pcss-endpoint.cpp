@@ -40,6 +40,7 @@
 
 #include "pcss-endpoint.h"
 #include "opal-call-manager.h"
+#include "opal-audio.h"
 
 #include "call.h"
 
@@ -47,6 +48,7 @@
 GMPCSSEndpoint::GMPCSSEndpoint (Opal::CallManager & ep,
                                 Ekiga::ServiceCore & _core) 
 :   OpalPCSSEndPoint (ep),
+    manager (ep),
     core (_core)
 {
 #ifdef WIN32
@@ -67,3 +69,29 @@ bool GMPCSSEndpoint::OnShowOutgoing (const OpalPCSSConnection & /*connection*/)
 {
   return true;
 }
+
+
+PSoundChannel *GMPCSSEndpoint::CreateSoundChannel (const OpalPCSSConnection & connection,
+                                                   const OpalMediaFormat & media_format,
+                                                   PBoolean is_source)
+{
+  PString device_name = is_source ? connection.GetSoundChannelRecordDevice ()
+                                  : connection.GetSoundChannelPlayDevice ();
+
+  if (device_name != "EKIGA")
+    return OpalPCSSEndPoint::CreateSoundChannel (connection, media_format, is_source);
+
+  /* as OpalPCSSEndPoint does, but with a channel which knows the cores */
+  PSoundChannel_EKIGA *channel =
+    new PSoundChannel_EKIGA (manager.get_audioinput_core (),
+                             manager.get_audiooutput_core ());
+
+  if (channel->Open (device_name,
+                     is_source ? PSoundChannel::Recorder : PSoundChannel::Player,
+                     1, media_format.GetClockRate (), 16))
+    return channel;
+
+  delete channel;
+
+  return NULL;
+}
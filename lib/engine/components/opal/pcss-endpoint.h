@@ -60,7 +60,12 @@ public:
 
   bool OnShowOutgoing (const OpalPCSSConnection &connection);  
 
+  PSoundChannel *CreateSoundChannel (const OpalPCSSConnection &connection,
+                                     const OpalMediaFormat &media_format,
+                                     PBoolean is_source);
+
 private:
+  Opal::CallManager & manager;
   Ekiga::ServiceCore & core;
 };
 
@@ -110,11 +110,7 @@ Opal::Sip::EndPoint::EndPoint (Opal::CallManager & _manager,
 {
   gmref_ptr<Ekiga::ChatCore> chat_core = core.get ("chat-core");
 
-  {
-    gmref_ptr<Opal::Bank> smart = core.get ("opal-account-store");
-    smart->reference (); // take a reference in the main thread
-    bank = smart.get ();
-  }
+  bank = core.get<Opal::Bank> ("opal-account-store");
 
 
   protocol_name = "sip";
@@ -153,7 +149,6 @@ Opal::Sip::EndPoint::EndPoint (Opal::CallManager & _manager,
 
 Opal::Sip::EndPoint::~EndPoint ()
 {
-  bank->unreference (); // leave a reference in the main thread
 }
 
 
@@ -1027,7 +1022,7 @@ Opal::Sip::EndPoint::OnPresenceInfoReceived (const PString & user,
   if (presence != "unknown" && (old_presence != presence || old_status != status)) {
     presence_infos[_uri].presence = presence;
     presence_infos[_uri].status = status;
-    Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), _uri, presence_infos[_uri].presence, presence_infos[_uri].status));
+    Ekiga::Runtime::run_in_main_coalesced ("sip-presence:" + _uri, sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), _uri, presence_infos[_uri].presence, presence_infos[_uri].status));
   }
 }
 
@@ -1070,9 +1065,9 @@ Opal::Sip::EndPoint::OnDialogInfoReceived (const SIPDialogNotification & info)
   dialog_infos[uri].status = status;
 
   if (_status)
-    Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), uri, dialog_infos[uri].presence, dialog_infos[uri].status));
+    Ekiga::Runtime::run_in_main_coalesced ("sip-presence:" + uri, sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), uri, dialog_infos[uri].presence, dialog_infos[uri].status));
   else
-    Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), uri, presence_infos[uri].presence, presence_infos[uri].status));
+    Ekiga::Runtime::run_in_main_coalesced ("sip-presence:" + uri, sigc::bind (sigc::mem_fun (this, &Opal::Sip::EndPoint::presence_status_in_main), uri, presence_infos[uri].presence, presence_infos[uri].status));
 }
 
 
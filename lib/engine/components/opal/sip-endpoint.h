@@ -226,7 +226,7 @@ namespace Opal {
       CallManager & manager;
 
       Ekiga::ServiceCore & core;
-      Opal::Bank* bank;
+      gmref_ptr<Opal::Bank> bank;
 
       Ekiga::CallProtocolManager::Interface listen_iface;
 
@@ -208,21 +208,21 @@ bool GMAudioInputManager_ptlib::has_device(const std::string & source, const std
 }
 
 void
-GMAudioInputManager_ptlib::device_error_in_main (Ekiga::AudioInputDevice device,
+GMAudioInputManager_ptlib::device_error_in_main (const Ekiga::AudioInputDevice & device,
 						 Ekiga::AudioInputErrorCodes code)
 {
-  device_error.emit (device, code);
+  publish_device_error (device, code);
 }
 
 void
-GMAudioInputManager_ptlib::device_opened_in_main (Ekiga::AudioInputDevice device,
-						  Ekiga::AudioInputSettings settings)
+GMAudioInputManager_ptlib::device_opened_in_main (const Ekiga::AudioInputDevice & device,
+						  const Ekiga::AudioInputSettings & settings)
 {
-  device_opened.emit (device, settings);
+  publish_device_opened (device, settings);
 }
 
 void
-GMAudioInputManager_ptlib::device_closed_in_main (Ekiga::AudioInputDevice device)
+GMAudioInputManager_ptlib::device_closed_in_main (const Ekiga::AudioInputDevice & device)
 {
-  device_closed.emit (device);
+  publish_device_closed (device);
 }
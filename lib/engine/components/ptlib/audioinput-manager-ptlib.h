@@ -83,11 +83,11 @@
       PSoundChannel *input_device;
 
     private:
-      void device_error_in_main (Ekiga::AudioInputDevice device,
+      void device_error_in_main (const Ekiga::AudioInputDevice & device,
 				 Ekiga::AudioInputErrorCodes code);
-      void device_opened_in_main (Ekiga::AudioInputDevice device,
-				  Ekiga::AudioInputSettings settings);
-      void device_closed_in_main (Ekiga::AudioInputDevice device);
+      void device_opened_in_main (const Ekiga::AudioInputDevice & device,
+				  const Ekiga::AudioInputSettings & settings);
+      void device_closed_in_main (const Ekiga::AudioInputDevice & device);
   };
 /**
  * @}
@@ -212,23 +212,23 @@ bool GMAudioOutputManager_ptlib::has_device(const std::string & sink, const std:
 
 void
 GMAudioOutputManager_ptlib::device_opened_in_main (Ekiga::AudioOutputPS ps,
-						   Ekiga::AudioOutputDevice device,
-						   Ekiga::AudioOutputSettings settings)
+						   const Ekiga::AudioOutputDevice & device,
+						   const Ekiga::AudioOutputSettings & settings)
 {
-  device_opened.emit (ps, device, settings);
+  publish_device_opened (ps, device, settings);
 }
 
 void
 GMAudioOutputManager_ptlib::device_closed_in_main (Ekiga::AudioOutputPS ps,
-						   Ekiga::AudioOutputDevice device)
+						   const Ekiga::AudioOutputDevice & device)
 {
-  device_closed.emit (ps, device);
+  publish_device_closed (ps, device);
 }
 
 void
 GMAudioOutputManager_ptlib::device_error_in_main (Ekiga::AudioOutputPS ps,
-						  Ekiga::AudioOutputDevice device,
+						  const Ekiga::AudioOutputDevice & device,
 						  Ekiga::AudioOutputErrorCodes code)
 {
-  device_error.emit (ps, device, code);
+  publish_device_error (ps, device, code);
 }
@@ -84,12 +84,12 @@
 
     private:
       void device_opened_in_main (Ekiga::AudioOutputPS ps,
-				  Ekiga::AudioOutputDevice device,
-				  Ekiga::AudioOutputSettings settings);
+				  const Ekiga::AudioOutputDevice & device,
+				  const Ekiga::AudioOutputSettings & settings);
       void device_closed_in_main (Ekiga::AudioOutputPS ps,
-				  Ekiga::AudioOutputDevice device);
+				  const Ekiga::AudioOutputDevice & device);
       void device_error_in_main (Ekiga::AudioOutputPS ps,
-				 Ekiga::AudioOutputDevice device,
+				 const Ekiga::AudioOutputDevice & device,
 				 Ekiga::AudioOutputErrorCodes code);
   };
 
@@ -34,6 +34,8 @@
  *
  */
 
+#include <sstream>
+
 #include "videoinput-manager-ptlib.h"
 #include "ptbuildopts.h"
 #include "ptlib.h"
@@ -41,16 +43,23 @@
 
 #define DEVICE_TYPE "PTLIB"
 
+/* Number of conversions timed when the device is opened */
+#define CALIBRATION_FRAMES 4
+
 GMVideoInputManager_ptlib::GMVideoInputManager_ptlib (Ekiga::ServiceCore & _core)
 : core (_core)
 {
   current_state.opened = false;
   input_device = NULL;
   expectedFrameSize = 0;
+  conversion_timer = g_timer_new ();
+  conversion_time = 0.0;
+  conversion_frames = 0;
 }
 
 GMVideoInputManager_ptlib::~GMVideoInputManager_ptlib ()
 {
+  g_timer_destroy (conversion_timer);
 }
 
 void GMVideoInputManager_ptlib::get_devices(std::vector <Ekiga::VideoInputDevice> & devices)
@@ -107,6 +116,10 @@ bool GMVideoInputManager_ptlib::set_device (const Ekiga::VideoInputDevice & devi
 bool GMVideoInputManager_ptlib::open (unsigned width, unsigned height, unsigned fps)
 {
   PVideoDevice::VideoFormat pvideo_format;
+  std::string native_format;
+  unsigned native_width = 0;
+  unsigned native_height = 0;
+  bool native = false;
 
   PTRACE(4, "GMVideoInputManager_ptlib\tOpening Device " << current_state.device);
   PTRACE(4, "GMVideoInputManager_ptlib\tOpening Device with " << width << "x" << height << "/" << fps);
@@ -116,6 +129,9 @@ bool GMVideoInputManager_ptlib::open (unsigned width, unsigned height, unsigned
   current_state.fps    = fps;
   expectedFrameSize = (width * height * 3) >> 1;
 
+  // the capabilities are queried before the device is opened by us
+  native = find_native_mode (width, height, native_format, native_width, native_height);
+
   pvideo_format = (PVideoDevice::VideoFormat)current_state.format;
   input_device = PVideoInputDevice::CreateOpenedDevice (current_state.device.source, utf2latin (current_state.device.name), FALSE);  // reencode back to latin-1 or codepage
 
@@ -126,16 +142,23 @@ bool GMVideoInputManager_ptlib::open (unsigned width, unsigned height, unsigned
     error_code = Ekiga::VI_ERROR_FORMAT;
   else if (!input_device->SetChannel (current_state.channel))
     error_code = Ekiga::VI_ERROR_CHANNEL;
-  else if (!input_device->SetColourFormatConverter ("YUV420P"))
-    error_code = Ekiga::VI_ERROR_COLOUR;
-  else if (!input_device->SetFrameRate (current_state.fps))
-    error_code = Ekiga::VI_ERROR_FPS;
-  else if (!input_device->SetFrameSizeConverter (current_state.width, current_state.height, PVideoFrameInfo::eScale))
-    error_code = Ekiga::VI_ERROR_SCALE;
-  else input_device->Start ();
+  else {
+
+    if (native)
+      native = setup_native_mode (native_format, native_width, native_height);
+
+    if (!native && !input_device->SetColourFormatConverter ("YUV420P"))
+      error_code = Ekiga::VI_ERROR_COLOUR;
+    else if (!input_device->SetFrameRate (current_state.fps))
+      error_code = Ekiga::VI_ERROR_FPS;
+    else if (!native && !input_device->SetFrameSizeConverter (current_state.width, current_state.height, PVideoFrameInfo::eScale))
+      error_code = Ekiga::VI_ERROR_SCALE;
+    else input_device->Start ();
+  }
 
   if (error_code != Ekiga::VI_ERROR_NONE) {
     PTRACE(1, "GMVideoInputManager_ptlib\tEncountered error " << error_code << " while opening device ");
+    converter.reset ();
     Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &GMVideoInputManager_ptlib::device_error_in_main), current_state.device, error_code));
     return false;
   }
@@ -151,6 +174,24 @@ bool GMVideoInputManager_ptlib::open (unsigned width, unsigned height, unsigned
   settings.contrast = contrast >> 8;
   settings.modifyable = true;
 
+  if (native) {
+
+    settings.pipeline = converter.describe ();
+    if (converter.is_passthrough ())
+      settings.pipeline += " (as captured)";
+    settings.conversion_cost = measure_conversion_cost ();
+  }
+  else {
+
+    std::stringstream pipeline;
+    pipeline << input_device->GetColourFormat () << " -> PTLib converter -> YUV420P "
+             << current_state.width << "x" << current_state.height;
+    settings.pipeline = pipeline.str ();
+  }
+
+  PTRACE(3, "GMVideoInputManager_ptlib\tCapture pipeline: " << settings.pipeline
+         << ", " << settings.conversion_cost << " us per frame");
+
   Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &GMVideoInputManager_ptlib::device_opened_in_main), current_state.device, settings));
 
   return true;
@@ -163,6 +204,15 @@ void GMVideoInputManager_ptlib::close()
     delete input_device;
     input_device = NULL;
   }
+
+  if (conversion_frames > 0)
+    PTRACE(4, "GMVideoInputManager_ptlib\tConverted " << conversion_frames << " frames, "
+           << (unsigned) (conversion_time * 1000000 / conversion_frames) << " us per frame");
+  converter.reset ();
+  native_frame.clear ();
+  conversion_time = 0.0;
+  conversion_frames = 0;
+
   current_state.opened = false;
   Ekiga::Runtime::run_in_main (sigc::bind (sigc::mem_fun (this, &GMVideoInputManager_ptlib::device_closed_in_main), current_state.device));
 }
@@ -177,6 +227,26 @@ bool GMVideoInputManager_ptlib::get_frame_data (char *data)
 
   PINDEX I = 0;
 
+  if (converter.is_active () && !converter.is_passthrough ()) {
+
+    if (input_device)
+      ret = input_device->GetFrameData (&native_frame[0], &I);
+
+    if ((unsigned) I != native_frame.size ()) {
+      PTRACE(1, "GMVideoInputManager_ptlib\tExpected a native frame of " << native_frame.size () << " bytes but got " << I << " bytes");
+    }
+
+    if (ret) {
+
+      g_timer_start (conversion_timer);
+      converter.convert (&native_frame[0], (unsigned char *) data);
+      conversion_time += g_timer_elapsed (conversion_timer, NULL);
+      conversion_frames++;
+    }
+
+    return ret;
+  }
+
   if (input_device)
     ret = input_device->GetFrameData ((BYTE*)data, &I);
 
@@ -186,6 +256,109 @@ bool GMVideoInputManager_ptlib::get_frame_data (char *data)
   return ret;
 }
 
+bool GMVideoInputManager_ptlib::find_native_mode (unsigned width,
+						  unsigned height,
+						  std::string & format,
+						  unsigned & native_width,
+						  unsigned & native_height)
+{
+  PVideoInputDevice::Capabilities capabilities;
+  unsigned long wanted = (unsigned long) width * height;
+  unsigned best_class = 0;
+  unsigned long best_distance = 0;
+  bool best_planar = false;
+  bool found = false;
+
+  if (!PVideoInputDevice::GetDeviceCapabilities (utf2latin (current_state.device.name),
+                                                 current_state.device.source,
+                                                 &capabilities)) {
+    PTRACE(4, "GMVideoInputManager_ptlib\tNo capabilities for " << current_state.device << ", using the PTLib converters");
+    return false;
+  }
+
+  for (std::list<PVideoFrameInfo>::const_iterator iter = capabilities.framesizes.begin ();
+       iter != capabilities.framesizes.end ();
+       ++iter) {
+
+    std::string mode_format = (const char *) iter->GetColourFormat ();
+    unsigned mode_width = iter->GetFrameWidth ();
+    unsigned mode_height = iter->GetFrameHeight ();
+
+    PTRACE(4, "GMVideoInputManager_ptlib\tNative mode " << mode_format << " " << mode_width << "x" << mode_height);
+
+    if (!Ekiga::VideoInputConverter::is_supported (mode_format)
+        || mode_width == 0 || mode_height == 0 || (mode_width | mode_height) & 1)
+      continue;
+
+    /* the exact size is best, then the closest larger size since
+     * downscaling keeps the details, and upscaling comes last ; at equal
+     * size YUV420P wins since it needs no colour conversion */
+    unsigned long area = (unsigned long) mode_width * mode_height;
+    unsigned long distance = (area > wanted) ? area - wanted : wanted - area;
+    bool planar = (mode_format == "YUV420P" || mode_format == "I420");
+    unsigned mode_class;
+
+    if (mode_width == width && mode_height == height)
+      mode_class = 0;
+    else if (mode_width >= width && mode_height >= height)
+      mode_class = 1;
+    else
+      mode_class = 2;
+
+    if (!found
+        || mode_class < best_class
+        || (mode_class == best_class && distance < best_distance)
+        || (mode_class == best_class && distance == best_distance && planar && !best_planar)) {
+
+      found = true;
+      best_class = mode_class;
+      best_distance = distance;
+      best_planar = planar;
+      format = mode_format;
+      native_width = mode_width;
+      native_height = mode_height;
+    }
+  }
+
+  return found;
+}
+
+bool GMVideoInputManager_ptlib::setup_native_mode (const std::string & format,
+						   unsigned native_width,
+						   unsigned native_height)
+{
+  if (!input_device->SetColourFormat (format)
+      || !input_device->SetFrameSize (native_width, native_height)) {
+
+    PTRACE(2, "GMVideoInputManager_ptlib\tCould not use native mode " << format << " "
+           << native_width << "x" << native_height << ", using the PTLib converters");
+    return false;
+  }
+
+  if (!converter.setup (format, native_width, native_height,
+                        current_state.width, current_state.height))
+    return false;
+
+  native_frame.resize (converter.get_source_size ());
+
+  return true;
+}
+
+unsigned GMVideoInputManager_ptlib::measure_conversion_cost ()
+{
+  if (!converter.is_active () || converter.is_passthrough ())
+    return 0;
+
+  std::vector<unsigned char> scratch (expectedFrameSize);
+
+  g_timer_start (conversion_timer);
+  for (unsigned i = 0 ; i < CALIBRATION_FRAMES ; i++)
+    converter.convert (&native_frame[0], &scratch[0]);
+  g_timer_stop (conversion_timer);
+
+  return (unsigned) (g_timer_elapsed (conversion_timer, NULL) * 1000000 / CALIBRATION_FRAMES);
+}
+
 void GMVideoInputManager_ptlib::set_colour (unsigned colour)
 {
   PTRACE(4, "GMVideoInputManager_ptlib\tSetting colour to " << colour);
@@ -229,21 +402,21 @@ bool GMVideoInputManager_ptlib::has_device(const std::string & source, const std
 }
 
 void
-GMVideoInputManager_ptlib::device_opened_in_main (Ekiga::VideoInputDevice device,
-						  Ekiga::VideoInputSettings settings)
+GMVideoInputManager_ptlib::device_opened_in_main (const Ekiga::VideoInputDevice & device,
+						  const Ekiga::VideoInputSettings & settings)
 {
-  device_opened.emit (device, settings);
+  publish_device_opened (device, settings);
 }
 
 void
-GMVideoInputManager_ptlib::device_closed_in_main (Ekiga::VideoInputDevice device)
+GMVideoInputManager_ptlib::device_closed_in_main (const Ekiga::VideoInputDevice & device)
 {
-  device_closed.emit (device);
+  publish_device_closed (device);
 }
 
 void
-GMVideoInputManager_ptlib::device_error_in_main (Ekiga::VideoInputDevice device,
+GMVideoInputManager_ptlib::device_error_in_main (const Ekiga::VideoInputDevice & device,
 						 Ekiga::VideoInputErrorCodes code)
 {
-  device_error.emit (device, code);
+  publish_device_error (device, code);
 }
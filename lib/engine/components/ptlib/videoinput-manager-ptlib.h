@@ -39,11 +39,16 @@
 #define __VIDEOINPUT_MANAGER_PTLIB_H__
 
 #include "videoinput-manager.h"
+#include "videoinput-converter.h"
 #include "runtime.h"
 
 #include "ptbuildopts.h"
 #include <ptlib/videoio.h>
 
+#include <glib.h>
+#include <list>
+#include <vector>
+
 /**
  * @addtogroup videoinput
  * @{
@@ -81,11 +86,29 @@
 
       PVideoInputDevice *input_device;
 
+      /* when the device can't give us what we want natively, we ask for its
+       * closest native mode and convert in 'converter' from 'native_frame' */
+      Ekiga::VideoInputConverter converter;
+      std::vector<unsigned char> native_frame;
+      GTimer *conversion_timer;
+      double conversion_time;
+      unsigned conversion_frames;
+
     private:
-      void device_opened_in_main (Ekiga::VideoInputDevice device,
-				  Ekiga::VideoInputSettings settings);
-      void device_closed_in_main (Ekiga::VideoInputDevice device);
-      void device_error_in_main (Ekiga::VideoInputDevice device,
+      bool find_native_mode (unsigned width,
+			     unsigned height,
+			     std::string & format,
+			     unsigned & native_width,
+			     unsigned & native_height);
+      bool setup_native_mode (const std::string & format,
+			      unsigned native_width,
+			      unsigned native_height);
+      unsigned measure_conversion_cost ();
+
+      void device_opened_in_main (const Ekiga::VideoInputDevice & device,
+				  const Ekiga::VideoInputSettings & settings);
+      void device_closed_in_main (const Ekiga::VideoInputDevice & device);
+      void device_error_in_main (const Ekiga::VideoInputDevice & device,
 				 Ekiga::VideoInputErrorCodes code);
   };
 /**
@@ -202,8 +202,8 @@ RL::Cluster::on_new_heap_form_submitted (bool submitted,
 
 
 void
-RL::Cluster::on_presence_received (std::string uri,
-				   std::string presence)
+RL::Cluster::on_presence_received (const std::string &uri,
+				   const std::string &presence)
 {
   for (iterator iter = begin ();
        iter != end ();
@@ -214,8 +214,8 @@ RL::Cluster::on_presence_received (std::string uri,
 }
 
 void
-RL::Cluster::on_status_received (std::string uri,
-				 std::string status)
+RL::Cluster::on_status_received (const std::string &uri,
+				 const std::string &status)
 {
   for (iterator iter = begin ();
        iter != end ();
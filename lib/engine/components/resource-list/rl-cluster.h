@@ -87,10 +87,10 @@ namespace RL {
     void on_new_heap_form_submitted (bool submitted,
 				     Ekiga::Form& result);
 
-    void on_presence_received (std::string uri,
-			       std::string presence);
-    void on_status_received (std::string uri,
-			     std::string presence);
+    void on_presence_received (const std::string &uri,
+			       const std::string &presence);
+    void on_status_received (const std::string &uri,
+			     const std::string &presence);
   };
 
   typedef gmref_ptr<Cluster> ClusterPtr;
@@ -0,0 +1,289 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         roster-flood-cluster.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of the cluster of the roster
+ *                          flood benchmark
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "roster-flood-cluster.h"
+
+/* the period of the stall monitor and of the storm, in ms */
+#define TICK 10
+
+static const double stall_limits[] = { 10, 20, 50, 100, 200, 500, 1000 };
+static const unsigned stall_limits_nbr = sizeof (stall_limits) / sizeof (stall_limits[0]);
+
+static const char *presences[] = { "online", "away", "dnd", "offline" };
+
+
+static double
+elapsed_ms (const GTimeVal & from,
+	    const GTimeVal & to)
+{
+  return (to.tv_sec - from.tv_sec) * 1000.0 + (to.tv_usec - from.tv_usec) / 1000.0;
+}
+
+
+/* Reads the resident memory of the process, in kbytes ; this is Linux
+ * only, elsewhere it is 0 */
+static unsigned long
+resident_memory ()
+{
+  FILE *file = fopen ("/proc/self/status", "r");
+  char line[256];
+  unsigned long result = 0;
+
+  if (file == NULL)
+    return 0;
+
+  while (fgets (line, sizeof (line), file))
+    if (strncmp (line, "VmRSS:", 6) == 0)
+      result = strtoul (line + 6, NULL, 10);
+
+  fclose (file);
+
+  return result;
+}
+
+
+bool
+Flood::Options::parse (const std::string spec)
+{
+  std::stringstream stream (spec);
+  std::string item;
+
+  while (std::getline (stream, item, ',')) {
+
+    std::string::size_type equal = item.find ('=');
+    std::string key = item.substr (0, equal);
+    unsigned value = (equal == std::string::npos) ? 0 : strtoul (item.c_str () + equal + 1, NULL, 10);
+
+    if (key == "presentities")
+      presentities = value;
+    else if (key == "groups")
+      groups = value;
+    else if (key == "updates")
+      updates = value;
+    else if (key == "rate")
+      rate = value;
+    else if (key == "quit")
+      quit = true;
+    else if (!key.empty ())
+      return false;
+  }
+
+  return presentities > 0 && rate > 0;
+}
+
+
+Flood::Cluster::Cluster (Ekiga::ServiceCore &_core,
+			 const Options &_options):
+  core(_core), options(_options), phase(Idle), sent(0), ticks(0),
+  populate_time(0), storm_time(0), storm_settle_time(0),
+  memory_before(0), memory_after(0), monitor_source(0),
+  stalls(stall_limits_nbr + 1, 0), max_stall(0)
+{
+}
+
+
+Flood::Cluster::~Cluster ()
+{
+  if (monitor_source != 0)
+    g_source_remove (monitor_source);
+}
+
+
+bool
+Flood::Cluster::populate_menu (Ekiga::MenuBuilder &)
+{
+  return false;
+}
+
+
+void
+Flood::Cluster::start ()
+{
+  if (phase != Idle)
+    return;
+
+  std::clog << "Roster flood: " << options.presentities << " presentities in "
+	    << options.groups << " groups, then " << options.updates
+	    << " updates at " << options.rate << " per second" << std::endl;
+
+  g_get_current_time (&monitor_last);
+  monitor_source = g_timeout_add_full (G_PRIORITY_HIGH, TICK, on_monitor_tick, this, NULL);
+
+  memory_before = resident_memory ();
+  phase = Populating;
+  g_get_current_time (&phase_start);
+
+  add_heap (HeapPtr (new Heap (core, options.presentities, options.groups)));
+
+  g_idle_add_full (G_PRIORITY_LOW, on_settled, this, NULL);
+}
+
+
+gboolean
+Flood::Cluster::on_monitor_tick (gpointer data)
+{
+  Cluster *self = (Cluster *) data;
+  GTimeVal now;
+
+  g_get_current_time (&now);
+
+  double late = elapsed_ms (self->monitor_last, now) - TICK;
+  unsigned bucket = 0;
+
+  while (bucket < stall_limits_nbr && late >= stall_limits[bucket])
+    bucket++;
+
+  self->stalls[bucket]++;
+  if (late > self->max_stall)
+    self->max_stall = late;
+  self->monitor_last = now;
+
+  return TRUE;
+}
+
+
+gboolean
+Flood::Cluster::on_storm_tick (gpointer data)
+{
+  Cluster *self = (Cluster *) data;
+
+  self->storm ();
+
+  return self->phase == Storming;
+}
+
+
+gboolean
+Flood::Cluster::on_settled (gpointer data)
+{
+  ((Cluster *) data)->settled ();
+
+  return FALSE;
+}
+
+
+void
+Flood::Cluster::storm ()
+{
+  GTimeVal now;
+
+  g_get_current_time (&now);
+
+  /* keep up with the rate, whatever the lateness of the ticks */
+  unsigned due = (unsigned) (elapsed_ms (phase_start, now) * options.rate / 1000);
+  due = std::min (due, options.updates);
+
+  for (; sent < due; sent++) {
+
+    unsigned index = g_random_int_range (0, options.presentities);
+    std::stringstream status;
+
+    status << "Flood " << sent;
+    presence_received.emit (Heap::get_uri (index), presences[sent % G_N_ELEMENTS (presences)]);
+    status_received.emit (Heap::get_uri (index), status.str ());
+  }
+
+  if (sent >= options.updates) {
+
+    storm_time = elapsed_ms (phase_start, now);
+    phase = Settling;
+    phase_start = now;
+    g_idle_add_full (G_PRIORITY_LOW, on_settled, this, NULL);
+  }
+}
+
+
+void
+Flood::Cluster::settled ()
+{
+  GTimeVal now;
+
+  g_get_current_time (&now);
+
+  if (phase == Populating) {
+
+    populate_time = elapsed_ms (phase_start, now);
+    memory_after = resident_memory ();
+
+    phase = Storming;
+    phase_start = now;
+    if (options.updates > 0)
+      g_timeout_add (TICK, on_storm_tick, this);
+    else
+      storm ();
+  }
+  else if (phase == Settling) {
+
+    storm_settle_time = elapsed_ms (phase_start, now);
+    phase = Done;
+    report ();
+  }
+}
+
+
+void
+Flood::Cluster::report ()
+{
+  g_source_remove (monitor_source);
+  monitor_source = 0;
+
+  std::clog << "Roster flood: settled " << populate_time << " ms after the population, "
+	    << (memory_after > memory_before ? (memory_after - memory_before) * 1024.0 / options.presentities : 0)
+	    << " bytes per presentity" << std::endl
+	    << "Roster flood: " << sent << " updates sent in " << storm_time << " ms, settled "
+	    << storm_settle_time << " ms after" << std::endl
+	    << "Roster flood: main loop stalls, at most " << max_stall << " ms :";
+
+  for (unsigned i = 0; i <= stall_limits_nbr; i++) {
+
+    if (i < stall_limits_nbr)
+      std::clog << " <" << stall_limits[i] << " ms: " << stalls[i];
+    else
+      std::clog << " more: " << stalls[i];
+  }
+  std::clog << std::endl;
+
+  /* under Xvfb, the run is only for the benchmark */
+  if (options.quit)
+    exit (0);
+}
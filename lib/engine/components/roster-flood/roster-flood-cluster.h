@@ -0,0 +1,162 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         roster-flood-cluster.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of the cluster of the roster flood
+ *                          benchmark
+ *
+ */
+
+#ifndef __ROSTER_FLOOD_CLUSTER_H__
+#define __ROSTER_FLOOD_CLUSTER_H__
+
+#include <vector>
+
+#include <glib.h>
+
+#include "cluster-impl.h"
+#include "presence-core.h"
+#include "services.h"
+#include "roster-flood-heap.h"
+
+namespace Flood
+{
+
+/**
+ * @addtogroup presence
+ * @internal
+ * @{
+ */
+
+  /** What the benchmark does, from the EKIGA_ROSTER_FLOOD environment
+   * variable : comma-separated key=value pairs among presentities,
+   * groups, updates and rate (updates per second), and "quit" to leave
+   * once the report is printed.
+   */
+  struct Options
+  {
+    Options (): presentities(1000), groups(20), updates(10000), rate(1000),
+		quit(false)
+    {}
+
+    bool parse (const std::string spec);
+
+    unsigned presentities;
+    unsigned groups;
+    unsigned updates;
+    unsigned rate;
+    bool quit;
+  };
+
+  /**
+   * This class is a cluster, and the presence fetcher of its heap : once
+   * the user interface is up, it fills the roster with the synthetic heap,
+   * then replays a storm of presence and status updates through the
+   * Ekiga::PresenceCore, as fast as asked.
+   *
+   * It measures how long the main loop takes to settle after each phase
+   * -- to have nothing left but the lowest priority --, how late a
+   * high priority timeout gets during the whole run, and what each
+   * presentity costs in memory, views included. The report goes to the
+   * standard error output.
+   */
+  class Cluster:
+    public Ekiga::ClusterImpl<Heap>,
+    public Ekiga::PresenceFetcher,
+    public Ekiga::Service,
+    public sigc::trackable
+  {
+  public:
+
+    Cluster (Ekiga::ServiceCore &_core,
+	     const Options &_options);
+
+    ~Cluster ();
+
+    const std::string get_name () const
+    { return "roster-flood"; }
+
+    const std::string get_description () const
+    { return "\tBenchmarks the roster with synthetic presentities"; }
+
+    bool populate_menu (Ekiga::MenuBuilder &);
+
+    /* the presentities only get presence from the storm */
+    void fetch (const std::string /*uri*/)
+    {}
+
+    void unfetch (const std::string /*uri*/)
+    {}
+
+    /** Starts the benchmark ; the user interface is supposed to be up.
+     */
+    void start ();
+
+  private:
+
+    Ekiga::ServiceCore &core;
+    Options options;
+
+    enum Phase { Idle, Populating, Storming, Settling, Done };
+    Phase phase;
+    unsigned sent;
+    unsigned ticks;
+    GTimeVal phase_start;
+
+    double populate_time;
+    double storm_time;
+    double storm_settle_time;
+    unsigned long memory_before;
+    unsigned long memory_after;
+
+    /* lateness of the stall monitor, in buckets of increasing ms */
+    guint monitor_source;
+    GTimeVal monitor_last;
+    std::vector<unsigned> stalls;
+    double max_stall;
+
+    static gboolean on_monitor_tick (gpointer data);
+    static gboolean on_storm_tick (gpointer data);
+    static gboolean on_settled (gpointer data);
+
+    void storm ();
+    void settled ();
+    void report ();
+  };
+
+  typedef gmref_ptr<Cluster> ClusterPtr;
+
+/**
+ * @}
+ */
+
+};
+
+#endif
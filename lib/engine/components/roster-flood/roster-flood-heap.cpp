@@ -0,0 +1,88 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         roster-flood-heap.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of the heap of the roster flood
+ *                          benchmark
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "roster-flood-heap.h"
+
+Flood::Heap::Heap (Ekiga::ServiceCore &core,
+		   unsigned presentities,
+		   unsigned groups)
+{
+  for (unsigned i = 0; i < presentities; i++) {
+
+    std::stringstream name;
+    std::stringstream group;
+    std::set<std::string> presentity_groups;
+
+    name << "Contact " << std::setw (6) << std::setfill ('0') << i;
+    group << "Group " << std::setw (4) << std::setfill ('0') << (i % std::max (groups, 1u));
+    presentity_groups.insert (group.str ());
+
+    add_presentity (gmref_ptr<Ekiga::URIPresentity> (new Ekiga::URIPresentity (core, name.str (), get_uri (i), presentity_groups)));
+  }
+}
+
+const std::string
+Flood::Heap::get_name () const
+{
+  return "Roster flood";
+}
+
+bool
+Flood::Heap::populate_menu (Ekiga::MenuBuilder &)
+{
+  return false;
+}
+
+bool
+Flood::Heap::populate_menu_for_group (const std::string /*name*/,
+				      Ekiga::MenuBuilder& /*builder*/)
+{
+  return false;
+}
+
+const std::string
+Flood::Heap::get_uri (unsigned index)
+{
+  std::stringstream uri;
+
+  uri << "flood:contact" << index << "@localhost";
+
+  return uri.str ();
+}
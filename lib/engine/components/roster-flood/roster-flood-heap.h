@@ -0,0 +1,94 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         roster-flood-heap.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of the heap of the roster flood
+ *                          benchmark
+ *
+ */
+
+#ifndef __ROSTER_FLOOD_HEAP_H__
+#define __ROSTER_FLOOD_HEAP_H__
+
+#include "heap-impl.h"
+#include "uri-presentity.h"
+
+namespace Flood
+{
+
+/**
+ * @addtogroup presence
+ * @internal
+ * @{
+ */
+
+  /**
+   * This class implements an Ekiga::Heap full of synthetic presentities.
+   *
+   * The presentities are Ekiga::URIPresentity, so that their presence goes
+   * through the Ekiga::PresenceCore as in a real roster ; their uris use a
+   * scheme of their own, so that no real presence fetcher subscribes to
+   * them.
+   */
+  class Heap: public Ekiga::HeapImpl<Ekiga::URIPresentity>
+  {
+  public:
+
+    /** The constructor.
+     * @param: The Ekiga::ServiceCore of the presentities.
+     * @param: The number of presentities to create.
+     * @param: The number of groups to spread them across.
+     */
+    Heap (Ekiga::ServiceCore &core,
+	  unsigned presentities,
+	  unsigned groups);
+
+    const std::string get_name () const;
+
+    bool populate_menu (Ekiga::MenuBuilder &);
+
+    bool populate_menu_for_group (const std::string name,
+				  Ekiga::MenuBuilder& builder);
+
+    /** Returns the uri of a presentity of the heap.
+     * @param: The index of the presentity.
+     */
+    static const std::string get_uri (unsigned index);
+  };
+
+  typedef gmref_ptr<Heap> HeapPtr;
+
+/**
+ * @}
+ */
+
+};
+
+#endif
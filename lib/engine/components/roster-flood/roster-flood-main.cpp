@@ -0,0 +1,100 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         roster-flood-main.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : code to hook the roster flood benchmark into
+ *                          the main program
+ *
+ */
+
+#include <iostream>
+
+#include <glib.h>
+
+#include "roster-flood-main.h"
+#include "runtime.h"
+#include "roster-flood-cluster.h"
+
+struct ROSTERFLOODSpark: public Ekiga::Spark
+{
+  ROSTERFLOODSpark (const Flood::Options &_options):
+    options(_options), result(false)
+  {}
+
+  bool try_initialize_more (Ekiga::ServiceCore& core,
+			    int* /*argc*/,
+			    char** /*argv*/[])
+  {
+    gmref_ptr<Ekiga::Service> service = core.get ("roster-flood");
+    gmref_ptr<Ekiga::PresenceCore> presence_core = core.get ("presence-core");
+
+    if (presence_core && !service) {
+
+      gmref_ptr<Flood::Cluster> cluster (new Flood::Cluster (core, options));
+      core.add (cluster);
+      presence_core->add_cluster (cluster);
+      presence_core->add_presence_fetcher (cluster);
+
+      /* let the user interface come up first */
+      Ekiga::Runtime::run_in_main (sigc::mem_fun (*cluster, &Flood::Cluster::start), 2);
+      result = true;
+    }
+
+    return result;
+  }
+
+  Ekiga::Spark::state get_state () const
+  { return result?FULL:BLANK; }
+
+  const std::string get_name () const
+  { return "ROSTERFLOOD"; }
+
+  Flood::Options options;
+  bool result;
+};
+
+void
+roster_flood_init (Ekiga::KickStart& kickstart)
+{
+  const gchar *spec = g_getenv ("EKIGA_ROSTER_FLOOD");
+  Flood::Options options;
+
+  if (spec == NULL)
+    return;
+
+  if (!options.parse (spec)) {
+
+    std::clog << "Roster flood: can't understand " << spec << std::endl;
+    return;
+  }
+
+  gmref_ptr<Ekiga::Spark> spark(new ROSTERFLOODSpark (options));
+  kickstart.add_spark (spark);
+}
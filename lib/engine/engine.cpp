@@ -57,6 +57,7 @@
 #include "history-main.h"
 #include "local-roster-main.h"
 #include "local-roster-bridge.h"
+#include "roster-flood-main.h"
 #include "gtk-core-main.h"
 #include "gtk-frontend.h"
 #include "gmconf-personal-details-main.h"
@@ -128,12 +129,18 @@
 
 static Ekiga::ServiceCore *service_core = NULL;
 
+/* lives until engine_stop : the sparks still being prepared when
+ * engine_init returns are initialized later from the main loop */
+static Ekiga::KickStart *kickstart_ptr = NULL;
+
 void
 engine_init (int argc,
-             char *argv [])
+             char *argv [],
+             bool headless)
 {
   service_core = new Ekiga::ServiceCore;
-  Ekiga::KickStart kickstart;
+  kickstart_ptr = new Ekiga::KickStart;
+  Ekiga::KickStart &kickstart = *kickstart_ptr;
 
 
   service_core->add (gmref_ptr<Ekiga::Service>(new Ekiga::NotificationCore));
@@ -142,7 +149,7 @@ engine_init (int argc,
    * be constructed thereafter                                      */
 
   gmref_ptr<Ekiga::AccountCore> account_core (new Ekiga::AccountCore);
-  gmref_ptr<Ekiga::ContactCore> contact_core (new Ekiga::ContactCore);
+  gmref_ptr<Ekiga::ContactCore> contact_core (new Ekiga::ContactCore (*service_core));
   gmref_ptr<Ekiga::CallCore> call_core (new Ekiga::CallCore);
   gmref_ptr<Ekiga::ChatCore> chat_core (new Ekiga::ChatCore);
   gmref_ptr<Ekiga::VideoOutputCore> videooutput_core (new Ekiga::VideoOutputCore);
@@ -176,7 +183,7 @@ engine_init (int argc,
   service_core->add (presence_core);
 
 #ifndef WIN32
-  if (!videooutput_x_init (*service_core, &argc, &argv)) {
+  if (!headless && !videooutput_x_init (*service_core, &argc, &argv)) {
     delete service_core;
     service_core = NULL;
     return;
@@ -184,7 +191,7 @@ engine_init (int argc,
 #endif
 
 #ifdef HAVE_DX
-  if (!videooutput_dx_init (*service_core, &argc, &argv)) {
+  if (!headless && !videooutput_dx_init (*service_core, &argc, &argv)) {
     delete service_core;
     service_core = NULL;
     return;
@@ -198,7 +205,8 @@ engine_init (int argc,
   }
 
 #ifdef HAVE_NOTIFY
-  libnotify_init (kickstart);
+  if (!headless)
+    libnotify_init (kickstart);
 #endif
 
 #ifdef HAVE_GSTREAMER
@@ -253,19 +261,20 @@ engine_init (int argc,
   resource_list_init (kickstart);
 #endif
 
-  history_init (kickstart);
+  if (!headless)
+    history_init (kickstart);
 
   /* FIXME: this one should go away -- but if I don't put it here, the GUI
    * doesn't work correctly */
   kickstart.kick (*service_core, &argc, &argv);
 
-  if (!gtk_core_init (*service_core, &argc, &argv)) {
+  if (!headless && !gtk_core_init (*service_core, &argc, &argv)) {
     delete service_core;
     service_core = NULL;
     return;
   }
 
-  if (!gtk_frontend_init (*service_core, &argc, &argv)) {
+  if (!headless && !gtk_frontend_init (*service_core, &argc, &argv)) {
     delete service_core;
     service_core = NULL;
     return;
@@ -275,6 +284,8 @@ engine_init (int argc,
 
   local_roster_bridge_init (kickstart);
 
+  roster_flood_init (kickstart);
+
   plugin_init (kickstart);
 
   kickstart.kick (*service_core, &argc, &argv);
@@ -310,6 +321,9 @@ engine_get_service_core ()
 void
 engine_stop ()
 {
+  delete kickstart_ptr;
+  kickstart_ptr = NULL;
+
   if (service_core)
     delete service_core;
   service_core = NULL;
@@ -45,8 +45,16 @@
  * @{
  */
 
+/** Create the services of the engine
+ * @param headless is true if nothing should be displayed : then the GTK+
+ * core and frontend, the video output windows, the notifications and the
+ * call history aren't started, for the test and benchmark programs. The
+ * configuration is still read and saved, and the accounts it lists are
+ * registered : those programs give the engine a configuration of its own.
+ */
 void engine_init (int argc,
-		  char *argv[]);
+		  char *argv[],
+		  bool headless = false);
 
 Ekiga::ServiceCore* engine_get_service_core ();
 
@@ -0,0 +1,205 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         event-bus.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of a bus of events sorted by topic
+ *
+ */
+
+#ifndef __EVENT_BUS_H__
+#define __EVENT_BUS_H__
+
+#include <sigc++/sigc++.h>
+#include <list>
+#include <map>
+
+#include "interned-string.h"
+
+namespace Ekiga
+{
+
+  /**
+   * @addtogroup services
+   * @{
+   */
+
+  /* Dispatches events to the listeners of their topic only, where a
+   * sigc::signal would call every listener and let them filter.
+   *
+   * Each topic has one event record, which the publisher updates in place
+   * before publishing it : the listeners get a reference to it, so a
+   * publication copies and allocates nothing. They should copy what they
+   * want to keep, since the record changes with the next event.
+   *
+   * A listener is dropped when the sigc::trackable object of its slot is
+   * destroyed. Listeners may subscribe, be destroyed, or remove the topic
+   * while it is being published.
+   */
+  template<typename Event>
+  class EventBus
+  {
+  public:
+
+    typedef sigc::slot1<void, const Event &> Listener;
+
+    /* returns the record of the topic, which is created with a default
+     * record if it doesn't exist */
+    Event &record (InternedString topic);
+
+    /* returns NULL if there's no such topic */
+    Event *find (InternedString topic);
+
+    void subscribe (InternedString topic,
+		    Listener listener);
+
+    /* gives the record of the topic to its listeners */
+    void publish (InternedString topic);
+
+    /* forgets the topic, its record and its listeners */
+    void remove (InternedString topic);
+
+  private:
+
+    struct Topic
+    {
+      Topic (): publishing(0), removed(false)
+      {}
+
+      Event record;
+      std::list<Listener> listeners;
+      unsigned int publishing;   // nested publications running
+      bool removed;   // the topic goes when they're done
+    };
+
+    typedef std::map<InternedString, Topic> topics_type;
+
+    topics_type topics;
+  };
+
+  /**
+   * @}
+   */
+
+};
+
+/* here begins the code from the template functions */
+
+template<typename Event>
+Event &
+Ekiga::EventBus<Event>::record (InternedString topic)
+{
+  Topic &result = topics[topic];
+
+  if (result.removed) {
+
+    result.removed = false;
+    result.record = Event ();
+  }
+
+  return result.record;
+}
+
+template<typename Event>
+Event *
+Ekiga::EventBus<Event>::find (InternedString topic)
+{
+  typename topics_type::iterator iter = topics.find (topic);
+
+  if (iter == topics.end () || iter->second.removed)
+    return NULL;
+
+  return &iter->second.record;
+}
+
+template<typename Event>
+void
+Ekiga::EventBus<Event>::subscribe (InternedString topic,
+				   Listener listener)
+{
+  Topic &result = topics[topic];
+
+  /* get rid of the listeners whose object is gone -- unless they're
+   * being called */
+  if (result.publishing == 0) {
+
+    typename std::list<Listener>::iterator iter = result.listeners.begin ();
+
+    while (iter != result.listeners.end ())
+      if (iter->empty ())
+	iter = result.listeners.erase (iter);
+      else
+	++iter;
+  }
+
+  result.listeners.push_back (listener);
+}
+
+template<typename Event>
+void
+Ekiga::EventBus<Event>::publish (InternedString topic)
+{
+  typename topics_type::iterator iter = topics.find (topic);
+
+  if (iter == topics.end () || iter->second.removed)
+    return;
+
+  Topic &current = iter->second;
+
+  current.publishing++;
+
+  for (typename std::list<Listener>::iterator listener
+	 = current.listeners.begin ();
+       listener != current.listeners.end () && !current.removed;
+       ++listener)
+    if ( !listener->empty ())
+      (*listener) (current.record);
+
+  current.publishing--;
+
+  if (current.publishing == 0 && current.removed)
+    topics.erase (iter);
+}
+
+template<typename Event>
+void
+Ekiga::EventBus<Event>::remove (InternedString topic)
+{
+  typename topics_type::iterator iter = topics.find (topic);
+
+  if (iter == topics.end ())
+    return;
+
+  if (iter->second.publishing > 0)
+    iter->second.removed = true;
+  else
+    topics.erase (iter);
+}
+
+#endif
@@ -0,0 +1,201 @@
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         gmref.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : Reference-counted memory management helpers
+ *
+ */
+
+#include "gmref.h"
+
+#ifdef GMREF_DEBUG
+#include <iostream>
+#include <map>
+#include <string>
+#include <typeinfo>
+#endif
+
+/* weak pointers come and go seldom : one lock for all of them is enough */
+static GStaticMutex weak_mutex = G_STATIC_MUTEX_INIT;
+
+bool
+GmRefCounted::reference_if_alive () const
+{
+  gint count;
+
+  do {
+
+    count = g_atomic_int_get (&refcount);
+    if (count == 0)
+      return false;
+  } while ( !g_atomic_int_compare_and_exchange (&refcount, count, count + 1));
+
+  debug_handoff ();
+
+  return true;
+}
+
+void
+GmRefCounted::release () const
+{
+  /* nobody holds a reference anymore, so a new weak pointer can only be
+   * copied from an existing one : if there is none, there's no need to
+   * lock
+   */
+  if (weak_refs != 0) {
+
+    /* and locking them fails from now on, since the count is zero */
+    g_static_mutex_lock (&weak_mutex);
+
+    while (weak_refs != 0) {
+
+      gmweak_base* weak = weak_refs;
+
+      weak_refs = weak->next;
+      weak->obj = 0;
+      weak->prev = 0;
+      weak->next = 0;
+    }
+
+    g_static_mutex_unlock (&weak_mutex);
+  }
+
+  delete this;
+}
+
+void
+gmweak_base::watch (const GmRefCounted* obj_)
+{
+  g_static_mutex_lock (&weak_mutex);
+
+  if (obj != 0) {
+
+    if (prev != 0)
+      prev->next = next;
+    else
+      obj->weak_refs = next;
+    if (next != 0)
+      next->prev = prev;
+  }
+
+  obj = obj_;
+  prev = 0;
+  next = 0;
+
+  if (obj != 0) {
+
+    next = obj->weak_refs;
+    if (next != 0)
+      next->prev = this;
+    obj->weak_refs = this;
+  }
+
+  g_static_mutex_unlock (&weak_mutex);
+}
+
+void
+gmweak_base::copy (const gmweak_base& other)
+{
+  const GmRefCounted* locked = other.lock ();
+
+  watch (locked);
+
+  if (locked != 0)
+    locked->unreference ();
+}
+
+void
+gmweak_base::unlink ()
+{
+  watch (0);
+}
+
+const GmRefCounted*
+gmweak_base::lock () const
+{
+  const GmRefCounted* result = 0;
+
+  g_static_mutex_lock (&weak_mutex);
+
+  if (obj != 0 && obj->reference_if_alive ())
+    result = obj;
+
+  g_static_mutex_unlock (&weak_mutex);
+
+  return result;
+}
+
+#ifdef GMREF_DEBUG
+
+static GStaticMutex debug_mutex = G_STATIC_MUTEX_INIT;
+static std::map<std::string, unsigned int> handoffs;
+
+void
+GmRefCounted::debug_init ()
+{
+  owner = g_thread_self ();
+}
+
+void
+GmRefCounted::debug_handoff () const
+{
+  if (g_thread_self () == owner)
+    return;
+
+  g_static_mutex_lock (&debug_mutex);
+  handoffs[typeid (*this).name ()]++;
+  g_static_mutex_unlock (&debug_mutex);
+}
+
+void
+gmref_debug_dump ()
+{
+  g_static_mutex_lock (&debug_mutex);
+
+  for (std::map<std::string, unsigned int>::const_iterator iter
+	 = handoffs.begin ();
+       iter != handoffs.end ();
+       ++iter)
+    std::clog << "gmref: " << iter->second
+	      << " references crossed threads for " << iter->first
+	      << std::endl;
+
+  g_static_mutex_unlock (&debug_mutex);
+}
+
+#else
+
+void
+gmref_debug_dump ()
+{
+}
+
+#endif
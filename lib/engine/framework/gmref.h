@@ -37,14 +37,18 @@
 #ifndef __GMREF_H__
 #define __GMREF_H__
 
+#include <glib.h>
+
 /* This is a reference-counted pointer class ; all it asks to the wrapped
  * object is a pair of reference/unreference methods.
  *
  * This class is thread-safe in the weak sense : you can use gmref_ptr from
  * any thread -- as long as you don't cross the thread boundary with a same
- * instance.
+ * instance. With GmRefCounted objects, two gmref_ptr on the same object
+ * can live in different threads, since the count is atomic.
  *
- * See later down for an helper to implement refcounted objects.
+ * See later down for an helper to implement refcounted objects, and for a
+ * weak pointer on them.
  */
 
 template<typename T>
@@ -92,16 +96,26 @@ template<typename T> bool operator!=(const gmref_ptr<T>& a,
 template<typename T> bool operator<(const gmref_ptr<T>& a,
 				    const gmref_ptr<T>& b);
 
+class gmweak_base;
+
 /* base class for a reference counted object
+ *
+ * The count is updated atomically, so references can be taken and left
+ * from any thread ; the object is deleted in the thread which leaves the
+ * last one.
+ *
+ * When compiled with GMREF_DEBUG defined, the object remembers the thread
+ * which created it, and the references taken or left from another thread
+ * are counted and reported (see gmref_debug_dump).
  */
 class GmRefCounted
 {
 public:
-  GmRefCounted (): refcount(0)
-  {}
+  GmRefCounted (): refcount(0), weak_refs(0)
+  { debug_init (); }
 
-  GmRefCounted (const GmRefCounted& /*other*/): refcount(0)
-  {}
+  GmRefCounted (const GmRefCounted& /*other*/): refcount(0), weak_refs(0)
+  { debug_init (); }
 
   GmRefCounted& operator= (const GmRefCounted& /*other*/)
   { return *this; }
@@ -109,12 +123,132 @@ public:
   virtual ~GmRefCounted ()
   {}
 
-  void reference () const { ++refcount; }
+  void reference () const
+  {
+    debug_handoff ();
+    g_atomic_int_inc (&refcount);
+  }
 
-  void unreference () const { if (--refcount == 0) delete this; }
+  void unreference () const
+  {
+    debug_handoff ();
+    if (g_atomic_int_dec_and_test (&refcount))
+      release ();
+  }
 
 private:
-  mutable int refcount;
+
+  friend class gmweak_base;
+
+  /* takes a reference, unless the object is already on its way out */
+  bool reference_if_alive () const;
+
+  /* clears the weak pointers, and deletes */
+  void release () const;
+
+#ifdef GMREF_DEBUG
+  void debug_init ();
+  void debug_handoff () const;
+
+  GThread* owner;
+#else
+  void debug_init () {}
+  void debug_handoff () const {}
+#endif
+
+  mutable volatile gint refcount;
+  mutable gmweak_base* weak_refs; // protected by a global lock
+};
+
+/* Prints the cross-thread references recorded when compiled with
+ * GMREF_DEBUG ; does nothing otherwise.
+ */
+void gmref_debug_dump ();
+
+/* untyped part of gmweak_ptr */
+class gmweak_base
+{
+protected:
+
+  gmweak_base (): obj(0), prev(0), next(0)
+  {}
+
+  ~gmweak_base ()
+  { unlink (); }
+
+  /* starts watching the object (or nothing if 0) */
+  void watch (const GmRefCounted* obj_);
+
+  /* watches what the other watches */
+  void copy (const gmweak_base& other);
+
+  /* stops watching */
+  void unlink ();
+
+  /* returns the object with a reference taken, or 0 if it's gone */
+  const GmRefCounted* lock () const;
+
+private:
+
+  friend class GmRefCounted;
+
+  const GmRefCounted* obj;
+  gmweak_base* prev;
+  gmweak_base* next;
+};
+
+/* A weak pointer on a GmRefCounted object : it doesn't keep the object
+ * alive, and becomes empty when it is deleted. Use lock () to get a
+ * gmref_ptr on the object before using it -- the result is empty if the
+ * object is gone.
+ *
+ * As with gmref_ptr, a same instance shouldn't be used from several
+ * threads at once.
+ */
+template<typename T>
+class gmweak_ptr: private gmweak_base
+{
+public:
+
+  gmweak_ptr ()
+  {}
+
+  gmweak_ptr (const gmref_ptr<T>& ptr)
+  { watch (ptr.get ()); }
+
+  gmweak_ptr (const gmweak_ptr& other): gmweak_base ()
+  { copy (other); }
+
+  gmweak_ptr& operator= (const gmweak_ptr& other)
+  {
+    if (this != &other)
+      copy (other);
+    return *this;
+  }
+
+  gmweak_ptr& operator= (const gmref_ptr<T>& ptr)
+  {
+    watch (ptr.get ());
+    return *this;
+  }
+
+  gmref_ptr<T> lock () const
+  {
+    const GmRefCounted* locked = gmweak_base::lock ();
+    gmref_ptr<T> result;
+
+    if (locked != 0) {
+
+      // dynamic : GmRefCounted is generally a virtual base
+      result = gmref_ptr<T> (dynamic_cast<T*>(const_cast<GmRefCounted*>(locked)));
+      locked->unreference (); // result holds its own
+    }
+
+    return result;
+  }
+
+  void reset ()
+  { unlink (); }
 };
 
 /* implementation of the templates */
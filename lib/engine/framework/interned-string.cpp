@@ -0,0 +1,60 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         interned-string.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of an interned string
+ *
+ */
+
+#include <glib.h>
+
+#include "interned-string.h"
+
+Ekiga::InternedString::InternedString (const std::string &text):
+  str(g_intern_string (text.c_str ()))
+{
+}
+
+Ekiga::InternedString::InternedString (const char *text):
+  str(g_intern_string (text))
+{
+}
+
+Ekiga::InternedString
+Ekiga::InternedString::lookup (const std::string &text)
+{
+  InternedString result;
+  GQuark quark = g_quark_try_string (text.c_str ());
+
+  if (quark != 0)
+    result.str = g_quark_to_string (quark);
+
+  return result;
+}
@@ -0,0 +1,101 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         interned-string.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of an interned string
+ *
+ */
+
+#ifndef __INTERNED_STRING_H__
+#define __INTERNED_STRING_H__
+
+#include <string>
+
+namespace Ekiga
+{
+
+  /**
+   * @addtogroup services
+   * @{
+   */
+
+  /* An uri or an identifier which is compared and copied a lot : all the
+   * equal strings are stored once, so copying one is copying a pointer,
+   * and comparing two is comparing pointers. The stored strings are never
+   * freed, so don't intern anything which only appears once.
+   *
+   * Interning is thread-safe.
+   */
+  class InternedString
+  {
+  public:
+
+    /* the null string, which is none of the interned ones */
+    InternedString (): str(0)
+    {}
+
+    /* interns the string if it isn't yet */
+    explicit InternedString (const std::string &text);
+
+    explicit InternedString (const char *text);
+
+    /* returns the null string if the text was never interned, without
+     * interning it */
+    static InternedString lookup (const std::string &text);
+
+    bool is_null () const
+    { return str == 0; }
+
+    /* "" for the null string */
+    const char *c_str () const
+    { return str ? str : ""; }
+
+    bool operator== (const InternedString &other) const
+    { return str == other.str; }
+
+    bool operator!= (const InternedString &other) const
+    { return str != other.str; }
+
+    /* an arbitrary order, for maps and sets */
+    bool operator< (const InternedString &other) const
+    { return str < other.str; }
+
+  private:
+
+    const char *str;
+  };
+
+  /**
+   * @}
+   */
+
+};
+
+#endif
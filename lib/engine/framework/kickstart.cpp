@@ -37,14 +37,74 @@
 
 #define KICKSTART_DEBUG 0
 
-#include <algorithm>
+/* how many sparks can prepare at the same time */
+#define KICKSTART_THREADS 4
 
-#if KICKSTART_DEBUG
+#include <algorithm>
 #include <iostream>
-#endif
 
-Ekiga::KickStart::KickStart ()
+#include <glib.h>
+
+struct preparation
+{
+  preparation (Ekiga::Spark* spark_,
+	       GAsyncQueue* done_,
+	       GSourceFunc on_prepared_,
+	       gpointer kickstart_): spark(spark_), done(done_),
+				     on_prepared(on_prepared_),
+				     kickstart(kickstart_), elapsed(0.0)
+  {}
+
+  /* the kickstart keeps a reference in its 'preparing' list : this is a
+   * plain pointer so the worker thread doesn't touch the refcount */
+  Ekiga::Spark* spark;
+  GAsyncQueue* done;
+  GSourceFunc on_prepared;
+  gpointer kickstart;
+  double elapsed;
+};
+
+static void
+prepare_in_thread (gpointer data,
+		   gpointer /*user_data*/)
+{
+  struct preparation* prep = (struct preparation*)data;
+  GTimer* timer = g_timer_new ();
+
+  prep->spark->prepare ();
+
+  prep->elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  GSourceFunc on_prepared = prep->on_prepared;
+  gpointer kickstart = prep->kickstart;
+  g_async_queue_push (prep->done, prep);
+
+  // the main loop will pick the result up
+  g_idle_add (on_prepared, kickstart);
+}
+
+static bool
+dependencies_met (Ekiga::ServiceCore& core,
+		  gmref_ptr<Ekiga::Spark>& spark)
+{
+  std::list<std::string> dependencies;
+
+  spark->get_dependencies (dependencies);
+
+  for (std::list<std::string>::iterator iter = dependencies.begin ();
+       iter != dependencies.end ();
+       ++iter)
+    if ( !core.get (*iter))
+      return false;
+
+  return true;
+}
+
+Ekiga::KickStart::KickStart (): core(NULL), argc(0), argv(NULL), pool(NULL),
+				timer(NULL)
 {
+  done = g_async_queue_new ();
 }
 
 Ekiga::KickStart::~KickStart ()
@@ -69,28 +129,58 @@ Ekiga::KickStart::~KickStart ()
   }
   std::cout << std::endl;
 #endif
+
+  /* wait for the running preparations, then make sure no idle source is
+   * left which would call us back */
+  if (pool != NULL)
+    g_thread_pool_free (pool, FALSE, TRUE);
+  while (g_source_remove_by_user_data (this))
+    ;
+  for (gpointer prep = g_async_queue_try_pop (done);
+       prep != NULL;
+       prep = g_async_queue_try_pop (done))
+    delete (struct preparation*)prep;
+  g_async_queue_unref (done);
+  if (timer != NULL)
+    g_timer_destroy (timer);
+
+  if (g_getenv ("EKIGA_KICKSTART_TIMINGS") != NULL) {
+
+    for (std::map<std::string, Timing>::iterator iter = timings.begin ();
+	 iter != timings.end ();
+	 ++iter)
+      std::clog << "KickStart(timings): " << iter->first
+		<< " prepare=" << (int)(iter->second.prepare * 1000) << "ms"
+		<< " initialize=" << (int)(iter->second.initialize * 1000) << "ms"
+		<< std::endl;
+  }
 }
 
 void
 Ekiga::KickStart::add_spark (gmref_ptr<Ekiga::Spark>& spark)
 {
-  blanks.push_back (spark);
+  if (spark->needs_preparation ())
+    unprepared.push_back (spark);
+  else
+    blanks.push_back (spark);
 #if KICKSTART_DEBUG
   std::cout << "KickStart(add_spark): " << spark->get_name () << std::endl;
 #endif
 }
 
 void
-Ekiga::KickStart::kick (Ekiga::ServiceCore& core,
-			int* argc,
-			char** argv[])
+Ekiga::KickStart::kick (Ekiga::ServiceCore& core_,
+			int* argc_,
+			char** argv_[])
 {
-  std::list<std::string> disabled;
-  bool went_on;
+  core = &core_;
+  argc = *argc_;
+  argv = *argv_;
+  disabled.clear ();
 
-  for (int arg = 2; arg <= *argc; arg++) {
+  for (int arg = 2; arg <= argc; arg++) {
 
-    std::string argument = (*argv)[arg - 1];
+    std::string argument = argv[arg - 1];
     if (argument.find ("--kickstart-disabled=") == 0) {
 
       std::string::size_type last_pos = argument.find_first_of ('=') + 1;
@@ -105,6 +195,114 @@ Ekiga::KickStart::kick (Ekiga::ServiceCore& core,
     }
   }
 
+  if (timer == NULL)
+    timer = g_timer_new ();
+
+  // first start preparing the new sparks in worker threads
+  for (std::list<gmref_ptr<Spark> >::iterator iter = unprepared.begin ();
+       iter != unprepared.end ();
+       ++iter) {
+
+    if (std::find (disabled.begin (),
+		   disabled.end (), (*iter)->get_name ())
+	== disabled.end ()) {
+
+      if (pool == NULL)
+	pool = g_thread_pool_new (prepare_in_thread, NULL,
+				  KICKSTART_THREADS, FALSE, NULL);
+
+      timings[(*iter)->get_name ()] = Timing ();
+      preparing.push_back (*iter);
+      g_thread_pool_push (pool, new preparation (&*(*iter), done,
+						 on_prepared, this), NULL);
+    }
+  }
+  unprepared.clear ();
+
+  // then initialize what we can while the others are preparing : they
+  // will get their chance from the main loop in on_prepared
+  try_sparks (core_, argc_, argv_, disabled);
+}
+
+int
+Ekiga::KickStart::on_prepared (void* data)
+{
+  Ekiga::KickStart* self = (Ekiga::KickStart*)data;
+
+  self->collect_prepared ();
+  self->try_sparks (*self->core, &self->argc, &self->argv, self->disabled);
+
+  if (self->preparing.empty ()
+      && self->timer != NULL) {
+
+    if (g_getenv ("EKIGA_KICKSTART_TIMINGS") != NULL)
+      std::clog << "KickStart(timings): preparations took "
+		<< (int)(g_timer_elapsed (self->timer, NULL) * 1000) << "ms"
+		<< std::endl;
+    g_timer_destroy (self->timer);
+    self->timer = NULL;
+  }
+
+  return FALSE;
+}
+
+void
+Ekiga::KickStart::collect_prepared ()
+{
+  for (gpointer data = g_async_queue_try_pop (done);
+       data != NULL;
+       data = g_async_queue_try_pop (done)) {
+
+    struct preparation* prep = (struct preparation*)data;
+
+    timings[prep->spark->get_name ()].prepare = prep->elapsed;
+
+    for (std::list<gmref_ptr<Spark> >::iterator iter = preparing.begin ();
+	 iter != preparing.end ();
+	 ++iter) {
+
+      if (&*(*iter) == prep->spark) {
+
+#if KICKSTART_DEBUG
+	std::cout << "KickStart(on_prepared): " << (*iter)->get_name ()
+		  << " is prepared" << std::endl;
+#endif
+	blanks.push_back (*iter);
+	preparing.erase (iter);
+	break;
+      }
+    }
+    delete prep;
+  }
+}
+
+bool
+Ekiga::KickStart::try_spark (gmref_ptr<Spark>& spark,
+			     Ekiga::ServiceCore& core,
+			     int* argc,
+			     char** argv[])
+{
+  bool result = false;
+
+  if (dependencies_met (core, spark)) {
+
+    GTimer* timer = g_timer_new ();
+    result = spark->try_initialize_more (core, argc, argv);
+    timings[spark->get_name ()].initialize += g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer);
+  }
+
+  return result;
+}
+
+void
+Ekiga::KickStart::try_sparks (Ekiga::ServiceCore& core,
+			      int* argc,
+			      char** argv[],
+			      const std::list<std::string>& disabled)
+{
+  bool went_on = false;
+
   // this makes sure we loop only if something needs to be done
   went_on = !(blanks.empty () && partials.empty ());
 
@@ -131,7 +329,7 @@ Ekiga::KickStart::kick (Ekiga::ServiceCore& core,
 		       disabled.end (), (*iter)->get_name ())
 	    == disabled.end ()) {
 
-	  result = (*iter)->try_initialize_more (core, argc, argv);
+	  result = try_spark (*iter, core, argc, argv);
 	} else {
 
 #if KICKSTART_DEBUG
@@ -204,7 +402,7 @@ Ekiga::KickStart::kick (Ekiga::ServiceCore& core,
 	   iter != temp.end ();
 	   ++iter) {
 
-	bool result = (*iter)->try_initialize_more (core, argc, argv);
+	bool result = try_spark (*iter, core, argc, argv);
 
 	if (result) {
 
@@ -59,8 +59,22 @@
  * - try_initialize_more shouldn't return 'true' if no new service could be
  * registered ;
  * - states should always evolve as BLANK -> PARTIAL -> FULL : no coming back!
+ *
+ * To get the main window up faster, a spark can also move its heavy work
+ * which doesn't touch the core, the GUI, the configuration or PTLIB into
+ * 'prepare', and return true from 'needs_preparation' : the kickstart runs
+ * those concurrently in a pool of worker threads, and doesn't wait for
+ * them -- the main loop goes on, and each spark is tried as soon as it is
+ * prepared. The try_initialize_more calls always happen in the main
+ * thread. A spark can also declare services it needs which it doesn't
+ * check itself, so it isn't tried before they are in the core.
+ *
+ * Setting the EKIGA_KICKSTART_TIMINGS environment variable makes the
+ * kickstart print how long each spark took.
  */
 
+#include <map>
+
 #include "services.h"
 
 namespace Ekiga
@@ -78,6 +92,18 @@ namespace Ekiga
 
     virtual state get_state () const = 0;
 
+    /* the services which should be in the core before trying this spark */
+    virtual void get_dependencies (std::list<std::string>& /*services*/) const
+    {}
+
+    /* thread-safe work done once, in a worker thread, before the first
+     * try_initialize_more -- if needs_preparation says so */
+    virtual bool needs_preparation () const
+    { return false; }
+
+    virtual void prepare ()
+    {}
+
     // this method is useful for debugging purposes
     virtual const std::string get_name () const = 0;
   };
@@ -92,14 +118,56 @@ namespace Ekiga
 
     void add_spark (gmref_ptr<Spark>& spark);
 
-    /* try to do more with the known blank/partial sparks */
+    /* start preparing the new sparks and try to do more with the known
+     * blank/partial sparks ; the sparks which are being prepared are tried
+     * from the main loop when they're ready, with the same core and
+     * arguments, so the kickstart and the core should live until then */
     void kick (Ekiga::ServiceCore& core,
 	       int* argc,
 	       char** argv[]);
 
   private:
+
+    struct Timing
+    {
+      Timing (): prepare(0.0), initialize(0.0)
+      {}
+
+      double prepare;     // seconds, in a worker thread
+      double initialize;  // seconds, in the main thread
+    };
+
+    /* loop on the blanks and partials as long as something happens */
+    void try_sparks (Ekiga::ServiceCore& core,
+		     int* argc,
+		     char** argv[],
+		     const std::list<std::string>& disabled);
+
+    bool try_spark (gmref_ptr<Spark>& spark,
+		    Ekiga::ServiceCore& core,
+		    int* argc,
+		    char** argv[]);
+
+    /* in the main loop, when preparations are done ; a GSourceFunc */
+    static int on_prepared (void* data);
+
+    void collect_prepared ();
+
+    std::list<gmref_ptr<Spark> > unprepared;
     std::list<gmref_ptr<Spark> > blanks;
     std::list<gmref_ptr<Spark> > partials;
+    std::list<gmref_ptr<Spark> > preparing;
+    std::map<std::string, Timing> timings;
+
+    /* what the last kick got, for the sparks prepared later */
+    Ekiga::ServiceCore* core;
+    int argc;
+    char** argv;
+    std::list<std::string> disabled;
+
+    struct _GThreadPool* pool;
+    struct _GAsyncQueue* done;
+    struct _GTimer* timer;
   };
 };
 
@@ -35,9 +35,23 @@
 
 #include "runtime.h"
 
+#include <algorithm>
+#include <iostream>
+#include <map>
+
 #include <glib.h>
 
+/* Don't run more than that many messages in a single dispatch, so a burst
+ * from the other threads doesn't starve the user interface : what's left
+ * waits for the next loop iteration, which comes at once */
+#define DISPATCH_BATCH 64
+
+/* Dispatched messages are kept for reuse, up to that many : a device
+ * thread reporting an event then doesn't allocate the message */
+#define MESSAGE_POOL_SIZE 64
+
 static GAsyncQueue* queue;
+static GMainContext* context;
 
 /* implementation of the helper functions
  *
@@ -48,15 +62,72 @@ struct message
   message (sigc::slot0<void> _action,
 	   unsigned int _seconds): action(_action),
 				   seconds(_seconds)
-  {}
+  {
+    g_get_current_time (&pushed);
+  }
 
   sigc::slot0<void> action;
   unsigned int seconds;
+  std::string key;   // empty if the message isn't coalesced
+  GTimeVal pushed;
 };
 
+/* the messages with a coalescing key still in the queue ; the mutex
+ * protects the map and the actions of those messages */
+static GStaticMutex pending_mutex = G_STATIC_MUTEX_INIT;
+static std::map<std::string, struct message*> pending;
+
+/* the messages waiting for reuse */
+static GStaticMutex pool_mutex = G_STATIC_MUTEX_INIT;
+static struct message* pool[MESSAGE_POOL_SIZE];
+static unsigned int pool_size;
+
+/* only touched in the main thread, except for the atomic counters */
+static Ekiga::Runtime::Statistics statistics;
+static volatile gint pushed_count;
+static volatile gint coalesced_count;
+static double total_latency; // ms
+
+/* main loop wakeups, counted in the poll function of the context */
+static GPollFunc default_poll;
+static GTimeVal started;
+
+static struct message*
+new_message (sigc::slot0<void> action,
+	     unsigned int seconds)
+{
+  struct message* msg = NULL;
+
+  g_static_mutex_lock (&pool_mutex);
+  if (pool_size > 0)
+    msg = pool[--pool_size];
+  g_static_mutex_unlock (&pool_mutex);
+
+  if (msg == NULL)
+    return new struct message (action, seconds);
+
+  msg->action = action;
+  msg->seconds = seconds;
+  g_get_current_time (&msg->pushed);
+
+  return msg;
+}
+
 static void
 free_message (struct message* msg)
 {
+  /* let what the action holds go now, not when the message is reused */
+  msg->action = sigc::slot0<void> ();
+  msg->key.clear ();
+
+  g_static_mutex_lock (&pool_mutex);
+  if (pool_size < MESSAGE_POOL_SIZE) {
+
+    pool[pool_size++] = msg;
+    msg = NULL;
+  }
+  g_static_mutex_unlock (&pool_mutex);
+
   delete msg;
 }
 
@@ -71,6 +142,51 @@ run_later_or_back_in_main_helper (gpointer data)
   return FALSE;
 }
 
+static void
+push (struct message* msg)
+{
+  g_atomic_int_inc (&pushed_count);
+  g_async_queue_push (queue, (gpointer)msg);
+
+  /* don't let the message wait until the main loop wakes up for some
+   * other reason */
+  g_main_context_wakeup (context);
+}
+
+static void
+account_latency (const struct message* msg)
+{
+  GTimeVal now;
+  double latency;
+
+  g_get_current_time (&now);
+  latency = (now.tv_sec - msg->pushed.tv_sec) * 1000.0
+    + (now.tv_usec - msg->pushed.tv_usec) / 1000.0;
+  if (latency < 0)
+    latency = 0; // the clock went backwards
+
+  statistics.dispatched++;
+  total_latency += latency;
+  statistics.average_latency = total_latency / statistics.dispatched;
+  if (latency > statistics.max_latency)
+    statistics.max_latency = latency;
+}
+
+/* an idle instance should sleep in there for as long as possible : count
+ * how often it comes back from a blocking poll, whatever woke it up */
+static gint
+counting_poll (GPollFD *fds,
+	       guint nfds,
+	       gint timeout)
+{
+  gint result = default_poll (fds, nfds, timeout);
+
+  if (timeout != 0)
+    statistics.wakeups++;
+
+  return result;
+}
+
 /* Implementation of the GSource
  *
  */
@@ -91,7 +207,8 @@ static gboolean
 prepare (GSource *source,
 	 gint *timeout)
 {
-  *timeout = 100;
+  /* no need to poll : pushing a message wakes the context up */
+  *timeout = -1;
 
   return check (source);
 }
@@ -103,19 +220,38 @@ dispatch (GSource *source,
 {
   struct source *src = (struct source *)source;
   struct message *msg = NULL;
+  gint depth = g_async_queue_length (src->queue);
+
+  if (depth > 0 && (unsigned int)depth > statistics.max_queue_depth)
+    statistics.max_queue_depth = depth;
 
-  msg = (struct message *)g_async_queue_pop (src->queue);
+  for (unsigned int count = 0;
+       count < DISPATCH_BATCH
+	 && (msg = (struct message *)g_async_queue_try_pop (src->queue)) != NULL;
+       count++) {
 
-  if (msg->seconds == 0)
-    (void)run_later_or_back_in_main_helper ((gpointer)msg);
-  else
+    if ( !msg->key.empty ()) {
+
+      /* from now on, a new message with that key gets queued again */
+      g_static_mutex_lock (&pending_mutex);
+      pending.erase (msg->key);
+      g_static_mutex_unlock (&pending_mutex);
+    }
+
+    account_latency (msg);
+
+    if (msg->seconds == 0)
+      (void)run_later_or_back_in_main_helper ((gpointer)msg);
+    else
 #if GLIB_CHECK_VERSION (2, 14, 0)
-    g_timeout_add_seconds (msg->seconds,
-			   run_later_or_back_in_main_helper, (gpointer)msg);
+      g_timeout_add_seconds (msg->seconds,
+			     run_later_or_back_in_main_helper, (gpointer)msg);
 #else
-    g_timeout_add (1000 * msg->seconds,
-		   run_later_or_back_in_main_helper, (gpointer)msg);
+      g_timeout_add (1000 * msg->seconds,
+		     run_later_or_back_in_main_helper, (gpointer)msg);
 #endif
+  }
+
   return TRUE;
 }
 
@@ -141,12 +277,17 @@ Ekiga::Runtime::init ()
 {
   // here we get a ref to the queue, which we'll release in quit
   queue = g_async_queue_new_full ((GDestroyNotify)free_message);
+  context = g_main_context_default ();
+
+  g_get_current_time (&started);
+  default_poll = g_main_context_get_poll_func (context);
+  g_main_context_set_poll_func (context, counting_poll);
 
   struct source* source = (struct source *)g_source_new (&source_funcs,
 					  sizeof (struct source));
   source->queue = queue;
   g_async_queue_ref (queue); // give a ref to the source
-  g_source_attach ((GSource *)source, g_main_context_default ());
+  g_source_attach ((GSource *)source, context);
 }
 
 void
@@ -157,13 +298,81 @@ Ekiga::Runtime::run ()
 void
 Ekiga::Runtime::quit ()
 {
+  if (g_getenv ("EKIGA_RUNTIME_STATISTICS") != NULL) {
+
+    Statistics stats;
+
+    get_statistics (stats);
+    std::clog << "Runtime: " << stats.pushed << " messages pushed, "
+	      << stats.coalesced << " coalesced, "
+	      << stats.dispatched << " dispatched" << std::endl
+	      << "Runtime: queue depth at most " << stats.max_queue_depth
+	      << ", latency " << stats.average_latency << " ms on average, "
+	      << stats.max_latency << " ms at most" << std::endl
+	      << "Runtime: " << stats.wakeups << " main loop wakeups, "
+	      << stats.wakeups_per_second << " per second" << std::endl;
+  }
+
+  g_static_mutex_lock (&pending_mutex);
+  pending.clear ();
+  g_static_mutex_unlock (&pending_mutex);
+
   g_async_queue_unref (queue);
   queue = NULL;
+
+  g_static_mutex_lock (&pool_mutex);
+  while (pool_size > 0)
+    delete pool[--pool_size];
+  g_static_mutex_unlock (&pool_mutex);
 }
 
 void
 Ekiga::Runtime::run_in_main (sigc::slot0<void> action,
 			     unsigned int seconds)
 {
-  g_async_queue_push (queue, (gpointer)(new struct message (action, seconds)));
+  push (new_message (action, seconds));
+}
+
+void
+Ekiga::Runtime::run_in_main_coalesced (const std::string key,
+				       sigc::slot0<void> action)
+{
+  std::map<std::string, struct message*>::iterator iter;
+
+  g_static_mutex_lock (&pending_mutex);
+
+  iter = pending.find (key);
+  if (iter != pending.end ()) {
+
+    /* the previous update didn't run yet : only the new one will -- and
+     * it keeps the place (and timestamp) of the old one in the queue */
+    iter->second->action = action;
+    g_atomic_int_inc (&coalesced_count);
+  }
+  else {
+
+    struct message* msg = new_message (action, 0);
+    msg->key = key;
+    pending[key] = msg;
+    push (msg);
+  }
+
+  g_static_mutex_unlock (&pending_mutex);
+}
+
+void
+Ekiga::Runtime::get_statistics (Statistics& stats)
+{
+  stats = statistics;
+  stats.queue_depth = queue ? std::max (g_async_queue_length (queue), 0) : 0;
+  stats.pushed = g_atomic_int_get (&pushed_count);
+  stats.coalesced = g_atomic_int_get (&coalesced_count);
+
+  GTimeVal now;
+  double elapsed;
+
+  g_get_current_time (&now);
+  elapsed = (now.tv_sec - started.tv_sec) + (now.tv_usec - started.tv_usec) / 1000000.0;
+  if (elapsed > 0)
+    stats.wakeups_per_second = stats.wakeups / elapsed;
 }
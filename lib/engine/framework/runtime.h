@@ -64,6 +64,25 @@ namespace Ekiga
 
   namespace Runtime
   {
+    /* what the cross-thread dispatcher went through since init */
+    struct Statistics
+    {
+      Statistics (): queue_depth(0), max_queue_depth(0), pushed(0),
+		     coalesced(0), dispatched(0), average_latency(0.0),
+		     max_latency(0.0), wakeups(0), wakeups_per_second(0.0)
+      {}
+
+      unsigned int queue_depth;     // messages waiting right now
+      unsigned int max_queue_depth;
+      unsigned int pushed;
+      unsigned int coalesced;       // updates which replaced a waiting one
+      unsigned int dispatched;
+      double average_latency;       // ms between push and dispatch
+      double max_latency;           // ms
+      unsigned int wakeups;         // times the main loop left a blocking poll
+      double wakeups_per_second;    // on average since init
+    };
+
     void init (); // depends on the implementation
 
     void run (); // depends on the implementation
@@ -73,6 +92,16 @@ namespace Ekiga
     void run_in_main (sigc::slot0<void> action,
 		      unsigned int seconds = 0); // depends on the implementation
 
+    /* Same as above, but if a message with the same key is still waiting,
+     * the new action replaces it instead of being queued after it : this
+     * is for state updates, where only the last one matters.
+     */
+    void run_in_main_coalesced (const std::string key,
+				sigc::slot0<void> action); // depends on the implementation
+
+    /* to be called from the main thread */
+    void get_statistics (Statistics& stats); // depends on the implementation
+
     inline void emit_signal_in_main (sigc::signal0<void> sign)
     {
       run_in_main (sigc::bind (sigc::ptr_fun (emit_signal_in_main_helper), sign));
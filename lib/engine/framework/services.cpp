@@ -34,11 +34,35 @@
  */
 
 #include <iostream>
+#include <cstdio>
+
+#include <unistd.h>
+#include <glib.h>
 
 #include "services.h"
 
+/* the resident memory of the process, in kB (0 if it can't be known) */
+static unsigned long
+resident_kb ()
+{
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  FILE *statm = fopen ("/proc/self/statm", "r");
+
+  if (statm == NULL)
+    return 0;
+
+  if (fscanf (statm, "%lu %lu", &size, &resident) != 2)
+    resident = 0;
+  fclose (statm);
+
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
 Ekiga::ServiceCore::~ServiceCore ()
 {
+  services_by_name.clear ();
+
   /* this frees the memory, if we're the only to hold references,
    * and frees the last first -- so there's no problem
    */
@@ -51,9 +75,10 @@ Ekiga::ServiceCore::add (gmref_ptr<Service> service)
 {
   bool result = false;
 
-  if ( !get (service->get_name ())) {
+  if ( !find (service->get_name ())) {
 
     services.push_front (service);
+    services_by_name[service->get_name ()] = service.get ();
     service_added (service);
     result = true;
   } else {
@@ -64,18 +89,96 @@ Ekiga::ServiceCore::add (gmref_ptr<Service> service)
   return result;
 }
 
+bool
+Ekiga::ServiceCore::add_lazy (const std::string name,
+			      const std::string group,
+			      sigc::slot0<gmref_ptr<Service> > factory)
+{
+  LazyService lazy;
+
+  if (find (name) || lazy_services.find (name) != lazy_services.end ())
+    return false;
+
+  lazy.name = name;
+  lazy.group = group;
+  lazy.factory = factory;
+
+  if (g_getenv ("EKIGA_EAGER_SERVICES") != NULL)
+    (void)build (lazy);
+  else
+    lazy_services[name] = lazy;
+
+  return true;
+}
+
+void
+Ekiga::ServiceCore::materialize (const std::string group)
+{
+  std::list<LazyService> temp;
+
+  for (std::map<std::string, LazyService>::iterator iter = lazy_services.begin ();
+       iter != lazy_services.end ();
+       /* nothing */)
+    if (iter->second.group == group) {
+
+      temp.push_back (iter->second);
+      lazy_services.erase (iter++);
+    } else
+      ++iter;
+
+  for (std::list<LazyService>::iterator iter = temp.begin ();
+       iter != temp.end ();
+       ++iter)
+    (void)build (*iter);
+}
+
 gmref_ptr<Ekiga::Service>
 Ekiga::ServiceCore::get (const std::string name)
 {
-  gmref_ptr<Service> result;
+  gmref_ptr<Service> result = find (name);
 
-  for (std::list<gmref_ptr<Service> >::iterator iter = services.begin ();
-       iter != services.end () && !result;
-       iter++)
-    if (name == (*iter)->get_name ()) {
+  if ( !result) {
+
+    std::map<std::string, LazyService>::iterator iter = lazy_services.find (name);
+    if (iter != lazy_services.end ()) {
 
-      result = *iter;
+      LazyService lazy = iter->second;
+      lazy_services.erase (iter);
+      result = build (lazy);
     }
+  }
+
+  return result;
+}
+
+gmref_ptr<Ekiga::Service>
+Ekiga::ServiceCore::find (const std::string name)
+{
+  std::map<std::string, Service*>::iterator iter = services_by_name.find (name);
+
+  if (iter != services_by_name.end ())
+    return gmref_ptr<Service> (iter->second);
+
+  return gmref_ptr<Service> ();
+}
+
+gmref_ptr<Ekiga::Service>
+Ekiga::ServiceCore::build (LazyService lazy)
+{
+  GTimer* timer = g_timer_new ();
+  unsigned long resident = resident_kb ();
+  gmref_ptr<Service> result = lazy.factory ();
+
+  if (result && !find (lazy.name))
+    add (result);
+
+  if (g_getenv ("EKIGA_KICKSTART_TIMINGS") != NULL)
+    std::clog << "ServiceCore(build): " << lazy.name
+	      << " took " << (int)(g_timer_elapsed (timer, NULL) * 1000) << "ms"
+	      << ", resident memory " << resident << "kB -> " << resident_kb () << "kB"
+	      << std::endl;
+  g_timer_destroy (timer);
+
   return result;
 }
 
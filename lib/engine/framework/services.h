@@ -38,11 +38,24 @@
 
 /* We want to register some named services to a central location : this is
  * it!
+ *
+ * Some services are heavy and seldom used (address book sources connecting
+ * to remote servers, for example), so they can be registered lazily : only
+ * a factory is given, and it is only called when the service is first asked
+ * for with 'get', or when its group is materialized (for example when the
+ * window showing that group is opened).
+ *
+ * Setting the EKIGA_EAGER_SERVICES environment variable makes the lazy
+ * services get built at once, to compare both behaviours ; with
+ * EKIGA_KICKSTART_TIMINGS set too, each build reports how long it took and
+ * how much the resident memory grew, so the startup cost of the lazy
+ * services can be read in both cases.
  */
 
 #include "gmref.h"
 
 #include <list>
+#include <map>
 #include <string>
 #include <sigc++/sigc++.h>
 
@@ -74,16 +87,91 @@ namespace Ekiga
 
     bool add (gmref_ptr<Service> service);
 
+    /* the factory should add the service to the core itself, along with
+     * whatever other plugging it needs, and return it */
+    bool add_lazy (const std::string name,
+		   const std::string group,
+		   sigc::slot0<gmref_ptr<Service> > factory);
+
+    void materialize (const std::string group);
+
     gmref_ptr<Service> get (const std::string name);
 
+    /* same as above, but already cast to the wanted type */
+    template<typename T>
+    gmref_ptr<T> get (const std::string name)
+    { return gmref_ptr<T> (get (name)); }
+
     void dump (std::ostream &stream) const;
 
     sigc::signal1<void, gmref_ptr<Service> > service_added;
 
   private:
 
+    struct LazyService
+    {
+      std::string name;
+      std::string group;
+      sigc::slot0<gmref_ptr<Service> > factory;
+    };
+
+    gmref_ptr<Service> find (const std::string name);
+
+    gmref_ptr<Service> build (LazyService lazy);
+
+    /* the list keeps the order of registration, which is used for the
+     * destruction, and the map makes the lookups cheap */
     std::list<gmref_ptr<Service> > services;
+    std::map<std::string, Service*> services_by_name;
+    std::map<std::string, LazyService> lazy_services;
+
+  };
+
+  /* A typed handle on a service : the service is looked up and cast the
+   * first time the handle is used, and then kept, so code running often
+   * (timers, media paths) doesn't pay for it each time.
+   */
+  template<typename T>
+  class ServiceHandle
+  {
+  public:
 
+    ServiceHandle (): core(0)
+    {}
+
+    ServiceHandle (ServiceCore& core_,
+		   const std::string name_): core(&core_), name(name_)
+    {}
+
+    void bind (ServiceCore& core_,
+	       const std::string name_)
+    {
+      core = &core_;
+      name = name_;
+      service.reset ();
+    }
+
+    gmref_ptr<T> get ()
+    { return resolve (); }
+
+    T* operator-> ()
+    { return resolve ().get (); }
+
+    operator bool ()
+    { return resolve (); }
+
+  private:
+
+    const gmref_ptr<T>& resolve ()
+    {
+      if ( !service && core != 0)
+	service = core->get<T> (name);
+      return service;
+    }
+
+    ServiceCore* core;
+    std::string name;
+    gmref_ptr<T> service;
   };
 
   class BasicService: public Service
@@ -49,9 +49,10 @@
  */
 struct _AddressBookWindowPrivate
 {
-  _AddressBookWindowPrivate (Ekiga::ContactCore & _core):core (_core) { }
+  _AddressBookWindowPrivate (Ekiga::ContactCore & _core):core (_core), populated (false) { }
 
   Ekiga::ContactCore & core;
+  bool populated;
   std::vector<sigc::connection> connections;
   GtkWidget *tree_view;
   GtkWidget *notebook;
@@ -92,6 +93,16 @@ static GObjectClass *parent_class = NULL;
 static void on_core_updated (gpointer data);
 
 
+/* DESCRIPTION  : Called when the window is shown.
+ * BEHAVIOR     : The first time, populates the window and follows the
+ *                sources from then on : visiting the sources builds the
+ *                lazy ones, which isn't done before it's needed.
+ * PRE          : The given GtkWidget pointer must be an SearchBook GObject.
+ */
+static void on_window_show (GtkWidget *widget,
+			    gpointer data);
+
+
 /* DESCRIPTION  : Called at startup to populate the window
  * BEHAVIOR     : 
  * PRE          : The given GtkWidget pointer must be an SearchBook GObject.
@@ -250,6 +261,37 @@ on_core_updated (gpointer data)
 }
 
 
+static void
+on_window_show (GtkWidget * /*widget*/,
+		gpointer data)
+{
+  AddressBookWindow *self = ADDRESSBOOK_WINDOW (data);
+  Ekiga::ContactCore &core = self->priv->core;
+  sigc::connection conn;
+
+  if (self->priv->populated)
+    return;
+  self->priv->populated = true;
+
+  /* first what is there, then what comes */
+  core.visit_sources (sigc::bind_return (sigc::bind (sigc::ptr_fun (on_source_added),
+						     (gpointer) self), true));
+
+  conn = core.source_added.connect (sigc::bind (sigc::ptr_fun (on_source_added), (gpointer) self));
+  self->priv->connections.push_back (conn);
+
+  conn = core.book_updated.connect (sigc::bind (sigc::ptr_fun (on_book_updated),
+                                                (gpointer) self));
+  self->priv->connections.push_back (conn);
+  conn = core.book_added.connect (sigc::bind (sigc::ptr_fun (on_book_added), 
+                                              (gpointer) self));
+  self->priv->connections.push_back (conn);
+  conn =
+    core.book_removed.connect (sigc::bind (sigc::ptr_fun (on_book_removed), 
+                                           (gpointer) self));
+  self->priv->connections.push_back (conn);
+}
+
 static void
 on_source_added (Ekiga::SourcePtr source,
 		 gpointer data)
@@ -754,25 +796,11 @@ addressbook_window_new (Ekiga::ContactCore &core)
                     G_CALLBACK (on_notebook_realize), self);
   gtk_paned_add2 (GTK_PANED (hpaned), self->priv->notebook);
 
-  conn = core.source_added.connect (sigc::bind (sigc::ptr_fun (on_source_added), (gpointer) self));
-  self->priv->connections.push_back (conn);
-
-  conn = core.book_updated.connect (sigc::bind (sigc::ptr_fun (on_book_updated),
-                                                (gpointer) self));
-  self->priv->connections.push_back (conn);
-  conn = core.book_added.connect (sigc::bind (sigc::ptr_fun (on_book_added), 
-                                              (gpointer) self));
-  self->priv->connections.push_back (conn);
-  conn =
-    core.book_removed.connect (sigc::bind (sigc::ptr_fun (on_book_removed), 
-                                           (gpointer) self));
-  self->priv->connections.push_back (conn);
-
   conn = core.questions.connect (sigc::bind (sigc::ptr_fun (on_handle_questions), (gpointer) self));
   self->priv->connections.push_back (conn);
 
-  core.visit_sources (sigc::bind_return (sigc::bind (sigc::ptr_fun (on_source_added),
-						     (gpointer) self), true));
+  g_signal_connect (self, "show",
+		    G_CALLBACK (on_window_show), self);
 
   return GTK_WIDGET (self);
 }
@@ -41,6 +41,7 @@
 #include <glib/gi18n.h>
 
 #include "book-view-gtk.h"
+#include "contact-list-model.h"
 
 #include "gmstockicons.h"
 #include "menu-builder-tools.h"
@@ -51,15 +52,17 @@
  */
 struct _BookViewGtkPrivate
 {
-  _BookViewGtkPrivate (Ekiga::BookPtr book_) : book (book_) { }
+  _BookViewGtkPrivate (Ekiga::BookPtr book_) : book (book_), model (NULL), icon (NULL) { }
 
   GtkTreeView *tree_view;
+  GtkTreeModel *model;
   GtkWidget *vbox;
   GtkWidget *entry;
   GtkWidget *statusbar;
   GtkWidget *scrolled_window;
 
   Ekiga::BookPtr book;
+  GdkPixbuf *icon;
   std::list<sigc::connection> connections;
 };
 
@@ -120,6 +123,15 @@ static void on_selection_changed (GtkTreeSelection * /*selection*/,
                                   gpointer data);
 
 
+/* DESCRIPTION  : Called when the text of the filter GtkEntry changes.
+ * BEHAVIOR     : Only shows the contacts whose name begins with the text,
+ *                without asking the Book.
+ * PRE          : A valid pointer to the BookViewGtk.
+ */
+static void on_entry_changed_cb (GtkWidget *entry,
+                                 gpointer data);
+
+
 /* DESCRIPTION  : Called when the user activates the filter GtkEntry.
  * BEHAVIOR     : Updates the Book search filter, which triggers
  *                a refresh.
@@ -149,6 +161,28 @@ static gint on_contact_clicked (GtkWidget *tree_view,
 
 /* Static functions */
 
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Compute the cell of the given column for the contact,
+ *                when the tree view shows its row.
+ * PRE          : The gpointer must point to the BookViewGtk GObject.
+ */
+static void
+book_view_gtk_fill_row (Ekiga::Contact &contact,
+                        gint column,
+                        GValue *value,
+                        gpointer data);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Only show the contacts whose name key begins with the
+ *                prefix, all of them if it is empty.
+ * PRE          : /
+ */
+static void
+book_view_gtk_set_filter (BookViewGtk *self,
+                          const std::string &prefix);
+
+
 /* DESCRIPTION  : /
  * BEHAVIOR     : Add the contact to the BookViewGtk.
  * PRE          : /
@@ -164,8 +198,7 @@ book_view_gtk_add_contact (BookViewGtk *self,
  */
 static void
 book_view_gtk_update_contact (BookViewGtk *self,
-                              Ekiga::ContactPtr contact,
-                              GtkTreeIter *iter);
+                              Ekiga::ContactPtr contact);
 
 
 /* DESCRIPTION  : /
@@ -177,17 +210,6 @@ book_view_gtk_remove_contact (BookViewGtk *self,
                               Ekiga::ContactPtr contact);
 
 
-/* DESCRIPTION  : /
- * BEHAVIOR     : Return TRUE and update the GtkTreeIter if we found
- *                the iter corresponding to the Contact in the BookViewGtk.
- * PRE          : /
- */
-static gboolean
-book_view_gtk_find_iter_for_contact (BookViewGtk *view,
-                                     Ekiga::ContactPtr contact,
-                                     GtkTreeIter *iter);
-
-
 
 /* Implementation of the callbacks */
 static void
@@ -202,14 +224,7 @@ static void
 on_contact_updated (Ekiga::ContactPtr contact,
 		    gpointer data)
 {
-  BookViewGtk *view = NULL;
-  GtkTreeIter iter;
-
-  view = BOOK_VIEW_GTK (data);
-
-  if (book_view_gtk_find_iter_for_contact (view, contact, &iter)) {
-    book_view_gtk_update_contact (view, contact, &iter);
-  }
+  book_view_gtk_update_contact (BOOK_VIEW_GTK (data), contact);
 }
 
 
@@ -250,6 +265,17 @@ on_selection_changed (GtkTreeSelection * /*selection*/,
 }
 
 
+static void
+on_entry_changed_cb (GtkWidget *entry,
+                     gpointer data)
+{
+  const char *entry_text = gtk_entry_get_text (GTK_ENTRY (entry));
+
+  book_view_gtk_set_filter (BOOK_VIEW_GTK (data),
+                            contact_list_model_name_key (entry_text));
+}
+
+
 static void
 on_entry_activated_cb (GtkWidget *entry,
                        gpointer data)
@@ -257,6 +283,9 @@ on_entry_activated_cb (GtkWidget *entry,
   GdkCursor *cursor = NULL;
   const char *entry_text = gtk_entry_get_text (GTK_ENTRY (entry));
 
+  /* the Book searches the way it wants, not only by names */
+  book_view_gtk_set_filter (BOOK_VIEW_GTK (data), "");
+
   cursor = gdk_cursor_new (GDK_WATCH);
   gdk_window_set_cursor (GTK_WIDGET (data)->window, cursor);
   gdk_cursor_unref (cursor);
@@ -341,89 +370,85 @@ on_contact_clicked (GtkWidget *tree_view,
 
 /* Implementation of the static functions */
 static void
-book_view_gtk_add_contact (BookViewGtk *self,
-                           Ekiga::ContactPtr contact)
+book_view_gtk_fill_row (Ekiga::Contact &contact,
+                        gint column,
+                        GValue *value,
+                        gpointer data)
 {
-  GtkTreeModel *model = NULL;
-  GtkListStore *store = NULL;
-  GtkTreeIter iter;
+  BookViewGtk *self = BOOK_VIEW_GTK (data);
 
-  model = gtk_tree_view_get_model (self->priv->tree_view);
-  store = GTK_LIST_STORE (model);
+  switch (column) {
 
-  gtk_list_store_append (store, &iter);
-  gtk_list_store_set (store, &iter, COLUMN_CONTACT_POINTER, contact.get (), -1);
-  book_view_gtk_update_contact (self, contact, &iter);
-}
+  case COLUMN_CONTACT_POINTER:
 
+    g_value_set_pointer (value, &contact);
+    break;
 
-static void
-book_view_gtk_update_contact (BookViewGtk *self,
-			      Ekiga::ContactPtr contact,
-			      GtkTreeIter *iter)
-{
-  GdkPixbuf *icon = NULL;
-  GtkListStore *store = NULL;
+  case COLUMN_PIXBUF:
 
-  store = GTK_LIST_STORE (gtk_tree_view_get_model (self->priv->tree_view));
-  icon = gtk_widget_render_icon (GTK_WIDGET (self->priv->tree_view),
-                                 GM_STOCK_STATUS_UNKNOWN, GTK_ICON_SIZE_MENU, NULL);
+    /* the same for all rows */
+    if (self->priv->icon == NULL)
+      self->priv->icon = gtk_widget_render_icon (GTK_WIDGET (self->priv->tree_view),
+                                                 GM_STOCK_STATUS_UNKNOWN,
+                                                 GTK_ICON_SIZE_MENU, NULL);
+    g_value_set_object (value, self->priv->icon);
+    break;
 
-  gtk_list_store_set (store, iter,
-                      COLUMN_PIXBUF, icon,
-		      COLUMN_NAME, contact->get_name ().c_str (),
-		      -1);
-  g_object_unref (icon);
+  case COLUMN_NAME:
 
-  if (GDK_IS_WINDOW (GTK_WIDGET (self)->window))
-    gdk_window_set_cursor (GTK_WIDGET (self)->window, NULL);
+    g_value_set_string (value, contact.get_name ().c_str ());
+    break;
+
+  default:
+    break;
+  }
 }
 
 
 static void
-book_view_gtk_remove_contact (BookViewGtk *self,
-                              Ekiga::ContactPtr contact)
+book_view_gtk_set_filter (BookViewGtk *self,
+                          const std::string &prefix)
 {
-  GtkTreeModel *model = NULL;
-  GtkListStore *store = NULL;
-  GtkTreeIter iter;
+  /* the tree view would follow the rows leaving or entering the range one
+   * by one : it is faster to give it the new range at once */
+  gtk_tree_view_set_model (self->priv->tree_view, NULL);
+  contact_list_model_set_filter (CONTACT_LIST_MODEL (self->priv->model), prefix);
+  gtk_tree_view_set_model (self->priv->tree_view, self->priv->model);
+}
 
-  model = gtk_tree_view_get_model (self->priv->tree_view);
-  store = GTK_LIST_STORE (model);
 
-  while (book_view_gtk_find_iter_for_contact (self, contact, &iter))
-    gtk_list_store_remove (store, &iter);
+static void
+book_view_gtk_add_contact (BookViewGtk *self,
+                           Ekiga::ContactPtr contact)
+{
+  contact_list_model_add (CONTACT_LIST_MODEL (self->priv->model), contact,
+                          contact_list_model_name_key (contact->get_name ()));
 
   if (GDK_IS_WINDOW (GTK_WIDGET (self)->window))
     gdk_window_set_cursor (GTK_WIDGET (self)->window, NULL);
 }
 
 
-static gboolean
-book_view_gtk_find_iter_for_contact (BookViewGtk *view,
-                                     Ekiga::ContactPtr contact,
-                                     GtkTreeIter *iter)
+static void
+book_view_gtk_update_contact (BookViewGtk *self,
+			      Ekiga::ContactPtr contact)
 {
-  GtkTreeModel *model = NULL;
-  gboolean found = FALSE;
+  contact_list_model_update (CONTACT_LIST_MODEL (self->priv->model), contact,
+                             contact_list_model_name_key (contact->get_name ()));
 
-  model = gtk_tree_view_get_model (view->priv->tree_view);
-
-  if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), iter)) {
-
-    do {
+  if (GDK_IS_WINDOW (GTK_WIDGET (self)->window))
+    gdk_window_set_cursor (GTK_WIDGET (self)->window, NULL);
+}
 
-      Ekiga::Contact *iter_contact = NULL;
-      gtk_tree_model_get (model, iter,
-                          COLUMN_CONTACT_POINTER, &iter_contact,
-                          -1);
-      if (iter_contact == contact.get ())
-        found = TRUE;
 
-    } while (!found && gtk_tree_model_iter_next (model, iter));
-  }
+static void
+book_view_gtk_remove_contact (BookViewGtk *self,
+                              Ekiga::ContactPtr contact)
+{
+  contact_list_model_remove (CONTACT_LIST_MODEL (self->priv->model), contact);
 
-  return found;
+  if (GDK_IS_WINDOW (GTK_WIDGET (self)->window))
+    gdk_window_set_cursor (GTK_WIDGET (self)->window, NULL);
 }
 
 
@@ -450,11 +475,24 @@ book_view_gtk_dispose (GObject *obj)
 					  NULL,	/* closure */
 					  NULL,	/* func */
 					  view); /* data */
-    gtk_list_store_clear (GTK_LIST_STORE (gtk_tree_view_get_model (view->priv->tree_view)));
+    gtk_tree_view_set_model (view->priv->tree_view, NULL);
 
     view->priv->tree_view = NULL;
   }
 
+  if (view->priv->model) {
+
+    contact_list_model_clear (CONTACT_LIST_MODEL (view->priv->model));
+    g_object_unref (view->priv->model);
+    view->priv->model = NULL;
+  }
+
+  if (view->priv->icon) {
+
+    g_object_unref (view->priv->icon);
+    view->priv->icon = NULL;
+  }
+
   parent_class->dispose (obj);
 }
 
@@ -532,7 +570,11 @@ book_view_gtk_new (Ekiga::BookPtr book)
   GtkWidget *button = NULL;
 
   GtkTreeSelection *selection = NULL;
-  GtkListStore *store = NULL;
+  const GType types[COLUMN_NUMBER] = {
+    G_TYPE_POINTER,
+    GDK_TYPE_PIXBUF,
+    G_TYPE_STRING
+  };
   GtkTreeViewColumn *column = NULL;
   GtkCellRenderer *renderer = NULL;
 
@@ -564,13 +606,13 @@ book_view_gtk_new (Ekiga::BookPtr book)
   g_signal_connect (G_OBJECT (result->priv->tree_view), "event-after",
 		    G_CALLBACK (on_contact_clicked), result);
 
-  store = gtk_list_store_new (COLUMN_NUMBER,
-			      G_TYPE_POINTER,
-                              GDK_TYPE_PIXBUF,
-                              G_TYPE_STRING);
-
-  gtk_tree_view_set_model (result->priv->tree_view, GTK_TREE_MODEL (store));
-  g_object_unref (store);
+  /* the view keeps a reference on the model, as it may be detached from
+   * the tree view while filtering */
+  result->priv->model = contact_list_model_new (COLUMN_NUMBER, types,
+                                                book_view_gtk_fill_row, result);
+  contact_list_model_set_key_column (CONTACT_LIST_MODEL (result->priv->model),
+                                     COLUMN_NAME);
+  gtk_tree_view_set_model (result->priv->tree_view, result->priv->model);
 
   /* Name */
   column = gtk_tree_view_column_new ();
@@ -587,12 +629,16 @@ book_view_gtk_new (Ekiga::BookPtr book)
                                        "text", COLUMN_NAME,
                                        NULL);
 
+  /* the model is sorted by name, and the rows all have the same height :
+   * the tree view then only asks the model about the rows it shows */
   gtk_tree_view_column_set_title (column, _("Full Name"));
   gtk_tree_view_column_set_sort_column_id (column, COLUMN_NAME);
   gtk_tree_view_column_set_sizing (GTK_TREE_VIEW_COLUMN (column),
-                                   GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+                                   GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_column_set_expand (column, TRUE);
   gtk_tree_view_column_set_resizable (column, true);
   gtk_tree_view_append_column (GTK_TREE_VIEW (result->priv->tree_view), column);
+  gtk_tree_view_set_fixed_height_mode (result->priv->tree_view, TRUE);
 
   /* The Search Box */
   hbox = gtk_hbox_new (FALSE, 0);
@@ -603,6 +649,8 @@ book_view_gtk_new (Ekiga::BookPtr book)
   gtk_box_pack_start (GTK_BOX (hbox), result->priv->entry, TRUE, TRUE, 2);
   gtk_box_pack_start (GTK_BOX (hbox), button, FALSE, FALSE, 2);
   gtk_box_pack_start (GTK_BOX (result->priv->vbox), hbox, FALSE, FALSE, 0);
+  g_signal_connect (result->priv->entry, "changed",
+                    G_CALLBACK (on_entry_changed_cb), result);
   g_signal_connect (result->priv->entry, "activate",
                     G_CALLBACK (on_entry_activated_cb), result);
   g_signal_connect (button, "clicked",
@@ -41,6 +41,7 @@
 #include <glib/gi18n.h>
 
 #include "call-history-view-gtk.h"
+#include "contact-list-model.h"
 
 #include "menu-builder-tools.h"
 #include "menu-builder-gtk.h"
@@ -67,62 +68,104 @@ destroy_connections (gpointer data,
   delete conns;
 }
 
-/* react to a new call being inserted in history */
+/* the most recent calls first */
+static std::string
+history_key (gmref_ptr<History::Contact> hcontact)
+{
+  std::stringstream key;
+
+  key << std::setw (20) << std::setfill ('0')
+      << (G_MAXUINT64 - (guint64) hcontact->get_call_start ());
+
+  return key.str ();
+}
+
+/* compute the cells of a row when the view shows it */
 static void
-on_contact_added (Ekiga::ContactPtr contact,
-		  GtkListStore *store)
+fill_row (Ekiga::Contact &contact,
+	  gint column,
+	  GValue *value,
+	  gpointer /*data*/)
 {
-  time_t t;
-  struct tm *timeinfo = NULL;
-  char buffer [80];
-  std::stringstream info;
-  const gchar *id = NULL;
+  History::Contact *hcontact = dynamic_cast<History::Contact *> (&contact);
 
-  gmref_ptr<History::Contact> hcontact = contact;
-  GtkTreeIter iter;
+  switch (column) {
+
+  case COLUMN_CONTACT:
+
+    g_value_set_pointer (value, &contact);
+    break;
+
+  case COLUMN_PIXBUF:
 
-  if (hcontact) {
+    if (hcontact == NULL)
+      break;
 
     switch (hcontact->get_type ()) {
 
     case History::RECEIVED:
 
-      id = GM_STOCK_CALL_RECEIVED;
+      g_value_set_static_string (value, GM_STOCK_CALL_RECEIVED);
       break;
 
     case History::PLACED:
 
-      id = GM_STOCK_CALL_PLACED;
+      g_value_set_static_string (value, GM_STOCK_CALL_PLACED);
       break;
 
     case History::MISSED:
 
-      id = GM_STOCK_CALL_MISSED;
+      g_value_set_static_string (value, GM_STOCK_CALL_MISSED);
       break;
 
     default:
-      id = GTK_STOCK_MISSING_IMAGE;
+      g_value_set_static_string (value, GTK_STOCK_MISSING_IMAGE);
     }
-  }
+    break;
+
+  case COLUMN_NAME:
+
+    g_value_set_string (value, contact.get_name ().c_str ());
+    break;
 
-  t = hcontact->get_call_start ();
-  timeinfo = localtime (&t);
-  if (timeinfo != NULL) {
-    strftime (buffer, 80, "%x %X", timeinfo);
-    info << buffer;
-    if (!hcontact->get_call_duration ().empty ())
-      info << " (" << hcontact->get_call_duration () << ")";
+  case COLUMN_INFO:
+
+    if (hcontact != NULL) {
+
+      time_t t;
+      struct tm *timeinfo = NULL;
+      char buffer [80];
+      std::stringstream info;
+
+      t = hcontact->get_call_start ();
+      timeinfo = localtime (&t);
+      if (timeinfo != NULL) {
+	strftime (buffer, 80, "%x %X", timeinfo);
+	info << buffer;
+	if (!hcontact->get_call_duration ().empty ())
+	  info << " (" << hcontact->get_call_duration () << ")";
+      }
+      else
+	info << hcontact->get_call_duration ();
+
+      g_value_set_string (value, info.str ().c_str ());
+    }
+    break;
+
+  default:
+    break;
   }
-  else
-    info << hcontact->get_call_duration ();
-
-  gtk_list_store_prepend (store, &iter);
-  gtk_list_store_set (store, &iter,
-		      COLUMN_CONTACT, contact.get (),
-		      COLUMN_PIXBUF, id,
-		      COLUMN_NAME, contact->get_name ().c_str (),
-		      COLUMN_INFO, info.str ().c_str (),
-		      -1);
+}
+
+/* react to a new call being inserted in history */
+static void
+on_contact_added (Ekiga::ContactPtr contact,
+		  ContactListModel *model)
+{
+  gmref_ptr<History::Contact> hcontact = contact;
+
+  if (hcontact)
+    contact_list_model_add (model, contact, history_key (hcontact));
 }
 
 /* react to user clicks */
@@ -193,7 +236,13 @@ call_history_view_gtk_new (gmref_ptr<History::Book> book)
 {
   GtkWidget *result = NULL;
   std::list<sigc::connection> *conns = NULL;
-  GtkListStore *store = NULL;
+  const GType types[COLUMN_NUMBER] = {
+    G_TYPE_POINTER,
+    G_TYPE_STRING,
+    G_TYPE_STRING,
+    G_TYPE_STRING
+  };
+  GtkTreeModel *model = NULL;
   GtkWidget *tree = NULL;
   GtkTreeViewColumn *column = NULL;
   GtkCellRenderer *renderer = NULL;
@@ -210,20 +259,19 @@ call_history_view_gtk_new (gmref_ptr<History::Book> book)
   conns = new std::list<sigc::connection>;
   g_object_weak_ref (G_OBJECT (result), destroy_connections, (gpointer)conns);
 
-  /* build the store then the tree */
-  store = gtk_list_store_new (COLUMN_NUMBER,
-			      G_TYPE_POINTER,
-			      G_TYPE_STRING,
-			      G_TYPE_STRING,
-			      G_TYPE_STRING);
+  /* build the model then the tree : the rows all have the same height,
+   * so the tree only asks the model about the rows it shows */
+  model = contact_list_model_new (COLUMN_NUMBER, types, fill_row, NULL);
 
-  tree = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
-  g_object_unref (store);
+  tree = gtk_tree_view_new_with_model (model);
+  g_object_unref (model);
   gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tree), FALSE);
   gtk_container_add (GTK_CONTAINER (result), tree);
 
   /* one column should be enough for everyone */
   column = gtk_tree_view_column_new ();
+  gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_column_set_expand (column, TRUE);
 
   /* show icon */
   renderer = gtk_cell_renderer_pixbuf_new ();
@@ -239,6 +287,7 @@ call_history_view_gtk_new (gmref_ptr<History::Book> book)
   gtk_tree_view_column_add_attribute (column, renderer,
 				      "secondary-text", COLUMN_INFO);
   gtk_tree_view_append_column (GTK_TREE_VIEW (tree), column);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree), TRUE);
 
   /* react to user clicks */
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (tree));
@@ -247,13 +296,13 @@ call_history_view_gtk_new (gmref_ptr<History::Book> book)
 		    G_CALLBACK (on_clicked), &(*book));
 
   /* connect to the signals */
-  connection = book->cleared.connect (sigc::bind (sigc::ptr_fun (gtk_list_store_clear), store));
+  connection = book->cleared.connect (sigc::bind (sigc::ptr_fun (contact_list_model_clear), CONTACT_LIST_MODEL (model)));
   conns->push_front (connection);
-  connection = book->contact_added.connect (sigc::bind (sigc::ptr_fun (on_contact_added), store));
+  connection = book->contact_added.connect (sigc::bind (sigc::ptr_fun (on_contact_added), CONTACT_LIST_MODEL (model)));
   conns->push_front (connection);
 
   /* populate */
-  book->visit_contacts (sigc::bind_return(sigc::bind (sigc::ptr_fun (on_contact_added), store), true));
+  book->visit_contacts (sigc::bind_return(sigc::bind (sigc::ptr_fun (on_contact_added), CONTACT_LIST_MODEL (model)), true));
 
   return result;
 }
@@ -0,0 +1,880 @@
+
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         contact-list-model.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : implementation of a lazy list model of contacts
+ *
+ */
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "contact-list-model.h"
+
+/* The rows, and the visible ones
+ *
+ * The visible rows are the range [first, last) of the sorted rows : the
+ * position of an iter is relative to first, or to last when the rows are
+ * shown in descending order. The iters don't survive a change of the
+ * model, so the stamp changes with each one.
+ */
+struct ContactListRow
+{
+  ContactListRow (const std::string &key_,
+		  Ekiga::ContactPtr contact_): key(key_), contact(contact_)
+  {}
+
+  std::string key;
+  Ekiga::ContactPtr contact;
+};
+
+struct ContactListRowLess
+{
+  bool operator() (const ContactListRow &row,
+		   const std::string &key) const
+  { return row.key < key; }
+
+  bool operator() (const std::string &key,
+		   const ContactListRow &row) const
+  { return key < row.key; }
+};
+
+struct _ContactListModelPrivate
+{
+  _ContactListModelPrivate (): first(0), last(0), stamp(1), key_column(-1),
+    order(GTK_SORT_ASCENDING), fill(NULL), data(NULL)
+  {}
+
+  std::vector<ContactListRow> rows;
+  std::map<Ekiga::Contact *, std::string> keys;
+  std::string prefix;
+  size_t first;
+  size_t last;
+  gint stamp;
+
+  gint key_column;
+  GtkSortType order;
+
+  std::vector<GType> types;
+  ContactListModelFillFunc fill;
+  gpointer data;
+};
+
+static GObjectClass *parent_class = NULL;
+
+
+/* Static functions */
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Return the position of the contact in the rows, or the
+ *                number of rows if it isn't there.
+ * PRE          : /
+ */
+static size_t
+contact_list_model_find_row (ContactListModel *self,
+			     Ekiga::Contact *contact);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Return TRUE if the key passes the filter.
+ * PRE          : /
+ */
+static gboolean
+contact_list_model_matches (ContactListModel *self,
+			    const std::string &key);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Return the visible position of the given row, which must
+ *                be in [first, last), and the other way around.
+ * PRE          : /
+ */
+static size_t
+contact_list_model_visible (ContactListModel *self,
+			    size_t row);
+
+static size_t
+contact_list_model_row (ContactListModel *self,
+			size_t position);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Make the iter point to the given visible position.
+ * PRE          : /
+ */
+static void
+contact_list_model_set_iter (ContactListModel *self,
+			     GtkTreeIter *iter,
+			     size_t position);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Return TRUE and set position if the iter is valid.
+ * PRE          : /
+ */
+static gboolean
+contact_list_model_get_position (ContactListModel *self,
+				 GtkTreeIter *iter,
+				 size_t &position);
+
+
+/* DESCRIPTION  : /
+ * BEHAVIOR     : Tell the views about a row which appeared, disappeared
+ *                or changed at the given visible position.
+ * PRE          : The model already is in its new state.
+ */
+static void
+contact_list_model_row_inserted (ContactListModel *self,
+				 size_t position);
+
+static void
+contact_list_model_row_deleted (ContactListModel *self,
+				size_t position);
+
+static void
+contact_list_model_row_changed (ContactListModel *self,
+				size_t position);
+
+
+/* Implementation of the static functions */
+static size_t
+contact_list_model_find_row (ContactListModel *self,
+			     Ekiga::Contact *contact)
+{
+  std::map<Ekiga::Contact *, std::string>::iterator key
+    = self->priv->keys.find (contact);
+
+  if (key == self->priv->keys.end ())
+    return self->priv->rows.size ();
+
+  std::pair<std::vector<ContactListRow>::iterator, std::vector<ContactListRow>::iterator> range
+    = std::equal_range (self->priv->rows.begin (), self->priv->rows.end (),
+			key->second, ContactListRowLess ());
+
+  for (std::vector<ContactListRow>::iterator iter = range.first;
+       iter != range.second;
+       ++iter)
+    if (iter->contact.get () == contact)
+      return iter - self->priv->rows.begin ();
+
+  return self->priv->rows.size ();
+}
+
+
+static gboolean
+contact_list_model_matches (ContactListModel *self,
+			    const std::string &key)
+{
+  return (self->priv->prefix.empty ()
+	  || key.compare (0, self->priv->prefix.length (), self->priv->prefix) == 0);
+}
+
+
+static size_t
+contact_list_model_visible (ContactListModel *self,
+			    size_t row)
+{
+  if (self->priv->order == GTK_SORT_DESCENDING)
+    return self->priv->last - 1 - row;
+
+  return row - self->priv->first;
+}
+
+
+static size_t
+contact_list_model_row (ContactListModel *self,
+			size_t position)
+{
+  if (self->priv->order == GTK_SORT_DESCENDING)
+    return self->priv->last - 1 - position;
+
+  return self->priv->first + position;
+}
+
+
+static void
+contact_list_model_set_iter (ContactListModel *self,
+			     GtkTreeIter *iter,
+			     size_t position)
+{
+  iter->stamp = self->priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (position);
+  iter->user_data2 = NULL;
+  iter->user_data3 = NULL;
+}
+
+
+static gboolean
+contact_list_model_get_position (ContactListModel *self,
+				 GtkTreeIter *iter,
+				 size_t &position)
+{
+  if (iter == NULL || iter->stamp != self->priv->stamp)
+    return FALSE;
+
+  position = GPOINTER_TO_UINT (iter->user_data);
+
+  return position < self->priv->last - self->priv->first;
+}
+
+
+static void
+contact_list_model_row_inserted (ContactListModel *self,
+				 size_t position)
+{
+  GtkTreePath *path = gtk_tree_path_new_from_indices (position, -1);
+  GtkTreeIter iter;
+
+  contact_list_model_set_iter (self, &iter, position);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (self), path, &iter);
+  gtk_tree_path_free (path);
+}
+
+
+static void
+contact_list_model_row_deleted (ContactListModel *self,
+				size_t position)
+{
+  GtkTreePath *path = gtk_tree_path_new_from_indices (position, -1);
+
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (self), path);
+  gtk_tree_path_free (path);
+}
+
+
+static void
+contact_list_model_row_changed (ContactListModel *self,
+				size_t position)
+{
+  GtkTreePath *path = gtk_tree_path_new_from_indices (position, -1);
+  GtkTreeIter iter;
+
+  contact_list_model_set_iter (self, &iter, position);
+  gtk_tree_model_row_changed (GTK_TREE_MODEL (self), path, &iter);
+  gtk_tree_path_free (path);
+}
+
+
+/* GtkTreeModel implementation */
+static GtkTreeModelFlags
+contact_list_model_get_flags (GtkTreeModel * /*model*/)
+{
+  return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+
+static gint
+contact_list_model_get_n_columns (GtkTreeModel *model)
+{
+  return CONTACT_LIST_MODEL (model)->priv->types.size ();
+}
+
+
+static GType
+contact_list_model_get_column_type (GtkTreeModel *model,
+				    gint column)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+
+  g_return_val_if_fail (column >= 0 && (size_t) column < self->priv->types.size (),
+			G_TYPE_INVALID);
+
+  return self->priv->types[column];
+}
+
+
+static gboolean
+contact_list_model_get_iter (GtkTreeModel *model,
+			     GtkTreeIter *iter,
+			     GtkTreePath *path)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+  gint *indices = gtk_tree_path_get_indices (path);
+
+  if (gtk_tree_path_get_depth (path) != 1
+      || indices[0] < 0
+      || (size_t) indices[0] >= self->priv->last - self->priv->first)
+    return FALSE;
+
+  contact_list_model_set_iter (self, iter, indices[0]);
+
+  return TRUE;
+}
+
+
+static GtkTreePath *
+contact_list_model_get_path (GtkTreeModel *model,
+			     GtkTreeIter *iter)
+{
+  size_t position = 0;
+
+  g_return_val_if_fail (contact_list_model_get_position (CONTACT_LIST_MODEL (model), iter, position), NULL);
+
+  return gtk_tree_path_new_from_indices (position, -1);
+}
+
+
+static void
+contact_list_model_get_value (GtkTreeModel *model,
+			      GtkTreeIter *iter,
+			      gint column,
+			      GValue *value)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+  size_t position = 0;
+
+  g_return_if_fail (column >= 0 && (size_t) column < self->priv->types.size ());
+
+  g_value_init (value, self->priv->types[column]);
+
+  g_return_if_fail (contact_list_model_get_position (self, iter, position));
+
+  self->priv->fill (*self->priv->rows[contact_list_model_row (self, position)].contact,
+		    column, value, self->priv->data);
+}
+
+
+static gboolean
+contact_list_model_iter_next (GtkTreeModel *model,
+			      GtkTreeIter *iter)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+  size_t position = 0;
+
+  if (!contact_list_model_get_position (self, iter, position)
+      || position + 1 >= self->priv->last - self->priv->first)
+    return FALSE;
+
+  contact_list_model_set_iter (self, iter, position + 1);
+
+  return TRUE;
+}
+
+
+static gboolean
+contact_list_model_iter_nth_child (GtkTreeModel *model,
+				   GtkTreeIter *iter,
+				   GtkTreeIter *parent,
+				   gint n)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+
+  if (parent != NULL
+      || n < 0
+      || (size_t) n >= self->priv->last - self->priv->first)
+    return FALSE;
+
+  contact_list_model_set_iter (self, iter, n);
+
+  return TRUE;
+}
+
+
+static gboolean
+contact_list_model_iter_children (GtkTreeModel *model,
+				  GtkTreeIter *iter,
+				  GtkTreeIter *parent)
+{
+  return contact_list_model_iter_nth_child (model, iter, parent, 0);
+}
+
+
+static gboolean
+contact_list_model_iter_has_child (GtkTreeModel * /*model*/,
+				   GtkTreeIter * /*iter*/)
+{
+  return FALSE;
+}
+
+
+static gint
+contact_list_model_iter_n_children (GtkTreeModel *model,
+				    GtkTreeIter *iter)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (model);
+
+  if (iter != NULL)
+    return 0;
+
+  return self->priv->last - self->priv->first;
+}
+
+
+static gboolean
+contact_list_model_iter_parent (GtkTreeModel * /*model*/,
+				GtkTreeIter * /*iter*/,
+				GtkTreeIter * /*child*/)
+{
+  return FALSE;
+}
+
+
+/* GtkTreeSortable implementation : the rows are kept sorted by their
+ * key, so only the order can change, and that is only a matter of
+ * numbering the visible rows from one end or the other */
+static gboolean
+contact_list_model_get_sort_column_id (GtkTreeSortable *sortable,
+				       gint *sort_column_id,
+				       GtkSortType *order)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (sortable);
+
+  if (sort_column_id != NULL)
+    *sort_column_id = self->priv->key_column;
+  if (order != NULL)
+    *order = self->priv->order;
+
+  return self->priv->key_column >= 0;
+}
+
+
+static void
+contact_list_model_set_sort_column_id (GtkTreeSortable *sortable,
+				       gint sort_column_id,
+				       GtkSortType order)
+{
+  ContactListModel *self = CONTACT_LIST_MODEL (sortable);
+  size_t count = self->priv->last - self->priv->first;
+
+  g_return_if_fail (sort_column_id == self->priv->key_column);
+
+  if (order == self->priv->order)
+    return;
+
+  self->priv->order = order;
+  self->priv->stamp++;
+
+  if (count > 0) {
+
+    std::vector<gint> new_order (count);
+    GtkTreePath *path = gtk_tree_path_new ();
+
+    for (size_t position = 0; position < count; position++)
+      new_order[position] = count - 1 - position;
+
+    gtk_tree_model_rows_reordered (GTK_TREE_MODEL (self), path, NULL, &new_order[0]);
+    gtk_tree_path_free (path);
+  }
+
+  gtk_tree_sortable_sort_column_changed (sortable);
+}
+
+
+static void
+contact_list_model_set_sort_func (GtkTreeSortable * /*sortable*/,
+				  gint /*sort_column_id*/,
+				  GtkTreeIterCompareFunc /*func*/,
+				  gpointer /*data*/,
+				  GDestroyNotify /*destroy*/)
+{
+  g_warning ("ContactListModel is sorted by its keys only");
+}
+
+
+static void
+contact_list_model_set_default_sort_func (GtkTreeSortable * /*sortable*/,
+					  GtkTreeIterCompareFunc /*func*/,
+					  gpointer /*data*/,
+					  GDestroyNotify /*destroy*/)
+{
+  g_warning ("ContactListModel is sorted by its keys only");
+}
+
+
+static gboolean
+contact_list_model_has_default_sort_func (GtkTreeSortable * /*sortable*/)
+{
+  return FALSE;
+}
+
+
+/* GObject boilerplate code */
+static void
+contact_list_model_finalize (GObject *obj)
+{
+  ContactListModel *self = NULL;
+
+  self = CONTACT_LIST_MODEL (obj);
+
+  delete self->priv;
+
+  parent_class->finalize (obj);
+}
+
+
+static void
+contact_list_model_class_init (gpointer g_class,
+			       gpointer /*class_data*/)
+{
+  GObjectClass *gobject_class = NULL;
+
+  parent_class = (GObjectClass *)g_type_class_peek_parent (g_class);
+
+  gobject_class = (GObjectClass *)g_class;
+  gobject_class->finalize = contact_list_model_finalize;
+}
+
+
+static void
+contact_list_model_tree_model_init (gpointer g_iface,
+				    gpointer /*iface_data*/)
+{
+  GtkTreeModelIface *iface = (GtkTreeModelIface *)g_iface;
+
+  iface->get_flags = contact_list_model_get_flags;
+  iface->get_n_columns = contact_list_model_get_n_columns;
+  iface->get_column_type = contact_list_model_get_column_type;
+  iface->get_iter = contact_list_model_get_iter;
+  iface->get_path = contact_list_model_get_path;
+  iface->get_value = contact_list_model_get_value;
+  iface->iter_next = contact_list_model_iter_next;
+  iface->iter_children = contact_list_model_iter_children;
+  iface->iter_has_child = contact_list_model_iter_has_child;
+  iface->iter_n_children = contact_list_model_iter_n_children;
+  iface->iter_nth_child = contact_list_model_iter_nth_child;
+  iface->iter_parent = contact_list_model_iter_parent;
+}
+
+
+static void
+contact_list_model_tree_sortable_init (gpointer g_iface,
+				       gpointer /*iface_data*/)
+{
+  GtkTreeSortableIface *iface = (GtkTreeSortableIface *)g_iface;
+
+  iface->get_sort_column_id = contact_list_model_get_sort_column_id;
+  iface->set_sort_column_id = contact_list_model_set_sort_column_id;
+  iface->set_sort_func = contact_list_model_set_sort_func;
+  iface->set_default_sort_func = contact_list_model_set_default_sort_func;
+  iface->has_default_sort_func = contact_list_model_has_default_sort_func;
+}
+
+
+GType
+contact_list_model_get_type ()
+{
+  static GType result = 0;
+
+  if (result == 0) {
+
+    static const GTypeInfo info = {
+      sizeof (ContactListModelClass),
+      NULL,
+      NULL,
+      contact_list_model_class_init,
+      NULL,
+      NULL,
+      sizeof (ContactListModel),
+      0,
+      NULL,
+      NULL
+    };
+
+    static const GInterfaceInfo tree_model_info = {
+      contact_list_model_tree_model_init,
+      NULL,
+      NULL
+    };
+
+    static const GInterfaceInfo tree_sortable_info = {
+      contact_list_model_tree_sortable_init,
+      NULL,
+      NULL
+    };
+
+    result = g_type_register_static (G_TYPE_OBJECT,
+				     "ContactListModelType",
+				     &info, (GTypeFlags) 0);
+    g_type_add_interface_static (result, GTK_TYPE_TREE_MODEL,
+				 &tree_model_info);
+    g_type_add_interface_static (result, GTK_TYPE_TREE_SORTABLE,
+				 &tree_sortable_info);
+  }
+
+  return result;
+}
+
+
+/* public methods implementation */
+GtkTreeModel *
+contact_list_model_new (gint n_columns,
+			const GType *types,
+			ContactListModelFillFunc fill,
+			gpointer data)
+{
+  ContactListModel *result = NULL;
+
+  g_return_val_if_fail (n_columns > 0 && types != NULL && fill != NULL, NULL);
+
+  result = (ContactListModel *) g_object_new (CONTACT_LIST_MODEL_TYPE, NULL);
+
+  result->priv = new _ContactListModelPrivate;
+  result->priv->types.assign (types, types + n_columns);
+  result->priv->fill = fill;
+  result->priv->data = data;
+
+  return GTK_TREE_MODEL (result);
+}
+
+
+void
+contact_list_model_add (ContactListModel *self,
+			Ekiga::ContactPtr contact,
+			const std::string &key)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  if (self->priv->keys.find (contact.get ()) != self->priv->keys.end ()) {
+
+    contact_list_model_update (self, contact, key);
+    return;
+  }
+
+  std::vector<ContactListRow>::iterator iter
+    = std::upper_bound (self->priv->rows.begin (), self->priv->rows.end (),
+			key, ContactListRowLess ());
+  size_t position = iter - self->priv->rows.begin ();
+
+  self->priv->rows.insert (iter, ContactListRow (key, contact));
+  self->priv->keys[contact.get ()] = key;
+  self->priv->stamp++;
+
+  if (contact_list_model_matches (self, key)) {
+
+    self->priv->last++;
+    contact_list_model_row_inserted (self, contact_list_model_visible (self, position));
+  }
+  else if (key < self->priv->prefix) {
+
+    /* only a key sorting before the filter moves the range : one sorting
+     * after it may land at first when the range is empty */
+    self->priv->first++;
+    self->priv->last++;
+  }
+}
+
+
+void
+contact_list_model_update (ContactListModel *self,
+			   Ekiga::ContactPtr contact,
+			   const std::string &key)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  std::map<Ekiga::Contact *, std::string>::iterator iter
+    = self->priv->keys.find (contact.get ());
+
+  if (iter == self->priv->keys.end ()) {
+
+    contact_list_model_add (self, contact, key);
+    return;
+  }
+
+  if (iter->second != key) {
+
+    contact_list_model_remove (self, contact);
+    contact_list_model_add (self, contact, key);
+    return;
+  }
+
+  size_t position = contact_list_model_find_row (self, contact.get ());
+
+  if (position >= self->priv->first && position < self->priv->last)
+    contact_list_model_row_changed (self, contact_list_model_visible (self, position));
+}
+
+
+void
+contact_list_model_remove (ContactListModel *self,
+			   Ekiga::ContactPtr contact)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  size_t position = contact_list_model_find_row (self, contact.get ());
+
+  if (position == self->priv->rows.size ())
+    return;
+
+  self->priv->rows.erase (self->priv->rows.begin () + position);
+  self->priv->keys.erase (contact.get ());
+  self->priv->stamp++;
+
+  if (position >= self->priv->first && position < self->priv->last) {
+
+    size_t visible = contact_list_model_visible (self, position);
+
+    self->priv->last--;
+    contact_list_model_row_deleted (self, visible);
+  }
+  else if (position < self->priv->first) {
+
+    self->priv->first--;
+    self->priv->last--;
+  }
+}
+
+
+void
+contact_list_model_clear (ContactListModel *self)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  /* from the end, so the views don't have to move the rows after */
+  while (self->priv->last > self->priv->first) {
+
+    self->priv->last--;
+    self->priv->stamp++;
+    contact_list_model_row_deleted (self, self->priv->last - self->priv->first);
+  }
+
+  self->priv->rows.clear ();
+  self->priv->keys.clear ();
+  self->priv->first = 0;
+  self->priv->last = 0;
+  self->priv->stamp++;
+}
+
+
+void
+contact_list_model_set_filter (ContactListModel *self,
+			       const std::string &prefix)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  std::vector<ContactListRow> &rows = self->priv->rows;
+  size_t first = 0;
+  size_t last = rows.size ();
+
+  /* no key in UTF-8 has a 0xff byte, so the keys beginning with prefix
+   * all sort before prefix + 0xff */
+  if ( !prefix.empty ()) {
+
+    first = std::lower_bound (rows.begin (), rows.end (),
+			      prefix, ContactListRowLess ()) - rows.begin ();
+    last = std::lower_bound (rows.begin (), rows.end (),
+			     prefix + '\xff', ContactListRowLess ()) - rows.begin ();
+  }
+
+  self->priv->prefix = prefix;
+
+  /* the views only learn about the rows which enter or leave the range */
+  if (last <= self->priv->first || first >= self->priv->last) {
+
+    while (self->priv->last > self->priv->first) {
+
+      self->priv->last--;
+      self->priv->stamp++;
+      contact_list_model_row_deleted (self, self->priv->last - self->priv->first);
+    }
+    self->priv->first = first;
+    self->priv->last = first;
+  }
+
+  /* the row at first is at the top in ascending order, and at the bottom
+   * in descending order -- and the other way around for the row at last */
+  while (self->priv->first < first) {
+
+    size_t visible = contact_list_model_visible (self, self->priv->first);
+
+    self->priv->first++;
+    self->priv->stamp++;
+    contact_list_model_row_deleted (self, visible);
+  }
+
+  while (self->priv->first > first) {
+
+    self->priv->first--;
+    self->priv->stamp++;
+    contact_list_model_row_inserted (self, contact_list_model_visible (self, self->priv->first));
+  }
+
+  while (self->priv->last > last) {
+
+    size_t visible = contact_list_model_visible (self, self->priv->last - 1);
+
+    self->priv->last--;
+    self->priv->stamp++;
+    contact_list_model_row_deleted (self, visible);
+  }
+
+  while (self->priv->last < last) {
+
+    self->priv->last++;
+    self->priv->stamp++;
+    contact_list_model_row_inserted (self, contact_list_model_visible (self, self->priv->last - 1));
+  }
+}
+
+
+Ekiga::Contact *
+contact_list_model_get_contact (ContactListModel *self,
+				GtkTreeIter *iter)
+{
+  size_t position = 0;
+
+  g_return_val_if_fail (IS_CONTACT_LIST_MODEL (self), NULL);
+
+  if ( !contact_list_model_get_position (self, iter, position))
+    return NULL;
+
+  return self->priv->rows[contact_list_model_row (self, position)].contact.get ();
+}
+
+
+void
+contact_list_model_set_key_column (ContactListModel *self,
+				   gint column)
+{
+  g_return_if_fail (IS_CONTACT_LIST_MODEL (self));
+
+  self->priv->key_column = column;
+}
+
+
+std::string
+contact_list_model_name_key (const std::string &name)
+{
+  std::string result;
+  gchar *normalized = g_utf8_normalize (name.c_str (), -1, G_NORMALIZE_ALL);
+
+  if (normalized == NULL)
+    return name;
+
+  gchar *folded = g_utf8_casefold (normalized, -1);
+  result = folded;
+
+  g_free (folded);
+  g_free (normalized);
+
+  return result;
+}
@@ -0,0 +1,139 @@
+
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         contact-list-model.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : declaration of a lazy list model of contacts
+ *
+ */
+
+#ifndef __CONTACT_LIST_MODEL_H__
+#define __CONTACT_LIST_MODEL_H__
+
+#include <string>
+#include <gtk/gtk.h>
+#include "contact.h"
+
+/* A GtkTreeModel listing contacts, for the views of big books.
+ *
+ * A GtkListStore holds a copy of every cell of every row : here each row
+ * is only a reference to the contact and its sort key, and the cells are
+ * computed by the view's fill function when the tree view asks for them,
+ * which it only does for the rows it shows when it is in fixed height
+ * mode.
+ *
+ * The rows are kept sorted by their key : a row is found by its position
+ * in constant time, and a contact is inserted at its place after a binary
+ * search. A filter restricts the visible rows to the ones whose key begins
+ * with a prefix : as the rows are sorted, those are a range of positions,
+ * and nothing is copied. The model is a GtkTreeSortable on its key column,
+ * where only the order can be chosen.
+ */
+
+typedef struct _ContactListModel ContactListModel;
+typedef struct _ContactListModelPrivate ContactListModelPrivate;
+typedef struct _ContactListModelClass ContactListModelClass;
+
+/* fills value, for the given column and contact ; value was initialized
+ * to the type of the column */
+typedef void (*ContactListModelFillFunc) (Ekiga::Contact &contact,
+					  gint column,
+					  GValue *value,
+					  gpointer data);
+
+/* public api */
+
+/* types are the n_columns types of the columns */
+GtkTreeModel *contact_list_model_new (gint n_columns,
+				      const GType *types,
+				      ContactListModelFillFunc fill,
+				      gpointer data);
+
+/* the contact is placed after the ones with the same key */
+void contact_list_model_add (ContactListModel *self,
+			     Ekiga::ContactPtr contact,
+			     const std::string &key);
+
+/* the key may have changed : the row moves if needed */
+void contact_list_model_update (ContactListModel *self,
+				Ekiga::ContactPtr contact,
+				const std::string &key);
+
+void contact_list_model_remove (ContactListModel *self,
+				Ekiga::ContactPtr contact);
+
+void contact_list_model_clear (ContactListModel *self);
+
+/* an empty prefix shows all the rows */
+void contact_list_model_set_filter (ContactListModel *self,
+				    const std::string &prefix);
+
+/* returns NULL if the iter doesn't point to a row */
+Ekiga::Contact *contact_list_model_get_contact (ContactListModel *self,
+						GtkTreeIter *iter);
+
+/* the column whose values the keys sort, so the tree view can show the
+ * rows in both orders (-1, the default, if there is none) */
+void contact_list_model_set_key_column (ContactListModel *self,
+					gint column);
+
+/* returns a key sorting and filtering names regardless of their case */
+std::string contact_list_model_name_key (const std::string &name);
+
+/* GObject thingies */
+
+struct _ContactListModel
+{
+  GObject parent;
+
+  ContactListModelPrivate *priv;
+};
+
+struct _ContactListModelClass
+{
+  GObjectClass parent;
+};
+
+#define CONTACT_LIST_MODEL_TYPE (contact_list_model_get_type ())
+
+#define CONTACT_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), CONTACT_LIST_MODEL_TYPE, ContactListModel))
+
+#define IS_CONTACT_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CONTACT_LIST_MODEL_TYPE))
+
+#define CONTACT_LIST_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), CONTACT_LIST_MODEL_TYPE, ContactListModelClass))
+
+#define IS_CONTACT_LIST_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CONTACT_LIST_MODEL_TYPE))
+
+#define CONTACT_LIST_MODEL_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), CONTACT_LIST_MODEL_TYPE, ContactListModelClass))
+
+GType contact_list_model_get_type ();
+
+#endif
@@ -37,6 +37,10 @@
 #ifndef __HEAP_IMPL_H__
 #define __HEAP_IMPL_H__
 
+#include <map>
+#include <list>
+#include <glib.h>
+
 #include "reflister.h"
 #include "heap.h"
 
@@ -62,6 +66,10 @@ namespace Ekiga
    *  - when the signal is received, then do a remove_presentity followed by
    *    calling the appropriate api function to delete the presentity in your
    *    backend.
+   *
+   * The presentities are also indexed by uri, so a heap receiving presence
+   * information doesn't have to visit all of them : the PresentityType
+   * must have a get_uri method, and emit 'updated' when its uri changes.
    */
   template<typename PresentityType = Presentity>
   class HeapImpl:
@@ -95,6 +103,38 @@ namespace Ekiga
     void add_presentity (gmref_ptr<PresentityType> presentity);
 
     void remove_presentity (gmref_ptr<PresentityType> presentity);
+
+    /** Finds a presentity of the heap from its uri
+     * @param uri is the uri (compared after normalization)
+     * @return the presentity, or an empty pointer if there is none
+     */
+    gmref_ptr<PresentityType> find_presentity_by_uri (const std::string uri) const;
+
+    /** Finds all the presentities of the heap with an uri
+     * @param uri is the uri (compared after normalization)
+     * @param presentities is filled with the matching presentities
+     */
+    void find_presentities_by_uri (const std::string uri,
+				   std::list<gmref_ptr<PresentityType> >& presentities) const;
+
+    /** Puts an uri in the form used for the index: surrounding blanks are
+     * dropped, the scheme and the host are lowercased -- when there's no
+     * '@', the host can't be told from a user, so only the scheme is.
+     */
+    static std::string normalize_uri (const std::string uri);
+
+  private:
+
+    void on_presentity_added (gmref_ptr<PresentityType> presentity);
+
+    void on_presentity_removed (gmref_ptr<PresentityType> presentity);
+
+    void on_presentity_updated (gmref_ptr<PresentityType> presentity);
+
+    typedef std::multimap<std::string, gmref_ptr<PresentityType> > uri_index_type;
+
+    uri_index_type uri_index;
+    std::map<gmref_ptr<PresentityType>, std::string> indexed_uris;
   };
 
 /**
@@ -111,6 +151,11 @@ Ekiga::HeapImpl<PresentityType>::HeapImpl ()
   RefLister<PresentityType>::object_added.connect (presentity_added.make_slot ());
   RefLister<PresentityType>::object_removed.connect (presentity_removed.make_slot ());
   RefLister<PresentityType>::object_updated.connect (presentity_updated.make_slot ());
+
+  /* and this keeps the index up to date */
+  RefLister<PresentityType>::object_added.connect (sigc::mem_fun (this, &HeapImpl::on_presentity_added));
+  RefLister<PresentityType>::object_removed.connect (sigc::mem_fun (this, &HeapImpl::on_presentity_removed));
+  RefLister<PresentityType>::object_updated.connect (sigc::mem_fun (this, &HeapImpl::on_presentity_updated));
 }
 
 
@@ -170,4 +215,112 @@ Ekiga::HeapImpl<PresentityType>::remove_presentity (gmref_ptr<PresentityType> pr
   remove_object (presentity);
 }
 
+template<typename PresentityType>
+gmref_ptr<PresentityType>
+Ekiga::HeapImpl<PresentityType>::find_presentity_by_uri (const std::string uri) const
+{
+  typename uri_index_type::const_iterator iter = uri_index.find (normalize_uri (uri));
+
+  if (iter != uri_index.end ())
+    return iter->second;
+
+  return gmref_ptr<PresentityType> ();
+}
+
+template<typename PresentityType>
+void
+Ekiga::HeapImpl<PresentityType>::find_presentities_by_uri (const std::string uri,
+							   std::list<gmref_ptr<PresentityType> >& presentities) const
+{
+  std::pair<typename uri_index_type::const_iterator, typename uri_index_type::const_iterator> range = uri_index.equal_range (normalize_uri (uri));
+
+  for (typename uri_index_type::const_iterator iter = range.first;
+       iter != range.second;
+       ++iter)
+    presentities.push_back (iter->second);
+}
+
+template<typename PresentityType>
+std::string
+Ekiga::HeapImpl<PresentityType>::normalize_uri (const std::string uri)
+{
+  std::string::size_type start = uri.find_first_not_of (" \t\r\n");
+  std::string::size_type stop = uri.find_last_not_of (" \t\r\n");
+  std::string result;
+  std::string::size_type colon;
+  std::string::size_type at;
+  std::string::size_type host_end;
+
+  if (start == std::string::npos)
+    return result;
+
+  result = uri.substr (start, stop - start + 1);
+
+  /* the scheme */
+  colon = result.find (':');
+  if (colon != std::string::npos)
+    for (std::string::size_type ii = 0; ii < colon; ii++)
+      result[ii] = g_ascii_tolower (result[ii]);
+
+  /* the host -- the user part is case-sensitive */
+  at = result.find ('@');
+  if (at != std::string::npos) {
+
+    host_end = result.find_first_of (";?>", at + 1);
+    if (host_end == std::string::npos)
+      host_end = result.length ();
+    for (std::string::size_type ii = at + 1; ii < host_end; ii++)
+      result[ii] = g_ascii_tolower (result[ii]);
+  }
+
+  return result;
+}
+
+template<typename PresentityType>
+void
+Ekiga::HeapImpl<PresentityType>::on_presentity_added (gmref_ptr<PresentityType> presentity)
+{
+  std::string key = normalize_uri (presentity->get_uri ());
+
+  uri_index.insert (std::make_pair (key, presentity));
+  indexed_uris[presentity] = key;
+}
+
+template<typename PresentityType>
+void
+Ekiga::HeapImpl<PresentityType>::on_presentity_removed (gmref_ptr<PresentityType> presentity)
+{
+  typename std::map<gmref_ptr<PresentityType>, std::string>::iterator key_iter = indexed_uris.find (presentity);
+
+  if (key_iter == indexed_uris.end ())
+    return;
+
+  std::pair<typename uri_index_type::iterator, typename uri_index_type::iterator> range = uri_index.equal_range (key_iter->second);
+  for (typename uri_index_type::iterator iter = range.first;
+       iter != range.second;
+       ++iter)
+    if (iter->second == presentity) {
+
+      uri_index.erase (iter);
+      break;
+    }
+
+  indexed_uris.erase (key_iter);
+}
+
+template<typename PresentityType>
+void
+Ekiga::HeapImpl<PresentityType>::on_presentity_updated (gmref_ptr<PresentityType> presentity)
+{
+  typename std::map<gmref_ptr<PresentityType>, std::string>::iterator key_iter = indexed_uris.find (presentity);
+
+  /* most updates are about the presence or status, not the uri */
+  if (key_iter != indexed_uris.end ()
+      && key_iter->second == normalize_uri (presentity->get_uri ()))
+    return;
+
+  on_presentity_removed (presentity);
+  on_presentity_added (presentity);
+}
+
 #endif
@@ -168,19 +168,20 @@ Ekiga::PresenceCore::add_presence_fetcher (gmref_ptr<PresenceFetcher> fetcher)
   presence_fetchers.push_back (fetcher);
   conns.push_back (fetcher->presence_received.connect (sigc::mem_fun (this, &Ekiga::PresenceCore::on_presence_received)));
   conns.push_back (fetcher->status_received.connect (sigc::mem_fun (this, &Ekiga::PresenceCore::on_status_received)));
-  for (std::map<std::string, uri_info>::const_iterator iter
-	 = uri_infos.begin ();
-       iter != uri_infos.end ();
+  for (std::map<InternedString, int>::const_iterator iter
+	 = uri_counts.begin ();
+       iter != uri_counts.end ();
        ++iter)
-    fetcher->fetch (iter->first);
+    fetcher->fetch (iter->first.c_str ());
 }
 
 void
-Ekiga::PresenceCore::fetch_presence (const std::string uri)
+Ekiga::PresenceCore::fetch_presence (const std::string &uri)
 {
-  uri_infos[uri].count++;
+  InternedString key(uri);
+  const PresenceEvent &event = get_presence_event (key);
 
-  if (uri_infos[uri].count == 1) {
+  if (++uri_counts[key] == 1) {
 
     for (std::list<gmref_ptr<PresenceFetcher> >::iterator iter
 	   = presence_fetchers.begin ();
@@ -189,17 +190,35 @@ Ekiga::PresenceCore::fetch_presence (const std::string uri)
       (*iter)->fetch (uri);
   }
 
-  presence_received.emit (uri, uri_infos[uri].presence);
-  status_received.emit (uri, uri_infos[uri].status);
+  presence_received.emit (uri, event.presence);
+  status_received.emit (uri, event.status);
 }
 
-void Ekiga::PresenceCore::unfetch_presence (const std::string uri)
+void
+Ekiga::PresenceCore::fetch_presence (const std::string &uri,
+				     EventBus<PresenceEvent>::Listener listener)
 {
-  uri_infos[uri].count--;
+  InternedString key(uri);
+
+  fetch_presence (uri);
 
-  if (uri_infos[uri].count <= 0) {
+  /* only the new listener needs to know what we knew already */
+  presence_bus.subscribe (key, listener);
+  listener (get_presence_event (key));
+}
+
+void Ekiga::PresenceCore::unfetch_presence (const std::string &uri)
+{
+  InternedString key = InternedString::lookup (uri);
+  std::map<InternedString, int>::iterator count = uri_counts.find (key);
 
-    uri_infos.erase (uri_infos.find (uri));
+  if (count == uri_counts.end ())
+    return;
+
+  if (--count->second <= 0) {
+
+    uri_counts.erase (count);
+    presence_bus.remove (key);
 
     for (std::list<gmref_ptr<PresenceFetcher> >::iterator iter
 	   = presence_fetchers.begin ();
@@ -210,21 +229,45 @@ void Ekiga::PresenceCore::unfetch_presence (const std::string uri)
 }
 
 void
-Ekiga::PresenceCore::on_presence_received (const std::string uri,
-					   const std::string presence)
+Ekiga::PresenceCore::on_presence_received (const std::string &uri,
+					   const std::string &presence)
 {
-  uri_infos[uri].presence = presence;
+  /* only keep what was asked for : looking up doesn't intern the uri */
+  InternedString key = InternedString::lookup (uri);
+
+  if (!key.is_null () && uri_counts.find (key) != uri_counts.end ()) {
+
+    get_presence_event (key).presence = presence;
+    presence_bus.publish (key);
+  }
   presence_received.emit (uri, presence);
 }
 
 void
-Ekiga::PresenceCore::on_status_received (const std::string uri,
-					 const std::string status)
+Ekiga::PresenceCore::on_status_received (const std::string &uri,
+					 const std::string &status)
 {
-  uri_infos[uri].status = status;
+  /* only keep what was asked for : looking up doesn't intern the uri */
+  InternedString key = InternedString::lookup (uri);
+
+  if (!key.is_null () && uri_counts.find (key) != uri_counts.end ()) {
+
+    get_presence_event (key).status = status;
+    presence_bus.publish (key);
+  }
   status_received.emit (uri, status);
 }
 
+Ekiga::PresenceEvent &
+Ekiga::PresenceCore::get_presence_event (InternedString uri)
+{
+  PresenceEvent &event = presence_bus.record (uri);
+
+  event.uri = uri;
+
+  return event;
+}
+
 void
 Ekiga::PresenceCore::add_presence_publisher (gmref_ptr<PresencePublisher> publisher)
 {
@@ -41,6 +41,7 @@
 #include "services.h"
 #include "cluster.h"
 #include "account-core.h"
+#include "event-bus.h"
 
 namespace Ekiga
 {
@@ -70,6 +71,19 @@ namespace Ekiga
 				MenuBuilder &/*builder*/) = 0;
   };
 
+  /** What is known about the presence of an uri ; the PresenceCore keeps
+   * one per fetched uri and updates it in place.
+   */
+  struct PresenceEvent
+  {
+    PresenceEvent (): presence("unknown")
+    { }
+
+    InternedString uri;
+    std::string presence;
+    std::string status;
+  };
+
   class PresenceFetcher: public virtual GmRefCounted
   {
   public:
@@ -244,13 +258,23 @@ namespace Ekiga
      * information for the given uri.
      * @param: The uri for which presence is requested.
      */
-    void fetch_presence (const std::string uri);
+    void fetch_presence (const std::string &uri);
+
+    /** Same as above, but the listener also gets the presence information
+     * of that uri -- and of that uri only -- at once and whenever it
+     * changes, until its object is destroyed ; this is much cheaper than
+     * filtering what the signals below give when there are many uris.
+     * @param: The uri for which presence is requested.
+     * @param: The listener.
+     */
+    void fetch_presence (const std::string &uri,
+			 EventBus<PresenceEvent>::Listener listener);
 
     /** Tells the PresenceCore that someone becomes uninterested in presence
      * information for the given uri.
      * @param: The uri for which presence isn't requested anymore.
      */
-    void unfetch_presence (const std::string uri);
+    void unfetch_presence (const std::string &uri);
 
     /** Those signals are emitted whenever information has been received
      * about an uri ; the information is a pair of strings (uri, information).
@@ -261,21 +285,14 @@ namespace Ekiga
   private:
 
     std::list<gmref_ptr<PresenceFetcher> > presence_fetchers;
-    void on_presence_received (const std::string uri,
-			       const std::string presence);
-    void on_status_received (const std::string uri,
-			     const std::string status);
-    struct uri_info
-    {
-      uri_info (): count(0), presence("unknown"), status("")
-      { }
-
-      int count;
-      std::string presence;
-      std::string status;
-    };
-
-    std::map<std::string, uri_info> uri_infos;
+    void on_presence_received (const std::string &uri,
+			       const std::string &presence);
+    void on_status_received (const std::string &uri,
+			     const std::string &status);
+    PresenceEvent &get_presence_event (InternedString uri);
+
+    std::map<InternedString, int> uri_counts;
+    EventBus<PresenceEvent> presence_bus;
 
     /* help publishing presence */
   public:
@@ -42,9 +42,7 @@ Ekiga::URIPresentity::URIPresentity (Ekiga::ServiceCore &_core,
   : core(_core), name(name_), uri(uri_), presence("unknown"), groups(groups_)
 {
   gmref_ptr<Ekiga::PresenceCore> presence_core = core.get ("presence-core");
-  presence_core->presence_received.connect (sigc::mem_fun (this, &Ekiga::URIPresentity::on_presence_received));
-  presence_core->status_received.connect (sigc::mem_fun (this, &Ekiga::URIPresentity::on_status_received));
-  presence_core->fetch_presence (uri);
+  presence_core->fetch_presence (uri, sigc::mem_fun (this, &Ekiga::URIPresentity::on_presence_event));
 }
 
 Ekiga::URIPresentity::~URIPresentity ()
@@ -99,23 +97,12 @@ Ekiga::URIPresentity::populate_menu (Ekiga::MenuBuilder &builder)
 }
 
 void
-Ekiga::URIPresentity::on_presence_received (std::string uri_,
-					    std::string presence_)
+Ekiga::URIPresentity::on_presence_event (const Ekiga::PresenceEvent &event)
 {
-  if (uri == uri_) {
+  if (presence != event.presence || status != event.status) {
 
-    presence = presence_;
-    updated.emit ();
-  }
-}
-
-void
-Ekiga::URIPresentity::on_status_received (std::string uri_,
-					  std::string status_)
-{
-  if (uri == uri_) {
-
-    status = status_;
+    presence = event.presence;
+    status = event.status;
     updated.emit ();
   }
 }
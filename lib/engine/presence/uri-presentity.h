@@ -106,11 +106,7 @@ namespace Ekiga
     std::string status;
     std::string avatar;
 
-    void on_presence_received (std::string uri_,
-			       std::string presence_);
-
-    void on_status_received (std::string uri_,
-			     std::string status_);
+    void on_presence_event (const Ekiga::PresenceEvent &event);
   };
 
   /**
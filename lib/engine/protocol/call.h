@@ -40,6 +40,8 @@
 
 #include <sigc++/sigc++.h>
 #include <string>
+#include <list>
+#include <ctime>
 
 #include "gmref.h"
 
@@ -51,6 +53,35 @@ namespace Ekiga
    * @{
    */
 
+  /** One sample of the media statistics of a call.
+   * Bandwidths are averaged over the sampling period, and the packet
+   * ratios are computed over that same period. Late packets are only
+   * counted for audio, the only stream going through a jitter buffer.
+   */
+  struct CallStatistics
+  {
+    CallStatistics (): timestamp(0),
+                       received_audio_bandwidth(0.0),
+                       transmitted_audio_bandwidth(0.0),
+                       received_video_bandwidth(0.0),
+                       transmitted_video_bandwidth(0.0),
+                       jitter(0),
+                       lost_packets(0.0),
+                       late_packets(0.0),
+                       out_of_order_packets(0.0)
+    {}
+
+    time_t timestamp;
+    double received_audio_bandwidth;    // kbytes/s
+    double transmitted_audio_bandwidth; // kbytes/s
+    double received_video_bandwidth;    // kbytes/s
+    double transmitted_video_bandwidth; // kbytes/s
+    unsigned jitter;                    // ms
+    double lost_packets;                // percentage
+    double late_packets;                // percentage
+    double out_of_order_packets;        // percentage
+  };
+
   /*
    * Everything is handled asynchronously and signaled through the
    * Ekiga::CallManager
@@ -68,6 +99,8 @@ namespace Ekiga
 
       enum StreamType { Audio, Video };
 
+      enum RecordingMode { RecordMixed, RecordStereo };
+
       /*
        * Call Management
        */
@@ -104,6 +137,27 @@ namespace Ekiga
        */
       virtual void set_reject_delay (unsigned delay) = 0;
 
+      /** Start recording the call to disk
+       * The audio of both directions goes to basename.wav, either mixed
+       * or the local party on the left and the remote party on the right,
+       * and the local video to basename.y4m if asked for.
+       * @param basename the path of the files, without the extension
+       * @param mode whether the two directions are mixed
+       * @param video whether the local video is recorded too
+       * @return false if the files could not be created
+       */
+      virtual bool start_recording (const std::string & basename,
+                                    RecordingMode mode,
+                                    bool video) = 0;
+
+      /** Stop recording the call ; the files are complete when it returns
+       */
+      virtual void stop_recording () = 0;
+
+      /** Return true if the call is being recorded
+       */
+      virtual bool is_recording () const = 0;
+
 
       /*
        * Call Information
@@ -189,6 +243,12 @@ namespace Ekiga
        */
       virtual double get_out_of_order_packets () const = 0;
 
+      /** Return the recent statistics of the call, oldest sample first
+       * @param history is filled with one sample per second for the last
+       * seconds of the call (the exact depth depends on the implementation)
+       */
+      virtual void get_statistics_history (std::list<CallStatistics> & history) const = 0;
+
 
 
       /*
@@ -229,6 +289,15 @@ namespace Ekiga
        */
       sigc::signal0<void> ringing;
 
+      /* Signal emitted when the recording starts
+       * @param the basename of the files
+       */
+      sigc::signal1<void, std::string> recording_started;
+
+      /* Signal emitted when the recording stops
+       */
+      sigc::signal0<void> recording_stopped;
+
       /* Signal emitted when a stream is opened
        * @param the stream name
        * @param the stream type
@@ -257,6 +326,11 @@ namespace Ekiga
        */
       sigc::signal2<void, std::string, StreamType> stream_resumed;
 
+      /* Signal emitted when a new statistics sample is available
+       * @param the new sample
+       */
+      sigc::signal1<void, CallStatistics> statistics_updated;
+
       /** This signal is emitted when the Call is removed.
        */
       sigc::signal0<void> removed;
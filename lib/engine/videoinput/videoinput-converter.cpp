@@ -0,0 +1,302 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         videoinput-converter.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Implementation of the converter turning the
+ *                          native frames of a capture device into YUV420P
+ *                          frames of the requested size.
+ *
+ */
+
+#include <cstring>
+#include <sstream>
+
+#include "videoinput-converter.h"
+
+using namespace Ekiga;
+
+/* Position in the source of the center of destination pixel 'pos',
+ * nearest neighbour */
+static unsigned
+source_position (unsigned pos,
+                 unsigned src_size,
+                 unsigned dst_size)
+{
+  unsigned result = ((2 * pos + 1) * src_size) / (2 * dst_size);
+
+  return (result < src_size) ? result : src_size - 1;
+}
+
+
+VideoInputConverter::VideoInputConverter ()
+{
+  reset ();
+}
+
+
+bool
+VideoInputConverter::is_supported (const std::string & format)
+{
+  return (format == "YUV420P" || format == "I420"
+          || format == "YUY2" || format == "YUYV"
+          || format == "UYVY");
+}
+
+
+bool
+VideoInputConverter::setup (const std::string & format_,
+                            unsigned src_width_,
+                            unsigned src_height_,
+                            unsigned dst_width_,
+                            unsigned dst_height_)
+{
+  reset ();
+
+  if (!is_supported (format_))
+    return false;
+
+  if (src_width_ == 0 || src_height_ == 0 || dst_width_ == 0 || dst_height_ == 0
+      || (src_width_ | src_height_ | dst_width_ | dst_height_) & 1)
+    return false;
+
+  format = format_;
+  src_width = src_width_;
+  src_height = src_height_;
+  dst_width = dst_width_;
+  dst_height = dst_height_;
+
+  if (format == "YUV420P" || format == "I420")
+    layout = PLANAR;
+  else if (format == "UYVY")
+    layout = PACKED_UYVY;
+  else
+    layout = PACKED_YUYV;
+
+  unsigned stride = (layout == PLANAR) ? src_width : 2 * src_width;
+
+  luma_rows.resize (dst_height);
+  for (unsigned y = 0 ; y < dst_height ; y++)
+    luma_rows[y] = source_position (y, src_height, dst_height) * stride;
+
+  luma_columns.resize (dst_width);
+  for (unsigned x = 0 ; x < dst_width ; x++) {
+
+    unsigned sx = source_position (x, src_width, dst_width);
+
+    if (layout == PLANAR)
+      luma_columns[x] = sx;
+    else if (layout == PACKED_YUYV)
+      luma_columns[x] = 2 * sx;
+    else
+      luma_columns[x] = 2 * sx + 1;
+  }
+
+  /* chroma is subsampled by two in both directions in YUV420P, only
+   * horizontally in the packed formats : there the two source lines of a
+   * destination chroma line are averaged */
+  chroma_rows.resize (dst_height / 2);
+  chroma_next_rows.resize (dst_height / 2);
+  for (unsigned y = 0 ; y < dst_height / 2 ; y++) {
+
+    unsigned sy = source_position (y, src_height / 2, dst_height / 2);
+
+    if (layout == PLANAR) {
+
+      chroma_rows[y] = sy * (src_width / 2);
+      chroma_next_rows[y] = chroma_rows[y];
+    }
+    else {
+
+      chroma_rows[y] = 2 * sy * stride;
+      chroma_next_rows[y] = (2 * sy + 1) * stride;
+    }
+  }
+
+  chroma_columns.resize (dst_width / 2);
+  for (unsigned x = 0 ; x < dst_width / 2 ; x++) {
+
+    unsigned sx = source_position (x, src_width / 2, dst_width / 2);
+
+    if (layout == PLANAR)
+      chroma_columns[x] = sx;
+    else if (layout == PACKED_YUYV)
+      chroma_columns[x] = 4 * sx + 1;
+    else
+      chroma_columns[x] = 4 * sx;
+  }
+
+  active = true;
+
+  return true;
+}
+
+
+void
+VideoInputConverter::reset ()
+{
+  active = false;
+  format.clear ();
+  layout = PLANAR;
+  src_width = src_height = 0;
+  dst_width = dst_height = 0;
+  luma_rows.clear ();
+  luma_columns.clear ();
+  chroma_rows.clear ();
+  chroma_next_rows.clear ();
+  chroma_columns.clear ();
+}
+
+
+bool
+VideoInputConverter::is_passthrough () const
+{
+  return (active && layout == PLANAR
+          && src_width == dst_width && src_height == dst_height);
+}
+
+
+unsigned
+VideoInputConverter::get_source_size () const
+{
+  if (layout == PLANAR)
+    return (src_width * src_height * 3) >> 1;
+
+  return src_width * src_height * 2;
+}
+
+
+void
+VideoInputConverter::convert (const unsigned char *src,
+                              unsigned char *dst) const
+{
+  if (!active)
+    return;
+
+  if (is_passthrough ()) {
+
+    memcpy (dst, src, get_source_size ());
+    return;
+  }
+
+  convert_luma (src, dst);
+
+  if (layout == PLANAR)
+    convert_planar_chroma (src, dst + dst_width * dst_height);
+  else
+    convert_packed_chroma (src, dst + dst_width * dst_height);
+}
+
+
+std::string
+VideoInputConverter::describe () const
+{
+  std::ostringstream result;
+
+  if (!active)
+    return "";
+
+  result << format << " " << src_width << "x" << src_height
+         << " -> YUV420P " << dst_width << "x" << dst_height;
+
+  return result.str ();
+}
+
+
+void
+VideoInputConverter::convert_luma (const unsigned char *src,
+                                   unsigned char *dst) const
+{
+  const unsigned *columns = &luma_columns[0];
+
+  for (unsigned y = 0 ; y < dst_height ; y++) {
+
+    const unsigned char *row = src + luma_rows[y];
+    unsigned char *out = dst + y * dst_width;
+
+    if (layout == PLANAR && src_width == dst_width)
+      memcpy (out, row, dst_width);
+    else
+      for (unsigned x = 0 ; x < dst_width ; x++)
+        out[x] = row[columns[x]];
+  }
+}
+
+
+void
+VideoInputConverter::convert_planar_chroma (const unsigned char *src,
+                                            unsigned char *dst) const
+{
+  const unsigned *columns = &chroma_columns[0];
+  unsigned width = dst_width / 2;
+  unsigned height = dst_height / 2;
+
+  for (unsigned plane = 0 ; plane < 2 ; plane++) {
+
+    const unsigned char *base = src + src_width * src_height
+      + plane * ((src_width * src_height) >> 2);
+    unsigned char *out = dst + plane * width * height;
+
+    for (unsigned y = 0 ; y < height ; y++, out += width) {
+
+      const unsigned char *row = base + chroma_rows[y];
+
+      if (src_width == dst_width)
+        memcpy (out, row, width);
+      else
+        for (unsigned x = 0 ; x < width ; x++)
+          out[x] = row[columns[x]];
+    }
+  }
+}
+
+
+void
+VideoInputConverter::convert_packed_chroma (const unsigned char *src,
+                                            unsigned char *dst) const
+{
+  const unsigned *columns = &chroma_columns[0];
+  unsigned width = dst_width / 2;
+  unsigned height = dst_height / 2;
+  unsigned char *u = dst;
+  unsigned char *v = dst + width * height;
+
+  for (unsigned y = 0 ; y < height ; y++, u += width, v += width) {
+
+    const unsigned char *row = src + chroma_rows[y];
+    const unsigned char *next = src + chroma_next_rows[y];
+
+    for (unsigned x = 0 ; x < width ; x++) {
+
+      unsigned offset = columns[x];
+
+      u[x] = (unsigned char) ((row[offset] + next[offset] + 1) >> 1);
+      v[x] = (unsigned char) ((row[offset + 2] + next[offset + 2] + 1) >> 1);
+    }
+  }
+}
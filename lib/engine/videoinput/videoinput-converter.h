@@ -0,0 +1,140 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         videoinput-converter.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Declaration of the converter turning the
+ *                          native frames of a capture device into YUV420P
+ *                          frames of the requested size.
+ *
+ */
+
+#ifndef __VIDEOINPUT_CONVERTER_H__
+#define __VIDEOINPUT_CONVERTER_H__
+
+#include <string>
+#include <vector>
+
+namespace Ekiga
+{
+/**
+ * @addtogroup videoinput
+ * @{
+ */
+
+  /** Converts and scales native capture frames into YUV420P in one pass.
+   *
+   * The source pixel of every destination pixel is computed once in
+   * setup () and kept in tables, so that converting a frame is only a
+   * sequence of table lookups without any arithmetic or branch in the
+   * inner loops.
+   */
+  class VideoInputConverter
+  {
+  public:
+
+    VideoInputConverter ();
+
+    /** Return true if frames in that native colour format can be converted
+     * @param format is the PTLib name of the colour format (YUV420P, YUY2...).
+     */
+    static bool is_supported (const std::string & format);
+
+    /** Prepare the conversion of native frames
+     * @param format is the PTLib name of the native colour format.
+     * @param src_width and src_height are the native frame size.
+     * @param dst_width and dst_height are the requested frame size.
+     * @return false if the format isn't supported or a size is odd.
+     */
+    bool setup (const std::string & format,
+                unsigned src_width,
+                unsigned src_height,
+                unsigned dst_width,
+                unsigned dst_height);
+
+    /** Forget the current setup
+     */
+    void reset ();
+
+    /** Return true if setup () succeeded
+     */
+    bool is_active () const { return active; }
+
+    /** Return true if native frames already are what was requested
+     */
+    bool is_passthrough () const;
+
+    /** Return the size in bytes of a native frame
+     */
+    unsigned get_source_size () const;
+
+    /** Convert a native frame into a YUV420P frame of the requested size
+     * @param src is a native frame, get_source_size () bytes long.
+     * @param dst is a buffer of dst_width * dst_height * 3 / 2 bytes.
+     */
+    void convert (const unsigned char *src,
+                  unsigned char *dst) const;
+
+    /** Return a human-readable description of the pipeline, like
+     * "YUY2 640x480 -> YUV420P 352x288".
+     */
+    std::string describe () const;
+
+  private:
+
+    typedef enum { PLANAR, PACKED_YUYV, PACKED_UYVY } Layout;
+
+    void convert_luma (const unsigned char *src,
+                       unsigned char *dst) const;
+    void convert_planar_chroma (const unsigned char *src,
+                                unsigned char *dst) const;
+    void convert_packed_chroma (const unsigned char *src,
+                                unsigned char *dst) const;
+
+    bool active;
+    std::string format;
+    Layout layout;
+    unsigned src_width;
+    unsigned src_height;
+    unsigned dst_width;
+    unsigned dst_height;
+
+    /* byte offsets in the native frame, one per destination row or column */
+    std::vector<unsigned> luma_rows;
+    std::vector<unsigned> luma_columns;
+    std::vector<unsigned> chroma_rows;
+    std::vector<unsigned> chroma_next_rows;
+    std::vector<unsigned> chroma_columns;
+  };
+
+/**
+ * @}
+ */
+};
+
+#endif
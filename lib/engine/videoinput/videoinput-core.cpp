@@ -36,6 +36,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <cstring>
 
 #include "config.h"
 
@@ -44,88 +45,132 @@
 
 using namespace Ekiga;
 
-VideoInputCore::VideoPreviewManager::VideoPreviewManager (VideoInputCore& _videoinput_core, VideoOutputCore& _videooutput_core)
-: PThread (1000, NoAutoDeleteThread, HighestPriority, "VideoPreviewManager"),
-    videoinput_core (_videoinput_core),
-  videooutput_core (_videooutput_core)
+/* how long the capture thread waits for the core lock before checking if
+ * it is asked to stop (ms) */
+#define FALLBACK_WAIT 20
+
+VideoInputCore::VideoCaptureManager::VideoCaptureManager (VideoInputCore& _videoinput_core)
+: PThread (1000, NoAutoDeleteThread, HighestPriority, "VideoCaptureManager"),
+  videoinput_core (_videoinput_core)
 {
-  videooutput_core.reference ();
-  width = 176;
-  height = 144;;
+  frame = NULL;
+  width = height = fps = 0;
   pause_thread = true;
   end_thread = false;
-  frame = NULL;
   // Since windows does not like to restart a thread that 
   // was never started, we do so here
   this->Resume ();
   thread_paused.Wait();
 }
 
-VideoInputCore::VideoPreviewManager::~VideoPreviewManager ()
+VideoInputCore::VideoCaptureManager::~VideoCaptureManager ()
 {
   if (!pause_thread)
     stop();
   end_thread = true;
   run_thread.Signal();
   thread_ended.Wait();
-  videooutput_core.unreference ();
 }
 
-void VideoInputCore::VideoPreviewManager::start (unsigned _width, unsigned _height)
+void VideoInputCore::VideoCaptureManager::start (unsigned _width, unsigned _height, unsigned _fps)
 {
-  PTRACE(4, "PreviewManager\tStarting Preview");
+  PTRACE(4, "CaptureManager\tStarting capture");
   width = _width;
   height = _height;
-  end_thread = false;
-  frame = (char*) malloc (unsigned (width * height * 3 / 2));
+  fps = _fps;
+  frame = (char*) malloc (width * height * 3 / 2);
 
-  videooutput_core.start();
   pause_thread = false;
   run_thread.Signal();
 }
 
-void VideoInputCore::VideoPreviewManager::stop ()
+void VideoInputCore::VideoCaptureManager::stop ()
 {
-  PTRACE(4, "PreviewManager\tStopping Preview");
+  PTRACE(4, "CaptureManager\tStopping capture");
   pause_thread = true;
   thread_paused.Wait();
 
-  if (frame) {
-    free (frame);
-    frame = NULL;
-  }  
-  videooutput_core.stop();
+  free (frame);
+  frame = NULL;
 }
 
-void VideoInputCore::VideoPreviewManager::Main ()
+void VideoInputCore::VideoCaptureManager::Main ()
 {
   PWaitAndSignal m(thread_ended);
 
-    
   while (!end_thread) {
 
     thread_paused.Signal ();
     run_thread.Wait ();
-    
+
     while (!pause_thread) {
-      if (frame) {
-        videoinput_core.get_frame_data(frame);
-        videooutput_core.set_frame_data(frame, width, height, true, 1);
-      }
-      // We have to sleep some time outside the mutex lock
-      // to give other threads time to get the mutex
-      // It will be taken into account by PAdaptiveDelay
-      Current()->Sleep (5);
-    }
 
+      videoinput_core.internal_capture_frame (frame);
+      videoinput_core.tee.push (frame, width, height, fps, PTime ());
+    }
   }
 }
 
+VideoInputCore::VideoPreviewManager::VideoPreviewManager (VideoInputCore& _videoinput_core, VideoOutputCore& _videooutput_core)
+: videoinput_core (_videoinput_core),
+  videooutput_core (_videooutput_core)
+{
+  videooutput_core.reference ();
+  active = false;
+  width = 176;
+  height = 144;
+  fps = 0;
+}
+
+VideoInputCore::VideoPreviewManager::~VideoPreviewManager ()
+{
+  if (active)
+    stop();
+  videooutput_core.unreference ();
+}
+
+void VideoInputCore::VideoPreviewManager::start (unsigned _width, unsigned _height, unsigned _fps)
+{
+  PTRACE(4, "PreviewManager\tStarting Preview");
+  width = _width;
+  height = _height;
+  fps = _fps;
+
+  videooutput_core.start();
+  videoinput_core.add_sink (*this, width, height, fps);
+  active = true;
+}
+
+void VideoInputCore::VideoPreviewManager::stop ()
+{
+  PTRACE(4, "PreviewManager\tStopping Preview");
+  videoinput_core.remove_sink (*this);
+  active = false;
+
+  videooutput_core.stop();
+}
+
+bool VideoInputCore::VideoPreviewManager::running (unsigned _width, unsigned _height, unsigned _fps) const
+{
+  return (active && width == _width && height == _height && fps == _fps);
+}
+
+void VideoInputCore::VideoPreviewManager::on_frame (const char *data,
+                                                    unsigned _width,
+                                                    unsigned _height,
+                                                    const PTime & /*timestamp*/)
+{
+  // in a call, the local video is displayed along the devices Opal opened
+  int devices_nbr = videooutput_core.get_devices_nbr ();
+
+  videooutput_core.set_frame_data (data, _width, _height, true,
+                                   devices_nbr > 0 ? devices_nbr : 1);
+}
+
 VideoInputCore::VideoInputCore (VideoOutputCore& _videooutput_core)
-:  preview_manager(*this, _videooutput_core)
+:  capture_manager(*this), preview_manager(*this, _videooutput_core)
 {
   PWaitAndSignal m_var(core_mutex);
-  PWaitAndSignal m_set(settings_mutex);
 
   preview_config.active = false;
   preview_config.width = 176;
@@ -142,10 +187,11 @@ VideoInputCore::VideoInputCore (VideoOutputCore& _videooutput_core)
   current_settings.colour = 0;
   current_settings.contrast = 0;
 
-  desired_settings.brightness = 0;
-  desired_settings.whiteness = 0;
-  desired_settings.colour = 0;
-  desired_settings.contrast = 0;
+  desired_brightness = 0;
+  desired_whiteness = 0;
+  desired_colour = 0;
+  desired_contrast = 0;
+  settings_changed = 0;
 
   current_manager = NULL;
   videoinput_core_conf_bridge = NULL;
@@ -178,9 +224,9 @@ void VideoInputCore::add_manager (VideoInputManager &manager)
   managers.insert (&manager);
   manager_added.emit (manager);
 
-  manager.device_opened.connect (sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_opened), &manager));
-  manager.device_closed.connect (sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_closed), &manager));
-  manager.device_error.connect (sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_error), &manager));
+  manager.device_events.subscribe (InternedString ("opened"), sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_opened), &manager));
+  manager.device_events.subscribe (InternedString ("closed"), sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_closed), &manager));
+  manager.device_events.subscribe (InternedString ("error"), sigc::bind (sigc::mem_fun (this, &VideoInputCore::on_device_error), &manager));
 }
 
 
@@ -277,14 +323,12 @@ void VideoInputCore::set_preview_config (unsigned width, unsigned height, unsign
   if ( ( preview_config.active && !stream_config.active) &&
        ( preview_config        !=  new_preview_config) )
   {
-    preview_manager.stop();
-    internal_close();
-
-    internal_open(new_preview_config.width, new_preview_config.height, new_preview_config.fps);
-    preview_manager.start(new_preview_config.width, new_preview_config.height);
+    internal_stop();
+    internal_start(new_preview_config.width, new_preview_config.height, new_preview_config.fps);
   }
 
   preview_config = new_preview_config;
+  internal_update_preview ();
 }
 
 
@@ -293,12 +337,11 @@ void VideoInputCore::start_preview ()
   PWaitAndSignal m(core_mutex);
 
   PTRACE(4, "VidInputCore\tStarting preview " << preview_config);
-  if (!preview_config.active && !stream_config.active) {
-    internal_open(preview_config.width, preview_config.height, preview_config.fps);
-    preview_manager.start(preview_config.width, preview_config.height);
-  }
+  if (!preview_config.active && !stream_config.active)
+    internal_start(preview_config.width, preview_config.height, preview_config.fps);
 
   preview_config.active = true;
+  internal_update_preview ();
 }
 
 void VideoInputCore::stop_preview ()
@@ -307,12 +350,12 @@ void VideoInputCore::stop_preview ()
 
   PTRACE(4, "VidInputCore\tStopping Preview");
   if (preview_config.active && !stream_config.active) {
-    preview_manager.stop();
-    internal_close();
+    internal_stop();
     internal_set_manager(desired_device, current_channel, current_format);
   }
 
   preview_config.active = false;
+  internal_update_preview ();
 }
 
 void VideoInputCore::set_stream_config (unsigned width, unsigned height, unsigned fps)
@@ -337,19 +380,19 @@ void VideoInputCore::start_stream ()
 
   PTRACE(4, "VidInputCore\tStarting stream " << stream_config);
   if (preview_config.active && !stream_config.active) {
-    preview_manager.stop();
     if ( preview_config != stream_config ) 
     {
-      internal_close();
-      internal_open(stream_config.width, stream_config.height, stream_config.fps);
+      internal_stop();
+      internal_start(stream_config.width, stream_config.height, stream_config.fps);
     }
   }
 
   if (!preview_config.active && !stream_config.active) {
-    internal_open(stream_config.width, stream_config.height, stream_config.fps);
+    internal_start(stream_config.width, stream_config.height, stream_config.fps);
   }
 
   stream_config.active = true;
+  internal_update_preview ();
 }
 
 void VideoInputCore::stop_stream ()
@@ -360,105 +403,88 @@ void VideoInputCore::stop_stream ()
   if (preview_config.active && stream_config.active) {
     if ( preview_config != stream_config ) 
     {
-      internal_close();
+      internal_stop();
       internal_set_manager(desired_device, current_channel, current_format);
-      internal_open(preview_config.width, preview_config.height, preview_config.fps);
+      internal_start(preview_config.width, preview_config.height, preview_config.fps);
     }
-    preview_manager.start(preview_config.width, preview_config.height);
   }
 
   if (!preview_config.active && stream_config.active) {
-    internal_close();
+    internal_stop();
     internal_set_manager(desired_device, current_channel, current_format);
   }
 
   stream_config.active = false;
+  internal_update_preview ();
 }
 
-void VideoInputCore::get_frame_data (char *data)
+void VideoInputCore::add_sink (VideoInputSink & sink, unsigned width, unsigned height, unsigned fps)
 {
-  PWaitAndSignal m(core_mutex);
-
-  if (current_manager) {
-    if (!current_manager->get_frame_data(data)) {
-
-      internal_close();
-
-      internal_set_fallback();
-
-      if (preview_config.active && !stream_config.active)
-        internal_open(preview_config.width, preview_config.height, preview_config.fps);
-
-      if (stream_config.active)
-        internal_open(stream_config.width, stream_config.height, stream_config.fps);
+  tee.add_sink (sink, width, height, fps);
+}
 
-      if (current_manager)
-        current_manager->get_frame_data(data); // the default device must always return true
-    }
-    internal_apply_settings();
-  }
+void VideoInputCore::remove_sink (VideoInputSink & sink)
+{
+  tee.remove_sink (sink);
 }
 
 void VideoInputCore::set_colour (unsigned colour)
 {
-  PWaitAndSignal m(settings_mutex);
-  desired_settings.colour = colour;
+  g_atomic_int_set (&desired_colour, colour);
+  g_atomic_int_set (&settings_changed, 1);
 }
 
 void VideoInputCore::set_brightness (unsigned brightness)
 {
-  PWaitAndSignal m(settings_mutex);
-  desired_settings.brightness = brightness;
+  g_atomic_int_set (&desired_brightness, brightness);
+  g_atomic_int_set (&settings_changed, 1);
 }
 
 void VideoInputCore::set_whiteness  (unsigned whiteness)
 {
-  PWaitAndSignal m(settings_mutex);
-  desired_settings.whiteness = whiteness;
+  g_atomic_int_set (&desired_whiteness, whiteness);
+  g_atomic_int_set (&settings_changed, 1);
 }
 
 void VideoInputCore::set_contrast   (unsigned contrast)
 {
-  PWaitAndSignal m(settings_mutex);
-  desired_settings.contrast = contrast;
+  g_atomic_int_set (&desired_contrast, contrast);
+  g_atomic_int_set (&settings_changed, 1);
 }
 
-void VideoInputCore::on_device_opened (VideoInputDevice device,
-                                     VideoInputSettings settings, 
+void VideoInputCore::on_device_opened (const VideoInputDeviceEvent & event,
                                      VideoInputManager *manager)
 {
-  device_opened.emit (*manager, device, settings);
+  PTRACE(4, "VidInputCore\tDevice opened, pipeline: " << event.settings.pipeline
+         << ", conversion: " << event.settings.conversion_cost << " us per frame");
+  device_opened.emit (*manager, event.device, event.settings);
 }
 
-void VideoInputCore::on_device_closed (VideoInputDevice device, VideoInputManager *manager)
+void VideoInputCore::on_device_closed (const VideoInputDeviceEvent & event, VideoInputManager *manager)
 {
-  device_closed.emit (*manager, device);
+  device_closed.emit (*manager, event.device);
 }
 
-void VideoInputCore::on_device_error (VideoInputDevice device, VideoInputErrorCodes error_code, VideoInputManager *manager)
+void VideoInputCore::on_device_error (const VideoInputDeviceEvent & event, VideoInputManager *manager)
 {
-  device_error.emit (*manager, device, error_code);
+  device_error.emit (*manager, event.device, event.error_code);
 }
 
 void VideoInputCore::internal_set_device(const VideoInputDevice & device, int channel, VideoInputFormat format)
 {
   PTRACE(4, "VidInputCore\tSetting device: " << device);
 
-  if (preview_config.active && !stream_config.active)
-    preview_manager.stop();
-
+  // the sinks stay registered, they just miss the frames during the switch
   if (preview_config.active || stream_config.active)
-    internal_close();
+    internal_stop();
 
   internal_set_manager (device, channel, format);
 
-  if (preview_config.active && !stream_config.active) {
-    internal_open(preview_config.width, preview_config.height, preview_config.fps);
-    preview_manager.start(preview_config.width,preview_config.height);
-  }
+  if (preview_config.active && !stream_config.active)
+    internal_start(preview_config.width, preview_config.height, preview_config.fps);
 
   if (stream_config.active)
-    internal_open(stream_config.width, stream_config.height, stream_config.fps);
+    internal_start(stream_config.width, stream_config.height, stream_config.fps);
 }
 
 void VideoInputCore::internal_set_manager (const VideoInputDevice & device, int channel, VideoInputFormat format)
@@ -517,27 +543,105 @@ void VideoInputCore::internal_close()
     current_manager->close();
 }
 
+void VideoInputCore::internal_start (unsigned width, unsigned height, unsigned fps)
+{
+  internal_open (width, height, fps);
+  capture_manager.start (width, height, fps);
+}
+
+void VideoInputCore::internal_stop ()
+{
+  capture_manager.stop ();
+  internal_close ();
+}
+
+void VideoInputCore::internal_update_preview ()
+{
+  VideoDeviceConfig config;
+
+  // the local video is displayed at the preview size when the user asked
+  // for a preview, and as it is sent otherwise
+  if (preview_config.active)
+    config = preview_config;
+  else if (stream_config.active)
+    config = stream_config;
+  else {
+
+    if (preview_manager.running ())
+      preview_manager.stop ();
+    return;
+  }
+
+  if (preview_manager.running (config.width, config.height, config.fps))
+    return;
+
+  if (preview_manager.running ())
+    preview_manager.stop ();
+  preview_manager.start (config.width, config.height, config.fps);
+}
+
+void VideoInputCore::internal_capture_frame (char *data)
+{
+  if (!current_manager)
+    return;
+
+  internal_apply_settings();
+
+  if (current_manager->get_frame_data(data))
+    return;
+
+  // Falling back changes the core state, so it needs the lock -- but the
+  // lock holder may be waiting for us to stop
+  while (!capture_manager.stopping ()) {
+
+    if (core_mutex.Wait (PTimeInterval (FALLBACK_WAIT))) {
+
+      internal_close();
+
+      internal_set_fallback();
+
+      if (preview_config.active && !stream_config.active)
+        internal_open(preview_config.width, preview_config.height, preview_config.fps);
+
+      if (stream_config.active)
+        internal_open(stream_config.width, stream_config.height, stream_config.fps);
+
+      if (current_manager)
+        current_manager->get_frame_data(data); // the default device must always return true
+
+      core_mutex.Signal();
+      return;
+    }
+  }
+}
+
 void VideoInputCore::internal_apply_settings()
 {
-  PWaitAndSignal m_set(settings_mutex);
+  if (!g_atomic_int_compare_and_exchange (&settings_changed, 1, 0))
+    return;
+
+  unsigned colour = g_atomic_int_get (&desired_colour);
+  unsigned brightness = g_atomic_int_get (&desired_brightness);
+  unsigned whiteness = g_atomic_int_get (&desired_whiteness);
+  unsigned contrast = g_atomic_int_get (&desired_contrast);
 
-  if (desired_settings.colour != current_settings.colour) {
-    current_manager->set_colour (desired_settings.colour);
-    current_settings.colour = desired_settings.colour;
+  if (colour != current_settings.colour) {
+    current_manager->set_colour (colour);
+    current_settings.colour = colour;
   }
 
-  if (desired_settings.brightness != current_settings.brightness) {
-    current_manager->set_brightness (desired_settings.brightness);
-    current_settings.brightness = desired_settings.brightness;
+  if (brightness != current_settings.brightness) {
+    current_manager->set_brightness (brightness);
+    current_settings.brightness = brightness;
   }
 
-  if (desired_settings.whiteness != current_settings.whiteness) {
-    current_manager->set_whiteness (desired_settings.whiteness);
-    current_settings.whiteness = desired_settings.whiteness;
+  if (whiteness != current_settings.whiteness) {
+    current_manager->set_whiteness (whiteness);
+    current_settings.whiteness = whiteness;
   }
 
-  if (desired_settings.contrast != current_settings.contrast) {
-    current_manager->set_contrast (desired_settings.contrast);
-    current_settings.contrast = desired_settings.contrast;
+  if (contrast != current_settings.contrast) {
+    current_manager->set_contrast (contrast);
+    current_settings.contrast = contrast;
   }
 }
@@ -43,6 +43,7 @@
 #include "hal-core.h"
 #include "videoinput-manager.h"
 #include "videoinput-gmconf-bridge.h"
+#include "videoinput-tee.h"
 
 #include <sigc++/sigc++.h>
 #include <glib.h>
@@ -65,8 +66,8 @@ namespace Ekiga
   /** Core object for the video input support
    * The video input core abstracts all functionality related to video input
    * in a thread safe manner. Typically, most of the functions except start_stream(),
-   * stop_stream(), and get_frame_data() will be called from 
-   * a UI thread, while the three mentioned funtions will be used by a video
+   * stop_stream(), add_sink() and remove_sink() will be called from 
+   * a UI thread, while the four mentioned funtions will be used by a video
    * streaming thread.
    * 
    * The video output core abstracts different video input managers, which can 
@@ -84,15 +85,24 @@ namespace Ekiga
    * back due to a removed device, and the respective device is re-added to the system,
    * it will be automatically activated.
    *
-   * The video input core can also be used in a preview mode, where it starts a separate
-   * thread (represented by the VideoPreviewManager), which grabs frames from the video 
-   * input core and passes them to the video output core. This can be used for displaying
-   * the local camera signal while not being in a call. If the preview is active and them
-   * and the stream is started, the core will automatically determined if the device needs
-   * to be reinitialized (the stream settings may be different from the preview settings
-   * due to the capabilities negotiation). In case preview is set to active and them
-   * the streaming is ended, the core will automatically switch back to preview mode,
-   * also reinitializing the device if preview settings differ from stream settings.
+   * While the device is open, a capture thread (the VideoCaptureManager) reads
+   * the frames from the manager and hands every one to a tee, which fans it
+   * out to the registered VideoInputSink objects (the encoder of the call,
+   * the local display, a recorder...), each at its own resolution and frame
+   * rate. The colour, brightness, etc. settings are passed to that thread
+   * through an atomic mailbox.
+   *
+   * The video input core can also be used in a preview mode, where it registers
+   * a sink (the VideoPreviewManager) which passes the frames to the video
+   * output core. This is used for displaying the local camera signal, in and
+   * out of a call : while streaming, the local display is fed from the same
+   * captured frames as the stream, scaled to the preview size. If the preview
+   * is active and the stream is started, the core will automatically determine
+   * if the device needs to be reinitialized (the stream settings may be different
+   * from the preview settings due to the capabilities negotiation). In case preview
+   * is active and the streaming is ended, the core will automatically switch back
+   * to preview mode, also reinitializing the device if preview settings differ
+   * from stream settings.
    */
   class VideoInputCore
     : public Service
@@ -249,17 +259,25 @@ namespace Ekiga
        */
       void stop_stream ();
 
-      /** Get one video frame buffer from the current manager.
-       * This function will block until the buffer is completely filled.
-       * Requires the stream or the preview (when being called from the 
-       * VideoPreviewManager) to be started.
-       * In case the device returns an error reading the frame, get_frame_data()
-       * falls back to the fallback device and reads the frame from there. Thus
-       * get_frame_data() always returns a frame.
-       * In case a new brightness, whiteness, etc. has bee set, it will be applied here.
-       * @param data a pointer to the frame buffer that is to be filled. The memory has to be allocated already.
+      /** Register a consumer of the captured frames
+       * The sink gets the frames captured while the device is open, whether
+       * for the stream or for the preview, from the capture thread. Calling
+       * it again for the same sink changes its configuration.
+       * In case the device returns an error reading a frame, the capture
+       * thread falls back to the fallback device and reads the frame from
+       * there, so the sinks keep getting frames.
+       * @param sink the sink.
+       * @param width the frame width the sink wants, the frames are scaled if needed.
+       * @param height the frame height the sink wants.
+       * @param fps the frame rate the sink wants at most, 0 for every frame.
+       */
+      void add_sink (VideoInputSink & sink, unsigned width, unsigned height, unsigned fps);
+
+      /** Unregister a consumer of the captured frames
+       * When this returns, the sink doesn't get frames anymore.
+       * @param sink the sink.
        */
-      void get_frame_data (char *data);
+      void remove_sink (VideoInputSink & sink);
 
 
       /** See vidinput-manager.h for the API
@@ -274,9 +292,9 @@ namespace Ekiga
 
       /** See videoinput-manager.h for the API
        */
-      sigc::signal3<void, VideoInputManager &, VideoInputDevice &, VideoInputSettings&> device_opened;
-      sigc::signal2<void, VideoInputManager &, VideoInputDevice &> device_closed;
-      sigc::signal3<void, VideoInputManager &, VideoInputDevice &, VideoInputErrorCodes> device_error;
+      sigc::signal3<void, VideoInputManager &, const VideoInputDevice &, const VideoInputSettings &> device_opened;
+      sigc::signal2<void, VideoInputManager &, const VideoInputDevice &> device_closed;
+      sigc::signal3<void, VideoInputManager &, const VideoInputDevice &, VideoInputErrorCodes> device_error;
 
       /** This signal is emitted when a video input has been added to the system.
        * This signal will be emitted if add_device was called with a device name and
@@ -293,11 +311,9 @@ namespace Ekiga
       sigc::signal2<void, VideoInputDevice, bool> device_removed;
 
   private:
-      void on_device_opened (VideoInputDevice device,  
-                             VideoInputSettings settings, 
-                             VideoInputManager *manager);
-      void on_device_closed (VideoInputDevice device, VideoInputManager *manager);
-      void on_device_error  (VideoInputDevice device, VideoInputErrorCodes error_code, VideoInputManager *manager);
+      void on_device_opened (const VideoInputDeviceEvent & event, VideoInputManager *manager);
+      void on_device_closed (const VideoInputDeviceEvent & event, VideoInputManager *manager);
+      void on_device_error  (const VideoInputDeviceEvent & event, VideoInputManager *manager);
 
       void internal_set_device(const VideoInputDevice & vidinput_device, int channel, VideoInputFormat format);
       void internal_set_manager (const VideoInputDevice & vidinput_device, int channel, VideoInputFormat format);
@@ -306,21 +322,30 @@ namespace Ekiga
       void internal_open (unsigned width, unsigned height, unsigned fps);
       void internal_close();
 
+      /* open and start capturing, stop capturing and close */
+      void internal_start (unsigned width, unsigned height, unsigned fps);
+      void internal_stop ();
+
+      /* register the local display sink with the right configuration, or
+       * unregister it, after the preview or the stream changed */
+      void internal_update_preview ();
+
+      /* called in the capture thread */
+      friend class VideoCaptureManager;
+      void internal_capture_frame (char *data);
       void internal_apply_settings();
 
 private:
-      /** VideoPreviewManager thread.
+      /** VideoPreviewManager sink.
         *
-        * VideoPreviewManager represents a thread that gets frames from the 
+        * VideoPreviewManager represents the sink that gets frames from the 
         * video input core and passes them to the video output core. This is 
-        * used for displaying the preview video. This thread will run only 
-        * while preview is active. It is called from the VideoInputCore, which
+        * used for displaying the local video. It is registered while the
+        * preview or the stream is active, by the VideoInputCore, which
         * has the interface to the application for enabling and disabling the preview.
         */
-      class VideoPreviewManager : public PThread
+      class VideoPreviewManager : public VideoInputSink
       {
-        PCLASSINFO(VideoPreviewManager, PThread);
-
       public:
         /** The constructor
         * @param _videoinput_core reference to the video input core.
@@ -332,34 +357,90 @@ private:
         */
         ~VideoPreviewManager();
 
-        /** Start the preview thread.
-        * Start the thread represented by the Main() function. Block until the thread is running.
-        * Requires the the current device to be opened.
-        * In case the resolution is changed, the preview manager has to be stopped and restarted.
+        /** Start the preview.
+        * Register to the video input core, and start the video output.
+        * In case the configuration is changed, the preview manager has to be stopped and restarted.
         * @param width the frame width in pixels of the preview video.
         * @param height the frame width in pixels of the preview video.
+        * @param fps the frame rate of the preview video.
         */
-        virtual void start(unsigned _width, unsigned _height);
+        void start(unsigned _width, unsigned _height, unsigned _fps);
 
-        /** Stop the preview thread.
-        * Stop the thread represented by the Main() function. Blocks until the thread has terminated.
+        /** Stop the preview.
+        * Blocks until the sink isn't fed anymore.
         */
-        virtual void stop();
+        void stop();
+
+        /** Tell whether the preview is started, and with which configuration
+        */
+        bool running (unsigned _width, unsigned _height, unsigned _fps) const;
+        bool running () const { return active; }
+
+        void on_frame (const char *data, unsigned width, unsigned height, const PTime & timestamp);
+
+      protected:
+        bool active;
+
+        VideoInputCore  & videoinput_core;
+        VideoOutputCore & videooutput_core;
+        unsigned width;
+        unsigned height;
+        unsigned fps;
+      };
+
+      /** VideoCaptureManager thread.
+        *
+        * VideoCaptureManager represents a thread that reads the frames from
+        * the current manager while the device is open, and pushes them to
+        * the tee. It is the only one to touch the manager while it runs : the
+        * VideoInputCore stops it before closing or changing the device.
+        */
+      class VideoCaptureManager : public PThread
+      {
+        PCLASSINFO(VideoCaptureManager, PThread);
+
+      public:
+        /** The constructor
+        * @param _videoinput_core reference to the video input core.
+        */
+        VideoCaptureManager(VideoInputCore & _videoinput_core);
+
+        /** The destructor
+        */
+        ~VideoCaptureManager();
+
+        /** Start the capture thread.
+        * Requires the current device to be opened with that configuration.
+        * @param width the frame width in pixels.
+        * @param height the frame height in pixels.
+        * @param fps the frame rate.
+        */
+        void start(unsigned _width, unsigned _height, unsigned _fps);
+
+        /** Stop the capture thread.
+        * Blocks until the thread doesn't touch the device anymore.
+        */
+        void stop();
+
+        /** Tell whether the capture thread is asked to stop.
+        */
+        bool stopping() const { return pause_thread; }
 
       protected:
         void Main ();
+
         char* frame;
+        unsigned width;
+        unsigned height;
+        unsigned fps;
 
-        bool end_thread;
-        bool pause_thread;
+        volatile bool end_thread;
+        volatile bool pause_thread;
         PMutex     thread_ended;
         PSyncPoint thread_paused;
         PSyncPoint run_thread;
 
         VideoInputCore  & videoinput_core;
-        VideoOutputCore & videooutput_core;
-        unsigned width;
-        unsigned height;
       };
 
       /** Class for storing the device configuration.
@@ -428,11 +509,19 @@ private:
       VideoInputFormat        current_format;
       int                     current_channel;
       VideoInputSettings      current_settings; 
-      VideoInputSettings      desired_settings;
+
+      /* the settings mailbox : the setters store the value, then raise
+       * the flag, and the capture thread applies them */
+      volatile gint           desired_colour;
+      volatile gint           desired_brightness;
+      volatile gint           desired_whiteness;
+      volatile gint           desired_contrast;
+      volatile gint           settings_changed;
 
       PMutex core_mutex;
-      PMutex settings_mutex;
 
+      VideoInputTee tee;
+      VideoCaptureManager capture_manager;
       VideoPreviewManager preview_manager;
       VideoInputCoreConfBridge* videoinput_core_conf_bridge;
     };
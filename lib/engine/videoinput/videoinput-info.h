@@ -70,11 +70,17 @@ namespace Ekiga
   class VideoInputDevice : public Device {};
 
   typedef struct VideoInputSettings {
+    VideoInputSettings (): whiteness(0), brightness(0), colour(0),
+                           contrast(0), modifyable(false), conversion_cost(0)
+    {}
+
     unsigned whiteness;
     unsigned brightness;
     unsigned colour;
     unsigned contrast;
     bool modifyable;
+    std::string pipeline;       // how the frames get from the device to us
+    unsigned conversion_cost;   // microseconds spent per frame converting
   } VideoInputSettings;
 
   enum VideoInputFormat {
@@ -42,6 +42,7 @@
 #include <sigc++/sigc++.h>
 
 #include "videoinput-info.h"
+#include "event-bus.h"
 
 namespace Ekiga
 {
@@ -51,6 +52,19 @@ namespace Ekiga
  * @{
  */
 
+  /** What a video input manager publishes when its device is opened, is
+   * closed, or fails : see VideoInputManager::device_events.
+   */
+  struct VideoInputDeviceEvent
+  {
+    VideoInputDeviceEvent (): error_code(VI_ERROR_NONE)
+    {}
+
+    VideoInputDevice device;
+    VideoInputSettings settings;   // when it's opened
+    VideoInputErrorCodes error_code;   // when it fails
+  };
+
   /** Generic implementation for the Ekiga::VideoInputManager class.
    *
    * Each VideoInputManager will represent a specific backend able to record video.
@@ -154,24 +168,47 @@ namespace Ekiga
 
       /*** API to act on VidInputDevice events ***/
 
-      /** This signal is emitted when a video input device is opened.
-       * @param device the video input device that was opened.
-       * @param config the current video input device configuration (current brightness, colour, etc.).
-       */
-      sigc::signal2<void, VideoInputDevice, VideoInputSettings> device_opened;
-
-      /** This signal is emitted when a video input device is closed.
-       * @param device the video input device that was closed.
-       */
-      sigc::signal1<void, VideoInputDevice> device_closed;
-
-      /** This signal is emitted when an error occurs when opening a video input device.
-       * @param device the video input device that caused the error.
-       * @param error_code the video input device error code.
+      /** The events of the devices of the manager, on the "opened",
+       * "closed" and "error" topics, which it publishes in the main thread.
+       * The record of a topic is reused from one event to the next, so
+       * delivering one allocates nothing : listeners get a reference to
+       * it, which is only valid during the call.
        */
-      sigc::signal2<void, VideoInputDevice, VideoInputErrorCodes> device_error;
+      EventBus<VideoInputDeviceEvent> device_events;
+
+  protected:
+      /* to be called in the main thread */
+      void publish_device_opened (const VideoInputDevice & device,
+                                  const VideoInputSettings & settings)
+      {
+        InternedString topic("opened");
+        VideoInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        event.settings = settings;
+        device_events.publish (topic);
+      }
+
+      void publish_device_closed (const VideoInputDevice & device)
+      {
+        InternedString topic("closed");
+        VideoInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        device_events.publish (topic);
+      }
+
+      void publish_device_error (const VideoInputDevice & device,
+                                 VideoInputErrorCodes error_code)
+      {
+        InternedString topic("error");
+        VideoInputDeviceEvent & event = device_events.record (topic);
+
+        event.device = device;
+        event.error_code = error_code;
+        device_events.publish (topic);
+      }
 
-  protected:  
       typedef struct ManagerState {
         bool opened;
         unsigned width;
@@ -0,0 +1,184 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         videoinput-tee.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Implementation of the tee fanning the captured
+ *                          frames out to several consumers.
+ *
+ */
+
+#include "videoinput-tee.h"
+
+#include <algorithm>
+
+using namespace Ekiga;
+
+VideoInputTee::VideoInputTee ()
+  : frame_count(0)
+{
+}
+
+
+void
+VideoInputTee::add_sink (VideoInputSink & sink,
+                         unsigned width,
+                         unsigned height,
+                         unsigned fps)
+{
+  PWaitAndSignal m(mutex);
+
+  PTRACE(4, "VidInputTee\tAdding sink " << &sink << " at " << width << "x" << height << "/" << fps);
+
+  SinkConfig & config = sinks[&sink];
+  config.width = width;
+  config.height = height;
+  config.fps = fps;
+  config.credit = 0;
+}
+
+
+void
+VideoInputTee::remove_sink (VideoInputSink & sink)
+{
+  PWaitAndSignal m(mutex);
+
+  {
+    PWaitAndSignal m(mutex);
+
+    PTRACE(4, "VidInputTee\tRemoving sink " << &sink);
+
+    sinks.erase (&sink);
+  }
+
+  // the frame being fed may still have the sink in its snapshot
+  PWaitAndSignal f(feeding_mutex);
+}
+
+
+void
+VideoInputTee::push (const char *data,
+                     unsigned width,
+                     unsigned height,
+                     unsigned fps,
+                     const PTime & timestamp)
+{
+  PWaitAndSignal f(feeding_mutex);
+
+  frame_count++;
+  deliveries.clear ();
+  sizes.clear ();
+
+  {
+    PWaitAndSignal m(mutex);
+
+    for (std::map<VideoInputSink *, SinkConfig>::iterator iter = sinks.begin ();
+         iter != sinks.end ();
+         ++iter) {
+
+      SinkConfig & config = iter->second;
+      Delivery delivery;
+
+      delivery.sink = iter->first;
+      delivery.size = Size (config.width, config.height);
+      sizes.push_back (delivery.size);
+
+      /* spread the frames a slower sink gets evenly : it earns its rate at
+       * every captured frame, and spends the capture rate on every frame
+       * it gets */
+      if (config.fps != 0 && config.fps < fps) {
+
+        config.credit += config.fps;
+        if (config.credit < fps)
+          continue;
+        config.credit -= fps;
+      }
+
+      deliveries.push_back (delivery);
+    }
+  }
+
+  // drop the scaled versions nobody asks for anymore
+  std::map<Size, Scaled>::iterator iter = cache.begin ();
+  while (iter != cache.end ()) {
+
+    if (std::find (sizes.begin (), sizes.end (), iter->first) != sizes.end ())
+      ++iter;
+    else
+      cache.erase (iter++);
+  }
+
+  for (std::vector<Delivery>::const_iterator delivery = deliveries.begin ();
+       delivery != deliveries.end ();
+       ++delivery) {
+
+    const char *frame = data;
+    if (delivery->size.first != width || delivery->size.second != height)
+      frame = get_scaled (data, width, height, delivery->size);
+
+    if (frame)
+      delivery->sink->on_frame (frame, delivery->size.first, delivery->size.second, timestamp);
+  }
+}
+
+
+const char *
+VideoInputTee::get_scaled (const char *data,
+                           unsigned width,
+                           unsigned height,
+                           const Size & size)
+{
+  Scaled & scaled = cache[size];
+
+  if (scaled.src_width != width || scaled.src_height != height) {
+
+    scaled.src_width = width;
+    scaled.src_height = height;
+    scaled.frame = 0;
+
+    if (!scaled.converter.setup ("YUV420P", width, height, size.first, size.second)) {
+
+      PTRACE(1, "VidInputTee\tCannot scale " << width << "x" << height
+             << " to " << size.first << "x" << size.second);
+      scaled.buffer.clear ();
+      return NULL;
+    }
+    scaled.buffer.resize ((size.first * size.second * 3) >> 1);
+  }
+
+  if (scaled.buffer.empty ())
+    return NULL;
+
+  if (scaled.frame != frame_count) {
+
+    scaled.converter.convert ((const unsigned char *) data, &scaled.buffer[0]);
+    scaled.frame = frame_count;
+  }
+
+  return (const char *) &scaled.buffer[0];
+}
@@ -0,0 +1,179 @@
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         videoinput-tee.h  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : Declaration of the tee fanning the captured
+ *                          frames out to several consumers.
+ *
+ */
+
+#ifndef __VIDEOINPUT_TEE_H__
+#define __VIDEOINPUT_TEE_H__
+
+#include "videoinput-converter.h"
+
+#include "ptbuildopts.h"
+#include "ptlib.h"
+
+#include <map>
+#include <vector>
+
+namespace Ekiga
+{
+/**
+ * @addtogroup videoinput
+ * @{
+ */
+
+  /** A consumer of the captured frames
+   */
+  class VideoInputSink
+  {
+  public:
+
+    virtual ~VideoInputSink () {}
+
+    /** Called from the capture thread for every frame the sink gets.
+     * It must return quickly, as the other sinks wait for it, and it must
+     * not remove sinks (adding one, or changing its configuration, is
+     * fine : it applies from the next frame).
+     * @param data the frame, in YUV420P ; it is only valid during the call.
+     * @param width the frame width in pixels.
+     * @param height the frame height in pixels.
+     * @param timestamp the time the frame was captured.
+     */
+    virtual void on_frame (const char *data,
+                           unsigned width,
+                           unsigned height,
+                           const PTime & timestamp) = 0;
+  };
+
+
+  /** Fans the captured frames out to the registered sinks.
+   *
+   * Each sink asks for its own resolution and frame rate : frames are
+   * dropped for the sinks asking for less than the capture rate, and
+   * scaled for the sinks asking for another size. A scaled version is
+   * computed at most once per captured frame, however many sinks share
+   * its size.
+   *
+   * The sinks are fed from a copy of their list, taken at every frame, so
+   * a slow sink doesn't keep the others from being added or configured.
+   */
+  class VideoInputTee
+  {
+  public:
+
+    VideoInputTee ();
+
+    /** Register a sink, or change its configuration
+     * @param sink the sink.
+     * @param width the frame width the sink wants.
+     * @param height the frame height the sink wants.
+     * @param fps the frame rate the sink wants, 0 for every frame.
+     */
+    void add_sink (VideoInputSink & sink,
+                   unsigned width,
+                   unsigned height,
+                   unsigned fps);
+
+    /** Unregister a sink
+     * When this returns, the sink isn't being fed anymore and won't be :
+     * this waits for the frame being fed, if any.
+     * @param sink the sink.
+     */
+    void remove_sink (VideoInputSink & sink);
+
+    /** Feed a captured frame to the sinks
+     * @param data the frame, in YUV420P.
+     * @param width the frame width in pixels.
+     * @param height the frame height in pixels.
+     * @param fps the capture frame rate.
+     * @param timestamp the time the frame was captured.
+     */
+    void push (const char *data,
+               unsigned width,
+               unsigned height,
+               unsigned fps,
+               const PTime & timestamp);
+
+  private:
+
+    struct SinkConfig
+    {
+      unsigned width;
+      unsigned height;
+      unsigned fps;
+      unsigned credit;  // decimation accumulator
+    };
+
+    struct Scaled
+    {
+      Scaled (): frame(0), src_width(0), src_height(0) {}
+
+      VideoInputConverter converter;
+      std::vector<unsigned char> buffer;
+      unsigned long frame;  // the frame the buffer holds
+      unsigned src_width;
+      unsigned src_height;
+    };
+
+    typedef std::pair<unsigned, unsigned> Size;
+
+    struct Delivery
+    {
+      VideoInputSink *sink;
+      Size size;
+    };
+
+    const char *get_scaled (const char *data,
+                            unsigned width,
+                            unsigned height,
+                            const Size & size);
+
+    std::map<VideoInputSink *, SinkConfig> sinks;
+
+    /* held while the sinks are fed : the snapshot and the scaled versions
+     * are only touched by the feeding thread */
+    unsigned long frame_count;
+    std::vector<Delivery> deliveries;
+    std::vector<Size> sizes;
+    std::map<Size, Scaled> cache;
+    PMutex feeding_mutex;
+
+    /* protects the sinks, but is never held while a sink is called */
+    PMutex mutex;
+  };
+
+/**
+ * @}
+ */
+};
+
+#endif
@@ -55,6 +55,7 @@ VideoOutputCore::VideoOutputCore ()
   videooutput_stats.rx_frames = 0;
   videooutput_stats.tx_frames = 0;
   number_times_started = 0;
+  devices_nbr = 0;
   videooutput_core_conf_bridge = NULL;
 }
 
@@ -190,6 +191,20 @@ void VideoOutputCore::set_frame_data (const char *data,
   }
 }
 
+void VideoOutputCore::set_devices_nbr (int _devices_nbr)
+{
+  PWaitAndSignal m(core_mutex);
+
+  devices_nbr = _devices_nbr;
+}
+
+int VideoOutputCore::get_devices_nbr ()
+{
+  PWaitAndSignal m(core_mutex);
+
+  return devices_nbr;
+}
+
 void VideoOutputCore::set_display_info (const DisplayInfo & _display_info)
 {
   PWaitAndSignal m(core_mutex);
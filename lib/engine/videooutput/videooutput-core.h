@@ -148,6 +148,18 @@ namespace Ekiga
 
       void set_display_info (const DisplayInfo & _display_info);
 
+      /** Set the number of video devices the call displays
+       * The Opal output devices keep it, so the local frames, which are
+       * displayed without going through Opal, use the same number.
+       * @param devices_nbr 0 out of a call, else as for set_frame_data().
+       */
+      void set_devices_nbr (int devices_nbr);
+
+      /** Get the number of video devices the call displays
+       * @return 0 out of a call.
+       */
+      int get_devices_nbr ();
+
 
       /*** Statistics ***/
 
@@ -183,6 +195,7 @@ namespace Ekiga
       VideoOutputStats videooutput_stats;
       GTimeVal last_stats;
       int number_times_started;
+      int devices_nbr;
 
       PMutex core_mutex;
 
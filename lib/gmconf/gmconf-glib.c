@@ -1242,18 +1242,49 @@ gm_conf_load_sys_conf (DataBase *db)
 
 
 /* last but not least, the implementation of the gmconf.h api */
+
+/* the configuration is saved a little while after it changed, rather
+ * than periodically : the timer is only armed when there is something
+ * to save */
+static guint saveconf_timer = 0;
+
 static gboolean
 saveconf_timer_callback (G_GNUC_UNUSED gpointer unused)
 {
   DataBase *db = database_get_default ();
   gchar *user_conf = NULL;
 
+  saveconf_timer = 0;
+
   user_conf = gm_conf_get_user_conf_filename ();
   database_save_file (db, user_conf);
 
   g_free (user_conf);
 
-  return TRUE;
+  return FALSE;
+}
+
+static void
+saveconf_schedule ()
+{
+  if (saveconf_timer != 0)
+    return;
+
+#if GLIB_CHECK_VERSION (2, 14, 0)
+  saveconf_timer = g_timeout_add_seconds (5, (GSourceFunc)saveconf_timer_callback, NULL);
+#else
+  saveconf_timer = g_timeout_add (5000, (GSourceFunc)saveconf_timer_callback, NULL);
+#endif
+}
+
+static void
+saveconf_cancel ()
+{
+  if (saveconf_timer == 0)
+    return;
+
+  g_source_remove (saveconf_timer);
+  saveconf_timer = 0;
 }
 
 void
@@ -1269,14 +1300,6 @@ gm_conf_init ()
 
   /* those keys aren't found in gnomemeeting's schema */
   gm_conf_set_bool ("/desktop/gnome/interface/menus_have_icons", TRUE);
-
-  /* automatic savings */
-#if GLIB_CHECK_VERSION (2, 14, 0)
-  g_timeout_add_seconds (5, (GSourceFunc)saveconf_timer_callback, NULL);
-#else
-  g_timeout_add (5000, (GSourceFunc)saveconf_timer_callback, NULL);
-#endif
-
 }
 
 
@@ -1285,6 +1308,8 @@ gm_conf_shutdown ()
 {
   /* a crash is sure to happen if anyone uses gmconf after this... */
   DataBase *db = database_get_default ();
+
+  saveconf_cancel ();
   database_destroy (db);
 }
 
@@ -1295,6 +1320,8 @@ gm_conf_save ()
   DataBase *db = database_get_default ();
   gchar *user_conf = NULL;
 
+  saveconf_cancel ();
+
   user_conf = gm_conf_get_user_conf_filename ();
 
   database_save_file (db, user_conf);
@@ -1419,6 +1446,7 @@ gm_conf_set_bool (const gchar *key,
 
   entry_set_bool (entry, val);
   database_notify_on_namespace (db, entry_get_key (entry));
+  saveconf_schedule ();
 }
 
 gboolean
@@ -1451,6 +1479,7 @@ gm_conf_set_int (const gchar *key,
 
   entry_set_int (entry, val);
   database_notify_on_namespace (db, entry_get_key (entry));
+  saveconf_schedule ();
 }
 
 int
@@ -1483,6 +1512,7 @@ gm_conf_set_float (const gchar *key,
 
   entry_set_float (entry, val);
   database_notify_on_namespace (db, entry_get_key (entry));
+  saveconf_schedule ();
 }
 
 gfloat
@@ -1515,6 +1545,7 @@ gm_conf_set_string (const gchar *key,
 
   entry_set_string (entry, val);
   database_notify_on_namespace (db, entry_get_key (entry));
+  saveconf_schedule ();
 }
 
 gchar *
@@ -1547,6 +1578,7 @@ gm_conf_set_string_list (const gchar *key,
 
   entry_set_list (entry, val);
   database_notify_on_namespace (db, entry_get_key (entry));
+  saveconf_schedule ();
 }
 
 GSList *
@@ -1572,6 +1604,7 @@ gm_conf_destroy (const gchar *namespac)
   g_return_if_fail (namespac != NULL);
 
   database_remove_namespace (db, namespac);
+  saveconf_schedule ();
 }
 
 gboolean
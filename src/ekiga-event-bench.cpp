@@ -0,0 +1,459 @@
+
+/*
+ * Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+
+ * This program is free software; you can  redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version. This program is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Ekiga is licensed under the GPL license and as a special exception, you
+ * have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination, without
+ * applying the requirements of the GNU GPL to the OPAL, OpenH323 and PWLIB
+ * programs, as long as you do follow the requirements of the GNU GPL for all
+ * the rest of the software thus combined.
+ */
+
+
+/*
+ *                         ekiga-event-bench.cpp  -  description
+ *                         ------------------------------------------
+ *   begin                : written in 2009 by Julien Puydt
+ *   copyright            : (c) 2009 by Julien Puydt
+ *   description          : counts the heap allocations done to deliver
+ *                          a presence update or a device event
+ *
+ */
+
+
+/* Every operator new of the program is counted, and the engine code paths
+ * which deliver an event are run many times : the count divided by the
+ * number of events is what an event costs the allocator.
+ *
+ * For presence, PRESENTITIES presentities watch one uri each, and the
+ * updates go round those uris, as they come from a presence fetcher :
+ *  - "broadcast" is how the presentities listened before : each one is
+ *    connected to the signals of the presence core, gets every update by
+ *    value, and drops the ones about other uris ;
+ *  - "bus" are URIPresentity objects, which get the updates of their own
+ *    uri from the event bus of the presence core.
+ *
+ * For the devices, the null audio input and output managers and the
+ * moving logo manager are opened and closed, with their cores : each
+ * event goes from the manager through Ekiga::Runtime::run_in_main and
+ * the device bus of the manager to the core, which emits it to a listener
+ * standing for the main window :
+ *  - "copies" is a listener taking the device and settings by value, as
+ *    every step of the way did before ;
+ *  - "references" is one taking references, as they all do now.
+ * The first round of a manager, opened then closed, is counted apart :
+ * its device bus then creates its records.
+ *
+ * glib's own allocations (g_malloc) aren't counted.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <glib.h>
+
+#include "runtime.h"
+#include "presence-core.h"
+#include "uri-presentity.h"
+#include "audioinput-core.h"
+#include "audiooutput-core.h"
+#include "videoinput-core.h"
+#include "videooutput-core.h"
+#include "audioinput-manager-null.h"
+#include "audiooutput-manager-null.h"
+#include "videoinput-manager-mlogo.h"
+
+#define PRESENTITIES 1000
+#define UPDATES 100000
+#define DEVICE_EVENTS 10240
+#define DEVICE_BATCH 16
+
+
+class EventBench : public PProcess
+{
+  PCLASSINFO(EventBench, PProcess);
+
+public:
+
+  EventBench ()
+    : PProcess ("", "ekiga-event-bench")
+  {
+  }
+
+  void Main ()
+  {
+  }
+};
+
+static unsigned long allocations = 0;
+
+void *
+operator new (size_t size) throw (std::bad_alloc)
+{
+  void *result = malloc (size ? size : 1);
+
+  if (result == NULL)
+    throw std::bad_alloc ();
+
+  allocations++;
+
+  return result;
+}
+
+void *
+operator new[] (size_t size) throw (std::bad_alloc)
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *ptr) throw ()
+{
+  free (ptr);
+}
+
+void
+operator delete[] (void *ptr) throw ()
+{
+  free (ptr);
+}
+
+
+/* presence */
+
+class BenchFetcher: public Ekiga::PresenceFetcher
+{
+public:
+
+  void fetch (const std::string /*uri*/)
+  {}
+
+  void unfetch (const std::string /*uri*/)
+  {}
+};
+
+/* what a presentity did before the presence core had an event bus */
+class BroadcastListener: public sigc::trackable
+{
+public:
+
+  BroadcastListener (gmref_ptr<Ekiga::PresenceCore> presence_core,
+		     const std::string uri_): uri(uri_), presence("unknown")
+  {
+    presence_core->presence_received.connect (sigc::mem_fun (this, &BroadcastListener::on_presence_received));
+    presence_core->status_received.connect (sigc::mem_fun (this, &BroadcastListener::on_status_received));
+    presence_core->fetch_presence (uri);
+  }
+
+private:
+
+  void on_presence_received (std::string uri_,
+			     std::string presence_)
+  {
+    if (uri == uri_)
+      presence = presence_;
+  }
+
+  void on_status_received (std::string uri_,
+			   std::string status_)
+  {
+    if (uri == uri_)
+      status = status_;
+  }
+
+  std::string uri;
+  std::string presence;
+  std::string status;
+};
+
+static void
+run_presence_updates (const char *name,
+		      gmref_ptr<BenchFetcher> fetcher,
+		      const std::vector<std::string> &uris)
+{
+  static const std::string presences[] = { "online", "away", "busy" };
+  static const std::string statuses[] = {
+    "In a meeting until four o'clock",
+    "Working from home today",
+    "On the phone with a customer"
+  };
+  unsigned long before = allocations;
+  clock_t start = clock ();
+
+  for (unsigned int update = 0; update < UPDATES; update++) {
+
+    const std::string &uri = uris[update % uris.size ()];
+
+    if (update % 2 == 0)
+      fetcher->presence_received.emit (uri, presences[(update / 2) % 3]);
+    else
+      fetcher->status_received.emit (uri, statuses[(update / 2) % 3]);
+  }
+
+  double cpu = (double) (clock () - start) / CLOCKS_PER_SEC;
+
+  std::cout << "presence," << name << ","
+	    << (double) (allocations - before) / UPDATES << ","
+	    << 1000000 * cpu / UPDATES << std::endl;
+}
+
+static void
+bench_presence (bool broadcast)
+{
+  Ekiga::ServiceCore core;
+  gmref_ptr<Ekiga::PresenceCore> presence_core (new Ekiga::PresenceCore (core));
+  gmref_ptr<BenchFetcher> fetcher (new BenchFetcher);
+  std::vector<std::string> uris;
+  std::vector<BroadcastListener *> listeners;
+  std::vector<gmref_ptr<Ekiga::URIPresentity> > presentities;
+
+  core.add (presence_core);
+  presence_core->add_presence_fetcher (fetcher);
+
+  for (unsigned int index = 0; index < PRESENTITIES; index++) {
+
+    char uri[64];
+
+    snprintf (uri, sizeof (uri), "sip:bench-user-%u@ekiga.example.org", index);
+    uris.push_back (uri);
+
+    if (broadcast)
+      listeners.push_back (new BroadcastListener (presence_core, uri));
+    else
+      presentities.push_back (gmref_ptr<Ekiga::URIPresentity> (new Ekiga::URIPresentity (core, uri, uri, std::set<std::string> ())));
+  }
+
+  run_presence_updates (broadcast ? "broadcast" : "bus", fetcher, uris);
+
+  for (std::vector<BroadcastListener *>::iterator iter = listeners.begin ();
+       iter != listeners.end ();
+       ++iter)
+    delete *iter;
+}
+
+
+/* devices */
+
+static unsigned int device_events = 0;
+
+template<typename Manager, typename Device, typename Settings>
+static void
+on_opened_copy (Manager & /*manager*/,
+		Device /*device*/,
+		Settings /*settings*/)
+{
+  device_events++;
+}
+
+template<typename Manager, typename Device, typename Settings>
+static void
+on_opened (Manager & /*manager*/,
+	   const Device & /*device*/,
+	   const Settings & /*settings*/)
+{
+  device_events++;
+}
+
+template<typename Manager, typename Device>
+static void
+on_closed_copy (Manager & /*manager*/,
+		Device /*device*/)
+{
+  device_events++;
+}
+
+template<typename Manager, typename Device>
+static void
+on_closed (Manager & /*manager*/,
+	   const Device & /*device*/)
+{
+  device_events++;
+}
+
+static void
+on_output_opened_copy (Ekiga::AudioOutputManager & /*manager*/,
+		       Ekiga::AudioOutputPS /*ps*/,
+		       Ekiga::AudioOutputDevice /*device*/,
+		       Ekiga::AudioOutputSettings /*settings*/)
+{
+  device_events++;
+}
+
+static void
+on_output_opened (Ekiga::AudioOutputManager & /*manager*/,
+		  Ekiga::AudioOutputPS /*ps*/,
+		  const Ekiga::AudioOutputDevice & /*device*/,
+		  const Ekiga::AudioOutputSettings & /*settings*/)
+{
+  device_events++;
+}
+
+static void
+on_output_closed_copy (Ekiga::AudioOutputManager & /*manager*/,
+		       Ekiga::AudioOutputPS /*ps*/,
+		       Ekiga::AudioOutputDevice /*device*/)
+{
+  device_events++;
+}
+
+static void
+on_output_closed (Ekiga::AudioOutputManager & /*manager*/,
+		  Ekiga::AudioOutputPS /*ps*/,
+		  const Ekiga::AudioOutputDevice & /*device*/)
+{
+  device_events++;
+}
+
+static void
+dispatch ()
+{
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+/* each round opens and closes the device : two events ;
+ * DEVICE_EVENTS is a multiple of 2 * DEVICE_BATCH */
+static void
+run_device_events (const char *name,
+		   const char *variant,
+		   sigc::slot0<void> open,
+		   sigc::slot0<void> close)
+{
+  unsigned int received = device_events;
+  unsigned long before = allocations;
+
+  open ();
+  close ();
+  dispatch ();
+  std::cout << "device," << name << " first round," << allocations - before << "," << std::endl;
+
+  before = allocations;
+  clock_t start = clock ();
+
+  for (unsigned int event = 0; event < DEVICE_EVENTS; event += 2 * DEVICE_BATCH) {
+
+    for (unsigned int count = 0; count < DEVICE_BATCH; count++) {
+
+      open ();
+      close ();
+    }
+    dispatch ();
+  }
+
+  double cpu = (double) (clock () - start) / CLOCKS_PER_SEC;
+
+  std::cout << "device," << name << " " << variant << ","
+	    << (double) (allocations - before) / DEVICE_EVENTS << ","
+	    << 1000000 * cpu / DEVICE_EVENTS << std::endl;
+
+  if (device_events - received != DEVICE_EVENTS + 2)
+    std::cerr << "Only " << device_events - received << " " << name
+	      << " events arrived" << std::endl;
+}
+
+static void
+bench_devices (bool copies)
+{
+  const char *variant = copies ? "copies" : "references";
+  Ekiga::ServiceCore core;
+  gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core (new Ekiga::AudioOutputCore);
+  gmref_ptr<Ekiga::AudioInputCore> audioinput_core (new Ekiga::AudioInputCore (*audiooutput_core));
+  gmref_ptr<Ekiga::VideoOutputCore> videooutput_core (new Ekiga::VideoOutputCore);
+  gmref_ptr<Ekiga::VideoInputCore> videoinput_core (new Ekiga::VideoInputCore (*videooutput_core));
+  std::vector<sigc::connection> conns;
+
+  /* the cores own their managers */
+  GMAudioInputManager_null *audioinput_manager = new GMAudioInputManager_null (core);
+  GMAudioOutputManager_null *audiooutput_manager = new GMAudioOutputManager_null (core);
+  GMVideoInputManager_mlogo *videoinput_manager = new GMVideoInputManager_mlogo (core);
+
+  audioinput_core->add_manager (*audioinput_manager);
+  audiooutput_core->add_manager (*audiooutput_manager);
+  videoinput_core->add_manager (*videoinput_manager);
+
+  if (copies) {
+
+    conns.push_back (audioinput_core->device_opened.connect (sigc::ptr_fun (&on_opened_copy<Ekiga::AudioInputManager, Ekiga::AudioInputDevice, Ekiga::AudioInputSettings>)));
+    conns.push_back (audioinput_core->device_closed.connect (sigc::ptr_fun (&on_closed_copy<Ekiga::AudioInputManager, Ekiga::AudioInputDevice>)));
+    conns.push_back (audiooutput_core->device_opened.connect (sigc::ptr_fun (&on_output_opened_copy)));
+    conns.push_back (audiooutput_core->device_closed.connect (sigc::ptr_fun (&on_output_closed_copy)));
+    conns.push_back (videoinput_core->device_opened.connect (sigc::ptr_fun (&on_opened_copy<Ekiga::VideoInputManager, Ekiga::VideoInputDevice, Ekiga::VideoInputSettings>)));
+    conns.push_back (videoinput_core->device_closed.connect (sigc::ptr_fun (&on_closed_copy<Ekiga::VideoInputManager, Ekiga::VideoInputDevice>)));
+  }
+  else {
+
+    conns.push_back (audioinput_core->device_opened.connect (sigc::ptr_fun (&on_opened<Ekiga::AudioInputManager, Ekiga::AudioInputDevice, Ekiga::AudioInputSettings>)));
+    conns.push_back (audioinput_core->device_closed.connect (sigc::ptr_fun (&on_closed<Ekiga::AudioInputManager, Ekiga::AudioInputDevice>)));
+    conns.push_back (audiooutput_core->device_opened.connect (sigc::ptr_fun (&on_output_opened)));
+    conns.push_back (audiooutput_core->device_closed.connect (sigc::ptr_fun (&on_output_closed)));
+    conns.push_back (videoinput_core->device_opened.connect (sigc::ptr_fun (&on_opened<Ekiga::VideoInputManager, Ekiga::VideoInputDevice, Ekiga::VideoInputSettings>)));
+    conns.push_back (videoinput_core->device_closed.connect (sigc::ptr_fun (&on_closed<Ekiga::VideoInputManager, Ekiga::VideoInputDevice>)));
+  }
+
+  std::vector<Ekiga::AudioInputDevice> audioinput_devices;
+  audioinput_manager->get_devices (audioinput_devices);
+  audioinput_manager->set_device (audioinput_devices.front ());
+  run_device_events ("audio input", variant,
+		     sigc::hide_return (sigc::bind (sigc::mem_fun (audioinput_manager, &GMAudioInputManager_null::open), 1, 8000, 16)),
+		     sigc::mem_fun (audioinput_manager, &GMAudioInputManager_null::close));
+
+  std::vector<Ekiga::AudioOutputDevice> audiooutput_devices;
+  audiooutput_manager->get_devices (audiooutput_devices);
+  audiooutput_manager->set_device (Ekiga::primary, audiooutput_devices.front ());
+  run_device_events ("audio output", variant,
+		     sigc::hide_return (sigc::bind (sigc::mem_fun (audiooutput_manager, &GMAudioOutputManager_null::open), Ekiga::primary, 1, 8000, 16)),
+		     sigc::bind (sigc::mem_fun (audiooutput_manager, &GMAudioOutputManager_null::close), Ekiga::primary));
+
+  std::vector<Ekiga::VideoInputDevice> videoinput_devices;
+  videoinput_manager->get_devices (videoinput_devices);
+  videoinput_manager->set_device (videoinput_devices.front (), 0, Ekiga::VI_FORMAT_PAL);
+  run_device_events ("video input", variant,
+		     sigc::hide_return (sigc::bind (sigc::mem_fun (videoinput_manager, &GMVideoInputManager_mlogo::open), GM_QCIF_WIDTH, GM_QCIF_HEIGHT, 30)),
+		     sigc::mem_fun (videoinput_manager, &GMVideoInputManager_mlogo::close));
+
+  for (std::vector<sigc::connection>::iterator iter = conns.begin ();
+       iter != conns.end ();
+       ++iter)
+    iter->disconnect ();
+}
+
+
+int
+main (int /*argc*/,
+      char * /*argv*/[])
+{
+  static EventBench instance;
+
+  g_type_init ();
+  g_thread_init (NULL);
+  Ekiga::Runtime::init ();
+
+  std::cout << "path,variant,allocations_per_event,cpu_us_per_event" << std::endl;
+
+  bench_presence (true);
+  bench_presence (false);
+  bench_devices (true);
+  bench_devices (false);
+
+  Ekiga::Runtime::quit ();
+
+  return 0;
+}
@@ -0,0 +1,482 @@
+/* Ekiga -- A VoIP and Video-Conferencing application
+ * Copyright (C) 2000-2009 Damien Sandras <dsandras@seconix.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * Ekiga is licensed under the GPL license and as a special exception,
+ * you have permission to link or otherwise combine this program with the
+ * programs OPAL, OpenH323 and PWLIB, and distribute the combination,
+ * without applying the requirements of the GNU GPL to the OPAL, OpenH323
+ * and PWLIB programs, as long as you do follow the requirements of the
+ * GNU GPL for all the rest of the software thus combined.
+ */
+
+
+/*
+ *                         ekiga-load.cpp  -  description
+ *                         --------------------------------
+ *   begin                : written in 2009 by Damien Sandras
+ *   copyright            : (c) 2009 by Damien Sandras
+ *   description          : headless load generator, ramping up calls
+ *                          through the engine.
+ *
+ */
+
+
+/* The engine is started without any user interface, with the silent
+ * audio devices and the moving logo, and the opal component dials one
+ * more call every --ramp seconds until --calls are up ; they are then
+ * held --hold seconds more. Every --interval seconds, one CSV line is
+ * printed :
+ *
+ *   time_s,calls,established,cpu_pct,cpu_pct_per_call,rss_kb,rss_kb_per_call,threads,tx_kbps,rx_kbps,lost_pct,late_pct,jitter_ms
+ *
+ * The RTP figures are the last statistics of the established calls :
+ * bandwidths summed, the others averaged.
+ *
+ * Unless --target is given, the calls go to a SIP stand-in in the same
+ * process, where the loopback endpoint sends back what it receives : the
+ * CPU, memory and threads then include the far end of the calls. With an
+ * external stand-in, only the engine is measured.
+ *
+ * The engine runs with a configuration directory of its own, created
+ * empty in the temporary directory and removed at the end : it starts
+ * from the system defaults, doesn't register the accounts of the user
+ * running it, and what it saves (the configuration, the roster) doesn't
+ * touch theirs. As in Ekiga, all the calls share the audio and video
+ * devices.
+ */
+
+#include "config.h"
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <sip/sipep.h>
+
+#include "gmconf.h"
+#include "engine.h"
+#include "runtime.h"
+#include "call-core.h"
+#include "audioinput-core.h"
+#include "audiooutput-core.h"
+#include "videoinput-core.h"
+#include "opal-call-manager.h"
+#include "loopback-endpoint.h"
+
+
+class LoadGenerator : public PProcess
+{
+  PCLASSINFO(LoadGenerator, PProcess);
+
+public:
+
+  LoadGenerator ()
+    : PProcess ("", "ekiga-load")
+  {
+  }
+
+  void Main ()
+  {
+  }
+};
+
+
+struct LoadState
+{
+  LoadState (): calls(0), ramp(2), hold(30), interval(5), port(5080),
+                dialled(0), loop(NULL), last_cpu(0.0)
+  {}
+
+  /* options */
+  unsigned calls;
+  unsigned ramp;
+  unsigned hold;
+  unsigned interval;
+  unsigned port;
+  std::string target;
+
+  unsigned dialled;
+  GMainLoop *loop;
+  gmref_ptr<Opal::CallManager> manager;
+  std::map<std::string, Ekiga::CallStatistics> established;
+
+  GTimeVal start;
+  GTimeVal last;
+  double last_cpu;
+};
+
+
+static void
+usage (const char *name)
+{
+  std::cerr << "Usage: " << name << " --calls=n [--ramp=s] [--hold=s] [--interval=s]"
+            << " [--port=port | --target=uri]" << std::endl;
+}
+
+
+static double
+elapsed (const GTimeVal & from,
+         const GTimeVal & to)
+{
+  return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1000000.0;
+}
+
+
+static double
+process_cpu_time ()
+{
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return 0.0;
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+}
+
+
+/* Read the resident memory, in kbytes, and the threads of the process ;
+ * this is Linux only, elsewhere they are 0 */
+static void
+read_process_status (unsigned long & rss,
+                     unsigned & threads)
+{
+  FILE *file = fopen ("/proc/self/status", "r");
+  char line[256];
+
+  rss = 0;
+  threads = 0;
+  if (file == NULL)
+    return;
+
+  while (fgets (line, sizeof (line), file)) {
+
+    if (strncmp (line, "VmRSS:", 6) == 0)
+      rss = strtoul (line + 6, NULL, 10);
+    else if (strncmp (line, "Threads:", 8) == 0)
+      threads = strtoul (line + 8, NULL, 10);
+  }
+
+  fclose (file);
+}
+
+
+static void
+on_statistics_updated (Ekiga::CallStatistics stats,
+                       std::string id,
+                       LoadState *state)
+{
+  if (state->established.find (id) != state->established.end ())
+    state->established[id] = stats;
+}
+
+
+static void
+on_established_call (gmref_ptr<Ekiga::CallManager> /*manager*/,
+                     gmref_ptr<Ekiga::Call> call,
+                     LoadState *state)
+{
+  state->established[call->get_id ()] = Ekiga::CallStatistics ();
+  call->statistics_updated.connect (sigc::bind (sigc::ptr_fun (on_statistics_updated),
+                                                call->get_id (), state));
+}
+
+
+static void
+on_cleared_call (gmref_ptr<Ekiga::CallManager> /*manager*/,
+                 gmref_ptr<Ekiga::Call> call,
+                 std::string reason,
+                 LoadState *state)
+{
+  if (state->established.erase (call->get_id ()) > 0)
+    std::cerr << "Call " << call->get_id () << " cleared: " << reason << std::endl;
+}
+
+
+static gboolean
+dial_cb (gpointer data)
+{
+  LoadState *state = (LoadState *) data;
+
+  if (!state->manager->dial (state->target))
+    std::cerr << "Could not dial " << state->target << std::endl;
+
+  state->dialled++;
+
+  return (state->dialled < state->calls);
+}
+
+
+static gboolean
+sample_cb (gpointer data)
+{
+  LoadState *state = (LoadState *) data;
+  GTimeVal now;
+  unsigned long rss = 0;
+  unsigned threads = 0;
+  double cpu = process_cpu_time ();
+  double tx = 0, rx = 0, lost = 0, late = 0, jitter = 0;
+
+  g_get_current_time (&now);
+  read_process_status (rss, threads);
+
+  unsigned calls = state->established.size ();
+  double cpu_pct = 100 * (cpu - state->last_cpu) / std::max (elapsed (state->last, now), 0.001);
+
+  for (std::map<std::string, Ekiga::CallStatistics>::const_iterator iter = state->established.begin ();
+       iter != state->established.end ();
+       ++iter) {
+
+    tx += 8 * (iter->second.transmitted_audio_bandwidth + iter->second.transmitted_video_bandwidth);
+    rx += 8 * (iter->second.received_audio_bandwidth + iter->second.received_video_bandwidth);
+    lost += iter->second.lost_packets;
+    late += iter->second.late_packets;
+    jitter += iter->second.jitter;
+  }
+
+  std::cout << (int) elapsed (state->start, now) << ","
+            << state->dialled << "," << calls << ","
+            << cpu_pct << "," << (calls > 0 ? cpu_pct / calls : 0) << ","
+            << rss << "," << (calls > 0 ? rss / calls : 0) << ","
+            << threads << "," << tx << "," << rx << ","
+            << (calls > 0 ? lost / calls : 0) << ","
+            << (calls > 0 ? late / calls : 0) << ","
+            << (calls > 0 ? jitter / calls : 0) << std::endl;
+
+  state->last = now;
+  state->last_cpu = cpu;
+
+  return TRUE;
+}
+
+
+static gboolean
+stop_cb (gpointer data)
+{
+  LoadState *state = (LoadState *) data;
+
+  sample_cb (data);
+  g_main_loop_quit (state->loop);
+
+  return FALSE;
+}
+
+
+/* the configuration directory of the engine, empty ; returns "" if it
+ * couldn't be created */
+static std::string
+make_config_dir ()
+{
+  gchar *path = g_build_filename (g_get_tmp_dir (), "ekiga-load-XXXXXX", NULL);
+  std::string result;
+
+  if (mkdtemp (path) != NULL)
+    result = path;
+  g_free (path);
+
+  return result;
+}
+
+
+static void
+remove_config_dir (const std::string & path)
+{
+  GDir *dir = g_dir_open (path.c_str (), 0, NULL);
+
+  if (dir != NULL) {
+
+    const gchar *name = NULL;
+    while ((name = g_dir_read_name (dir)) != NULL) {
+
+      gchar *child = g_build_filename (path.c_str (), name, NULL);
+      if (g_file_test (child, G_FILE_TEST_IS_DIR))
+        remove_config_dir (child);
+      else
+        g_unlink (child);
+      g_free (child);
+    }
+    g_dir_close (dir);
+  }
+
+  g_rmdir (path.c_str ());
+}
+
+
+static void
+use_null_devices (Ekiga::ServiceCore & core)
+{
+  gmref_ptr<Ekiga::AudioInputCore> audioinput_core = core.get ("audioinput-core");
+  gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core = core.get ("audiooutput-core");
+  gmref_ptr<Ekiga::VideoInputCore> videoinput_core = core.get ("videoinput-core");
+
+  Ekiga::AudioInputDevice audioinput;
+  audioinput.type = audioinput.source = "Ekiga";
+  audioinput.name = "SILENT";
+  audioinput_core->set_device (audioinput);
+
+  Ekiga::AudioOutputDevice audiooutput;
+  audiooutput.type = audiooutput.source = "Ekiga";
+  audiooutput.name = "SILENT";
+  audiooutput_core->set_device (Ekiga::primary, audiooutput);
+  audiooutput_core->set_device (Ekiga::secondary, audiooutput);
+
+  Ekiga::VideoInputDevice videoinput;
+  videoinput.type = videoinput.source = videoinput.name = "Moving Logo";
+  videoinput_core->set_device (videoinput, 0, Ekiga::VI_FORMAT_PAL);
+}
+
+
+int
+main (int argc,
+      char *argv[])
+{
+  LoadState state;
+
+  g_type_init ();
+  g_thread_init (NULL);
+  signal (SIGPIPE, SIG_IGN);
+
+  for (int i = 1 ; i < argc ; i++) {
+
+    std::string arg = argv[i];
+
+    if (arg.compare (0, 8, "--calls=") == 0)
+      state.calls = atoi (arg.c_str () + 8);
+    else if (arg.compare (0, 7, "--ramp=") == 0)
+      state.ramp = std::max (atoi (arg.c_str () + 7), 1);
+    else if (arg.compare (0, 7, "--hold=") == 0)
+      state.hold = atoi (arg.c_str () + 7);
+    else if (arg.compare (0, 11, "--interval=") == 0)
+      state.interval = std::max (atoi (arg.c_str () + 11), 1);
+    else if (arg.compare (0, 7, "--port=") == 0)
+      state.port = atoi (arg.c_str () + 7);
+    else if (arg.compare (0, 9, "--target=") == 0)
+      state.target = arg.substr (9);
+    else {
+
+      usage (argv[0]);
+      return 1;
+    }
+  }
+
+  if (state.calls == 0) {
+
+    usage (argv[0]);
+    return 1;
+  }
+
+  /* before anything asks GLib for the configuration directory */
+  std::string config_dir = make_config_dir ();
+  if (config_dir.empty ()) {
+
+    std::cerr << "Could not create a configuration directory" << std::endl;
+    return 1;
+  }
+  g_setenv ("XDG_CONFIG_HOME", config_dir.c_str (), TRUE);
+
+  gm_conf_init ();
+
+  static LoadGenerator instance;
+
+  /* the far end of the calls, unless there is one already */
+  OpalManager *stand_in = NULL;
+  if (state.target.empty ()) {
+
+    std::stringstream listener;
+    std::stringstream target;
+
+    stand_in = new OpalManager;
+    SIPEndPoint *sip = new SIPEndPoint (*stand_in);
+    new GMLoopbackEndpoint (*stand_in);
+
+    listener << "udp$127.0.0.1:" << state.port;
+    if (!sip->StartListeners (PStringArray (listener.str ()))) {
+
+      std::cerr << "Could not listen on port " << state.port << std::endl;
+      gm_conf_shutdown ();
+      remove_config_dir (config_dir);
+      return 1;
+    }
+
+    target << "sip:loopback@127.0.0.1:" << state.port;
+    state.target = target.str ();
+  }
+
+  Ekiga::Runtime::init ();
+  engine_init (argc, argv, true);
+
+  Ekiga::ServiceCore *core = engine_get_service_core ();
+  if (core == NULL) {
+
+    std::cerr << "Could not start the engine" << std::endl;
+    gm_conf_shutdown ();
+    remove_config_dir (config_dir);
+    return 1;
+  }
+
+  use_null_devices (*core);
+
+  gmref_ptr<Ekiga::CallCore> call_core = core->get ("call-core");
+  state.manager = core->get ("opal-component");
+
+  call_core->established_call.connect (sigc::bind (sigc::ptr_fun (on_established_call), &state));
+  call_core->cleared_call.connect (sigc::bind (sigc::ptr_fun (on_cleared_call), &state));
+
+  std::cout << "time_s,calls,established,cpu_pct,cpu_pct_per_call,rss_kb,rss_kb_per_call,threads,tx_kbps,rx_kbps,lost_pct,late_pct,jitter_ms" << std::endl;
+
+  g_get_current_time (&state.start);
+  state.last = state.start;
+  state.last_cpu = process_cpu_time ();
+  state.loop = g_main_loop_new (NULL, FALSE);
+
+  dial_cb (&state);
+  if (state.calls > 1)
+    g_timeout_add (state.ramp * 1000, dial_cb, &state);
+  g_timeout_add (state.interval * 1000, sample_cb, &state);
+  g_timeout_add (((state.calls - 1) * state.ramp + state.hold) * 1000, stop_cb, &state);
+
+  g_main_loop_run (state.loop);
+  g_main_loop_unref (state.loop);
+
+  state.manager->ClearAllCalls (OpalConnection::EndedByLocalUser, true);
+  state.manager.reset ();
+  call_core.reset ();
+
+  engine_stop ();
+  Ekiga::Runtime::quit ();
+
+  delete stand_in;
+
+  /* the pending save is dropped, and what was saved goes away */
+  gm_conf_shutdown ();
+  remove_config_dir (config_dir);
+
+  return 0;
+}
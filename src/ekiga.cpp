@@ -248,4 +248,6 @@ GnomeMeeting::StopEngine ()
   engine_stop ();
 
   Ekiga::Runtime::quit ();
+
+  gmref_debug_dump ();
 }
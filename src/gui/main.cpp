@@ -97,6 +97,7 @@
 #include "audiooutput-core.h"
 
 #include "call-core.h"
+#include "contact-core.h"
 #include "account.h"
 #include "gtk-frontend.h"
 #include "roster-view-gtk.h"
@@ -121,6 +122,11 @@ struct _EkigaMainWindowPrivate
 {
   Ekiga::ServiceCore *core;
 
+  /* Services used by the refresh timers */
+  Ekiga::ServiceHandle<Ekiga::AudioInputCore> audioinput_core;
+  Ekiga::ServiceHandle<Ekiga::AudioOutputCore> audiooutput_core;
+  Ekiga::ServiceHandle<Ekiga::VideoOutputCore> videooutput_core;
+
   GtkAccelGroup *accel;
   GtkWidget *main_menu;
   GtkWidget *main_notebook;
@@ -166,7 +172,6 @@ struct _EkigaMainWindowPrivate
   GtkWidget *output_signal;
   GtkObject *adj_input_volume;
   GtkObject *adj_output_volume;
-  unsigned int levelmeter_timeout_id;
 
   /* Video Settings Window */
   GtkWidget *video_settings_window;
@@ -195,9 +200,24 @@ struct _EkigaMainWindowPrivate
   std::list<std::string> accounts;
   Ekiga::Presentity* presentity;
 
+  /* Completion of the URL bar from the contacts */
+  Ekiga::ContactSearchPtr search;
+
   std::vector<sigc::connection> connections;
 };
 
+/* columns of the URL bar completion */
+enum {
+  COMPLETION_URI,
+  COMPLETION_NAME,
+  COMPLETION_RANK,
+  COMPLETION_FOUND,   // the row comes from a contact search
+  COMPLETION_NUMBER
+};
+
+/* how many contacts are offered at most */
+#define MAX_FOUND_COMPLETIONS 20
+
 /* properties */
 enum {
   PROP_0,
@@ -358,6 +378,15 @@ static void transfer_current_call_cb (GtkWidget *,
 				      gpointer);
 
 
+/* DESCRIPTION  :  /
+ * BEHAVIOR     :  Asks for a file and saves the recent statistics of the
+ *                 current call there, one line per second.
+ * PRE          :  a pointer to the main window
+ */
+static void save_call_statistics_cb (GtkWidget *,
+                                     gpointer);
+
+
 /* DESCRIPTION  :  This callback is called when the user changes the
  *                 audio settings sliders in the main notebook.
  * BEHAVIOR     :  Update the volume of the choosen mixers. If the update
@@ -467,6 +496,26 @@ static void fullscreen_changed_cb (GtkWidget *,
 static void url_changed_cb (GtkEditable *, 
 			    gpointer);
 
+/* DESCRIPTION  :  This callback is called when the contact search started
+ *                 from the URL bar found contacts.
+ * BEHAVIOR     :  Adds their URIs to the completion, best ranked first.
+ * PRE          :  A valid pointer to the main window GMObject.
+ */
+static void on_contact_search_results (const std::list<Ekiga::ContactSearchResult> &,
+				       bool,
+				       EkigaMainWindow *);
+
+/* DESCRIPTION  :  This callback is called by the URL bar completion for
+ *                 each of its rows.
+ * BEHAVIOR     :  Shows the rows beginning with the URL, as usual, and
+ *                 all the contacts the search found.
+ * PRE          :  A valid pointer to the main window GMObject.
+ */
+static gboolean completion_match_cb (GtkEntryCompletion *,
+				     const gchar *,
+				     GtkTreeIter *,
+				     gpointer);
+
 /* DESCRIPTION  :  This callback is called when the user presses a
  *                 button in the toolbar. 
  *                 (See menu_toggle_changed)
@@ -606,9 +655,7 @@ static gboolean on_stats_refresh_cb (gpointer self)
   if (mw->priv->calling_state == Connected && mw->priv->current_call) {
 
     Ekiga::VideoOutputStats videooutput_stats;
-    gmref_ptr<Ekiga::VideoOutputCore> videooutput_core
-      = mw->priv->core->get ("videooutput-core");
-    videooutput_core->get_videooutput_stats(videooutput_stats);
+    mw->priv->videooutput_core->get_videooutput_stats(videooutput_stats);
   
     msg = g_strdup_printf (_("A:%.1f/%.1f   V:%.1f/%.1f   FPS:%d/%d"), 
                            mw->priv->current_call->get_transmitted_audio_bandwidth (),
@@ -635,18 +682,20 @@ static gboolean on_stats_refresh_cb (gpointer self)
   return true;
 }
 
-static gboolean on_signal_level_refresh_cb (gpointer self) 
+static void on_audioinput_level_changed_cb (float level,
+                                            gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
 
-  gmref_ptr<Ekiga::AudioInputCore> audioinput_core
-    = mw->priv->core->get ("audioinput-core");
-  gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core
-    = mw->priv->core->get ("audiooutput-core");
+  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->input_signal), level);
+}
 
-  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->output_signal), audiooutput_core->get_average_level());
-  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->input_signal), audioinput_core->get_average_level());
-  return true;
+static void on_audiooutput_level_changed_cb (float level,
+                                             gpointer self)
+{
+  EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
+
+  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->output_signal), level);
 }
 
 static void on_established_call_cb (gmref_ptr<Ekiga::CallManager>  /*manager*/,
@@ -1081,8 +1130,8 @@ on_size_changed_cb (Ekiga::VideoOutputManager & /* manager */, unsigned width, u
 
 void
 on_videoinput_device_opened_cb (Ekiga::VideoInputManager & /* manager */,
-                                Ekiga::VideoInputDevice & /* device */,
-                                Ekiga::VideoInputSettings & settings,
+                                const Ekiga::VideoInputDevice & /* device */,
+                                const Ekiga::VideoInputSettings & settings,
                                 gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
@@ -1099,7 +1148,7 @@ on_videoinput_device_opened_cb (Ekiga::VideoInputManager & /* manager */,
 
 
 void 
-on_videoinput_device_closed_cb (Ekiga::VideoInputManager & /* manager */, Ekiga::VideoInputDevice & /*device*/, gpointer self)
+on_videoinput_device_closed_cb (Ekiga::VideoInputManager & /* manager */, const Ekiga::VideoInputDevice & /*device*/, gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
 
@@ -1137,7 +1186,7 @@ on_videoinput_device_removed_cb (const Ekiga::VideoInputDevice & device, bool, g
 
 void 
 on_videoinput_device_error_cb (Ekiga::VideoInputManager & /* manager */, 
-                               Ekiga::VideoInputDevice & device, 
+                               const Ekiga::VideoInputDevice & device, 
                                Ekiga::VideoInputErrorCodes error_code, 
                                gpointer self)
 {
@@ -1193,8 +1242,8 @@ on_videoinput_device_error_cb (Ekiga::VideoInputManager & /* manager */,
 
 void
 on_audioinput_device_opened_cb (Ekiga::AudioInputManager & /* manager */,
-                                Ekiga::AudioInputDevice & /* device */,
-                                Ekiga::AudioInputSettings & settings,
+                                const Ekiga::AudioInputDevice & /* device */,
+                                const Ekiga::AudioInputSettings & settings,
                                 gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
@@ -1210,7 +1259,7 @@ on_audioinput_device_opened_cb (Ekiga::AudioInputManager & /* manager */,
 
 void 
 on_audioinput_device_closed_cb (Ekiga::AudioInputManager & /* manager */, 
-                                Ekiga::AudioInputDevice & /*device*/, 
+                                const Ekiga::AudioInputDevice & /*device*/, 
                                 gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
@@ -1253,7 +1302,7 @@ on_audioinput_device_removed_cb (const Ekiga::AudioInputDevice & device,
 
 void 
 on_audioinput_device_error_cb (Ekiga::AudioInputManager & /* manager */, 
-                               Ekiga::AudioInputDevice & device, 
+                               const Ekiga::AudioInputDevice & device, 
                                Ekiga::AudioInputErrorCodes error_code, 
                                gpointer self)
 {
@@ -1297,8 +1346,8 @@ on_audioinput_device_error_cb (Ekiga::AudioInputManager & /* manager */,
 void
 on_audiooutput_device_opened_cb (Ekiga::AudioOutputManager & /*manager*/,
                                  Ekiga::AudioOutputPS ps,
-                                 Ekiga::AudioOutputDevice & /*device*/,
-                                 Ekiga::AudioOutputSettings & settings,
+                                 const Ekiga::AudioOutputDevice & /*device*/,
+                                 const Ekiga::AudioOutputSettings & settings,
                                  gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
@@ -1318,7 +1367,7 @@ on_audiooutput_device_opened_cb (Ekiga::AudioOutputManager & /*manager*/,
 void 
 on_audiooutput_device_closed_cb (Ekiga::AudioOutputManager & /*manager*/, 
                                  Ekiga::AudioOutputPS ps, 
-                                 Ekiga::AudioOutputDevice & /*device*/, 
+                                 const Ekiga::AudioOutputDevice & /*device*/, 
                                  gpointer self)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (self);
@@ -1367,7 +1416,7 @@ on_audiooutput_device_removed_cb (const Ekiga::AudioOutputDevice & device,
 void 
 on_audiooutput_device_error_cb (Ekiga::AudioOutputManager & /*manager */, 
                                 Ekiga::AudioOutputPS ps,
-                                Ekiga::AudioOutputDevice & device, 
+                                const Ekiga::AudioOutputDevice & device, 
                                 Ekiga::AudioOutputErrorCodes error_code, 
                                 gpointer self)
 {
@@ -1984,6 +2033,73 @@ toggle_video_stream_pause_cb (GtkWidget * /*widget*/,
 }
 
 
+static void
+save_call_statistics_cb (GtkWidget * /*widget*/,
+                         gpointer data)
+{
+  EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (data);
+  GtkWidget *dialog = NULL;
+  gchar *filename = NULL;
+  GError *error = NULL;
+
+  if (!mw->priv->current_call)
+    return;
+
+  dialog = gtk_file_chooser_dialog_new (_("Save Call Statistics"),
+                                        GTK_WINDOW (mw),
+                                        GTK_FILE_CHOOSER_ACTION_SAVE,
+                                        GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+                                        GTK_STOCK_SAVE, GTK_RESPONSE_ACCEPT,
+                                        NULL);
+  gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (dialog), TRUE);
+  gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (dialog), "call-statistics.csv");
+
+  if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
+    filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+  gtk_widget_destroy (dialog);
+
+  /* the call may have ended while the dialog was shown */
+  if (filename == NULL || !mw->priv->current_call) {
+
+    g_free (filename);
+    return;
+  }
+
+  std::list<Ekiga::CallStatistics> history;
+  mw->priv->current_call->get_statistics_history (history);
+
+  GString *csv = g_string_new ("time,audio rx,audio tx,video rx,video tx,"
+                               "jitter,lost,late,out of order\n");
+  for (std::list<Ekiga::CallStatistics>::const_iterator iter = history.begin ();
+       iter != history.end ();
+       ++iter) {
+
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* not localized : the decimal separator must stay a dot */
+    g_string_append_printf (csv, "%ld", (long) iter->timestamp);
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->received_audio_bandwidth));
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->transmitted_audio_bandwidth));
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->received_video_bandwidth));
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->transmitted_video_bandwidth));
+    g_string_append_printf (csv, ",%u", iter->jitter);
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->lost_packets));
+    g_string_append_printf (csv, ",%s", g_ascii_dtostr (buffer, sizeof (buffer), iter->late_packets));
+    g_string_append_printf (csv, ",%s\n", g_ascii_dtostr (buffer, sizeof (buffer), iter->out_of_order_packets));
+  }
+
+  if (!g_file_set_contents (filename, csv->str, csv->len, &error)) {
+
+    gnomemeeting_error_dialog (GTK_WINDOW (mw), _("Could not save the call statistics"),
+                               "%s", error->message);
+    g_error_free (error);
+  }
+
+  g_string_free (csv, TRUE);
+  g_free (filename);
+}
+
+
 static void 
 transfer_current_call_cb (G_GNUC_UNUSED GtkWidget *widget,
 			  gpointer data)
@@ -2024,9 +2140,11 @@ audio_volume_window_shown_cb (GtkWidget * /*widget*/,
   gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core
     = mw->priv->core->get ("audiooutput-core");
 
+  /* the cores push the new levels while audio flows */
+  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->input_signal), audioinput_core->get_average_level ());
+  gm_level_meter_set_level (GM_LEVEL_METER (mw->priv->output_signal), audiooutput_core->get_average_level ());
   audioinput_core->set_average_collection (true);
   audiooutput_core->set_average_collection (true);
-  mw->priv->levelmeter_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 50, on_signal_level_refresh_cb, data, NULL);
 }
 
 
@@ -2041,7 +2159,6 @@ audio_volume_window_hidden_cb (GtkWidget * /*widget*/,
   gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core
     = mw->priv->core->get ("audiooutput-core");
 
-  g_source_remove (mw->priv->levelmeter_timeout_id);
   audioinput_core->set_average_collection (false);
   audiooutput_core->set_average_collection (false);
 }
@@ -2230,8 +2347,18 @@ url_changed_cb (GtkEditable *e,
   const char *tip_text = NULL;
   gchar *entry = NULL;
 
+  const char *query = NULL;
+  gboolean valid = FALSE;
+  gboolean found = FALSE;
+
   tip_text = gtk_entry_get_text (GTK_ENTRY (e));
 
+  if (mw->priv->search) {
+
+    mw->priv->search->cancel ();
+    mw->priv->search.reset ();
+  }
+
   if (g_strrstr (tip_text, "@") == NULL) {
 
     gtk_list_store_clear (mw->priv->completion);
@@ -2242,15 +2369,133 @@ url_changed_cb (GtkEditable *e,
 
       entry = g_strdup_printf ("%s@%s", tip_text, it->c_str ());
       gtk_list_store_append (mw->priv->completion, &iter);
-      gtk_list_store_set (mw->priv->completion, &iter, 0, entry, -1);
+      gtk_list_store_set (mw->priv->completion, &iter, COMPLETION_URI, entry, -1);
       g_free (entry);
     }
   }
+  else {
+
+    valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (mw->priv->completion), &iter);
+    while (valid) {
+
+      gtk_tree_model_get (GTK_TREE_MODEL (mw->priv->completion), &iter,
+			  COMPLETION_FOUND, &found, -1);
+      if (found)
+	valid = gtk_list_store_remove (mw->priv->completion, &iter);
+      else
+	valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (mw->priv->completion), &iter);
+    }
+  }
+
+  /* search the contacts of all the books, without the scheme */
+  query = strchr (tip_text, ':');
+  query = (query != NULL) ? query + 1 : tip_text;
+
+  if (g_utf8_strlen (query, -1) >= 2 && mw->priv->core != NULL) {
+
+    gmref_ptr<Ekiga::ContactCore> contact_core = mw->priv->core->get ("contact-core");
+
+    if (contact_core)
+      mw->priv->search
+	= contact_core->search (query,
+				sigc::bind (sigc::ptr_fun (on_contact_search_results), mw));
+  }
 
   gtk_widget_set_tooltip_text (GTK_WIDGET (e), tip_text);
 }
 
 
+static void
+on_contact_search_results (const std::list<Ekiga::ContactSearchResult> &results,
+			   bool /*finished*/,
+			   EkigaMainWindow *mw)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (mw->priv->completion);
+  GtkTreeIter iter;
+  GtkTreeIter position;
+  gboolean valid = FALSE;
+  gboolean found = FALSE;
+  guint rank = 0;
+  unsigned count = 0;
+
+  valid = gtk_tree_model_get_iter_first (model, &iter);
+  while (valid) {
+
+    gtk_tree_model_get (model, &iter, COMPLETION_FOUND, &found, -1);
+    if (found)
+      count++;
+    valid = gtk_tree_model_iter_next (model, &iter);
+  }
+
+  for (std::list<Ekiga::ContactSearchResult>::const_iterator result = results.begin ();
+       result != results.end () && count < MAX_FOUND_COMPLETIONS;
+       ++result, count++) {
+
+    /* after the rows ranked as well or better */
+    valid = gtk_tree_model_get_iter_first (model, &position);
+    while (valid) {
+
+      gtk_tree_model_get (model, &position,
+			  COMPLETION_FOUND, &found,
+			  COMPLETION_RANK, &rank, -1);
+      if (found && rank > result->rank)
+	break;
+      valid = gtk_tree_model_iter_next (model, &position);
+    }
+
+    if (valid)
+      gtk_list_store_insert_before (mw->priv->completion, &iter, &position);
+    else
+      gtk_list_store_append (mw->priv->completion, &iter);
+
+    gtk_list_store_set (mw->priv->completion, &iter,
+			COMPLETION_URI, result->uri.c_str (),
+			COMPLETION_NAME, result->name.c_str (),
+			COMPLETION_RANK, result->rank,
+			COMPLETION_FOUND, TRUE,
+			-1);
+  }
+}
+
+
+static gboolean
+completion_match_cb (G_GNUC_UNUSED GtkEntryCompletion *completion,
+		     const gchar *key,
+		     GtkTreeIter *iter,
+		     gpointer data)
+{
+  EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (data);
+  gchar *uri = NULL;
+  gchar *normalized = NULL;
+  gchar *folded = NULL;
+  gboolean found = FALSE;
+  gboolean result = FALSE;
+
+  gtk_tree_model_get (GTK_TREE_MODEL (mw->priv->completion), iter,
+		      COMPLETION_URI, &uri,
+		      COMPLETION_FOUND, &found, -1);
+
+  /* key is already normalized and case-folded */
+  if (found)
+    result = TRUE;
+  else if (uri != NULL) {
+
+    normalized = g_utf8_normalize (uri, -1, G_NORMALIZE_ALL);
+    if (normalized != NULL) {
+
+      folded = g_utf8_casefold (normalized, -1);
+      result = (strncmp (key, folded, strlen (key)) == 0);
+      g_free (folded);
+      g_free (normalized);
+    }
+  }
+
+  g_free (uri);
+
+  return result;
+}
+
+
 static void 
 toolbar_toggle_button_changed_cb (G_GNUC_UNUSED GtkWidget *widget,
 				  gpointer data)
@@ -3166,6 +3411,11 @@ ekiga_main_window_init_menu (EkigaMainWindow *mw)
  		     NULL, GDK_t, 
 		     G_CALLBACK (transfer_current_call_cb), mw,
 		     FALSE),
+      GTK_MENU_ENTRY("save_call_statistics", _("_Save Statistics..."),
+		     _("Save the statistics of the last minute of the current call"),
+ 		     GTK_STOCK_SAVE_AS, 0,
+		     G_CALLBACK (save_call_statistics_cb), mw,
+		     FALSE),
 
       GTK_MENU_SEPARATOR,
 
@@ -3317,6 +3567,7 @@ ekiga_main_window_init_uri_toolbar (EkigaMainWindow *mw)
 {
   GtkToolItem *item = NULL;
   GtkEntryCompletion *completion = NULL;
+  GtkCellRenderer *renderer = NULL;
 
   g_return_if_fail (EKIGA_IS_MAIN_WINDOW (mw));
 
@@ -3329,13 +3580,24 @@ ekiga_main_window_init_uri_toolbar (EkigaMainWindow *mw)
   /* Entry */
   item = gtk_tool_item_new ();
   mw->priv->entry = gtk_entry_new ();
-  mw->priv->completion = gtk_list_store_new (1, G_TYPE_STRING);
+  mw->priv->completion = gtk_list_store_new (COMPLETION_NUMBER,
+					     G_TYPE_STRING,
+					     G_TYPE_STRING,
+					     G_TYPE_UINT,
+					     G_TYPE_BOOLEAN);
   completion = gtk_entry_completion_new ();
   gtk_entry_completion_set_model (GTK_ENTRY_COMPLETION (completion), GTK_TREE_MODEL (mw->priv->completion));
   gtk_entry_set_completion (GTK_ENTRY (mw->priv->entry), completion);
   gtk_entry_completion_set_inline_completion (GTK_ENTRY_COMPLETION (completion), false);
   gtk_entry_completion_set_popup_completion (GTK_ENTRY_COMPLETION (completion), true);
-  gtk_entry_completion_set_text_column (GTK_ENTRY_COMPLETION (completion), 0);
+  gtk_entry_completion_set_text_column (GTK_ENTRY_COMPLETION (completion), COMPLETION_URI);
+  gtk_entry_completion_set_match_func (GTK_ENTRY_COMPLETION (completion),
+				       completion_match_cb, mw, NULL);
+  renderer = gtk_cell_renderer_text_new ();
+  g_object_set (renderer, "foreground", "darkgray", NULL);
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (completion), renderer, FALSE);
+  gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (completion), renderer,
+				 "text", COMPLETION_NAME);
 
   gtk_container_add (GTK_CONTAINER (item), mw->priv->entry);
   gtk_container_set_border_width (GTK_CONTAINER (item), 0);
@@ -3795,7 +4057,6 @@ ekiga_main_window_init (EkigaMainWindow *mw)
   mw->priv->transfer_call_popup = NULL;
   mw->priv->current_call = gmref_ptr<Ekiga::Call>(0);
   mw->priv->timeout_id = -1;
-  mw->priv->levelmeter_timeout_id = -1;
   mw->priv->calling_state = Standby;
   mw->priv->audio_transmission_active = false;
   mw->priv->audio_reception_active = false;
@@ -3835,6 +4096,9 @@ ekiga_main_window_finalize (GObject *gobject)
 {
   EkigaMainWindow *mw = EKIGA_MAIN_WINDOW (gobject);
 
+  if (mw->priv->search)
+    mw->priv->search->cancel ();
+
   gtk_widget_destroy (mw->priv->audio_settings_window);
   gtk_widget_destroy (mw->priv->video_settings_window);
 
@@ -3956,6 +4220,9 @@ ekiga_main_window_set_property (GObject *object,
     case PROP_SERVICE_CORE:
       mw->priv->core = static_cast<Ekiga::ServiceCore *>
                                                  (g_value_get_pointer (value));
+      mw->priv->audioinput_core.bind (*mw->priv->core, "audioinput-core");
+      mw->priv->audiooutput_core.bind (*mw->priv->core, "audiooutput-core");
+      mw->priv->videooutput_core.bind (*mw->priv->core, "videooutput-core");
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -4054,6 +4321,9 @@ ekiga_main_window_connect_engine_signals (EkigaMainWindow *mw)
   conn = audioinput_core->device_error.connect (sigc::bind (sigc::ptr_fun (on_audioinput_device_error_cb), (gpointer) mw));
   mw->priv->connections.push_back (conn);
 
+  conn = audioinput_core->average_level_changed.connect (sigc::bind (sigc::ptr_fun (on_audioinput_level_changed_cb), (gpointer) mw));
+  mw->priv->connections.push_back (conn);
+
   /* New AudioOutput Engine signals */
   gmref_ptr<Ekiga::AudioOutputCore> audiooutput_core
     = mw->priv->core->get ("audiooutput-core");
@@ -4072,6 +4342,9 @@ ekiga_main_window_connect_engine_signals (EkigaMainWindow *mw)
 
   conn = audiooutput_core->device_error.connect (sigc::bind (sigc::ptr_fun (on_audiooutput_device_error_cb), (gpointer) mw));
   mw->priv->connections.push_back (conn);
+
+  conn = audiooutput_core->average_level_changed.connect (sigc::bind (sigc::ptr_fun (on_audiooutput_level_changed_cb), (gpointer) mw));
+  mw->priv->connections.push_back (conn);
     
   /* New Call Engine signals */
   gmref_ptr<Ekiga::CallCore> call_core = mw->priv->core->get ("call-core");
@@ -4358,9 +4631,10 @@ ekiga_main_window_update_stats (EkigaMainWindow *mw,
     quality_level = 0.2;
   }
 
-  if ( (lost > 0.02) ||
-       (late > 0.02) ||
-       (out_of_order > 0.02) ) {
+  /* those are percentages */
+  if ( (lost > 2.0) ||
+       (late > 2.0) ||
+       (out_of_order > 2.0) ) {
     quality_level = 0;
   }
 
@@ -777,6 +777,13 @@ gm_pw_init_audio_devices_page (GtkWidget *prefs_window,
     gnome_prefs_string_option_menu_new (subsection, _("Input device:"), (const gchar **)array, AUDIO_DEVICES_KEY "input_device", _("Select the audio input device to use"), 2, get_default_audio_device_name ());
   g_free (array);
 
+  subsection = gnome_prefs_subsection_new (prefs_window, container,
+                                           _("Audio Processing"), 3, 1);
+
+  gnome_prefs_toggle_new (subsection, _("_Remove the low frequencies"), AUDIO_DEVICES_KEY "high_pass_filter", _("If enabled, the hum and the rumble under 100 Hz are removed from the captured audio"), 0);
+  gnome_prefs_toggle_new (subsection, _("Attenuate the background _noise"), AUDIO_DEVICES_KEY "noise_gate", _("If enabled, the captured audio is attenuated while its level stays under a threshold, so that the background noise is not sent between the sentences"), 1);
+  gnome_prefs_toggle_new (subsection, _("Adjust the input _level automatically"), AUDIO_DEVICES_KEY "automatic_gain_control", _("If enabled, the level of the captured speech is adjusted automatically"), 2);
+
 
   /* That button will refresh the device list */
   gm_pw_add_update_button (prefs_window, container, GTK_STOCK_REFRESH, _("_Detect devices"), G_CALLBACK (refresh_devices_list_cb), _("Click here to refresh the device list."), 1, prefs_window);
@@ -973,7 +980,7 @@ gm_pw_init_audio_codecs_page (GtkWidget *prefs_window,
   /* Here we add the audio codecs options */
   subsection = 
     gnome_prefs_subsection_new (prefs_window, container,
-				_("Settings"), 3, 1);
+				_("Settings"), 5, 1);
 
   /* Translators: the full sentence is Automatically adjust jitter buffer
      between X and Y ms */
@@ -981,7 +988,11 @@ gm_pw_init_audio_codecs_page (GtkWidget *prefs_window,
   
   gnome_prefs_toggle_new (subsection, _("Enable echo can_celation"), AUDIO_CODECS_KEY "enable_echo_cancelation", _("If enabled, use echo cancelation."), 1);
 
-  gnome_prefs_spin_new (subsection, _("Maximum _jitter buffer (in ms):"), AUDIO_CODECS_KEY "maximum_jitter_buffer", _("The maximum jitter buffer size for audio reception (in ms)."), 20.0, 2000.0, 50.0, 2, NULL, true);
+  gnome_prefs_toggle_new (subsection, _("_Adapt the jitter buffer to the network"), AUDIO_CODECS_KEY "adaptive_jitter_buffer", _("If enabled, the jitter buffer size follows the network conditions, up to the maximum jitter buffer."), 2);
+
+  gnome_prefs_spin_new (subsection, _("Maximum _jitter buffer (in ms):"), AUDIO_CODECS_KEY "maximum_jitter_buffer", _("The maximum jitter buffer size for audio reception (in ms)."), 20.0, 2000.0, 50.0, 3, NULL, true);
+
+  gnome_prefs_toggle_new (subsection, _("Order the codecs _automatically"), CODECS_KEY "automatic_ordering", _("If enabled, the codecs too expensive for the CPU left or for the network are moved after the others, and the video size is reduced if needed, at each call. Disabled codecs stay disabled."), 4);
 }
 
 